@@ -11,6 +11,12 @@
 #include "BonSolReader.hpp"
 namespace Bonmin
 {
+  void BonminAmplSetup::registerOptions()
+  {
+    BonminSetup::registerOptions();
+    AmplTMINLP::registerOptions(roptions_);
+  }
+
   void BonminAmplSetup::initialize(char **& argv)
   {
     readOptionsFile();
@@ -39,6 +45,7 @@ namespace Bonmin
     setOptionsAndJournalist(solver->roptions(),
         solver->options(),
         solver->journalist());
+    AmplTMINLP::registerOptions(roptions_);
     /* Get the basic options. */
     readOptionsFile();
     /* Read the model.*/
@@ -17,6 +17,8 @@ namespace Bonmin
   class BonminAmplSetup: public BonminSetup
   {
   public:
+    /** Register all the options, including the ones of the AMPL interface.*/
+    virtual void registerOptions();
     /** initialize bonmin with ampl model using the command line arguments.*/
     void initialize(char **& argv);
     /** initialize bonmin with ampl model using the command line arguments and an existing OsiTMINLPInterface.*/
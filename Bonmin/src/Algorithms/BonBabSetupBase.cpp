@@ -22,6 +22,7 @@
 #include "BonChooseVariable.hpp"
 #include "BonTMINLP2Quad.hpp"
 #include "BonTMINLPLinObj.hpp"
+#include "BonAsyncJournal.hpp"
 namespace Bonmin
 {
   int BabSetupBase::defaultIntParam_[BabSetupBase::NumberIntParam] = {
@@ -255,9 +256,24 @@ namespace Bonmin
       linObj->setTminlp(GetRawPtr(tminlp));
       tminlp = GetRawPtr(linObj);
     }
+    bool asyncOutput = false;
+    int async;
+    options_->GetEnumValue("async_output", async, prefix_.c_str());
+    if (async) {
+      AsyncJournal * console =
+        dynamic_cast<AsyncJournal *>(GetRawPtr(journalist_->GetJournal("console")));
+      asyncOutput = console != NULL && console->startWriter();
+    }
     nonlinearSolver_->initialize(roptions_, options_, journalist_, prefix(), tminlp);
     if(messageHandler_ != NULL)
       nonlinearSolver_->passInMessageHandler(messageHandler_);
+    else if (asyncOutput) {
+      // Bonmin's and Cbc's messages have to go through the console journal
+      // to stay in order with Ipopt's output
+      messageHandler_ = new JournalMessageHandler(journalist_->GetJournal("console"),
+                                                  *nonlinearSolver_->messageHandler());
+      nonlinearSolver_->passInMessageHandler(messageHandler_);
+    }
     else
       messageHandler_ = nonlinearSolver_->messageHandler()->clone();
     if (ival){
@@ -442,6 +458,18 @@ namespace Bonmin
                                             "");
     roptions->setOptionExtraInfo("nlp_log_at_root",63);
 
+    roptions->AddStringOption2("async_output",
+        "Write the console output from a separate thread.",
+        "no",
+        "no", "",
+        "yes", "",
+        "Each thread formats and buffers its messages itself, complete lines "
+        "are written by a background thread. The output of solvers running in "
+        "different threads then interleaves line by line without locking. "
+        "Requires Bonmin to be configured with --enable-bonmin-threads, "
+        "the option is ignored otherwise.");
+    roptions->setOptionExtraInfo("async_output", 127);
+
     roptions->SetRegisteringCategory("Branch-and-bound options", RegisteredOptions::BonminCategory);
 
   roptions->AddLowerBoundedIntegerOption
@@ -653,8 +681,12 @@ namespace Bonmin
     roptions_ = new Bonmin::RegisteredOptions();
 
     try {
-      Ipopt::SmartPtr<Ipopt::Journal> stdout_journal =
-        journalist_->AddFileJournal("console", "stdout", Ipopt::J_ITERSUMMARY);
+      // The console can be switched to asynchronous output once the options
+      // are read (see use())
+      Ipopt::SmartPtr<AsyncJournal> stdout_journal =
+        new AsyncJournal("console", Ipopt::J_ITERSUMMARY);
+      stdout_journal->Open("stdout");
+      journalist_->AddJournal(GetRawPtr(stdout_journal));
 
       options_->SetJournalist(journalist_);
       options_->SetRegisteredOptions(GetRawPtr(roptions_));
@@ -15,6 +15,7 @@
 #include "CbcStrategy.hpp"
 #include "OsiAuxInfo.hpp"
 #include "OsiClpSolverInterface.hpp"
+#include "CoinThreadPool.hpp"
 
 #include <climits>
 #ifdef COIN_HAS_CPX
@@ -68,6 +69,10 @@ namespace Bonmin {
 #if 1
       
       b.options()->GetIntegerValue("number_cpx_threads",ivalue,prefix);
+      // By default CPLEX takes all processors, leave it only the threads of
+      // the COIN-OR thread pool not used by others when such a pool is set up
+      if (ivalue == 0 && CoinThreadPool::global().numberThreads() > 1)
+        ivalue = CoinThreadPool::global().availableThreads();
       CPXsetintparam(cpxSolver->getEnvironmentPtr(), CPX_PARAM_THREADS, ivalue);
       b.options()->GetIntegerValue("cpx_parallel_strategy",ivalue,prefix);
       CPXsetintparam(cpxSolver->getEnvironmentPtr(), CPX_PARAM_PARALLELMODE, ivalue);
@@ -570,7 +575,9 @@ namespace Bonmin {
     roptions->AddLowerBoundedIntegerOption("number_cpx_threads",
                            "Set number of threads to use with cplex.",
                            0, 0,
-                           "(refer to CPLEX documentation)"
+                           "(refer to CPLEX documentation). If 0 and the COIN-OR thread pool has "
+                           "more than one thread (environment variable COIN_THREADS), CPLEX gets "
+                           "the threads of the pool not reserved by others."
                            );
     roptions->setOptionExtraInfo("number_cpx_threads",64);
 
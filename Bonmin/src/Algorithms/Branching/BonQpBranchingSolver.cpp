@@ -19,11 +19,15 @@ namespace Bonmin
 
   QpBranchingSolver::QpBranchingSolver(OsiTMINLPInterface * solver)
       :
-      StrongBranchingSolver(solver)
+      StrongBranchingSolver(solver),
+      first_solve_(true),
+      node_infeasible_(false)
   {}
 
   QpBranchingSolver::QpBranchingSolver(const QpBranchingSolver & rhs) :
-      StrongBranchingSolver(rhs)
+      StrongBranchingSolver(rhs),
+      first_solve_(true),
+      node_infeasible_(false)
   {}
 
   QpBranchingSolver &
@@ -54,26 +58,28 @@ namespace Bonmin
     branching_tqp_ = new BranchingTQP(tminlp2tnlp);
 
     first_solve_ = true;
+    node_infeasible_ = false;
 #ifdef COIN_HAS_FILTERSQP
-    FilterSolver* filter_solver =
-      dynamic_cast<FilterSolver*> (tminlp_interface->solver());
-    if (filter_solver) {
-      Ipopt::SmartPtr<BqpdSolver> qp_solver =
-	new BqpdSolver(RegOptions(), Options(), Jnlst(), tminlp_interface->prefix());
-#if 1
-      // Solve the QP with the original bounds and set the hot start
-      // information
-      TNLPSolver::ReturnStatus retstatus;
-      retstatus = qp_solver->OptimizeTNLP(GetRawPtr(branching_tqp_));
-      if (retstatus == TNLPSolver::solvedOptimal ||
-	  retstatus == TNLPSolver::solvedOptimalTol) {
-	first_solve_ = false;
-	qp_solver->markHotStart();
-      }
-#endif
-      tqp_solver_ = GetRawPtr(qp_solver);
-      //tqp_solver_ = new FilterSolver(RegOptions(), Options(), Jnlst());
+    // The QPs are always solved with Bqpd when it is available, whatever
+    // the solver used for the nonlinear problems: the QP at the node is
+    // factorized once here and each candidate is then solved by a few
+    // active set pivots from that factorization.
+    Ipopt::SmartPtr<BqpdSolver> qp_solver =
+      new BqpdSolver(RegOptions(), Options(), Jnlst(), tminlp_interface->prefix());
+    // Solve the QP with the original bounds and set the hot start
+    // information
+    TNLPSolver::ReturnStatus retstatus;
+    retstatus = qp_solver->OptimizeTNLP(GetRawPtr(branching_tqp_));
+    if (retstatus == TNLPSolver::solvedOptimal ||
+        retstatus == TNLPSolver::solvedOptimalTol) {
+      first_solve_ = false;
+      qp_solver->markHotStart();
+    }
+    else if (retstatus == TNLPSolver::provenInfeasible) {
+      // Branching only tightens bounds, all candidates are infeasible too
+      node_infeasible_ = true;
     }
+    tqp_solver_ = GetRawPtr(qp_solver);
 #endif
     if (IsNull(tqp_solver_)) {
       tqp_solver_ = tminlp_interface->solver()->clone();
@@ -97,7 +103,10 @@ namespace Bonmin
   solveFromHotStart(OsiTMINLPInterface* tminlp_interface)
   {
     TNLPSolver::ReturnStatus retstatus;
-    if (first_solve_) {
+    if (node_infeasible_) {
+      retstatus = TNLPSolver::provenInfeasible;
+    }
+    else if (first_solve_) {
       retstatus = tqp_solver_->OptimizeTNLP(GetRawPtr(branching_tqp_));
     }
     else {
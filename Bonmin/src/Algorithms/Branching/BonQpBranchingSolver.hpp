@@ -61,6 +61,9 @@ namespace Bonmin
 #endif
 
     bool first_solve_;
+
+    /// True if the QP at the node (before branching) is infeasible
+    bool node_infeasible_;
   };
 
 }
@@ -27,6 +27,7 @@
 #include "BonDiver.hpp"
 #include "BonLinearCutsGenerator.hpp"
 #include "BonTMINLPLinObj.hpp"
+#include "BonAsyncJournal.hpp"
 // sets cutoff a bit above real one, to avoid single-point feasible sets
 #define CUTOFF_TOL 1e-6
 
@@ -681,6 +682,14 @@ namespace Bonmin
       status = TMINLP::MINLP_ERROR;
     }
   }
+  // The caller may write to the console directly from here on, let an
+  // asynchronous console catch up first.
+  if (IsValid(s.journalist())) {
+    Ipopt::SmartPtr<Ipopt::Journal> console = s.journalist()->GetJournal("console");
+    AsyncJournal * asyncConsole = dynamic_cast<AsyncJournal *>(GetRawPtr(console));
+    if (asyncConsole != NULL)
+      asyncConsole->drain();
+  }
   s.nonlinearSolver()->model()->finalize_solution(status,
      s.nonlinearSolver()->getNumCols(),
      bestSolution_,
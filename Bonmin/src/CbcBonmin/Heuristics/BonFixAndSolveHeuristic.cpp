@@ -66,8 +66,8 @@ namespace Bonmin {
     }
     if(nFixed < numberObjects / 3) return 0;
     double cutoff = info.cutoff_; 
+    // nlp is owned (and deleted) by the local search.
     int r_val = doLocalSearch(nlp, newSolution, objectiveValue, cutoff);
-    delete nlp;
     return r_val;
   }
 
@@ -56,7 +56,7 @@ namespace Bonmin {
 		       OsiCuts & cs) {return 0;}
 
 
-   /** Do a local search based on setup and passed solver.*/
+   /** Do a local search based on setup and passed solver (takes ownership of solver).*/
    int doLocalSearch(OsiTMINLPInterface * solver, 
                       double *solution, 
                       double & solValue,
@@ -13,6 +13,8 @@
 #include "IpBlas.hpp"
 
 #include <list>
+#include <vector>
+#include <algorithm>
 
 #include "AmplTNLP.hpp"
 #include "BonAmplTMINLP.hpp"
@@ -107,6 +109,19 @@ namespace Bonmin
     Initialize(jnlst, roptions, options, argv, suffix_handler, appName, nl_file_content);
   }
 
+  void
+  AmplTMINLP::registerOptions(Ipopt::SmartPtr<Bonmin::RegisteredOptions> roptions)
+  {
+    // We try to register the options - if those have been registered
+    // already, we catch the exception and don't need to do it again
+    try {
+      AmplTNLP::RegisterOptions(GetRawPtr(roptions));
+    }
+    catch(RegisteredOptions::OPTION_ALREADY_REGISTERED) {
+      // skipping
+    }
+  }
+
   void
   AmplTMINLP::Initialize(const SmartPtr<const Journalist>& jnlst,
       const SmartPtr<Bonmin::RegisteredOptions> roptions,
@@ -117,6 +132,7 @@ namespace Bonmin
       std::string* nl_file_content /* = NULL */
                         )
   {
+    registerOptions(roptions);
     appName_ = appName;
     options->GetEnumValue("file_solution",writeAmplSolFile_,"bonmin.");
     jnlst_ = jnlst;
@@ -328,6 +344,13 @@ namespace Bonmin
       ampl_tnlp_->set_active_objective(0);
     }
   }
+  /** Order pairs on their first element only.*/
+  static bool
+  first_less(const std::pair<int, int> & a, const std::pair<int, int> & b)
+  {
+    return a.first < b.first;
+  }
+
   /** To store all data stored in the nonconvex suffixes.*/
   struct NonConvexSuff
   {
@@ -349,6 +372,37 @@ namespace Bonmin
     /** Index of variable y in a simple concave constraint of type y >= F(x).*/
     int scYIdx;
   };
+  /** Build a sorted table of (suffix value, variable index) used to find
+      the variable carrying a given id. When several variables have the
+      same id, the last one is kept. If positiveOnly is true, variables
+      with a non-positive id are ignored.*/
+  static void
+  make_id_map(int n, const Index * id, bool positiveOnly,
+              std::vector<std::pair<int, int> > & id_map)
+  {
+    id_map.clear();
+    id_map.reserve(n);
+    for (int i = 0 ; i < n ; i++) {
+      if (!positiveOnly || id[i] > 0)
+        id_map.push_back(std::make_pair(id[i], i));
+    }
+    // stable so that the last variable with a given id comes last
+    std::stable_sort(id_map.begin(), id_map.end(), first_less);
+  }
+
+  /** Find the variable with id value in table built by make_id_map.*/
+  static int
+  find_id(const std::vector<std::pair<int, int> > & id_map, int value,
+          int notFound)
+  {
+    std::vector<std::pair<int, int> >::const_iterator k =
+      std::upper_bound(id_map.begin(), id_map.end(),
+                       std::make_pair(value, 0), first_less);
+    if (k == id_map.begin() || (k - 1)->first != value)
+      return notFound;
+    return (k - 1)->second;
+  }
+
   void AmplTMINLP::read_convexities()
   {
     ASL_pfgh* asl = ampl_tnlp_->AmplSolverObject();
@@ -369,11 +423,8 @@ namespace Bonmin
         exit(ERROR_IN_AMPL_SUFFIXES);
       }
       int numberSimpleConcave = 0;
-      std::map<int, int> id_map;
-
-      for (int i = 0 ; i < n_var ; i++) {
-        id_map[id[i]] = i;
-      }
+      std::vector<std::pair<int, int> > id_map;
+      make_id_map(n_var, id, false, id_map);
 
 
       for (int i = 0 ; i < n_con ; i++) {
@@ -392,7 +443,8 @@ namespace Bonmin
           nonConvexConstraintsAndRelaxations_[numberSimpleConcave].cIdx = i;
           nonConvexConstraintsAndRelaxations_[numberSimpleConcave].cRelaxIdx = -1;
           simpleConcaves_[numberSimpleConcave].cIdx = i;
-          simpleConcaves_[numberSimpleConcave].yIdx = id_map[primary_var[i]];
+          simpleConcaves_[numberSimpleConcave].yIdx =
+            find_id(id_map, primary_var[i], 0);
 
           //Now get gradient of i to get xIdx.
           int nnz;
@@ -445,18 +497,14 @@ namespace Bonmin
 
     c_extra_id_.clear();
     c_extra_id_.resize(n_con, -1);
-    std::map<int, int> id_map;
-
-      for (int i = 0 ; i < n_var ; i++) {
-        if(onoff_v[i] > 0)
-          id_map[onoff_v[i]] = i;
-      }
+    std::vector<std::pair<int, int> > id_map;
+    make_id_map(n_var, onoff_v, true, id_map);
 
       for (int i = 0 ; i < n_con ; i++) {
         if(onoff_c[i] > 0){
-          std::map<int, int >::iterator k = id_map.find(onoff_c[i]);
-          if(k != id_map.end()){
-            c_extra_id_[i] = (*k).second;
+          int k = find_id(id_map, onoff_c[i], -1);
+          if(k != -1){
+            c_extra_id_[i] = k;
           }
           else{
             std::cerr<<"Incorrect suffixes description in ampl model. onoff_c has value attributed to no variable "<<std::endl;
@@ -664,50 +712,15 @@ namespace Bonmin
   bool AmplTMINLP::eval_gi(Index n, const Number* x, bool new_x,
       Index i, Number& gi)
   {
-    ASL_pfgh* asl = ampl_tnlp_->AmplSolverObject();
-
-    // ignore new_x for now
-    xunknown();
-
-    fint nerror = 0;
-    gi = conival(i, const_cast<real*>(x), &nerror);
-    if (nerror!=0) {
-      return false;
-    }
-    else {
-      return true;
-    }
+    return ampl_tnlp_->eval_gi(n, x, new_x, i, gi);
   }
 
   bool AmplTMINLP::eval_grad_gi(Index n, const Number* x, bool new_x,
       Index i, Index& nele_grad_gi, Index* jCol,
       Number* values)
   {
-    ASL_pfgh* asl = ampl_tnlp_->AmplSolverObject();
-
-    if (jCol) {
-      // Only compute the number of nonzeros and the indices
-      DBG_ASSERT(!values);
-      nele_grad_gi = 0;
-      for (cgrad* cg=Cgrad[i]; cg; cg = cg->next) {
-        jCol[nele_grad_gi++] = cg->varno + 1;
-      }
-      return true;
-    }
-    DBG_ASSERT(values);
-
-    // ignore new_x for now
-    xunknown();
-
-    asl->i.congrd_mode = 1;
-    fint nerror = 0;
-    congrd(i, const_cast<real*>(x), values, &nerror);
-    if (nerror!=0) {
-      return false;
-    }
-    else {
-      return true;
-    }
+    return ampl_tnlp_->eval_grad_gi(n, x, new_x, i, nele_grad_gi, jCol,
+        values);
   }
 
   void AmplTMINLP::finalize_solution(TMINLP::SolverReturn status,
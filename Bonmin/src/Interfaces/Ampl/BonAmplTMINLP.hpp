@@ -65,6 +65,9 @@ namespace Bonmin
         const std::string& appName = "bonmin",
         std::string* nl_file_content = NULL);
 
+    /** Register the options of the AMPL interface (if they are not registered yet).*/
+    static void registerOptions(Ipopt::SmartPtr<Bonmin::RegisteredOptions> roptions);
+
     /** read the branching priorities from ampl suffixes.*/
     void read_priorities();
 
@@ -0,0 +1,402 @@
+// Copyright (C) 2012, International Business Machines Corporation and others.
+// All Rights Reserved.
+// This code is published under the Common Public License.
+
+#include "BonminConfig.h"
+#include "BonAsyncJournal.hpp"
+#include "IpUtils.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef BONMIN_PTHREADS
+#include <pthread.h>
+#include <time.h>
+#endif
+
+namespace Bonmin {
+
+#ifdef BONMIN_PTHREADS
+  /** A block of complete lines handed to the writer thread.*/
+  struct AsyncRecord {
+    AsyncRecord * next;
+    size_t length;
+    char text[1];
+  };
+
+  struct AsyncThreadBuffer;
+
+  struct AsyncJournal::ThreadData {
+    /** The writer thread.*/
+    pthread_t writer;
+    /** Key of the calling thread's buffer.*/
+    pthread_key_t key;
+    /** Records not yet taken by the writer, newest first.*/
+    AsyncRecord * volatile head;
+    /** All thread buffers ever created, freed with the journal.*/
+    AsyncThreadBuffer * volatile buffers;
+    /** Number of records handed over.*/
+    volatile long pushed;
+    /** Number of records written.*/
+    volatile long written;
+    /** Set when the writer should finish.*/
+    volatile int stop;
+    /** Output file.*/
+    FILE * file;
+  };
+
+  /** Text of one thread not yet handed to the writer.*/
+  struct AsyncThreadBuffer {
+    AsyncThreadBuffer * next;
+    AsyncJournal::ThreadData * data;
+    /** Spin lock on pending, only contended when another thread hands it
+        over (see AsyncJournal::drain()).*/
+    volatile int lock;
+    /** Incomplete last line.*/
+    std::string pending;
+    /** Formatting buffer, as generous as the one of Ipopt's StreamJournal.*/
+    char format[32768];
+  };
+
+  static void
+  pushRecord(AsyncJournal::ThreadData * data, const char * text, size_t length){
+    AsyncRecord * record =
+      static_cast<AsyncRecord *>(malloc(sizeof(AsyncRecord) + length));
+    if(record == NULL)
+      return;
+    memcpy(record->text, text, length);
+    record->length = length;
+    AsyncRecord * head = NULL;
+    while(true){
+      record->next = head;
+      AsyncRecord * seen = __sync_val_compare_and_swap(&data->head, head, record);
+      if(seen == head)
+        break;
+      head = seen;
+    }
+    __sync_fetch_and_add(&data->pushed, 1);
+  }
+
+  /** Append text to the thread's buffer, handing over complete lines.*/
+  static void
+  appendText(AsyncThreadBuffer * buffer, const char * text, size_t length){
+    size_t end = length;
+    while(end > 0 && text[end - 1] != '\n')
+      end--;
+    Ipopt::AcquireSpinLock(buffer->lock);
+    if(end == 0){
+      buffer->pending.append(text, length);
+    }
+    else {
+      if(buffer->pending.empty()){
+        pushRecord(buffer->data, text, end);
+      }
+      else {
+        buffer->pending.append(text, end);
+        pushRecord(buffer->data, buffer->pending.data(), buffer->pending.size());
+        buffer->pending.clear();
+      }
+      buffer->pending.append(text + end, length - end);
+    }
+    Ipopt::ReleaseSpinLock(buffer->lock);
+  }
+
+  /** Hand over the incomplete line of buffer, which may belong to another
+      thread.*/
+  static void
+  handOver(AsyncThreadBuffer * buffer){
+    Ipopt::AcquireSpinLock(buffer->lock);
+    if(!buffer->pending.empty()){
+      pushRecord(buffer->data, buffer->pending.data(), buffer->pending.size());
+      buffer->pending.clear();
+    }
+    Ipopt::ReleaseSpinLock(buffer->lock);
+  }
+
+  /** Hand over the incomplete lines of all threads.*/
+  static void
+  handOverAll(AsyncJournal::ThreadData * data){
+    // Buffers are only ever added at the head of the list
+    AsyncThreadBuffer * buffer =
+      __sync_val_compare_and_swap(&data->buffers, (AsyncThreadBuffer *) NULL,
+                                  (AsyncThreadBuffer *) NULL);
+    for(; buffer != NULL ; buffer = buffer->next)
+      handOver(buffer);
+  }
+
+  /** Write the records handed over so far, returns their number.*/
+  static long
+  writeRecords(AsyncJournal::ThreadData * data){
+    AsyncRecord * list =
+      __sync_lock_test_and_set(&data->head, (AsyncRecord *) NULL);
+    // The list is newest first
+    AsyncRecord * ordered = NULL;
+    while(list != NULL){
+      AsyncRecord * next = list->next;
+      list->next = ordered;
+      ordered = list;
+      list = next;
+    }
+    long count = 0;
+    while(ordered != NULL){
+      AsyncRecord * next = ordered->next;
+      fwrite(ordered->text, 1, ordered->length, data->file);
+      free(ordered);
+      ordered = next;
+      count++;
+    }
+    if(count)
+      fflush(data->file);
+    return count;
+  }
+
+  static void
+  sleepMicroSeconds(long microSeconds){
+    struct timespec interval;
+    interval.tv_sec = 0;
+    interval.tv_nsec = 1000 * microSeconds;
+    nanosleep(&interval, NULL);
+  }
+
+  extern "C" {
+    static void * asyncJournalWriter(void * threadData){
+      AsyncJournal::ThreadData * data =
+        static_cast<AsyncJournal::ThreadData *>(threadData);
+      // Sleep a little longer each time nothing was written, so that an idle
+      // journal costs next to nothing while a busy one is written promptly.
+      long interval = 50;
+      while(true){
+        int stop = __sync_fetch_and_add(&data->stop, 0);
+        long count = writeRecords(data);
+        if(count == 0){
+          if(stop)
+            break;
+          sleepMicroSeconds(interval);
+          if(interval < 10000)
+            interval *= 2;
+          continue;
+        }
+        interval = 50;
+        __sync_fetch_and_add(&data->written, count);
+      }
+      return NULL;
+    }
+
+    static void asyncJournalThreadExit(void * buffer){
+      handOver(static_cast<AsyncThreadBuffer *>(buffer));
+    }
+  }
+
+  static AsyncThreadBuffer *
+  threadBuffer(AsyncJournal::ThreadData * data){
+    AsyncThreadBuffer * buffer =
+      static_cast<AsyncThreadBuffer *>(pthread_getspecific(data->key));
+    if(buffer == NULL){
+      buffer = new AsyncThreadBuffer;
+      buffer->data = data;
+      buffer->lock = 0;
+      AsyncThreadBuffer * head = NULL;
+      while(true){
+        buffer->next = head;
+        AsyncThreadBuffer * seen =
+          __sync_val_compare_and_swap(&data->buffers, head, buffer);
+        if(seen == head)
+          break;
+        head = seen;
+      }
+      pthread_setspecific(data->key, buffer);
+    }
+    return buffer;
+  }
+#else
+  struct AsyncJournal::ThreadData {
+  };
+#endif
+
+  AsyncJournal::AsyncJournal(const std::string & name,
+                             Ipopt::EJournalLevel default_level):
+    Journal(name, default_level),
+    file_(NULL),
+    threadData_(NULL){
+  }
+
+  AsyncJournal::~AsyncJournal(){
+#ifdef BONMIN_PTHREADS
+    if(threadData_ != NULL){
+      handOverAll(threadData_);
+      __sync_fetch_and_add(&threadData_->stop, 1);
+      pthread_join(threadData_->writer, NULL);
+      pthread_key_delete(threadData_->key);
+      // Lines handed over by threads exiting while the writer stopped
+      writeRecords(threadData_);
+      AsyncThreadBuffer * buffer = threadData_->buffers;
+      while(buffer != NULL){
+        AsyncThreadBuffer * next = buffer->next;
+        delete buffer;
+        buffer = next;
+      }
+      delete threadData_;
+      threadData_ = NULL;
+    }
+#endif
+    if(file_ && file_ != stdout && file_ != stderr)
+      fclose(file_);
+    file_ = NULL;
+  }
+
+  bool
+  AsyncJournal::available(){
+#ifdef BONMIN_PTHREADS
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  bool
+  AsyncJournal::Open(const char * fname){
+    if(threadData_ != NULL)
+      return false;
+    if(file_ && file_ != stdout && file_ != stderr)
+      fclose(file_);
+    file_ = NULL;
+    if(strcmp("stdout", fname) == 0)
+      file_ = stdout;
+    else if(strcmp("stderr", fname) == 0)
+      file_ = stderr;
+    else
+      file_ = fopen(fname, "w+");
+    return file_ != NULL;
+  }
+
+  bool
+  AsyncJournal::startWriter(){
+    if(threadData_ != NULL)
+      return true;
+#ifdef BONMIN_PTHREADS
+    if(file_ == NULL)
+      return false;
+    ThreadData * data = new ThreadData;
+    data->head = NULL;
+    data->buffers = NULL;
+    data->pushed = 0;
+    data->written = 0;
+    data->stop = 0;
+    data->file = file_;
+    if(pthread_key_create(&data->key, asyncJournalThreadExit)){
+      delete data;
+      return false;
+    }
+    fflush(file_);
+    if(pthread_create(&data->writer, NULL, asyncJournalWriter, data)){
+      pthread_key_delete(data->key);
+      delete data;
+      return false;
+    }
+    threadData_ = data;
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  void
+  AsyncJournal::drain(){
+#ifdef BONMIN_PTHREADS
+    if(threadData_ == NULL){
+      if(file_)
+        fflush(file_);
+      return;
+    }
+    handOverAll(threadData_);
+    long target = __sync_fetch_and_add(&threadData_->pushed, 0);
+    while(__sync_fetch_and_add(&threadData_->written, 0) < target)
+      sleepMicroSeconds(50);
+#else
+    if(file_)
+      fflush(file_);
+#endif
+  }
+
+  void
+  AsyncJournal::PrintImpl(Ipopt::EJournalCategory category,
+                          Ipopt::EJournalLevel level, const char* str){
+#ifdef BONMIN_PTHREADS
+    if(threadData_ != NULL){
+      appendText(threadBuffer(threadData_), str, strlen(str));
+      return;
+    }
+#endif
+    if(file_)
+      fprintf(file_, "%s", str);
+  }
+
+  void
+  AsyncJournal::PrintfImpl(Ipopt::EJournalCategory category,
+                           Ipopt::EJournalLevel level, const char* pformat,
+                           va_list ap){
+#ifdef BONMIN_PTHREADS
+    if(threadData_ != NULL){
+      AsyncThreadBuffer * buffer = threadBuffer(threadData_);
+      int length = vsnprintf(buffer->format, sizeof(buffer->format), pformat, ap);
+      if(length < 0)
+        return;
+      if(length >= (int) sizeof(buffer->format))
+        length = (int) sizeof(buffer->format) - 1;
+      appendText(buffer, buffer->format, length);
+      return;
+    }
+#endif
+    if(file_)
+      vfprintf(file_, pformat, ap);
+  }
+
+  void
+  AsyncJournal::FlushBufferImpl(){
+    // When writing asynchronously the writer flushes after each block of
+    // lines, waiting for it here would make every Ipopt iteration wait.
+    if(threadData_ == NULL && file_)
+      fflush(file_);
+  }
+
+  JournalMessageHandler::JournalMessageHandler(Ipopt::SmartPtr<Ipopt::Journal> journal,
+                                               const CoinMessageHandler & handler):
+    CoinMessageHandler(handler),
+    journal_(journal){
+  }
+
+  JournalMessageHandler::JournalMessageHandler(const JournalMessageHandler & other):
+    CoinMessageHandler(other),
+    journal_(other.journal_){
+  }
+
+  JournalMessageHandler &
+  JournalMessageHandler::operator=(const JournalMessageHandler & rhs){
+    if(this != &rhs){
+      CoinMessageHandler::operator=(rhs);
+      journal_ = rhs.journal_;
+    }
+    return *this;
+  }
+
+  JournalMessageHandler::~JournalMessageHandler(){
+  }
+
+  int
+  JournalMessageHandler::print(){
+    if(IsNull(journal_))
+      return CoinMessageHandler::print();
+    if(!journal_->IsAccepted(Ipopt::J_USER_APPLICATION, Ipopt::J_SUMMARY))
+      return 0;
+    journal_->Print(Ipopt::J_USER_APPLICATION, Ipopt::J_SUMMARY, messageBuffer());
+    journal_->Print(Ipopt::J_USER_APPLICATION, Ipopt::J_SUMMARY, "\n");
+    return 0;
+  }
+
+  CoinMessageHandler *
+  JournalMessageHandler::clone() const{
+    return new JournalMessageHandler(*this);
+  }
+}/* Ends Bonmin namespace.*/
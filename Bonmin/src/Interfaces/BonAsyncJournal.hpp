@@ -0,0 +1,124 @@
+// Copyright (C) 2012, International Business Machines Corporation and others.
+// All Rights Reserved.
+// This code is published under the Common Public License.
+
+#ifndef BonAsyncJournal_H
+#define BonAsyncJournal_H
+
+#include "IpJournalist.hpp"
+#include "CoinMessageHandler.hpp"
+
+namespace Bonmin {
+
+  /** Journal writing to a file (or stdout/stderr) from a background thread.
+
+      Until startWriter() is called the journal behaves like an
+      Ipopt::FileJournal.  Afterwards each thread formats its messages into a
+      buffer of its own; complete lines are handed to the writer thread
+      through a lock-free list and written in the order each thread produced
+      them.  Output of solvers running in different threads therefore
+      interleaves line by line without any locking in the threads printing,
+      and the threads never wait for the file.
+
+      Text written directly to the same file (not through the journal) may
+      appear out of order with the journal's output, which is why Bonmin
+      routes its CoinMessageHandler output through the journal as well (see
+      JournalMessageHandler).
+
+      The writer thread is only available if Bonmin was configured with
+      --enable-bonmin-threads.
+  */
+  class AsyncJournal : public Ipopt::Journal {
+  public:
+    /** Constructor.*/
+    AsyncJournal(const std::string & name, Ipopt::EJournalLevel default_level);
+
+    /** Destructor, writes all pending output.*/
+    virtual ~AsyncJournal();
+
+    /** Open the output location, "stdout" and "stderr" have their usual
+        meaning. Returns false if the file could not be opened.*/
+    bool Open(const char * fname);
+
+    /** Start the writer thread. Returns false if the journal can not write
+        asynchronously (no thread support, or the thread could not be
+        created), in which case it keeps writing directly.*/
+    bool startWriter();
+
+    /** Is output written by a background thread.*/
+    bool asynchronous() const{
+      return threadData_ != NULL;
+    }
+
+    /** Hand over the incomplete lines of all threads and wait until the
+        writer thread has written everything handed over so far. A line
+        another thread is still printing is cut where it stands.*/
+    void drain();
+
+    /** Can journals write asynchronously in this build.*/
+    static bool available();
+
+    /** Implementation (threads and buffers).*/
+    struct ThreadData;
+
+  protected:
+    /**@name Overloaded from Ipopt::Journal.*/
+    //@{
+    virtual void PrintImpl(Ipopt::EJournalCategory category,
+                           Ipopt::EJournalLevel level, const char* str);
+
+    virtual void PrintfImpl(Ipopt::EJournalCategory category,
+                            Ipopt::EJournalLevel level, const char* pformat,
+                            va_list ap);
+
+    virtual void FlushBufferImpl();
+    //@}
+
+  private:
+    /** Not implemented.*/
+    AsyncJournal(const AsyncJournal &);
+    /** Not implemented.*/
+    AsyncJournal & operator=(const AsyncJournal &);
+
+    /** Output file.*/
+    FILE * file_;
+    /** Writer thread and buffers, NULL while writing directly.*/
+    ThreadData * threadData_;
+  };
+
+  /** Message handler printing into an Ipopt journal.
+      The handler decides which messages are printed with its log levels as
+      usual (without formatting the others), the printed lines are then
+      passed to the journal at level J_SUMMARY in category
+      J_USER_APPLICATION. That category is not changed by Ipopt's
+      print_level, so setting its level to J_NONE in the journal is what
+      silences the handler. Used to keep Bonmin's, Cbc's and Ipopt's output
+      in order when the console journal writes asynchronously.
+  */
+  class JournalMessageHandler : public CoinMessageHandler {
+  public:
+    /** Constructor, takes the log levels of handler.*/
+    JournalMessageHandler(Ipopt::SmartPtr<Ipopt::Journal> journal,
+                          const CoinMessageHandler & handler);
+
+    /** Copy constructor.*/
+    JournalMessageHandler(const JournalMessageHandler & other);
+
+    /** Assignment operator.*/
+    JournalMessageHandler & operator=(const JournalMessageHandler & rhs);
+
+    /** Destructor.*/
+    virtual ~JournalMessageHandler();
+
+    /** Print the current message to the journal.*/
+    virtual int print();
+
+    /** Virtual copy constructor.*/
+    virtual CoinMessageHandler * clone() const;
+
+  private:
+    /** Journal the messages go to.*/
+    Ipopt::SmartPtr<Ipopt::Journal> journal_;
+  };
+}/* Ends Bonmin namespace.*/
+#endif
@@ -0,0 +1,208 @@
+// Copyright (C) 2012, International Business Machines Corporation and others.
+// All Rights Reserved.
+// This code is published under the Common Public License.
+
+#include "BonNlpSnapshot.hpp"
+#include "BonTMINLP2TNLP.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace Bonmin {
+
+  /** Identifies snapshot files (the last character is the format version).*/
+  static const char snapshotMagic[8] = {'B','O','N','S','N','A','P','2'};
+
+  /** Write n elements of array to fp.*/
+  template <class T>
+  static bool writeArray(FILE * fp, const T * array, int n){
+    if (n == 0)
+      return true;
+    return fwrite(array, sizeof(T), n, fp) == (size_t) n;
+  }
+
+  /** Read n elements from fp into array.*/
+  template <class T>
+  static bool readArray(FILE * fp, std::vector<T> & array, int n){
+    array.resize(n);
+    if (n == 0)
+      return true;
+    return fread(&array[0], sizeof(T), n, fp) == (size_t) n;
+  }
+
+  /** Get the Hessian structure of problem with C style indices. Leaves
+      the arrays empty if problem does not give the structure.*/
+  static void getHessianStructure(TMINLP2TNLP & problem,
+                                  std::vector<Ipopt::Index> & hRow,
+                                  std::vector<Ipopt::Index> & hCol){
+    Ipopt::Index n, m, nnz_jac, nnz_h;
+    Ipopt::TNLP::IndexStyleEnum index_style;
+    problem.get_nlp_info(n, m, nnz_jac, nnz_h, index_style);
+    hRow.resize(nnz_h);
+    hCol.resize(nnz_h);
+    if (nnz_h == 0)
+      return;
+    if (!problem.eval_h(n, NULL, false, 1., m, NULL, false, nnz_h,
+                        &hRow[0], &hCol[0], NULL)) {
+      hRow.clear();
+      hCol.clear();
+      return;
+    }
+    if (index_style == Ipopt::TNLP::FORTRAN_STYLE) {
+      for (int k = 0 ; k < nnz_h ; k++) {
+        hRow[k]--;
+        hCol[k]--;
+      }
+    }
+  }
+
+  /** Get the Jacobian structure of problem with C style indices.*/
+  static bool getJacobianStructure(TMINLP2TNLP & problem,
+                                   std::vector<Ipopt::Index> & jRow,
+                                   std::vector<Ipopt::Index> & jCol){
+    Ipopt::Index n, m, nnz_jac, nnz_h;
+    Ipopt::TNLP::IndexStyleEnum index_style;
+    problem.get_nlp_info(n, m, nnz_jac, nnz_h, index_style);
+    jRow.resize(nnz_jac);
+    jCol.resize(nnz_jac);
+    if (nnz_jac == 0)
+      return true;
+    if (!problem.eval_jac_g(n, NULL, false, m, nnz_jac, &jRow[0], &jCol[0],
+                            NULL))
+      return false;
+    if (index_style == Ipopt::TNLP::FORTRAN_STYLE) {
+      for (int k = 0 ; k < nnz_jac ; k++) {
+        jRow[k]--;
+        jCol[k]--;
+      }
+    }
+    return true;
+  }
+
+  NlpSnapshot::NlpSnapshot(const std::string & fileName):
+    fileName_(fileName),
+    used_(false),
+    x_(),
+    duals_(){
+  }
+
+  NlpSnapshot::~NlpSnapshot(){
+  }
+
+  NlpSnapshot::ReadStatus
+  NlpSnapshot::read(TMINLP2TNLP & problem){
+    FILE * fp = fopen(fileName_.c_str(), "rb");
+    if (fp == NULL)
+      return noFile;
+
+    Ipopt::Index n, m, nnz_jac, nnz_h;
+    Ipopt::TNLP::IndexStyleEnum index_style;
+    problem.get_nlp_info(n, m, nnz_jac, nnz_h, index_style);
+    std::vector<Ipopt::Index> hRow, hCol;
+    getHessianStructure(problem, hRow, hCol);
+
+    bool ok = true;
+    char magic[8];
+    ok = fread(magic, 1, 8, fp) == 8 && !memcmp(magic, snapshotMagic, 8);
+
+    // Dimensions must match.
+    std::vector<int> header;
+    ok = ok && readArray(fp, header, 4);
+    ok = ok && header[0] == n && header[1] == m && header[2] == nnz_jac
+         && header[3] == (int) hRow.size();
+
+    // And so must the type of each variable.
+    std::vector<int> varTypes;
+    ok = ok && readArray(fp, varTypes, n);
+    if (ok) {
+      const TMINLP::VariableType * types = problem.var_types();
+      for (int i = 0 ; ok && i < n ; i++)
+        ok = varTypes[i] == (int) types[i];
+    }
+
+    // The constraint linearities must be the ones of the problem: the
+    // interface uses them to decide which constraints to linearize.
+    std::vector<Ipopt::TNLP::LinearityType> constTypesRead;
+    ok = ok && readArray(fp, constTypesRead, m);
+    if (ok && m > 0) {
+      std::vector<Ipopt::TNLP::LinearityType> constTypes(m);
+      ok = problem.get_constraints_linearity(m, &constTypes[0])
+           && constTypes == constTypesRead;
+    }
+
+    // So must the sparsity structures, entry by entry.
+    std::vector<Ipopt::Index> jRowRead, jColRead;
+    ok = ok && readArray(fp, jRowRead, nnz_jac);
+    ok = ok && readArray(fp, jColRead, nnz_jac);
+    if (ok) {
+      std::vector<Ipopt::Index> jRow, jCol;
+      ok = getJacobianStructure(problem, jRow, jCol) && jRow == jRowRead
+           && jCol == jColRead;
+    }
+    std::vector<Ipopt::Index> hRowRead, hColRead;
+    ok = ok && readArray(fp, hRowRead, header[3]);
+    ok = ok && readArray(fp, hColRead, header[3]);
+    ok = ok && hRowRead == hRow && hColRead == hCol;
+
+    ok = ok && readArray(fp, x_, n);
+    ok = ok && readArray(fp, duals_, 2*n + m);
+    // Nothing may follow.
+    ok = ok && fgetc(fp) == EOF;
+    fclose(fp);
+
+    if (ok)
+      return readOk;
+    x_.clear();
+    duals_.clear();
+    return mismatch;
+  }
+
+  bool
+  NlpSnapshot::write(TMINLP2TNLP & problem) const{
+    if (problem.x_sol() == NULL || problem.duals_sol() == NULL)
+      return false;
+
+    Ipopt::Index n, m, nnz_jac, nnz_h;
+    Ipopt::TNLP::IndexStyleEnum index_style;
+    problem.get_nlp_info(n, m, nnz_jac, nnz_h, index_style);
+    std::vector<Ipopt::TNLP::LinearityType> constTypes(m);
+    std::vector<Ipopt::Index> jRow, jCol;
+    if ((m > 0 && !problem.get_constraints_linearity(m, &constTypes[0]))
+        || !getJacobianStructure(problem, jRow, jCol))
+      return false;
+
+    FILE * fp = fopen(fileName_.c_str(), "wb");
+    if (fp == NULL)
+      return false;
+
+    std::vector<Ipopt::Index> hRow, hCol;
+    getHessianStructure(problem, hRow, hCol);
+    const int nnz_h_recorded = (int) hRow.size();
+
+    int header[4] = {n, m, nnz_jac, nnz_h_recorded};
+    std::vector<int> varTypes(n);
+    const TMINLP::VariableType * types = problem.var_types();
+    for (int i = 0 ; i < n ; i++)
+      varTypes[i] = (int) types[i];
+
+    bool ok = fwrite(snapshotMagic, 1, 8, fp) == 8;
+    ok = ok && writeArray(fp, header, 4);
+    ok = ok && writeArray(fp, n ? &varTypes[0] : (int *) NULL, n);
+    ok = ok && writeArray(fp, m ? &constTypes[0] :
+                          (Ipopt::TNLP::LinearityType *) NULL, m);
+    ok = ok && writeArray(fp, nnz_jac ? &jRow[0] : (Ipopt::Index *) NULL,
+                          nnz_jac);
+    ok = ok && writeArray(fp, nnz_jac ? &jCol[0] : (Ipopt::Index *) NULL,
+                          nnz_jac);
+    ok = ok && writeArray(fp, nnz_h_recorded ? &hRow[0] : (Ipopt::Index *) NULL,
+                          nnz_h_recorded);
+    ok = ok && writeArray(fp, nnz_h_recorded ? &hCol[0] : (Ipopt::Index *) NULL,
+                          nnz_h_recorded);
+    ok = ok && writeArray(fp, problem.x_sol(), n);
+    ok = ok && writeArray(fp, problem.duals_sol(), 2*n + m);
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok)
+      remove(fileName_.c_str());
+    return ok;
+  }
+} /* Ends Bonmin namespace.*/
@@ -0,0 +1,105 @@
+// Copyright (C) 2012, International Business Machines Corporation and others.
+// All Rights Reserved.
+// This code is published under the Common Public License.
+
+#ifndef BonNlpSnapshot_H
+#define BonNlpSnapshot_H
+
+#include <string>
+#include <vector>
+#include "IpTNLP.hpp"
+#include "BonTMINLP.hpp"
+
+namespace Bonmin {
+  class TMINLP2TNLP;
+
+  /** Binary snapshot of the root continuous relaxation of a problem.
+      The snapshot records the dimensions and variable types of the problem,
+      the structures of the constraint Jacobian and of the Hessian of the
+      Lagrangian, the linearity of the constraints and the primal-dual
+      solution of the root NLP.
+
+      A run solving a problem with the same structure as the one the
+      snapshot was taken from (for example another scenario with different
+      data or bounds) can then warm start its root NLP from the recorded
+      solution.  The structures and linearities are not taken from the file:
+      they are only compared with the ones of the problem, to reject a
+      snapshot written for another problem.
+
+      The object is shared (through SmartPtr) by an OsiTMINLPInterface and
+      all its copies: only the first one performing a root solve uses it.
+  */
+  class NlpSnapshot : public Ipopt::ReferencedObject {
+  public:
+    /** Constructor for snapshot stored in fileName.*/
+    NlpSnapshot(const std::string & fileName);
+
+    /** Destructor.*/
+    virtual ~NlpSnapshot();
+
+    /** Outcome of read().*/
+    enum ReadStatus {
+      /** The snapshot was read and matches the problem.*/
+      readOk,
+      /** There is no snapshot file (yet).*/
+      noFile,
+      /** The file is damaged or was written for a problem with a different
+          structure.*/
+      mismatch
+    };
+
+    /** Read the file and check that it was written for a problem with the
+        same structure as problem: same dimensions, variable types and
+        constraint linearities (as given by get_constraints_linearity), and
+        the same Jacobian and Hessian sparsity structures.*/
+    ReadStatus read(TMINLP2TNLP & problem);
+
+    /** Write the snapshot of problem (which should just have been solved
+        to optimality).*/
+    bool write(TMINLP2TNLP & problem) const;
+
+    /** Name of the file.*/
+    const std::string & fileName() const{
+      return fileName_;
+    }
+
+    /** Has the snapshot already been used by some interface.*/
+    bool used() const{
+      return used_;
+    }
+
+    /** Mark the snapshot as used.*/
+    void setUsed(){
+      used_ = true;
+    }
+
+    /** @name Data read from file.*/
+    //@{
+    /** Primal solution of the root NLP.*/
+    const Ipopt::Number * x() const{
+      return x_.empty() ? NULL : &x_[0];
+    }
+    /** Dual solution of the root NLP (z_L, z_U and lambda).*/
+    const Ipopt::Number * duals() const{
+      return duals_.empty() ? NULL : &duals_[0];
+    }
+    //@}
+
+  private:
+    /** Copy constructor (not implemented).*/
+    NlpSnapshot(const NlpSnapshot &);
+    /** Assignment (not implemented).*/
+    NlpSnapshot & operator=(const NlpSnapshot &);
+
+    /** Name of the file.*/
+    std::string fileName_;
+    /** Has a root solve already used the snapshot.*/
+    bool used_;
+    /** Primal solution.*/
+    std::vector<Ipopt::Number> x_;
+    /** Dual solution.*/
+    std::vector<Ipopt::Number> duals_;
+  };
+} /* Ends Bonmin namespace.*/
+
+#endif
@@ -19,6 +19,7 @@
 #include "BonTNLP2FPNLP.hpp"
 #include "BonTMINLP2OsiLP.hpp"
 #include "BonTNLPSolver.hpp"
+#include "BonNlpSnapshot.hpp"
 #include "CoinTime.hpp"
 #include <climits>
 #include <string>
@@ -71,6 +72,28 @@ register_general_options
       "This will affect the function getWarmStart(), and as a consequence the warm starting in the various algorithms.");
   roptions->setOptionExtraInfo("warm_start",8);
 
+  roptions->AddStringOption1("nlp_snapshot_file",
+      "File in which to keep a snapshot of the root continuous relaxation (leave unset for none).",
+      "",
+      "*", "Any acceptable standard file name",
+      "If the file exists and was written for a problem with the same dimensions, variable types, "
+      "constraint linearities and Jacobian and Hessian structures, the first NLP is warm started "
+      "from the solution it contains. Otherwise (with a warning if the file exists), the file is written after "
+      "the first NLP is solved to optimality. "
+      "This is useful to solve in a row several instances sharing the same structure.");
+  roptions->setOptionExtraInfo("nlp_snapshot_file",8);
+
+  roptions->AddStringOption2("nlp_cutoff_termination",
+      "Let the NLP solver stop as soon as a node is proven to be infeasible or above the cutoff.",
+      "no",
+      "no", "",
+      "yes", "",
+      "The current cutoff is passed to the NLP solver, which terminates as soon as a lower bound derived from "
+      "its multipliers exceeds it, or when its restoration phase finds a certificate of infeasibility. "
+      "These bounds are only valid for convex problems. "
+      "Nodes stopped at the cutoff are reported as having reached the dual objective limit.");
+  roptions->setOptionExtraInfo("nlp_cutoff_termination",8);
+
   roptions->SetRegisteringCategory("Output and Loglevel", RegisteredOptions::BonminCategory);
   
   roptions->AddBoundedIntegerOption("nlp_log_level",
@@ -334,6 +357,7 @@ OsiTMINLPInterface::Messages::Messages
           "OA on non-convex constraint is very experimental.");                          
   ADD_MSG(SOLVER_DISAGREE_STATUS, warn_m, 1, "%s says problem %s, %s says %s.");
   ADD_MSG(SOLVER_DISAGREE_VALUE, warn_m, 1, "%s gives objective %.16g, %s gives %.16g.");
+  ADD_MSG(WARNING_SNAPSHOT, warn_m, 1, "Could not %s NLP snapshot file %s.");
 
 }
 
@@ -418,6 +442,7 @@ OsiTMINLPInterface::OsiTMINLPInterface():
     infty_(1e100),
     warmStartMode_(None),
     firstSolve_(true),
+    cutoffTermination_(false),
     cutStrengthener_(NULL),
     oaMessages_(),
     oaHandler_(NULL),
@@ -582,6 +607,8 @@ OsiTMINLPInterface::OsiTMINLPInterface (const OsiTMINLPInterface &source):
     infty_(source.infty_),
     warmStartMode_(source.warmStartMode_),
     firstSolve_(true),
+    snapshot_(source.snapshot_),
+    cutoffTermination_(source.cutoffTermination_),
     cutStrengthener_(source.cutStrengthener_),
     oaMessages_(),
     oaHandler_(NULL),
@@ -698,6 +725,8 @@ OsiTMINLPInterface & OsiTMINLPInterface::operator=(const OsiTMINLPInterface& rhs
       rhsRelax_ = rhs.rhsRelax_;
       infty_ = rhs.infty_;
       warmStartMode_ = rhs.warmStartMode_;
+      snapshot_ = rhs.snapshot_;
+      cutoffTermination_ = rhs.cutoffTermination_;
       newCutoffDecr = rhs.newCutoffDecr;
 
     }
@@ -827,6 +856,7 @@ const char * OsiTMINLPInterface::FAILED_SYMB="FAILED";
 const char * OsiTMINLPInterface::UNBOUND_SYMB="UNBOUNDED";
 const char * OsiTMINLPInterface::INFEAS_SYMB="INFEAS";
 const char * OsiTMINLPInterface::TIME_SYMB="TIME";
+const char * OsiTMINLPInterface::CUTOFF_SYMB="CUTOFF";
 ///////////////////////////////////////////////////////////////////
 // WarmStart Information                                                                           //
 ///////////////////////////////////////////////////////////////////
@@ -1796,6 +1826,24 @@ OsiTMINLPInterface::randomStartingPoint()
 
 
 
+bool
+OsiTMINLPInterface::restoreFromSnapshot()
+{
+  NlpSnapshot::ReadStatus status = snapshot_->read(*problem_);
+  if (status == NlpSnapshot::mismatch)
+    messageHandler()->message(WARNING_SNAPSHOT, messages_)
+      <<"use"<<snapshot_->fileName()<<CoinMessageEol;
+  if (status != NlpSnapshot::readOk)
+    return false;
+
+  int numberRows = getNumRows();
+  int numberCols = getNumCols();
+  problem_->setxInit(numberCols, snapshot_->x());
+  problem_->setDualsInit(2*numberCols + numberRows, snapshot_->duals());
+  app_->enableWarmStart();
+  return true;
+}
+
 /** This methods initialiaze arrays for storing the jacobian */
 int OsiTMINLPInterface::initializeJacobianArrays()
 {
@@ -2609,11 +2657,24 @@ OsiTMINLPInterface::solveAndCheckErrors(bool warmStarted, bool throwOnFailure,
     const char * whereFrom)
 {
   if (BonminAbortAll == true) return;
+  // The cutoff is only meant for this solve, the options go into every
+  // clone of app_ (feasibility problems, cut strengthening)
+  if (cutoffTermination_)
+    app_->setCutoffTermination(OsiDualObjectiveLimit_);
   totalNlpSolveTime_-=CoinCpuTime();
-  if(warmStarted)
-    optimizationStatus_ = app_->ReOptimizeTNLP(GetRawPtr(problem_to_optimize_));
-  else
-    optimizationStatus_ = app_->OptimizeTNLP(GetRawPtr(problem_to_optimize_));
+  try {
+    if(warmStarted)
+      optimizationStatus_ = app_->ReOptimizeTNLP(GetRawPtr(problem_to_optimize_));
+    else
+      optimizationStatus_ = app_->OptimizeTNLP(GetRawPtr(problem_to_optimize_));
+  }
+  catch(...) {
+    if (cutoffTermination_)
+      app_->clearCutoffTermination();
+    throw;
+  }
+  if (cutoffTermination_)
+    app_->clearCutoffTermination();
   totalNlpSolveTime_+=CoinCpuTime();
   nCallOptimizeTNLP_++;
   hasBeenOptimized_ = true;
@@ -2794,7 +2855,25 @@ void OsiTMINLPInterface::initialSolve(const char * whereFrom)
   }
   if(warmStartMode_ >= Optimum)
     app_->disableWarmStart(); 
+
+  // The first root solve of the interface (or one of its copies) reads or
+  // writes the snapshot.
+  bool useSnapshot = firstSolve_ && IsValid(snapshot_) && !snapshot_->used()
+                     && problem_to_optimize_ == GetRawPtr(problem_);
+  bool restored = false;
+  if (useSnapshot) {
+    snapshot_->setUsed();
+    restored = restoreFromSnapshot();
+  }
   solveAndCheckErrors(0,1,"initialSolve");
+  if (restored) {
+    app_->disableWarmStart();
+  }
+  else if (useSnapshot && isProvenOptimal()) {
+    if (!snapshot_->write(*problem_))
+      messageHandler()->message(WARNING_SNAPSHOT, messages_)
+        <<"write"<<snapshot_->fileName()<<CoinMessageEol;
+  }
   
   //Options should have been printed if not done already turn off Ipopt output
   if(!hasPrintedOptions) {
@@ -2945,7 +3024,8 @@ bool OsiTMINLPInterface::isPrimalObjectiveLimitReached() const
 bool OsiTMINLPInterface::isDualObjectiveLimitReached() const
 {
   //  (*messageHandler_)<<"Warning : isDualObjectiveLimitReached not implemented yet"<<CoinMessageEol;
-  return (optimizationStatus_==TNLPSolver::unbounded);
+  return (optimizationStatus_==TNLPSolver::unbounded) ||
+         (optimizationStatus_==TNLPSolver::objectiveLimitReached);
 
 }
 /// Iteration limit reached?
@@ -2983,6 +3063,15 @@ OsiTMINLPInterface::extractInterfaceParams()
     int buffy;
     app_->options()->GetEnumValue("warm_start", buffy, app_->prefix());
     warmStartMode_ = (WarmStartModes) buffy;   
+
+    std::string snapshotFile;
+    app_->options()->GetStringValue("nlp_snapshot_file", snapshotFile, app_->prefix());
+    if (snapshotFile.empty())
+      snapshot_ = NULL;
+    else if (IsNull(snapshot_) || snapshot_->fileName() != snapshotFile)
+      snapshot_ = new NlpSnapshot(snapshotFile);
+
+    app_->options()->GetBoolValue("nlp_cutoff_termination", cutoffTermination_, app_->prefix());
  
     app_->options()->GetIntegerValue("num_retry_unsolved_random_point", numRetryUnsolved_,app_->prefix());
     app_->options()->GetIntegerValue("num_resolve_at_root", numRetryInitial_,app_->prefix());
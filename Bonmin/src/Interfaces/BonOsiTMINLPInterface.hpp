@@ -32,6 +32,7 @@ namespace Bonmin {
   class TNLPSolver;
   class RegisteredOptions;
   class StrongBranchingSolver;
+  class NlpSnapshot;
 
   /** Solvers for solving nonlinear programs.*/
   enum Solver{
@@ -114,6 +115,7 @@ class SimpleError : public CoinError
     WARNING_NON_CONVEX_OA /** Warn that there are equality or ranged constraints and OA may works bad.*/,
     SOLVER_DISAGREE_STATUS /** Different solver gives different status for problem.*/,
     SOLVER_DISAGREE_VALUE /** Different solver gives different optimal value for problem.*/,
+    WARNING_SNAPSHOT /** Failed to read or write a snapshot file.*/,
     OSITMINLPINTERFACE_DUMMY_END
   };
 
@@ -1099,6 +1101,10 @@ protected:
   /// Initialize data structures for storing the jacobian
   int initializeJacobianArrays();
 
+  /** Take the starting point of the root NLP from snapshot_ if it
+      matches the problem. Returns true on success.*/
+  bool restoreFromSnapshot();
+
   ///@name Virtual callbacks for application specific stuff
   //@{
   virtual std::string  appName()
@@ -1282,6 +1288,10 @@ protected:
   WarmStartModes warmStartMode_;
   /** Is it the first solve (for random starting point at root options).*/
   bool firstSolve_;
+  /** Snapshot of the root NLP read or written at the first solve (shared by copies).*/
+  Ipopt::SmartPtr<NlpSnapshot> snapshot_;
+  /** Pass the cutoff to the NLP solver and let it stop early.*/
+  bool cutoffTermination_;
   /** Object for strengthening cuts */
   Ipopt::SmartPtr<CutStrengthener> cutStrengthener_;
 
@@ -1323,6 +1333,7 @@ static const char * FAILED_SYMB;
 static const char * INFEAS_SYMB;
 static const char * TIME_SYMB;
 static const char * UNBOUND_SYMB;
+static const char * CUTOFF_SYMB;
   /** Get status as a char * for log.*/
   const char * statusAsString(TNLPSolver::ReturnStatus r){
     if(r == TNLPSolver::solvedOptimal || r == TNLPSolver::solvedOptimalTol){
@@ -1333,6 +1344,8 @@ static const char * UNBOUND_SYMB;
       return UNBOUND_SYMB;}
     else if(r == TNLPSolver::timeLimit){
       return TIME_SYMB;}
+    else if(r == TNLPSolver::objectiveLimitReached){
+      return CUTOFF_SYMB;}
     else return FAILED_SYMB;
   }
   const char * statusAsString(){
@@ -40,6 +40,7 @@ class TNLPSolver: public Ipopt::ReferencedObject{
     solvedOptimalTol =2/** Problem solved to "acceptable level of tolerance. */,
     provenInfeasible =3/** Infeasibility Proven. */,
     unbounded = 4/** Problem is unbounded.*/,
+    objectiveLimitReached = 6/** Problem can not beat the objective cutoff.*/,
     numReturnCodes/**Fake member to know size*/
   };
 
@@ -151,6 +152,14 @@ TNLPSolver(Ipopt::SmartPtr<Bonmin::RegisteredOptions> roptions,
   virtual void disableWarmStart() = 0;
    //@}
 
+  /** Ask the solver to stop as soon as it can prove that the problem is
+      infeasible or can not beat cutoff (default does nothing).*/
+  virtual void setCutoffTermination(double cutoff){}
+
+  /** Undo setCutoffTermination, the options are shared with the solver's
+      clones which solve other problems (default does nothing).*/
+  virtual void clearCutoffTermination(){}
+
   ///Get a pointer to a journalist
   Ipopt::SmartPtr<Ipopt::Journalist> journalist(){
     return journalist_;}
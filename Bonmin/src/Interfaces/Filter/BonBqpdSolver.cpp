@@ -487,9 +487,12 @@ namespace Bonmin
   bool
   BqpdSolver::cachedInfo::markHotStart()
   {
-     next_reinit_ = BqpdSolver::reinit_freq_; 
+    next_reinit_ = BqpdSolver::reinit_freq_;
+    if (haveHotStart_) {
+      unmarkHotStart();
+    }
 #ifdef DISABLE_COPYING
-     return 1;
+    return 1;
 #endif
 #ifdef TIME_BQPD
     times_.warm_start -= CoinCpuTime();
@@ -710,12 +713,15 @@ namespace Bonmin
     F77_FUNC(wsc,WSC).mxws = mxws;
     F77_FUNC(wsc,WSC).mxlws = mxlws;
 
-    if (use_warm_start_in_cache_ && !bad_warm_start_info_) {
+    // With a hot start, the factorization stored there is still valid
+    // when the last resolve left unusable warm start information.
+    if (use_warm_start_in_cache_ && (!bad_warm_start_info_ || haveHotStart_)) {
       ifail = 0;
       use_warm_start_in_cache_ = false;
-      if (haveHotStart_ && pivots_ > next_reinit_) {
+      if (haveHotStart_ && (bad_warm_start_info_ || pivots_ > next_reinit_)) {
         //printf("Reinitialize hot start\n");
         copyFromHotStart();
+        bad_warm_start_info_ = false;
         while (BqpdSolver::reinit_freq_ > 0&& next_reinit_ < pivots_)
           next_reinit_ += BqpdSolver::reinit_freq_;
       }
@@ -11,6 +11,9 @@
 #include "BonIpoptSolver.hpp"
 #include "IpSolveStatistics.hpp"
 #include "CoinError.hpp"
+#include "CoinThreadPool.hpp"
+
+#include <algorithm>
 
 #include "BonIpoptInteriorWarmStarter.hpp"
 #include "BonIpoptWarmStart.hpp"
@@ -18,6 +21,44 @@
 
 extern bool BonminAbortAll;
 
+namespace
+{
+  /** Reserves the workers of the COIN-OR thread pool that nobody else has
+      reserved (e.g. the Cbc tree threads) for the parallel
+      sections of one Ipopt solve, and gives them back at the end.  Without
+      a pool the thread options are left alone, i.e. Ipopt uses the OpenMP
+      default.  The thread counts are given to the solve only, the options
+      (which other solvers may be copying in other threads) are not
+      changed. */
+  class PoolThreadsForSolve {
+  public:
+    PoolThreadsForSolve(Ipopt::IpoptApplication & app,
+                        const std::vector<std::string> & threadOptions):
+      app_(app),
+      reserved_(0)
+    {
+      CoinThreadPool & pool = CoinThreadPool::global();
+      if (threadOptions.empty() || !CoinThreadPool::threaded() ||
+          pool.numberThreads() <= 1)
+        return;
+      // The thread calling the solve is one of the threads Ipopt runs on
+      reserved_ = pool.reserveThreads(pool.availableThreads() - 1);
+      for (unsigned int i = 0 ; i < threadOptions.size() ; i++)
+        app_.SetSolveIntegerValue(threadOptions[i], reserved_ + 1);
+    }
+    ~PoolThreadsForSolve()
+    {
+      if (reserved_ > 0) {
+        app_.ClearSolveIntegerValues();
+        CoinThreadPool::global().releaseThreads(reserved_);
+      }
+    }
+  private:
+    Ipopt::IpoptApplication & app_;
+    int reserved_;
+  };
+}
+
 namespace Bonmin
 {
 
@@ -73,7 +114,8 @@ namespace Bonmin
     problemHadZeroDimension_(other.problemHadZeroDimension_),
     warmStartStrategy_(other.warmStartStrategy_),
     enable_warm_start_(false),
-    optimized_before_(false){
+    optimized_before_(false),
+    poolThreadOptions_(other.poolThreadOptions_){
       app_ = new Ipopt::IpoptApplication(GetRawPtr(roptions_), options_, journalist_);
   }
 
@@ -137,6 +179,7 @@ namespace Bonmin
                                   true, true);
       }
 #endif
+      PoolThreadsForSolve threads(*app_, poolThreadOptions_);
       if (enable_warm_start_ && optimized_before_) {
         optimizationStatus_ = app_->ReOptimizeTNLP(tnlp);
       }
@@ -183,6 +226,7 @@ namespace Bonmin
                                   true, true);
       }
 #endif
+      PoolThreadsForSolve threads(*app_, poolThreadOptions_);
       if (optimized_before_) {
         optimizationStatus_ = app_->ReOptimizeTNLP(tnlp);
       }
@@ -270,10 +314,28 @@ namespace Bonmin
     set = Options->GetEnumValue("mu_oracle",dummy_int, "");
     if(!set)
     Options->SetStringValue("mu_oracle","probing", true, true);
+    // Collect the timing traces of all NLPs solved in one file
+    set = Options->GetEnumValue("phase_trace_append",dummy_int, "");
+    if(!set)
+    Options->SetStringValue("phase_trace_append","yes", true, true);
     if(!Options->GetIntegerValue("print_level",default_log_level_,"")) {
       default_log_level_ = 1;
       Options->SetIntegerValue("print_level",1, true, true);
     }
+    // Ipopt's parallel sections get the threads of the COIN-OR thread pool
+    // that are free when a solve starts (see PoolThreadsForSolve)
+    const char * threadOptions[5] = {"ldl_num_threads", "csr_conversion_num_threads",
+                                     "limited_memory_num_threads", "block_eval_num_threads",
+                                     "ruiz_scaling_num_threads"};
+    for(int i = 0 ; i < 5 ; i++){
+      // setMinlpDefaults runs again with each Initialize
+      if(std::find(poolThreadOptions_.begin(), poolThreadOptions_.end(),
+                   threadOptions[i]) != poolThreadOptions_.end())
+        continue;
+      set = Options->GetIntegerValue(threadOptions[i], dummy_int, "");
+      if(!set)
+        poolThreadOptions_.push_back(threadOptions[i]);
+    }
   }
 
 
@@ -313,6 +375,8 @@ namespace Bonmin
       return solvedOptimalTol;
     case Ipopt::Infeasible_Problem_Detected:
       return provenInfeasible;
+    case Ipopt::Objective_Cutoff_Reached:
+      return objectiveLimitReached;
     case Ipopt::Diverging_Iterates:
       return unbounded;
     case Ipopt::Maximum_CpuTime_Exceeded:
@@ -409,6 +473,20 @@ IpoptSolver::getUsedWarmStart(Ipopt::SmartPtr<TMINLP2TNLP> tnlp) const
     options_->SetStringValue("warm_start_init_point", "no");
   }
 
+  void
+  IpoptSolver::setCutoffTermination(double cutoff)
+  {
+    options_->SetNumericValue("obj_cutoff", std::min(cutoff, 1e20), true, true);
+    options_->SetStringValue("infeasibility_certificate", "yes", true, true);
+  }
+
+  void
+  IpoptSolver::clearCutoffTermination()
+  {
+    options_->SetNumericValue("obj_cutoff", 1e20, true, true);
+    options_->SetStringValue("infeasibility_certificate", "no", true, true);
+  }
+
 
   void
   IpoptSolver::setOutputToDefault()
@@ -108,6 +108,12 @@ namespace Bonmin
 
     //@}
 
+    /// Pass cutoff to Ipopt and turn on its infeasibility certificate
+    virtual void setCutoffTermination(double cutoff);
+
+    /// Reset obj_cutoff and infeasibility_certificate to their defaults
+    virtual void clearCutoffTermination();
+
     /// Get the CpuTime of the last optimization.
     virtual double CPUTime();
 
@@ -180,6 +186,10 @@ namespace Bonmin
     /** flag remembering if we have call the Optimize method of the
         IpoptInterface before */
     bool optimized_before_;
+    /** Thread count options of Ipopt not set by the user; each solve
+        gets the number of threads it obtains from the COIN-OR thread
+        pool for them. */
+    std::vector<std::string> poolThreadOptions_;
     //name of solver (Ipopt)
     static std::string  solverName_;
   };
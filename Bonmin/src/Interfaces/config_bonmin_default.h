@@ -15,3 +15,6 @@
 
 /* Release Version number of project */
 #define BONMIN_VERSION_RELEASE 9999
+
+/* Define to 1 if Bonmin may use background threads */
+/* #define BONMIN_PTHREADS 1 */
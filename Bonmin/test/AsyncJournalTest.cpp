@@ -0,0 +1,187 @@
+// Copyright (C) 2012, International Business Machines Corporation and others.
+// All Rights Reserved.
+// This code is published under the Common Public License.
+
+/* Checks the asynchronous console journal with several threads printing
+   through one journalist while another one keeps setting print levels:
+   - every line is written, each thread's lines in order, and the lines
+     of suppressed levels are not,
+   - drain() and the destructor hand over the incomplete lines of all
+     threads,
+   - JournalMessageHandler follows the level of J_USER_APPLICATION.
+   Meant to be run under ThreadSanitizer as well (configure with
+   CXXFLAGS=-fsanitize=thread).
+
+   Usage: asyncJournalTest*/
+
+#include "BonminConfig.h"
+#include "BonAsyncJournal.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifdef BONMIN_PTHREADS
+#include <pthread.h>
+#endif
+
+using namespace Ipopt;
+using namespace Bonmin;
+
+#ifdef BONMIN_PTHREADS
+static const int numberThreads = 4;
+static const int numberLines = 3000;
+static const char * fileName = "asyncJournalTest.out";
+
+static Journalist * journalist = NULL;
+/** Number of workers done with the current phase.*/
+static volatile int done = 0;
+/** Phase the workers may start.*/
+static volatile int phase = 0;
+/** Set when the level setter should stop.*/
+static volatile int stop = 0;
+
+static int readInt(volatile int & value){
+  return __sync_fetch_and_add(&value, 0);
+}
+
+static void waitFor(volatile int & value, int target){
+  while(readInt(value) < target) {}
+}
+
+extern "C" {
+  static void * worker(void * arg){
+    long id = (long) arg;
+    for(int i = 0 ; i < numberLines ; i++){
+      journalist->Printf(J_SUMMARY, J_MAIN, "thread %ld ", id);
+      journalist->Printf(J_SUMMARY, J_MAIN, "line %d\n", i);
+      journalist->Printf(J_DETAILED, J_MAIN, "suppressed %d\n", i);
+    }
+    journalist->Printf(J_SUMMARY, J_MAIN, "[tail %ld]", id);
+    __sync_fetch_and_add(&done, 1);
+    waitFor(phase, 1);
+    journalist->Printf(J_SUMMARY, J_MAIN, "\n[late %ld]", id);
+    __sync_fetch_and_add(&done, 1);
+    waitFor(phase, 2);
+    return NULL;
+  }
+
+  /** Sets the levels the way IpoptApplication does before each solve.*/
+  static void * levelSetter(void * arg){
+    Journal * journal = static_cast<Journal *>(arg);
+    while(!readInt(stop)){
+      journal->SetPrintLevel(J_DBG, J_ALL);
+      journal->SetPrintLevel(J_DBG, J_NONE);
+      for(int category = J_DBG + 1 ; category < J_USER_APPLICATION ; category++)
+        journal->SetPrintLevel((EJournalCategory) category, J_SUMMARY);
+    }
+    return NULL;
+  }
+}
+
+static bool check(bool condition, const char * what){
+  if(!condition)
+    printf("asyncJournalTest: %s\n", what);
+  return condition;
+}
+
+static std::string readFile(){
+  std::string text;
+  FILE * fp = fopen(fileName, "r");
+  if(fp == NULL)
+    return text;
+  char block[4096];
+  size_t length;
+  while((length = fread(block, 1, sizeof(block), fp)) > 0)
+    text.append(block, length);
+  fclose(fp);
+  return text;
+}
+
+int main(){
+  SmartPtr<Journalist> jnlst = new Journalist;
+  SmartPtr<AsyncJournal> journal = new AsyncJournal("console", J_SUMMARY);
+  if(!journal->Open(fileName) || !jnlst->AddJournal(GetRawPtr(journal))
+     || !journal->startWriter()){
+    printf("asyncJournalTest: could not start the journal\n");
+    return 1;
+  }
+  journalist = GetRawPtr(jnlst);
+  bool ok = true;
+
+  {
+    CoinMessageHandler base;
+    JournalMessageHandler handler(GetRawPtr(journal), base);
+    handler.message(0, "TST", "[handler shown]", 'I', 0) << CoinMessageEol;
+    journal->SetPrintLevel(J_USER_APPLICATION, J_NONE);
+    handler.message(0, "TST", "[handler hidden]", 'I', 0) << CoinMessageEol;
+  }
+
+  pthread_t setter;
+  pthread_t threads[numberThreads];
+  pthread_create(&setter, NULL, levelSetter, GetRawPtr(journal));
+  for(long i = 0 ; i < numberThreads ; i++)
+    pthread_create(threads + i, NULL, worker, (void *) i);
+
+  // All threads are waiting with an incomplete line
+  waitFor(done, numberThreads);
+  journal->drain();
+  std::string text = readFile();
+  ok = check(text.find("[handler shown]") != std::string::npos, "message lost") && ok;
+  ok = check(text.find("[handler hidden]") == std::string::npos,
+             "message printed at level J_NONE") && ok;
+  ok = check(text.find("suppressed") == std::string::npos,
+             "suppressed line printed") && ok;
+  int next[numberThreads] = {0};
+  for(size_t start = 0 ; start < text.size() ; ){
+    size_t end = text.find('\n', start);
+    if(end == std::string::npos)
+      end = text.size();
+    long id;
+    int line;
+    if(sscanf(text.c_str() + start, "thread %ld line %d", &id, &line) == 2){
+      ok = check(id >= 0 && id < numberThreads && line == next[id],
+                 "lines out of order") && ok;
+      if(id >= 0 && id < numberThreads)
+        next[id]++;
+    }
+    start = end + 1;
+  }
+  char tag[32];
+  for(int i = 0 ; i < numberThreads ; i++){
+    ok = check(next[i] == numberLines, "lines lost") && ok;
+    sprintf(tag, "[tail %d]", i);
+    ok = check(text.find(tag) != std::string::npos, "drain() lost a line") && ok;
+  }
+
+  // The destructor hands over what the threads are still printing
+  __sync_fetch_and_add(&phase, 1);
+  waitFor(done, 2 * numberThreads);
+  __sync_fetch_and_add(&stop, 1);
+  pthread_join(setter, NULL);
+  jnlst->DeleteAllJournals();
+  journalist = NULL;
+  jnlst = NULL;
+  journal = NULL;
+  __sync_fetch_and_add(&phase, 1);
+  for(int i = 0 ; i < numberThreads ; i++)
+    pthread_join(threads[i], NULL);
+  text = readFile();
+  for(int i = 0 ; i < numberThreads ; i++){
+    sprintf(tag, "[late %d]", i);
+    ok = check(text.find(tag) != std::string::npos,
+               "destructor lost a line") && ok;
+  }
+
+  remove(fileName);
+  if(!ok)
+    return 1;
+  printf("asyncJournalTest: all tests passed\n");
+  return 0;
+}
+#else
+int main(){
+  printf("asyncJournalTest: no thread support, skipped\n");
+  return 0;
+}
+#endif
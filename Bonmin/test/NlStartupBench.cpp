@@ -0,0 +1,118 @@
+// Copyright (C) 2012, International Business Machines Corporation and others.
+// All Rights Reserved.
+// This code is published under the Common Public License.
+
+/* Measures the time taken by Bonmin to read an AMPL model and to be ready to
+   solve its first NLP, on generated .nl files of increasing size.
+
+   The generated models have 2n variables and n constraints
+       min  - sum x_i - sum y_i
+       s.t. (x_i - 1/2)^2 + x_{i+1} + y_i <= 1   i = 0,...,n-1
+            0 <= x <= 1, y binary
+   (with x_n = x_0) so that the Jacobian has 3n nonzeros, the Hessian n.
+
+   Usage: nlStartupBench [smallest n] [largest n]
+   (sizes are multiplied by 4 from one file to the next).*/
+
+#include "BonminConfig.h"
+#include "BonAmplSetup.hpp"
+#include "BonOsiTMINLPInterface.hpp"
+#include "CoinTime.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace Bonmin;
+
+/** Write the model described above in ascii .nl format to stub.nl.*/
+static void writeNlFile(const std::string & stub, int n)
+{
+  std::string name = stub + ".nl";
+  FILE * fp = fopen(name.c_str(), "w");
+  if (fp == NULL) {
+    fprintf(stderr, "Can not open %s for writing\n", name.c_str());
+    exit(1);
+  }
+  fprintf(fp, "g3 1 1 0\t# generated by nlStartupBench\n");
+  fprintf(fp, " %d %d 1 0 0\n", 2*n, n);
+  fprintf(fp, " %d 0\n", n);
+  fprintf(fp, " 0 0\n");
+  fprintf(fp, " %d 0 0\n", n);
+  fprintf(fp, " 0 0 0 1\n");
+  fprintf(fp, " %d 0 0 0 0\n", n);
+  fprintf(fp, " %d %d\n", 3*n, 2*n);
+  fprintf(fp, " 0 0\n");
+  fprintf(fp, " 0 0 0 0 0\n");
+  // Nonlinear parts of the constraints (x_i - 0.5)^2
+  for (int i = 0 ; i < n ; i++) {
+    fprintf(fp, "C%d\no5\no0\nn-0.5\nv%d\nn2\n", i, i);
+  }
+  fprintf(fp, "O0 0\nn0\n");
+  fprintf(fp, "r\n");
+  for (int i = 0 ; i < n ; i++) {
+    fprintf(fp, "1 1\n");
+  }
+  fprintf(fp, "b\n");
+  for (int i = 0 ; i < 2*n ; i++) {
+    fprintf(fp, "0 0 1\n");
+  }
+  // Column counts: x_i appears in constraints i and i-1, y_i in i.
+  fprintf(fp, "k%d\n", 2*n - 1);
+  int count = 0;
+  for (int j = 0 ; j < 2*n - 1 ; j++) {
+    count += (j < n) ? 2 : 1;
+    fprintf(fp, "%d\n", count);
+  }
+  for (int i = 0 ; i < n ; i++) {
+    int next = (i + 1) % n;
+    if (next < i) {
+      fprintf(fp, "J%d 3\n%d 1\n%d 0\n%d 1\n", i, next, i, n + i);
+    }
+    else {
+      fprintf(fp, "J%d 3\n%d 0\n%d 1\n%d 1\n", i, i, next, n + i);
+    }
+  }
+  fprintf(fp, "G0 %d\n", 2*n);
+  for (int j = 0 ; j < 2*n ; j++) {
+    fprintf(fp, "%d -1\n", j);
+  }
+  fclose(fp);
+}
+
+int main(int argc, char ** argv)
+{
+  int smallest = 1000;
+  int largest = 256000;
+  if (argc > 1)
+    smallest = atoi(argv[1]);
+  if (argc > 2)
+    largest = atoi(argv[2]);
+  if (smallest < 2)
+    smallest = 2;
+
+  printf("%10s %10s %12s %12s %12s\n", "vars", "cons", "write (s)",
+         "setup (s)", "1st NLP (s)");
+  for (int n = smallest ; n <= largest ; n *= 4) {
+    char stub[64];
+    sprintf(stub, "startupBench%d", n);
+
+    double start = CoinWallclockTime();
+    writeNlFile(stub, n);
+    double written = CoinWallclockTime();
+
+    const char * args[3] = {"nlStartupBench", stub, NULL};
+    const char ** bench_argv = args;
+    BonminAmplSetup bonmin;
+    bonmin.initialize(const_cast<char **&>(bench_argv));
+    double setUp = CoinWallclockTime();
+
+    bonmin.nonlinearSolver()->initialSolve();
+    double solved = CoinWallclockTime();
+
+    printf("%10d %10d %12.3f %12.3f %12.3f\n", 2*n, n, written - start,
+           setUp - written, solved - setUp);
+    remove((std::string(stub) + ".nl").c_str());
+  }
+  return 0;
+}
@@ -0,0 +1,240 @@
+// Copyright (C) 2012, International Business Machines Corporation and others.
+// All Rights Reserved.
+// This code is published under the Common Public License.
+
+/* Compares B-BB with and without nlp_cutoff_termination on a generated
+   convex MINLP with n binary and n continuous variables
+       min  sum c_i y_i + sum q_i x_i^2
+       s.t. x_i <= y_i                       i = 0,...,n-1
+            sum x_i >= n/4
+            sum w_i x_i^2 <= n/8
+            0 <= x <= 1, y binary
+   Many nodes of the tree are infeasible (not enough y's left at one) or
+   can not beat the incumbent, which is where the NLP solver is allowed to
+   stop early.
+
+   Usage: nodeCutoffBench [n]*/
+
+#include "BonminConfig.h"
+#include "BonTMINLP.hpp"
+#include "BonBonminSetup.hpp"
+#include "BonCbc.hpp"
+#include "BonOsiTMINLPInterface.hpp"
+#include "CoinTime.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Ipopt;
+using namespace Bonmin;
+
+class CutoffBenchTMINLP : public TMINLP
+{
+public:
+  CutoffBenchTMINLP(int n):
+    n_(n), c_(n), q_(n), w_(n)
+  {
+    // deterministic coefficients
+    unsigned int seed = 12345;
+    for (int i = 0 ; i < n ; i++) {
+      seed = seed * 1103515245 + 12345;
+      c_[i] = 1. + (double)((seed >> 8) % 1000) / 100.;
+      seed = seed * 1103515245 + 12345;
+      q_[i] = 1. + (double)((seed >> 8) % 1000) / 200.;
+      seed = seed * 1103515245 + 12345;
+      w_[i] = 0.5 + (double)((seed >> 8) % 1000) / 1000.;
+    }
+  }
+
+  virtual bool get_variables_types(Index n, VariableType* var_types)
+  {
+    for (int i = 0 ; i < n_ ; i++) {
+      var_types[i] = CONTINUOUS;
+      var_types[n_ + i] = BINARY;
+    }
+    return true;
+  }
+
+  virtual bool get_variables_linearity(Index n, TNLP::LinearityType* var_types)
+  {
+    for (int i = 0 ; i < n_ ; i++) {
+      var_types[i] = TNLP::NON_LINEAR;
+      var_types[n_ + i] = TNLP::LINEAR;
+    }
+    return true;
+  }
+
+  virtual bool get_constraints_linearity(Index m, TNLP::LinearityType* const_types)
+  {
+    for (int i = 0 ; i <= n_ ; i++)
+      const_types[i] = TNLP::LINEAR;
+    const_types[n_ + 1] = TNLP::NON_LINEAR;
+    return true;
+  }
+
+  virtual bool get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
+                            Index& nnz_h_lag, TNLP::IndexStyleEnum& index_style)
+  {
+    n = 2*n_;
+    m = n_ + 2;
+    nnz_jac_g = 4*n_;
+    nnz_h_lag = n_;
+    index_style = TNLP::C_STYLE;
+    return true;
+  }
+
+  virtual bool get_bounds_info(Index n, Number* x_l, Number* x_u,
+                               Index m, Number* g_l, Number* g_u)
+  {
+    for (int i = 0 ; i < n ; i++) {
+      x_l[i] = 0.;
+      x_u[i] = 1.;
+    }
+    for (int i = 0 ; i < n_ ; i++) {
+      g_l[i] = -DBL_MAX;
+      g_u[i] = 0.;
+    }
+    g_l[n_] = n_/4.;
+    g_u[n_] = DBL_MAX;
+    g_l[n_ + 1] = -DBL_MAX;
+    g_u[n_ + 1] = n_/8.;
+    return true;
+  }
+
+  virtual bool get_starting_point(Index n, bool init_x, Number* x,
+                                  bool init_z, Number* z_L, Number* z_U,
+                                  Index m, bool init_lambda, Number* lambda)
+  {
+    for (int i = 0 ; i < n ; i++)
+      x[i] = 0.5;
+    return true;
+  }
+
+  virtual bool eval_f(Index n, const Number* x, bool new_x, Number& obj_value)
+  {
+    obj_value = 0.;
+    for (int i = 0 ; i < n_ ; i++)
+      obj_value += c_[i]*x[n_ + i] + q_[i]*x[i]*x[i];
+    return true;
+  }
+
+  virtual bool eval_grad_f(Index n, const Number* x, bool new_x, Number* grad_f)
+  {
+    for (int i = 0 ; i < n_ ; i++) {
+      grad_f[i] = 2.*q_[i]*x[i];
+      grad_f[n_ + i] = c_[i];
+    }
+    return true;
+  }
+
+  virtual bool eval_g(Index n, const Number* x, bool new_x, Index m, Number* g)
+  {
+    g[n_] = 0.;
+    g[n_ + 1] = 0.;
+    for (int i = 0 ; i < n_ ; i++) {
+      g[i] = x[i] - x[n_ + i];
+      g[n_] += x[i];
+      g[n_ + 1] += w_[i]*x[i]*x[i];
+    }
+    return true;
+  }
+
+  virtual bool eval_jac_g(Index n, const Number* x, bool new_x,
+                          Index m, Index nele_jac, Index* iRow, Index *jCol,
+                          Number* values)
+  {
+    if (values == NULL) {
+      for (int i = 0 ; i < n_ ; i++) {
+        iRow[2*i] = i;
+        jCol[2*i] = i;
+        iRow[2*i + 1] = i;
+        jCol[2*i + 1] = n_ + i;
+        iRow[2*n_ + i] = n_;
+        jCol[2*n_ + i] = i;
+        iRow[3*n_ + i] = n_ + 1;
+        jCol[3*n_ + i] = i;
+      }
+    }
+    else {
+      for (int i = 0 ; i < n_ ; i++) {
+        values[2*i] = 1.;
+        values[2*i + 1] = -1.;
+        values[2*n_ + i] = 1.;
+        values[3*n_ + i] = 2.*w_[i]*x[i];
+      }
+    }
+    return true;
+  }
+
+  virtual bool eval_h(Index n, const Number* x, bool new_x,
+                      Number obj_factor, Index m, const Number* lambda,
+                      bool new_lambda, Index nele_hess, Index* iRow,
+                      Index* jCol, Number* values)
+  {
+    if (values == NULL) {
+      for (int i = 0 ; i < n_ ; i++) {
+        iRow[i] = i;
+        jCol[i] = i;
+      }
+    }
+    else {
+      for (int i = 0 ; i < n_ ; i++)
+        values[i] = 2.*(obj_factor*q_[i] + lambda[n_ + 1]*w_[i]);
+    }
+    return true;
+  }
+
+  virtual void finalize_solution(TMINLP::SolverReturn status,
+                                 Index n, const Number* x, Number obj_value)
+  {}
+
+  virtual const SosInfo * sosConstraints() const{return NULL;}
+  virtual const BranchingInfo* branchingInfo() const{return NULL;}
+
+private:
+  int n_;
+  std::vector<double> c_;
+  std::vector<double> q_;
+  std::vector<double> w_;
+};
+
+int main(int argc, char ** argv)
+{
+  int n = 24;
+  if (argc > 1)
+    n = atoi(argv[1]);
+  if (n < 4)
+    n = 4;
+
+  printf("%12s %10s %10s %12s %10s %14s\n", "cutoff_term", "nodes",
+         "NLP solves", "NLP iters", "time (s)", "best obj");
+  const char * modes[2] = {"no", "yes"};
+  for (int k = 0 ; k < 2 ; k++) {
+    SmartPtr<TMINLP> tminlp = new CutoffBenchTMINLP(n);
+    BonminSetup bonmin;
+    bonmin.initializeOptionsAndJournalist();
+    bonmin.options()->SetStringValue("bonmin.algorithm", "B-BB");
+    bonmin.options()->SetStringValue("bonmin.nlp_cutoff_termination", modes[k]);
+    bonmin.options()->SetIntegerValue("bonmin.bb_log_level", 0);
+    bonmin.options()->SetIntegerValue("bonmin.nlp_log_level", 0);
+    bonmin.options()->SetIntegerValue("print_level", 0);
+    bonmin.readOptionsFile();
+    bonmin.initialize(tminlp);
+
+    double start = CoinCpuTime();
+    Bab bb;
+    bb(bonmin);
+    double time = CoinCpuTime() - start;
+
+    // Branch-and-bound works on a clone of the setup's solver
+    OsiTMINLPInterface * nlp =
+      dynamic_cast<OsiTMINLPInterface *>(bb.model().solver());
+    if (nlp == NULL)
+      nlp = bonmin.nonlinearSolver();
+    printf("%12s %10d %10d %12d %10.3f %14.6f\n", modes[k], bb.numNodes(),
+           nlp->nCallOptimizeTNLP(), nlp->totalIterations(), time,
+           bb.bestObj());
+  }
+  return 0;
+}
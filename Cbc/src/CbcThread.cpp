@@ -31,6 +31,7 @@
 #include "OsiAuxInfo.hpp"
 
 #include "CoinTime.hpp"
+#include "CoinThreadPool.hpp"
 #ifdef CBC_THREAD
 /// Thread functions
 static void * doNodesThread(void * voidInfo);
@@ -262,6 +263,8 @@ parallelHeuristics (int numberThreads,
                     int sizeOfData,
                     void * argBundle)
 {
+    // Keep the thread pool from running tasks on the same processors
+    int reserved = CoinThreadPool::global().reserveThreads(numberThreads);
     Coin_pthread_t * threadId = new Coin_pthread_t [numberThreads];
     char * args = reinterpret_cast<char *>(argBundle);
     for (int i = 0; i < numberThreads; i++) {
@@ -273,6 +276,7 @@ parallelHeuristics (int numberThreads,
         pthread_join(threadId[i].thr, NULL);
     }
     delete [] threadId;
+    CoinThreadPool::global().releaseThreads(reserved);
 }
 // End of specific thread stuff
 
@@ -527,7 +531,8 @@ CbcBaseModel::CbcBaseModel()
         numberObjects_(0),
         saveObjects_(NULL),
         defaultParallelIterations_(400),
-        defaultParallelNodes_(2)
+        defaultParallelNodes_(2),
+        reservedThreads_(0)
 {
 }
 // Constructor with model
@@ -540,10 +545,14 @@ CbcBaseModel::CbcBaseModel (CbcModel & model,  int type)
         numberObjects_(0),
         saveObjects_(NULL),
         defaultParallelIterations_(400),
-        defaultParallelNodes_(2)
+        defaultParallelNodes_(2),
+        reservedThreads_(0)
 {
     numberThreads_ = model.getNumberThreads();
     if (numberThreads_) {
+        // Children run on threads of their own, the thread pool (used by
+        // Clp and Bonmin) gives up as many workers while they exist
+        reservedThreads_ = CoinThreadPool::global().reserveThreads(numberThreads_);
         children_ = new CbcThread [numberThreads_+1];
         // Do a partial one for base model
         void * mutex_main = NULL;
@@ -631,6 +640,8 @@ CbcBaseModel::stopThreads(int type)
     saveObjects_ = NULL;
     numberObjects_ = 0;
     numberThreads_ = 0;
+    CoinThreadPool::global().releaseThreads(reservedThreads_);
+    reservedThreads_ = 0;
 }
 // Wait for threads in tree
 int
@@ -1103,6 +1114,7 @@ CbcBaseModel::~CbcBaseModel()
     for (int i = 0; i < numberObjects_; i++)
         delete saveObjects_[i];
     delete [] saveObjects_;
+    CoinThreadPool::global().releaseThreads(reservedThreads_);
 }
 // Sets Dantzig state in children
 void
@@ -409,6 +409,8 @@ private:
     int threadStats_[6];
     int defaultParallelIterations_;
     int defaultParallelNodes_;
+    /// Threads taken out of CoinThreadPool::global() while children run
+    int reservedThreads_;
 };
 #else
 // Dummy threads
@@ -13,17 +13,10 @@
 #include "ClpCholeskyDense.hpp"
 #include "ClpMessage.hpp"
 #include "ClpQuadraticObjective.hpp"
+#include "CoinThreadPool.hpp"
 #if CLP_HAS_ABC
 #include "CoinAbcCommon.hpp"
 #endif
-#if CLP_HAS_ABC<3
-#undef cilk_for 
-#undef cilk_spawn
-#undef cilk_sync
-#define cilk_for for 
-#define cilk_spawn
-#define cilk_sync
-#endif
 
 /*#############################################################################*/
 /* Constructors / Destructor / Assignment*/
@@ -94,6 +87,9 @@ ClpCholeskyBase * ClpCholeskyDense::clone() const
 #define number_blocks(x) (((x)+BLOCK-1)>>BLOCKSHIFT)
 #define number_rows(x) ((x)<<BLOCKSHIFT)
 #define number_entries(x) ((x)<<BLOCKSQSHIFT)
+/* Recursive updates with fewer rows than this in the half that could go to
+   another thread are done on the calling thread */
+#define SPAWN_ROWS ( 8*BLOCK )
 /* Gets space */
 int
 ClpCholeskyDense::reserveSpace(const ClpCholeskyBase * factor, int numberRows)
@@ -644,6 +640,8 @@ ClpCholeskyDense::factorizePart2( int * rowsDropped)
      info.diagonal_ = diagonal_;
      info.doubleParameters_[0] = doubleParameters_[10];
      info.integerParameters_[0] = integerParameters_[34];
+     /* looked up once here, as CoinThreadPool::global() takes a lock */
+     info.pool = &CoinThreadPool::global();
 #ifndef CLP_CILK
      ClpCholeskyCfactor(&info, a, numberRows_, numberBlocks,
                         diagonal_, workDouble_, rowsDropped);
@@ -671,6 +669,91 @@ ClpCholeskyDense::factorizePart2( int * rowsDropped)
      doubleParameters_[4] = CoinMin(doubleParameters_[4], 1.0 / largest);
      integerParameters_[20] += numberDropped;
 }
+/* The recursive updates split their block in two halves writing to
+   different parts of the factor.  The first half is passed to the thread
+   pool as one of these tasks while the calling thread does the second. */
+class ClpCholeskyCtriRecTask : public CoinTask {
+public:
+     ClpCholeskyCtriRecTask(ClpCholeskyDenseC * thisStruct, longDouble * aTri, int nThis,
+                            longDouble * aUnder, longDouble * diagonal, longDouble * work,
+                            int nLeft, int iBlock, int jBlock, int numberBlocks)
+          : thisStruct_(thisStruct), aTri_(aTri), nThis_(nThis), aUnder_(aUnder),
+            diagonal_(diagonal), work_(work), nLeft_(nLeft), iBlock_(iBlock),
+            jBlock_(jBlock), numberBlocks_(numberBlocks) {}
+     virtual void run() {
+          ClpCholeskyCtriRec(thisStruct_, aTri_, nThis_, aUnder_, diagonal_, work_,
+                             nLeft_, iBlock_, jBlock_, numberBlocks_);
+     }
+private:
+     ClpCholeskyDenseC * thisStruct_;
+     longDouble * aTri_;
+     int nThis_;
+     longDouble * aUnder_;
+     longDouble * diagonal_;
+     longDouble * work_;
+     int nLeft_;
+     int iBlock_;
+     int jBlock_;
+     int numberBlocks_;
+};
+class ClpCholeskyCrecTriTask : public CoinTask {
+public:
+     ClpCholeskyCrecTriTask(ClpCholeskyDenseC * thisStruct, longDouble * aUnder, int nTri,
+                            int nDo, int iBlock, int jBlock, longDouble * aTri,
+                            longDouble * diagonal, longDouble * work, int numberBlocks)
+          : thisStruct_(thisStruct), aUnder_(aUnder), nTri_(nTri), nDo_(nDo),
+            iBlock_(iBlock), jBlock_(jBlock), aTri_(aTri), diagonal_(diagonal),
+            work_(work), numberBlocks_(numberBlocks) {}
+     virtual void run() {
+          ClpCholeskyCrecTri(thisStruct_, aUnder_, nTri_, nDo_, iBlock_, jBlock_, aTri_,
+                             diagonal_, work_, numberBlocks_);
+     }
+private:
+     ClpCholeskyDenseC * thisStruct_;
+     longDouble * aUnder_;
+     int nTri_;
+     int nDo_;
+     int iBlock_;
+     int jBlock_;
+     longDouble * aTri_;
+     longDouble * diagonal_;
+     longDouble * work_;
+     int numberBlocks_;
+};
+class ClpCholeskyCrecRecTask : public CoinTask {
+public:
+     ClpCholeskyCrecRecTask(ClpCholeskyDenseC * thisStruct, longDouble * above, int nUnder,
+                            int nUnderK, int nDo, longDouble * aUnder, longDouble * aOther,
+                            longDouble * work, int iBlock, int jBlock, int numberBlocks)
+          : thisStruct_(thisStruct), above_(above), nUnder_(nUnder), nUnderK_(nUnderK),
+            nDo_(nDo), aUnder_(aUnder), aOther_(aOther), work_(work), iBlock_(iBlock),
+            jBlock_(jBlock), numberBlocks_(numberBlocks) {}
+     virtual void run() {
+          ClpCholeskyCrecRec(thisStruct_, above_, nUnder_, nUnderK_, nDo_, aUnder_, aOther_,
+                             work_, iBlock_, jBlock_, numberBlocks_);
+     }
+private:
+     ClpCholeskyDenseC * thisStruct_;
+     longDouble * above_;
+     int nUnder_;
+     int nUnderK_;
+     int nDo_;
+     longDouble * aUnder_;
+     longDouble * aOther_;
+     longDouble * work_;
+     int iBlock_;
+     int jBlock_;
+     int numberBlocks_;
+};
+/* Give task to the thread pool if the half has at least SPAWN_ROWS rows*/
+static inline void
+ClpCholeskySpawnHalf(CoinTaskGroup & group, CoinTask & task, int nRows)
+{
+     if (nRows >= SPAWN_ROWS)
+          group.spawn(&task);
+     else
+          task.run();
+}
 /* Non leaf recursive factor*/
 void
 ClpCholeskyCfactor(ClpCholeskyDenseC * thisStruct, longDouble * a, int n, int numberBlocks,
@@ -705,10 +788,12 @@ ClpCholeskyCtriRec(ClpCholeskyDenseC * thisStruct, longDouble * aTri, int nThis,
      } else if (nThis < nLeft) {
           int nb = number_blocks((nLeft + 1) >> 1);
           int nLeft2 = number_rows(nb);
-          cilk_spawn ClpCholeskyCtriRec(thisStruct, aTri, nThis, aUnder, diagonal, work, nLeft2, iBlock, jBlock, numberBlocks);
+          CoinTaskGroup group(thisStruct->pool);
+          ClpCholeskyCtriRecTask first(thisStruct, aTri, nThis, aUnder, diagonal, work, nLeft2, iBlock, jBlock, numberBlocks);
+          ClpCholeskySpawnHalf(group, first, nLeft2);
           ClpCholeskyCtriRec(thisStruct, aTri, nThis, aUnder + number_entries(nb), diagonal, work, nLeft - nLeft2,
                              iBlock + nb, jBlock, numberBlocks);
-	  cilk_sync;
+          group.wait();
      } else {
           int nb = number_blocks((nThis + 1) >> 1);
           int nThis2 = number_rows(nb);
@@ -754,7 +839,9 @@ ClpCholeskyCrecTri(ClpCholeskyDenseC * thisStruct, longDouble * aUnder, int nTri
           int nTri2 = number_rows(nb);
           longDouble * aother;
           int i;
-          cilk_spawn ClpCholeskyCrecTri(thisStruct, aUnder, nTri2, nDo, iBlock, jBlock, aTri, diagonal, work, numberBlocks);
+          CoinTaskGroup group(thisStruct->pool);
+          ClpCholeskyCrecTriTask first(thisStruct, aUnder, nTri2, nDo, iBlock, jBlock, aTri, diagonal, work, numberBlocks);
+          ClpCholeskySpawnHalf(group, first, nTri2);
           /* and rectangular update */
           i = ((numberBlocks - iBlock) * (numberBlocks - iBlock + 1) -
                (numberBlocks - iBlock - nb) * (numberBlocks - iBlock - nb + 1)) >> 1;
@@ -763,7 +850,7 @@ ClpCholeskyCrecTri(ClpCholeskyDenseC * thisStruct, longDouble * aUnder, int nTri
                              work, iBlock, jBlock, numberBlocks);
           ClpCholeskyCrecTri(thisStruct, aUnder + number_entries(nb), nTri - nTri2, nDo, iBlock + nb, jBlock,
                              aTri + number_entries(i), diagonal, work, numberBlocks);
-	  cilk_sync;
+          group.wait();
      }
 }
 /* Non leaf recursive rectangle rectangle update,
@@ -783,11 +870,13 @@ ClpCholeskyCrecRec(ClpCholeskyDenseC * thisStruct, longDouble * above, int nUnde
      } else if (nDo <= nUnderK && nUnder <= nUnderK) {
           int nb = number_blocks((nUnderK + 1) >> 1);
           int nUnder2 = number_rows(nb);
-          cilk_spawn ClpCholeskyCrecRec(thisStruct, above, nUnder, nUnder2, nDo, aUnder, aOther, work,
-                             iBlock, jBlock, numberBlocks);
+          CoinTaskGroup group(thisStruct->pool);
+          ClpCholeskyCrecRecTask first(thisStruct, above, nUnder, nUnder2, nDo, aUnder, aOther, work,
+                                       iBlock, jBlock, numberBlocks);
+          ClpCholeskySpawnHalf(group, first, nUnder2);
           ClpCholeskyCrecRec(thisStruct, above, nUnder, nUnderK - nUnder2, nDo, aUnder + number_entries(nb),
                              aOther + number_entries(nb), work, iBlock, jBlock, numberBlocks);
-	  cilk_sync;
+          group.wait();
      } else if (nUnderK <= nDo && nUnder <= nDo) {
           int nb = number_blocks((nDo + 1) >> 1);
           int nDo2 = number_rows(nb);
@@ -804,13 +893,15 @@ ClpCholeskyCrecRec(ClpCholeskyDenseC * thisStruct, longDouble * above, int nUnde
           int nb = number_blocks((nUnder + 1) >> 1);
           int nUnder2 = number_rows(nb);
           int i;
-          cilk_spawn ClpCholeskyCrecRec(thisStruct, above, nUnder2, nUnderK, nDo, aUnder, aOther, work,
-                             iBlock, jBlock, numberBlocks);
+          CoinTaskGroup group(thisStruct->pool);
+          ClpCholeskyCrecRecTask first(thisStruct, above, nUnder2, nUnderK, nDo, aUnder, aOther, work,
+                                       iBlock, jBlock, numberBlocks);
+          ClpCholeskySpawnHalf(group, first, nUnder2);
           i = ((numberBlocks - iBlock) * (numberBlocks - iBlock - 1) -
                (numberBlocks - iBlock - nb) * (numberBlocks - iBlock - nb - 1)) >> 1;
           ClpCholeskyCrecRec(thisStruct, above + number_entries(nb), nUnder - nUnder2, nUnderK, nDo, aUnder,
                              aOther + number_entries(i), work, iBlock + nb, jBlock, numberBlocks);
-	  cilk_sync;
+          group.wait();
      }
 }
 /* Leaf recursive factor*/
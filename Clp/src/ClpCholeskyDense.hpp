@@ -10,6 +10,7 @@
 
 #include "ClpCholeskyBase.hpp"
 class ClpMatrixBase;
+class CoinThreadPool;
 
 class ClpCholeskyDense : public ClpCholeskyBase {
 
@@ -94,6 +95,7 @@ typedef struct {
      int integerParameters_[2]; /* corresponds to 34, nThreads */
      int n;
      int numberBlocks;
+     CoinThreadPool * pool; /* pool the recursive updates spawn into */
 } ClpCholeskyDenseC;
 
 extern "C" {
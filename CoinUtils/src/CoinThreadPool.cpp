@@ -0,0 +1,751 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#include "CoinUtilsConfig.h"
+#include "CoinThreadPool.hpp"
+#include "CoinHelperFunctions.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#ifdef COINUTILS_PTHREADS
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#endif
+
+namespace {
+  /// A queued task and the counter of its group
+  struct CoinTaskEntry {
+    CoinTask * task;
+    int * pending;
+  };
+
+  /// One chunk of a parallelFor()
+  class CoinChunkTask : public CoinTask {
+  public:
+    CoinChunkTask() :
+      body_(NULL), first_(0), last_(0), chunk_(0) {}
+    CoinChunkTask(CoinRangeTask * body, int first, int last, int chunk) :
+      body_(body), first_(first), last_(last), chunk_(chunk) {}
+    virtual void run()
+    { body_->run(first_, last_, chunk_);}
+  private:
+    CoinRangeTask * body_;
+    int first_;
+    int last_;
+    int chunk_;
+  };
+
+#ifdef COINUTILS_PTHREADS
+  /// Parse a list such as "0-3,8,10-11" as found in /sys
+  void coinParseList(const char * text, std::vector<int> & values)
+  {
+    values.clear();
+    const char * p = text;
+    while (*p) {
+      char * end;
+      long first = strtol(p, &end, 10);
+      if (end == p)
+        break;
+      long last = first;
+      p = end;
+      if (*p == '-') {
+        last = strtol(p + 1, &end, 10);
+        if (end == p + 1)
+          break;
+        p = end;
+      }
+      for (long i = first; i <= last; i++)
+        values.push_back(static_cast<int>(i));
+      if (*p != ',')
+        break;
+      p++;
+    }
+  }
+
+  /// Read a one line file of /sys into values
+  bool coinReadList(const char * name, std::vector<int> & values)
+  {
+    FILE * fp = fopen(name, "r");
+    if (!fp)
+      return false;
+    char line[4096];
+    bool ok = fgets(line, sizeof(line), fp) != NULL;
+    fclose(fp);
+    if (ok)
+      coinParseList(line, values);
+    return ok;
+  }
+
+  /** Processors the process may run on, grouped by NUMA node.  Without
+      NUMA information all processors are put in one node.
+  */
+  void coinProcessorTopology(std::vector<std::vector<int> > & nodes)
+  {
+    nodes.clear();
+#if defined(__linux__) && defined(CPU_ISSET)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+      std::vector<int> online;
+      if (coinReadList("/sys/devices/system/node/online", online)) {
+        for (unsigned int k = 0; k < online.size(); k++) {
+          char name[80];
+          sprintf(name, "/sys/devices/system/node/node%d/cpulist", online[k]);
+          std::vector<int> cpus;
+          if (!coinReadList(name, cpus))
+            continue;
+          std::vector<int> usable;
+          for (unsigned int i = 0; i < cpus.size(); i++) {
+            if (cpus[i] < CPU_SETSIZE && CPU_ISSET(cpus[i], &allowed))
+              usable.push_back(cpus[i]);
+          }
+          if (usable.size())
+            nodes.push_back(usable);
+        }
+      }
+      if (!nodes.size()) {
+        std::vector<int> usable;
+        for (int i = 0; i < CPU_SETSIZE; i++) {
+          if (CPU_ISSET(i, &allowed))
+            usable.push_back(i);
+        }
+        if (usable.size())
+          nodes.push_back(usable);
+      }
+    }
+#endif
+  }
+#endif
+
+  /// Number of processors the process may use
+  int coinNumberProcessors()
+  {
+    int number = 1;
+#ifdef COINUTILS_PTHREADS
+    std::vector<std::vector<int> > nodes;
+    coinProcessorTopology(nodes);
+    if (nodes.size()) {
+      number = 0;
+      for (unsigned int i = 0; i < nodes.size(); i++)
+        number += static_cast<int>(nodes[i].size());
+    }
+#ifdef _SC_NPROCESSORS_ONLN
+    else {
+      number = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+    }
+#endif
+#endif
+    return CoinMax(number, 1);
+  }
+
+  CoinThreadPool * coinGlobalPool = NULL;
+#ifdef COINUTILS_PTHREADS
+  pthread_mutex_t coinGlobalPoolLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+}
+
+#ifdef COINUTILS_PTHREADS
+/// A worker thread and its deque
+struct CoinThreadWorker {
+  /// Pool data
+  CoinThreadPool::Implementation * pool;
+  /// Index in the pool
+  int index;
+  /// NUMA node
+  int node;
+  /// Processor the worker is pinned to, -1 if none
+  int cpu;
+  /// Thread
+  pthread_t thread;
+  /// Guards tasks
+  pthread_mutex_t lock;
+  /// Queued tasks, the owner works at the back and thieves at the front
+  std::deque<CoinTaskEntry> tasks;
+  /// Workers to steal from, same node first
+  std::vector<int> victims;
+};
+
+struct CoinThreadPool::Implementation {
+  /// All workers
+  std::vector<CoinThreadWorker *> workers;
+  /// Workers whose thread was created
+  int numberWorkers;
+  /// Number of NUMA nodes
+  int numberNodes;
+  /// Copy of CoinThreadPool::deterministic_
+  bool deterministic;
+  /// Guards everything below and the counters of the task groups
+  pthread_mutex_t lock;
+  /// Signaled when tasks are queued, threads released or the pool stops
+  pthread_cond_t wakeUp;
+  /// Signaled when a group finishes or tasks are queued while someone waits
+  pthread_cond_t changed;
+  /// Tasks in all deques
+  int queued;
+  /// Tasks in the deque of each worker
+  std::vector<int> queuedAt;
+  /// Workers handed out by reserveThreads()
+  int reserved;
+  /// Next worker for tasks spawned from outside threads
+  int nextWorker;
+  /// Threads blocked in wait()
+  int waiting;
+  /// Set when the workers have to exit
+  bool stop;
+};
+
+namespace {
+  pthread_key_t coinWorkerKey;
+  pthread_once_t coinWorkerKeyOnce = PTHREAD_ONCE_INIT;
+
+  void coinCreateWorkerKey()
+  {
+    pthread_key_create(&coinWorkerKey, NULL);
+  }
+
+  /// Worker running on this thread, NULL if the thread is not a worker
+  CoinThreadWorker * coinCurrentWorker()
+  {
+    pthread_once(&coinWorkerKeyOnce, coinCreateWorkerKey);
+    return static_cast<CoinThreadWorker *>(pthread_getspecific(coinWorkerKey));
+  }
+
+  /// Take a task out of the deque of worker, newest first if own is true
+  bool coinTakeTask(CoinThreadPool::Implementation * pool, int worker,
+                    bool own, CoinTaskEntry & entry)
+  {
+    CoinThreadWorker * victim = pool->workers[worker];
+    bool found = false;
+    pthread_mutex_lock(&victim->lock);
+    if (victim->tasks.size()) {
+      if (own) {
+        entry = victim->tasks.back();
+        victim->tasks.pop_back();
+      } else {
+        entry = victim->tasks.front();
+        victim->tasks.pop_front();
+      }
+      found = true;
+    }
+    pthread_mutex_unlock(&victim->lock);
+    if (found) {
+      pthread_mutex_lock(&pool->lock);
+      pool->queued--;
+      pool->queuedAt[worker]--;
+      pthread_mutex_unlock(&pool->lock);
+    }
+    return found;
+  }
+
+  /** Find a task for self (NULL for a thread which is not a worker): from
+      its own deque and, if steal is true, from the others.
+  */
+  bool coinFindTask(CoinThreadPool::Implementation * pool,
+                    CoinThreadWorker * self, bool steal, CoinTaskEntry & entry)
+  {
+    if (self && coinTakeTask(pool, self->index, true, entry))
+      return true;
+    if (!steal)
+      return false;
+    if (self) {
+      for (unsigned int i = 0; i < self->victims.size(); i++) {
+        if (coinTakeTask(pool, self->victims[i], false, entry))
+          return true;
+      }
+    } else {
+      for (int i = 0; i < pool->numberWorkers; i++) {
+        if (coinTakeTask(pool, i, false, entry))
+          return true;
+      }
+    }
+    return false;
+  }
+
+  /// Run a task and tell its group
+  void coinExecute(CoinThreadPool::Implementation * pool, CoinTaskEntry & entry)
+  {
+    entry.task->run();
+    pthread_mutex_lock(&pool->lock);
+    // The group may go away as soon as the lock is released
+    if (--*entry.pending == 0)
+      pthread_cond_broadcast(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+  }
+
+  extern "C" {
+    static void * coinWorkerMain(void * argument)
+    {
+      CoinThreadWorker * self = static_cast<CoinThreadWorker *>(argument);
+      CoinThreadPool::Implementation * pool = self->pool;
+      pthread_once(&coinWorkerKeyOnce, coinCreateWorkerKey);
+      pthread_setspecific(coinWorkerKey, self);
+#if defined(__linux__) && defined(CPU_SET)
+      if (self->cpu >= 0) {
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        CPU_SET(self->cpu, &mask);
+        pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+      }
+#endif
+      while (true) {
+        bool steal = false;
+        pthread_mutex_lock(&pool->lock);
+        while (true) {
+          bool parked = self->index >= pool->numberWorkers - pool->reserved;
+          steal = !pool->deterministic && !parked;
+          if (pool->queuedAt[self->index] > 0 || (steal && pool->queued > 0))
+            break;
+          if (pool->stop)
+            break;
+          pthread_cond_wait(&pool->wakeUp, &pool->lock);
+        }
+        // Own tasks are always finished before leaving
+        bool leave = pool->stop && pool->queuedAt[self->index] <= 0;
+        pthread_mutex_unlock(&pool->lock);
+        if (leave)
+          break;
+        CoinTaskEntry entry;
+        if (coinFindTask(pool, self, steal, entry))
+          coinExecute(pool, entry);
+      }
+      return NULL;
+    }
+  }
+}
+#else
+struct CoinThreadPool::Implementation {
+};
+#endif
+
+//#############################################################################
+
+CoinTaskGroup::CoinTaskGroup(CoinThreadPool * pool) :
+  pool_(pool ? pool : &CoinThreadPool::global()),
+  pending_(0),
+  numberSpawned_(0),
+  home_(-1)
+{
+#ifdef COINUTILS_PTHREADS
+  CoinThreadWorker * self = coinCurrentWorker();
+  if (self && self->pool == pool_->implementation_)
+    home_ = self->index;
+#endif
+}
+
+CoinTaskGroup::~CoinTaskGroup()
+{
+  wait();
+}
+
+void
+CoinTaskGroup::spawn(CoinTask * task)
+{
+  pool_->spawn(*this, task);
+}
+
+void
+CoinTaskGroup::wait()
+{
+  pool_->wait(*this);
+}
+
+//#############################################################################
+
+CoinThreadPool::CoinThreadPool(int numberThreads, Pinning pinning,
+                               bool deterministic) :
+  implementation_(NULL),
+  numberThreads_(1),
+  pinning_(pinning),
+  deterministic_(deterministic)
+{
+#ifdef COINUTILS_PTHREADS
+  if (numberThreads <= 1)
+    return;
+  Implementation * pool = new Implementation;
+  implementation_ = pool;
+  pool->numberWorkers = numberThreads - 1;
+  pool->deterministic = deterministic;
+  pool->queued = 0;
+  pool->queuedAt.resize(pool->numberWorkers, 0);
+  pool->reserved = 0;
+  pool->nextWorker = 0;
+  pool->waiting = 0;
+  pool->stop = false;
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->wakeUp, NULL);
+  pthread_cond_init(&pool->changed, NULL);
+
+  // Order processors for pinning; the calling thread is assumed to be on
+  // the first one, so workers start with the second.
+  std::vector<std::vector<int> > nodes;
+  coinProcessorTopology(nodes);
+  pool->numberNodes = CoinMax(static_cast<int>(nodes.size()), 1);
+  std::vector<int> cpus;
+  std::vector<int> cpuNode;
+  if (pinning == pinCompact) {
+    for (unsigned int k = 0; k < nodes.size(); k++) {
+      for (unsigned int i = 0; i < nodes[k].size(); i++) {
+        cpus.push_back(nodes[k][i]);
+        cpuNode.push_back(k);
+      }
+    }
+  } else if (pinning == pinScatter) {
+    unsigned int largest = 0;
+    for (unsigned int k = 0; k < nodes.size(); k++)
+      largest = CoinMax(largest, static_cast<unsigned int>(nodes[k].size()));
+    for (unsigned int i = 0; i < largest; i++) {
+      for (unsigned int k = 0; k < nodes.size(); k++) {
+        if (i < nodes[k].size()) {
+          cpus.push_back(nodes[k][i]);
+          cpuNode.push_back(k);
+        }
+      }
+    }
+  }
+
+  pool->workers.resize(pool->numberWorkers);
+  for (int i = 0; i < pool->numberWorkers; i++) {
+    CoinThreadWorker * worker = new CoinThreadWorker;
+    worker->pool = pool;
+    worker->index = i;
+    worker->node = 0;
+    worker->cpu = -1;
+    if (cpus.size()) {
+      int k = (i + 1) % static_cast<int>(cpus.size());
+      worker->cpu = cpus[k];
+      worker->node = cpuNode[k];
+    }
+    pthread_mutex_init(&worker->lock, NULL);
+    pool->workers[i] = worker;
+  }
+  // Steal from the same node first, in both cases starting after oneself
+  for (int i = 0; i < pool->numberWorkers; i++) {
+    CoinThreadWorker * worker = pool->workers[i];
+    for (int pass = 0; pass < 2; pass++) {
+      for (int j = 1; j < pool->numberWorkers; j++) {
+        int victim = (i + j) % pool->numberWorkers;
+        bool sameNode = pool->workers[victim]->node == worker->node;
+        if (sameNode == (pass == 0))
+          worker->victims.push_back(victim);
+      }
+    }
+  }
+  for (int i = 0; i < pool->numberWorkers; i++) {
+    if (pthread_create(&pool->workers[i]->thread, NULL, coinWorkerMain,
+                       pool->workers[i])) {
+      pthread_mutex_lock(&pool->lock);
+      pool->numberWorkers = i;
+      pthread_mutex_unlock(&pool->lock);
+      break;
+    }
+  }
+  numberThreads_ = pool->numberWorkers + 1;
+#endif
+}
+
+CoinThreadPool::~CoinThreadPool()
+{
+#ifdef COINUTILS_PTHREADS
+  Implementation * pool = implementation_;
+  if (!pool)
+    return;
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = true;
+  pthread_cond_broadcast(&pool->wakeUp);
+  pthread_mutex_unlock(&pool->lock);
+  for (int i = 0; i < pool->numberWorkers; i++)
+    pthread_join(pool->workers[i]->thread, NULL);
+  for (unsigned int i = 0; i < pool->workers.size(); i++) {
+    pthread_mutex_destroy(&pool->workers[i]->lock);
+    delete pool->workers[i];
+  }
+  pthread_cond_destroy(&pool->changed);
+  pthread_cond_destroy(&pool->wakeUp);
+  pthread_mutex_destroy(&pool->lock);
+  delete pool;
+#endif
+}
+
+//#############################################################################
+
+CoinThreadPool &
+CoinThreadPool::global()
+{
+#ifdef COINUTILS_PTHREADS
+  pthread_mutex_lock(&coinGlobalPoolLock);
+#endif
+  if (!coinGlobalPool) {
+    int numberThreads = 1;
+    Pinning pinning = pinNone;
+    bool deterministic = false;
+    const char * value = getenv("COIN_THREADS");
+    if (value) {
+      numberThreads = atoi(value);
+      // 0 means one thread per processor
+      if (numberThreads <= 0)
+        numberThreads = coinNumberProcessors();
+    }
+    value = getenv("COIN_THREAD_PINNING");
+    if (value && !strcmp(value, "compact"))
+      pinning = pinCompact;
+    else if (value && !strcmp(value, "scatter"))
+      pinning = pinScatter;
+    value = getenv("COIN_THREAD_DETERMINISTIC");
+    if (value && atoi(value))
+      deterministic = true;
+    // Never deleted: static destructors of other objects may still use it
+    coinGlobalPool = new CoinThreadPool(numberThreads, pinning, deterministic);
+  }
+#ifdef COINUTILS_PTHREADS
+  pthread_mutex_unlock(&coinGlobalPoolLock);
+#endif
+  return *coinGlobalPool;
+}
+
+bool
+CoinThreadPool::configureGlobal(int numberThreads, Pinning pinning,
+                                bool deterministic)
+{
+  bool done = false;
+#ifdef COINUTILS_PTHREADS
+  pthread_mutex_lock(&coinGlobalPoolLock);
+#endif
+  if (!coinGlobalPool) {
+    if (numberThreads <= 0)
+      numberThreads = coinNumberProcessors();
+    coinGlobalPool = new CoinThreadPool(numberThreads, pinning, deterministic);
+    done = true;
+  }
+#ifdef COINUTILS_PTHREADS
+  pthread_mutex_unlock(&coinGlobalPoolLock);
+#endif
+  return done;
+}
+
+bool
+CoinThreadPool::threaded()
+{
+#ifdef COINUTILS_PTHREADS
+  return true;
+#else
+  return false;
+#endif
+}
+
+//#############################################################################
+
+void
+CoinThreadPool::spawn(CoinTaskGroup & group, CoinTask * task)
+{
+#ifdef COINUTILS_PTHREADS
+  Implementation * pool = implementation_;
+  if (pool) {
+    CoinThreadWorker * self = coinCurrentWorker();
+    if (self && self->pool != pool)
+      self = NULL;
+    pthread_mutex_lock(&pool->lock);
+    int active = pool->numberWorkers - pool->reserved;
+    int target = -1;
+    if (active > 0) {
+      if (deterministic_) {
+        int base = group.home_ >= 0 ? group.home_ : 0;
+        target = (base + 1 + group.numberSpawned_) % active;
+      } else if (self) {
+        target = self->index;
+      } else {
+        target = pool->nextWorker % active;
+        pool->nextWorker = (pool->nextWorker + 1) % active;
+      }
+      group.numberSpawned_++;
+      group.pending_++;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    if (target >= 0) {
+      CoinTaskEntry entry;
+      entry.task = task;
+      entry.pending = &group.pending_;
+      CoinThreadWorker * worker = pool->workers[target];
+      pthread_mutex_lock(&worker->lock);
+      worker->tasks.push_back(entry);
+      pthread_mutex_unlock(&worker->lock);
+      pthread_mutex_lock(&pool->lock);
+      pool->queued++;
+      pool->queuedAt[target]++;
+      pthread_cond_broadcast(&pool->wakeUp);
+      if (pool->waiting)
+        pthread_cond_broadcast(&pool->changed);
+      pthread_mutex_unlock(&pool->lock);
+      return;
+    }
+  }
+#endif
+  group.numberSpawned_++;
+  task->run();
+}
+
+void
+CoinThreadPool::wait(CoinTaskGroup & group)
+{
+#ifdef COINUTILS_PTHREADS
+  Implementation * pool = implementation_;
+  if (!pool)
+    return;
+  CoinThreadWorker * self = coinCurrentWorker();
+  if (self && self->pool != pool)
+    self = NULL;
+  pthread_mutex_lock(&pool->lock);
+  while (group.pending_ > 0) {
+    bool own = self && pool->queuedAt[self->index] > 0;
+    bool parked = self && self->index >= pool->numberWorkers - pool->reserved;
+    bool steal = !deterministic_ && !parked;
+    if (own || (steal && pool->queued > 0)) {
+      pthread_mutex_unlock(&pool->lock);
+      CoinTaskEntry entry;
+      if (coinFindTask(pool, self, steal, entry))
+        coinExecute(pool, entry);
+      pthread_mutex_lock(&pool->lock);
+    } else {
+      pool->waiting++;
+      pthread_cond_wait(&pool->changed, &pool->lock);
+      pool->waiting--;
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+#endif
+}
+
+int
+CoinThreadPool::numberChunks(int first, int last, int grain)
+{
+  if (last <= first)
+    return 0;
+  grain = CoinMax(grain, 1);
+  return (last - first + grain - 1) / grain;
+}
+
+void
+CoinThreadPool::parallelFor(int first, int last, int grain, CoinRangeTask & body)
+{
+  grain = CoinMax(grain, 1);
+  int number = numberChunks(first, last, grain);
+  if (number <= 1 || availableThreads() <= 1) {
+    for (int k = 0; k < number; k++)
+      body.run(first + k * grain, CoinMin(first + (k + 1) * grain, last), k);
+    return;
+  }
+  std::vector<CoinChunkTask> chunks(number);
+  CoinTaskGroup group(this);
+  for (int k = 0; k < number; k++) {
+    chunks[k] = CoinChunkTask(&body, first + k * grain,
+                              CoinMin(first + (k + 1) * grain, last), k);
+    group.spawn(&chunks[k]);
+  }
+  group.wait();
+}
+
+//#############################################################################
+
+int
+CoinThreadPool::numberThreads() const
+{
+  return numberThreads_;
+}
+
+int
+CoinThreadPool::availableThreads() const
+{
+  int available = numberThreads_;
+#ifdef COINUTILS_PTHREADS
+  Implementation * pool = implementation_;
+  if (pool) {
+    pthread_mutex_lock(&pool->lock);
+    available = pool->numberWorkers - pool->reserved + 1;
+    pthread_mutex_unlock(&pool->lock);
+  }
+#endif
+  return available;
+}
+
+int
+CoinThreadPool::reserveThreads(int wanted)
+{
+  int granted = 0;
+#ifdef COINUTILS_PTHREADS
+  Implementation * pool = implementation_;
+  if (pool && wanted > 0) {
+    pthread_mutex_lock(&pool->lock);
+    granted = CoinMin(wanted, pool->numberWorkers - pool->reserved);
+    pool->reserved += granted;
+    pthread_mutex_unlock(&pool->lock);
+  }
+#endif
+  return granted;
+}
+
+void
+CoinThreadPool::releaseThreads(int number)
+{
+#ifdef COINUTILS_PTHREADS
+  Implementation * pool = implementation_;
+  if (pool && number > 0) {
+    pthread_mutex_lock(&pool->lock);
+    pool->reserved = CoinMax(pool->reserved - number, 0);
+    pthread_cond_broadcast(&pool->wakeUp);
+    pthread_mutex_unlock(&pool->lock);
+  }
+#endif
+}
+
+bool
+CoinThreadPool::deterministic() const
+{
+  return deterministic_;
+}
+
+CoinThreadPool::Pinning
+CoinThreadPool::pinning() const
+{
+  return pinning_;
+}
+
+int
+CoinThreadPool::numberNumaNodes() const
+{
+#ifdef COINUTILS_PTHREADS
+  if (implementation_)
+    return implementation_->numberNodes;
+#endif
+  return 1;
+}
+
+int
+CoinThreadPool::numaNode(int worker) const
+{
+#ifdef COINUTILS_PTHREADS
+  Implementation * pool = implementation_;
+  if (pool && worker >= 0 && worker < pool->numberWorkers)
+    return pool->workers[worker]->node;
+#endif
+  return 0;
+}
+
+int
+CoinThreadPool::currentWorker()
+{
+#ifdef COINUTILS_PTHREADS
+  CoinThreadWorker * self = coinCurrentWorker();
+  if (self)
+    return self->index;
+#endif
+  return -1;
+}
@@ -0,0 +1,230 @@
+/* $Id$ */
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifndef CoinThreadPool_H
+#define CoinThreadPool_H
+
+#include <cstddef>
+
+/** \file CoinThreadPool.hpp
+    A task scheduler shared by all the COIN-OR projects running in a process.
+
+    There is one global pool per process (CoinThreadPool::global()).  Code that
+    wants to run things in parallel spawns CoinTask objects into a
+    CoinTaskGroup or calls CoinThreadPool::parallelFor().  A thread waiting for
+    a group runs queued tasks itself, so that parallel sections nested inside
+    tasks (Bonmin calling Cbc calling Clp) never use more threads than the pool
+    has.  Code that needs threads of its own for a long time (the Cbc tree
+    threads) reserves them from the pool with reserveThreads(), which parks
+    the same number of pool workers until releaseThreads() is called.
+
+    The pool only has worker threads if CoinUtils was configured with
+    --enable-coinutils-threads.  Otherwise all tasks run on the calling thread
+    in the order they are spawned.
+
+    The global pool is created on first use.  Its size is taken from the
+    environment variable COIN_THREADS (default 1, i.e.\ no workers), worker
+    pinning from COIN_THREAD_PINNING (none, compact or scatter) and the
+    deterministic mode from COIN_THREAD_DETERMINISTIC (0 or 1).  A program can
+    also call CoinThreadPool::configureGlobal() before anything uses the pool.
+*/
+
+class CoinThreadPool;
+
+/** A piece of work run by a CoinThreadPool.
+    The task object is owned by the caller and has to stay alive until the
+    group it was spawned into has been waited for.
+*/
+class CoinTask {
+public:
+  virtual ~CoinTask() {}
+  /// Do the work
+  virtual void run() = 0;
+};
+
+/** Body of CoinThreadPool::parallelFor().
+    run() is called once for each chunk of the range.
+*/
+class CoinRangeTask {
+public:
+  virtual ~CoinRangeTask() {}
+  /** Process the indices first to last-1 which form chunk number chunk.
+      Chunk boundaries only depend on the range and the grain size, so the
+      chunk number can index partial results that are combined in order
+      afterwards to get results independent of the number of threads.
+  */
+  virtual void run(int first, int last, int chunk) = 0;
+};
+
+/** A set of tasks that is waited for together.
+    Groups are cheap and meant to be created on the stack around a parallel
+    section, e.g.
+    \code
+    CoinTaskGroup group;
+    group.spawn(&left);
+    right.run();
+    group.wait();
+    \endcode
+    The destructor waits for tasks still pending.
+*/
+class CoinTaskGroup {
+public:
+  /// Group on pool (the global pool if NULL)
+  CoinTaskGroup(CoinThreadPool * pool = NULL);
+  /// Destructor, waits for pending tasks
+  ~CoinTaskGroup();
+  /** Queue task.  If the pool has no available worker the task is run
+      before spawn() returns.
+  */
+  void spawn(CoinTask * task);
+  /// Returns when all the tasks spawned so far have finished
+  void wait();
+  /// The pool the tasks go to
+  inline CoinThreadPool * pool() const
+  { return pool_;}
+
+private:
+  /// Not implemented
+  CoinTaskGroup(const CoinTaskGroup &);
+  /// Not implemented
+  CoinTaskGroup & operator=(const CoinTaskGroup &);
+  friend class CoinThreadPool;
+
+  /// Pool
+  CoinThreadPool * pool_;
+  /// Tasks spawned and not finished (guarded by the pool)
+  int pending_;
+  /// Number of tasks spawned (used for deterministic placement)
+  int numberSpawned_;
+  /// Worker that created the group, -1 if not a worker of pool_
+  int home_;
+};
+
+/** A pool of worker threads with work stealing.
+
+    Each worker has its own deque of tasks.  A worker takes the newest task of
+    its own deque first and, when that is empty, steals the oldest task of
+    another worker, looking at workers on its own NUMA node before the others.
+
+    Workers may be pinned to processors.  With compact pinning consecutive
+    workers fill one NUMA node before the next, with scatter pinning they are
+    spread round robin over the nodes.
+
+    In deterministic mode there is no stealing: the k-th task spawned in a
+    group always goes to the same worker, and a thread waiting for a group only
+    runs tasks of its own deque.  Together with parallelFor()'s fixed chunks
+    this makes runs reproducible, at the price of some idle time when tasks are
+    unbalanced.
+*/
+class CoinThreadPool {
+public:
+  /// How workers are bound to processors
+  enum Pinning {
+    /// Let the operating system decide
+    pinNone = 0,
+    /// Fill NUMA nodes one after the other
+    pinCompact,
+    /// Round robin over NUMA nodes
+    pinScatter
+  };
+
+  /**@name Global pool */
+  //@{
+  /// The pool of the process, created on first call
+  static CoinThreadPool & global();
+  /** Set up the global pool.  Returns false (and does nothing) if the global
+      pool already exists.
+  */
+  static bool configureGlobal(int numberThreads, Pinning pinning = pinNone,
+                              bool deterministic = false);
+  /// True if CoinUtils was built with thread support
+  static bool threaded();
+  //@}
+
+  /**@name Constructors and destructor */
+  //@{
+  /** Pool computing with numberThreads threads, i.e.\ the calling thread
+      and numberThreads-1 workers.
+  */
+  CoinThreadPool(int numberThreads, Pinning pinning = pinNone,
+                 bool deterministic = false);
+  /// Destructor, finishes queued tasks and joins the workers
+  ~CoinThreadPool();
+  //@}
+
+  /**@name Parallel sections */
+  //@{
+  /** Call body.run() on the chunks [first+k*grain, first+(k+1)*grain) of
+      [first,last) and wait for all of them.
+  */
+  void parallelFor(int first, int last, int grain, CoinRangeTask & body);
+  /// Number of chunks parallelFor() uses for the range
+  static int numberChunks(int first, int last, int grain);
+  //@}
+
+  /**@name Thread budget */
+  //@{
+  /// Number of threads of the pool (workers plus the calling thread)
+  int numberThreads() const;
+  /// Number of threads not reserved
+  int availableThreads() const;
+  /** Take up to wanted threads out of the pool for threads the caller
+      creates itself.  Returns the number actually reserved, the same number
+      of workers stop taking new tasks until releaseThreads().
+  */
+  int reserveThreads(int wanted);
+  /// Give back threads obtained with reserveThreads()
+  void releaseThreads(int number);
+  //@}
+
+  /**@name Placement */
+  //@{
+  /// True in deterministic mode
+  bool deterministic() const;
+  /// Pinning of the workers
+  Pinning pinning() const;
+  /// Number of NUMA nodes seen (1 if unknown)
+  int numberNumaNodes() const;
+  /// NUMA node of a worker (0 if not pinned)
+  int numaNode(int worker) const;
+  /// Index of the calling thread among the workers of its pool, -1 if not a worker
+  static int currentWorker();
+  //@}
+
+  /// Implementation (not part of the interface)
+  struct Implementation;
+
+private:
+  /// Not implemented
+  CoinThreadPool(const CoinThreadPool &);
+  /// Not implemented
+  CoinThreadPool & operator=(const CoinThreadPool &);
+  friend class CoinTaskGroup;
+
+  /// Queue task for group
+  void spawn(CoinTaskGroup & group, CoinTask * task);
+  /// Wait for group, running tasks meanwhile
+  void wait(CoinTaskGroup & group);
+
+  /// Workers, queues and synchronization
+  Implementation * implementation_;
+  /// Threads of the pool
+  int numberThreads_;
+  /// Pinning
+  Pinning pinning_;
+  /// Deterministic mode
+  bool deterministic_;
+};
+
+//#############################################################################
+/** A function that tests the methods in the CoinThreadPool class. The
+    only reason for it not to be a member method is that this way it doesn't
+    have to be compiled into the library. And that's a gain, because the
+    library should be compiled with optimization on, but this method should be
+    compiled with debugging. */
+void
+CoinThreadPoolUnitTest();
+
+#endif
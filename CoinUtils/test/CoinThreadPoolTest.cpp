@@ -0,0 +1,230 @@
+// Copyright (C) 2012, International Business Machines
+// Corporation and others.  All Rights Reserved.
+// This code is licensed under the terms of the Eclipse Public License (EPL).
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <cassert>
+#include <vector>
+#include "CoinThreadPool.hpp"
+
+namespace {
+  // Sums a range recursively, spawning the left half
+  class SumTask : public CoinTask {
+  public:
+    SumTask(CoinThreadPool * pool, const std::vector<double> * values,
+            int first, int last) :
+      pool_(pool), values_(values), first_(first), last_(last), sum_(0.0) {}
+    virtual void run()
+    {
+      if (last_ - first_ <= 64) {
+        sum_ = 0.0;
+        for (int i = first_; i < last_; i++)
+          sum_ += (*values_)[i];
+        return;
+      }
+      int middle = (first_ + last_) / 2;
+      SumTask left(pool_, values_, first_, middle);
+      SumTask right(pool_, values_, middle, last_);
+      CoinTaskGroup group(pool_);
+      group.spawn(&left);
+      right.run();
+      group.wait();
+      sum_ = left.sum_ + right.sum_;
+    }
+    double sum() const
+    { return sum_;}
+  private:
+    CoinThreadPool * pool_;
+    const std::vector<double> * values_;
+    int first_;
+    int last_;
+    double sum_;
+  };
+
+  // Partial sums per chunk
+  class ChunkSum : public CoinRangeTask {
+  public:
+    ChunkSum(const std::vector<double> & values, int numberChunks) :
+      values_(values), partial_(numberChunks, -1.0), calls_(numberChunks, 0) {}
+    virtual void run(int first, int last, int chunk)
+    {
+      double sum = 0.0;
+      for (int i = first; i < last; i++)
+        sum += values_[i];
+      partial_[chunk] = sum;
+      calls_[chunk]++;
+    }
+    const std::vector<double> & values_;
+    std::vector<double> partial_;
+    std::vector<int> calls_;
+  };
+
+  // Records the worker it runs on and, if asked, spawns two children
+  class WhereTask : public CoinTask {
+  public:
+    WhereTask() : pool_(NULL), children_(false), worker_(-2) {}
+    virtual void run()
+    {
+      worker_ = CoinThreadPool::currentWorker();
+      if (!children_)
+        return;
+      CoinTaskGroup group(pool_);
+      for (int k = 0; k < 2; k++)
+        group.spawn(&child_[k]);
+      group.wait();
+    }
+    CoinThreadPool * pool_;
+    bool children_;
+    int worker_;
+    WhereTask * child_;
+  };
+
+  /* In deterministic mode, the k-th task of a group goes to worker
+     (home + 1 + k) modulo the number of active workers, where home is the
+     worker that created the group (0 for other threads). */
+  void
+  testPlacement(CoinThreadPool & pool)
+  {
+    const int numberTasks = 7;
+    int active = pool.numberThreads() - 1;
+    if (!CoinThreadPool::threaded())
+      active = 0;
+    std::vector<int> first;
+    for (int pass = 0; pass < 3; pass++) {
+      std::vector<WhereTask> children(2 * numberTasks);
+      std::vector<WhereTask> tasks(numberTasks);
+      CoinTaskGroup group(&pool);
+      for (int k = 0; k < numberTasks; k++) {
+        tasks[k].pool_ = &pool;
+        tasks[k].children_ = true;
+        tasks[k].child_ = &children[2 * k];
+        group.spawn(&tasks[k]);
+      }
+      group.wait();
+      std::vector<int> placement;
+      for (int k = 0; k < numberTasks; k++) {
+        int worker = tasks[k].worker_;
+        if (active > 0)
+          assert(worker == (1 + k) % active);
+        else
+          assert(worker == -1);
+        placement.push_back(worker);
+        for (int j = 0; j < 2; j++) {
+          int childWorker = children[2 * k + j].worker_;
+          if (active > 0)
+            assert(childWorker == (worker + 1 + j) % active);
+          else
+            assert(childWorker == -1);
+          placement.push_back(childWorker);
+        }
+      }
+      if (pass == 0)
+        first = placement;
+      assert(placement == first);
+    }
+  }
+
+  void
+  testPool(CoinThreadPool & pool)
+  {
+    const int n = 100000;
+    std::vector<double> values(n);
+    double serial = 0.0;
+    for (int i = 0; i < n; i++) {
+      values[i] = 1.0 / (1.0 + i);
+      serial += values[i];
+    }
+
+    // nested task groups
+    {
+      SumTask task(&pool, &values, 0, n);
+      task.run();
+      assert(task.sum() > serial - 1.0e-9 && task.sum() < serial + 1.0e-9);
+    }
+
+    // parallelFor chunks do not depend on the threads, and combining the
+    // partial sums in order always gives the same bits
+    {
+      const int grain = 1000;
+      int numberChunks = CoinThreadPool::numberChunks(0, n - 7, grain);
+      assert(numberChunks == (n - 7 + grain - 1) / grain);
+      double first = 0.0;
+      for (int pass = 0; pass < 3; pass++) {
+        ChunkSum body(values, numberChunks);
+        pool.parallelFor(0, n - 7, grain, body);
+        double sum = 0.0;
+        for (int k = 0; k < numberChunks; k++) {
+          assert(body.calls_[k] == 1);
+          sum += body.partial_[k];
+        }
+        if (pass == 0)
+          first = sum;
+        assert(sum == first);
+      }
+      CoinThreadPool serialPool(1);
+      ChunkSum body(values, numberChunks);
+      serialPool.parallelFor(0, n - 7, grain, body);
+      double sum = 0.0;
+      for (int k = 0; k < numberChunks; k++)
+        sum += body.partial_[k];
+      assert(sum == first);
+    }
+
+    // empty range
+    {
+      ChunkSum body(values, 1);
+      pool.parallelFor(5, 5, 10, body);
+      assert(body.calls_[0] == 0);
+    }
+
+    // reservations
+    {
+      int available = pool.availableThreads();
+      assert(available == pool.numberThreads());
+      int reserved = pool.reserveThreads(1000);
+      assert(reserved == pool.numberThreads() - 1);
+      assert(pool.availableThreads() == 1);
+      // still works, on the calling thread
+      SumTask task(&pool, &values, 0, n);
+      task.run();
+      assert(task.sum() > serial - 1.0e-9 && task.sum() < serial + 1.0e-9);
+      pool.releaseThreads(reserved);
+      assert(pool.availableThreads() == available);
+    }
+  }
+}
+
+void
+CoinThreadPoolUnitTest()
+{
+  assert(CoinThreadPool::currentWorker() == -1);
+  {
+    CoinThreadPool pool(1);
+    assert(pool.numberThreads() == 1);
+    assert(pool.numberNumaNodes() == 1);
+    testPool(pool);
+  }
+  {
+    CoinThreadPool pool(4);
+    if (CoinThreadPool::threaded())
+      assert(pool.numberThreads() == 4);
+    else
+      assert(pool.numberThreads() == 1);
+    testPool(pool);
+  }
+  {
+    CoinThreadPool pool(3, CoinThreadPool::pinScatter, true);
+    assert(pool.deterministic());
+    testPool(pool);
+    testPlacement(pool);
+  }
+  {
+    CoinThreadPool pool(4, CoinThreadPool::pinCompact);
+    for (int i = 0; i < pool.numberThreads() - 1; i++)
+      assert(pool.numaNode(i) >= 0 && pool.numaNode(i) < pool.numberNumaNodes());
+    testPool(pool);
+  }
+}
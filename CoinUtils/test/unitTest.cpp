@@ -24,6 +24,7 @@
 #include "CoinMpsIO.hpp"
 #include "CoinLpIO.hpp"
 #include "CoinMessageHandler.hpp"
+#include "CoinThreadPool.hpp"
 void CoinModelUnitTest(const std::string & mpsDir,
                        const std::string & netlibDir, const std::string & testModel);
 // Function Prototypes. Function definitions is in this file.
@@ -208,6 +209,9 @@ int main (int argc, const char *argv[])
   if (!CoinMessageHandlerUnitTest())
   { allOK = false ; }
 
+  testingMessage( "Testing CoinThreadPool\n" );
+  CoinThreadPoolUnitTest();
+
   if (allOK)
   { testingMessage( "All tests completed successfully.\n" );
     return (0) ; }
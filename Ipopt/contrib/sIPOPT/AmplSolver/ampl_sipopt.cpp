@@ -25,6 +25,8 @@ int main(int argv, char**argc)
 
   // Register sIPOPT options
   RegisterOptions_sIPOPT(app_ipopt->RegOptions());
+  // Register the options of the AMPL interface
+  AmplTNLP::RegisterOptions(app_ipopt->RegOptions());
   app_ipopt->Options()->SetRegisteredOptions(app_ipopt->RegOptions());
 
   // Call Initialize the first time to create a journalist, but ignore
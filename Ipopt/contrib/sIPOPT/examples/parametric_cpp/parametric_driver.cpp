@@ -11,6 +11,7 @@
 #include "IpPDSearchDirCalc.hpp"
 #include "IpIpoptAlg.hpp"
 #include "SensRegOp.hpp"
+#include "IpDenseVector.hpp"
 
 int main(int argv, char**argc)
 {
@@ -55,6 +56,31 @@ int main(int argv, char**argc)
   printf("#-------------------------------------------\n");
   app_sens->Run();
 
+  printf("\n");
+  printf("#-------------------------------------------\n");
+  printf("# Batch of sensitivity steps\n");
+  printf("#-------------------------------------------\n");
+  // Perturbations of (eta_1, eta_2), one column per scenario. The
+  // first column is the perturbation used by Run above.
+  const Index n_params = 2;
+  const Index n_scenarios = 4;
+  const Number delta_p[n_params*n_scenarios] = {-0.5, 0.0,
+						-0.25, 0.0,
+						0.0, 0.1,
+						0.25, -0.1};
+  std::vector<SmartPtr<IteratesVector> > batch_sol;
+  if (app_sens->RunBatch(n_params, n_scenarios, delta_p, batch_sol) == SOLVE_SUCCESS) {
+    for (Index j=0; j<n_scenarios; ++j) {
+      const DenseVector* x = dynamic_cast<const DenseVector*>(GetRawPtr(batch_sol[j]->x()));
+      const Number* x_val = x->Values();
+      printf("scenario %d:", j);
+      for (Index k=0; k<x->Dim(); ++k) {
+	printf(" % .8f", x_val[k]);
+      }
+      printf("\n");
+    }
+  }
+
   printf("\n");
   printf("#-------------------------------------------\n");
   printf("# Sensitivity with bound checking\n");
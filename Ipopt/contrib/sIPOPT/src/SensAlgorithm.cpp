@@ -105,4 +105,35 @@ namespace Ipopt
     return retval;
   }
 
+  SensAlgorithmExitStatus SensAlgorithm::RunBatch(const DenseGenMatrix& delta_u,
+						  std::vector<SmartPtr<IteratesVector> >& sol)
+  {
+    DBG_START_METH("SensAlgorithm::RunBatch", dbg_verbosity);
+
+    const Index n_par = (Index)measurement_->GetInitialEqConstraints().size();
+    if (delta_u.NRows()!=n_par) {
+      Jnlst().Printf(J_ERROR, J_MAIN, "sIPOPT: The perturbations have %d rows, but there are %d parameters.\n",
+		     delta_u.NRows(), n_par);
+      return FATAL_ERROR;
+    }
+    if (sens_step_calc_->Do_Boundcheck()) {
+      Jnlst().Printf(J_WARNING, J_MAIN, "sIPOPT: The bound check is not applied to batches of perturbations.\n");
+    }
+
+    if (!sens_step_calc_->MultiStep(delta_u, sol)) {
+      Jnlst().Printf(J_ERROR, J_MAIN, "sIPOPT: The backsolve for the batch of perturbations failed.\n");
+      return FATAL_ERROR;
+    }
+
+    // unscale solutions...
+    SmartPtr<const Vector> unscaled_x;
+    for (size_t j=0; j<sol.size(); ++j) {
+      unscaled_x = IpNLP().NLP_scaling()->unapply_vector_scaling_x(sol[j]->x());
+      DBG_ASSERT(IsValid(unscaled_x));
+      sol[j]->Set_x(*unscaled_x);
+    }
+
+    return SOLVE_SUCCESS;
+  }
+
 }
@@ -38,6 +38,16 @@ namespace Ipopt
      *  timeframe. */
     SensAlgorithmExitStatus Run();
 
+    /** Computes the sensitivity steps for a batch of perturbations.
+     *  Column j of delta_u holds the perturbation of the parameters
+     *  (in the order of the initial value constraints) for scenario
+     *  j.  All steps are computed with one multi-RHS backsolve, and
+     *  sol[j] receives the new primal-dual estimate of scenario j
+     *  (with x unscaled, as for Run).  The bound check is not
+     *  applied to batches. */
+    SensAlgorithmExitStatus RunBatch(const DenseGenMatrix& delta_u,
+				     std::vector<SmartPtr<IteratesVector> >& sol);
+
   private:
 
     std::vector< SmartPtr<SchurDriver> > driver_vec_;
@@ -13,6 +13,8 @@
 // Ipopt includes
 #include "IpPDSearchDirCalc.hpp"
 #include "IpIpoptAlg.hpp"
+#include "IpDenseGenMatrix.hpp"
+#include "IpBlas.hpp"
 
 namespace Ipopt
 {
@@ -131,6 +133,13 @@ namespace Ipopt
 			       "yes", "Take residuals into account",
 			       "no", "Don't take residuals into account",
 			       "The residuals of the KKT conditions should be zero at the optimal solution. However, in practice, especially for large problems and depending on the termination criteria, they may deviate from this theoretical state. If this option is set to yes, the residuals will be taken into account when computing the right hand side for the sensitivity step.");
+    roptions->AddLowerBoundedIntegerOption(
+					   "sens_num_threads",
+					   "Number of threads for the dense products of batched sensitivity steps",
+					   0, 1,
+					   "When the sensitivity steps for a batch of perturbations are computed from the sensitivity matrix, "
+					   "the products with the perturbations are distributed over this many threads. "
+					   "The value 0 means the OpenMP default. Without OpenMP support, this option has no effect.");
   }
 
   SensAlgorithmExitStatus SensApplication::Run()
@@ -228,6 +237,7 @@ namespace Ipopt
       case LOCAL_INFEASIBILITY:
       case USER_REQUESTED_STOP:
       case FEASIBLE_POINT_FOUND:
+      case OBJECTIVE_CUTOFF_REACHED:
       case DIVERGING_ITERATES:
       case RESTORATION_FAILURE:
       case ERROR_IN_STEP_COMPUTATION:
@@ -275,6 +285,50 @@ namespace Ipopt
     return retval;
   }
 
+  SensAlgorithmExitStatus SensApplication::RunBatch(Index n_params, Index n_scenarios,
+						    const Number* delta_p,
+						    std::vector<SmartPtr<IteratesVector> >& sol)
+  {
+    DBG_START_METH("SensApplication::RunBatch", dbg_verbosity);
+
+    sol.clear();
+    bool sens_internal_abort;
+    Options()->GetBoolValue("sens_internal_abort", sens_internal_abort, "");
+    if (sens_internal_abort) {
+      jnlst_->Printf(J_WARNING, J_MAIN, "\n\t--------------= Warning =--------------\nInternal abort has been called for the sensitivity calculations.\n");
+      return FATAL_ERROR;
+    }
+
+    Number max_pdpert;
+    Options()->GetNumericValue("sens_max_pdpert", max_pdpert, "");
+    Number pdpert_x, pdpert_s, pdpert_c, pdpert_d;
+    ip_data_->getPDPert(pdpert_x, pdpert_s, pdpert_c, pdpert_d);
+    if (Max(pdpert_x, pdpert_s, pdpert_c, pdpert_d)>max_pdpert) {
+      jnlst_->Printf(J_WARNING, J_MAIN, "\n\t--------------= Warning =--------------\nInertia correction of primal dual system is too large for meaningful sIPOPT results.\n"
+		     "\t... aborting computation.\n"
+		     "Set option sens_max_pdpert to a higher value (current: %f) to run sIPOPT algorithm anyway\n", max_pdpert);
+      return FATAL_ERROR;
+    }
+
+    SmartPtr<SensBuilder> schur_builder = new SensBuilder();
+    const std::string prefix = ""; // I should be getting this somewhere else...
+    SmartPtr<SensAlgorithm> controller = schur_builder->BuildSensAlg(*jnlst_,
+								     *options_,
+								     prefix,
+								     *ip_nlp_,
+								     *ip_data_,
+								     *ip_cq_,
+								     *pd_solver_);
+
+    SmartPtr<DenseGenMatrixSpace> delta_u_space = new DenseGenMatrixSpace(n_params, n_scenarios);
+    SmartPtr<DenseGenMatrix> delta_u = delta_u_space->MakeNewDenseGenMatrix();
+    if (n_params>0 && n_scenarios>0) {
+      IpBlasDcopy(n_params*n_scenarios, delta_p, 1, delta_u->Values(), 1);
+    }
+
+    return controller->RunBatch(*delta_u, sol);
+  }
+
   void SensApplication::Initialize()
   {
     DBG_START_METH("SensApplication::Initialize", dbg_verbosity);
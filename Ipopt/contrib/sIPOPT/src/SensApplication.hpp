@@ -33,6 +33,18 @@ namespace Ipopt
 
     SensAlgorithmExitStatus Run();
 
+    /** Computes the sensitivity steps for n_scenarios perturbations of
+     *  the n_params parameters at once.  delta_p holds the
+     *  perturbations column by column (n_params values per scenario,
+     *  in the order of the parameter indices of sens_init_constr).  On
+     *  return, sol[j] is the new primal-dual estimate for scenario j.
+     *  This can be called several times after
+     *  SetIpoptAlgorithmObjects; it does not call
+     *  finalize_solution. */
+    SensAlgorithmExitStatus RunBatch(Index n_params, Index n_scenarios,
+				     const Number* delta_p,
+				     std::vector<SmartPtr<IteratesVector> >& sol);
+
     void Initialize();
 
     void SetIpoptAlgorithmObjects(SmartPtr<IpoptApplication> app_ipopt,
@@ -10,6 +10,7 @@
 
 #include "IpAlgStrategy.hpp"
 #include "IpIteratesVector.hpp"
+#include <vector>
 
 namespace Ipopt
 {
@@ -30,6 +31,19 @@ namespace Ipopt
 
     virtual bool Solve(SmartPtr<IteratesVector> delta_lhs, SmartPtr<const IteratesVector> delta_rhs)=0;
 
+    /** Solves for several right hand sides at once. The default
+     *  implementation calls Solve for one after the other. */
+    virtual bool MultiSolve(std::vector<SmartPtr<IteratesVector> >& delta_lhsV,
+			    std::vector<SmartPtr<const IteratesVector> >& delta_rhsV)
+    {
+      DBG_ASSERT(delta_lhsV.size()==delta_rhsV.size());
+      bool retval = true;
+      for (size_t i=0; i<delta_rhsV.size() && retval; ++i) {
+	retval = Solve(delta_lhsV[i], delta_rhsV[i]);
+      }
+      return retval;
+    }
+
   };
 
 }
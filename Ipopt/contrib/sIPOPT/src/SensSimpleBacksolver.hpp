@@ -29,6 +29,10 @@ namespace Ipopt {
 
     bool Solve(SmartPtr<IteratesVector> delta_lhs, SmartPtr<const IteratesVector> delta_rhs);
 
+    /** Passes all right hand sides to the PDSystemSolver at once */
+    bool MultiSolve(std::vector<SmartPtr<IteratesVector> >& delta_lhsV,
+		    std::vector<SmartPtr<const IteratesVector> >& delta_rhsV);
+
 
   private:
 
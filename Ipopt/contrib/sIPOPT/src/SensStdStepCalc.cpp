@@ -11,6 +11,9 @@
 #include "IpBlas.hpp"
 #include "SensIndexSchurData.hpp"
 
+#ifdef _OPENMP
+# include <omp.h>
+#endif
 
 namespace Ipopt
 {
@@ -24,7 +27,8 @@ namespace Ipopt
     ift_data_(ift_data),
     backsolver_(backsolver),
     bound_eps_(1e-3),
-    kkt_residuals_(true)
+    kkt_residuals_(true),
+    num_threads_(1)
   {
     DBG_START_METH("StdStepCalculator::StdStepCalculator", dbg_verbosity);
   }
@@ -39,6 +43,7 @@ namespace Ipopt
   {
     options.GetNumericValue("sens_bound_eps", bound_eps_, prefix);
     options.GetBoolValue("sens_kkt_residuals", kkt_residuals_, prefix);
+    options.GetIntegerValue("sens_num_threads", num_threads_, prefix);
     SensitivityStepCalculator::InitializeImpl(options,
 					      prefix);
     return true;
@@ -140,6 +145,171 @@ namespace Ipopt
     return retval;
   }
 
+  /** Copies the values of an IteratesVector with DenseVector
+   *  components into one array */
+  static void CopyIteratesToArray(const IteratesVector& v, Number* values)
+  {
+    for (Index i=0; i<v.NComps(); ++i) {
+      const DenseVector* dv = static_cast<const DenseVector*>(GetRawPtr(v.GetComp(i)));
+      const Index dim = dv->Dim();
+      if (dim==0) {
+	continue;
+      }
+      if (dv->IsHomogeneous()) {
+	Number scalar = dv->Scalar();
+	IpBlasDcopy(dim, &scalar, 0, values, 1);
+      }
+      else {
+	IpBlasDcopy(dim, dv->Values(), 1, values, 1);
+      }
+      values += dim;
+    }
+  }
+
+  bool StdStepCalculator::MultiStep(const DenseGenMatrix& delta_u,
+				    std::vector<SmartPtr<IteratesVector> >& sol)
+  {
+    DBG_START_METH("StdStepCalculator::MultiStep", dbg_verbosity);
+
+    const Index n_par = delta_u.NRows();
+    const Index n_scen = delta_u.NCols();
+    DBG_ASSERT(n_par==ift_data_->GetNRowsAdded());
+    sol.resize(n_scen);
+    if (n_scen==0) {
+      return true;
+    }
+
+    SmartPtr<const IteratesVector> trial = IpData().trial();
+    SmartPtr<IteratesVector> r_s;
+    if (kkt_residuals_) {
+      r_s = trial->MakeNewIteratesVector();
+      r_s->Set_x_NonConst(*IpCq().curr_grad_lag_x()->MakeNewCopy());
+      r_s->Set_s_NonConst(*IpCq().curr_grad_lag_s()->MakeNewCopy());
+      r_s->Set_y_c_NonConst(*IpCq().curr_c()->MakeNewCopy());
+      r_s->Set_y_d_NonConst(*IpCq().curr_d_minus_s()->MakeNewCopy());
+      r_s->Set_z_L_NonConst(*IpCq().curr_compl_x_L()->MakeNewCopy());
+      r_s->Set_z_U_NonConst(*IpCq().curr_compl_x_U()->MakeNewCopy());
+      r_s->Set_v_L_NonConst(*IpCq().curr_compl_s_L()->MakeNewCopy());
+      r_s->Set_v_U_NonConst(*IpCq().curr_compl_s_U()->MakeNewCopy());
+      r_s->Print(Jnlst(),J_VECTOR,J_USER1,"r_s init");
+    }
+
+    SmartPtr<DenseVectorSpace> du_space = new DenseVectorSpace(n_par);
+    std::vector<SmartPtr<const IteratesVector> > rhsV;
+    std::vector<SmartPtr<IteratesVector> > lhsV;
+    bool retval;
+
+    if (n_scen<=n_par+1) {
+      // One right hand side A^T*delta_u_j - r_s per scenario
+      for (Index j=0; j<n_scen; ++j) {
+	SmartPtr<DenseVector> du = new DenseVector(GetRawPtr(du_space));
+	du->SetValues(delta_u.Values()+j*n_par);
+	SmartPtr<IteratesVector> rhs = trial->MakeNewIteratesVector();
+	ift_data_->TransMultiply(*du, *rhs);
+	if (IsValid(r_s)) {
+	  rhs->Axpy(-1.0, *r_s);
+	}
+	rhsV.push_back(ConstPtr(rhs));
+	sol[j] = trial->MakeNewIteratesVector();
+      }
+      retval = backsolver_->MultiSolve(sol, rhsV);
+      for (Index j=0; j<n_scen; ++j) {
+	sol[j]->Axpy(1.0, *trial);
+      }
+      return retval;
+    }
+
+    // Sensitivity matrix P = K^(-1)*A^T, one column per parameter,
+    // and the step for the KKT residual as last right hand side
+    for (Index k=0; k<n_par; ++k) {
+      SmartPtr<DenseVector> e_k = new DenseVector(GetRawPtr(du_space));
+      e_k->Set(0.);
+      e_k->Values()[k] = 1.;
+      SmartPtr<IteratesVector> rhs = trial->MakeNewIteratesVector();
+      ift_data_->TransMultiply(*e_k, *rhs);
+      rhsV.push_back(ConstPtr(rhs));
+      lhsV.push_back(trial->MakeNewIteratesVector());
+    }
+    if (IsValid(r_s)) {
+      r_s->Scal(-1.0);
+      rhsV.push_back(ConstPtr(r_s));
+      lhsV.push_back(trial->MakeNewIteratesVector());
+    }
+    retval = backsolver_->MultiSolve(lhsV, rhsV);
+
+    // Dense copies of P and of the base point trial - K^(-1)*r_s
+    const Index n_kkt = trial->Dim();
+    std::vector<Number> P(n_kkt*Max(n_par, 1));
+    for (Index k=0; k<n_par; ++k) {
+      CopyIteratesToArray(*lhsV[k], &P[k*n_kkt]);
+    }
+    SmartPtr<IteratesVector> base = trial->MakeNewIteratesVectorCopy();
+    if (IsValid(r_s)) {
+      base->Axpy(1.0, *lhsV[n_par]);
+    }
+    std::vector<Number> base_vals(n_kkt);
+    CopyIteratesToArray(*base, &base_vals[0]);
+    lhsV.clear();
+
+    // Value arrays of the results; these are obtained here, because
+    // creating the vectors and requesting their values is not thread
+    // safe
+    const Index n_comps = trial->NComps();
+    std::vector<Index> comp_dims(n_comps);
+    for (Index c=0; c<n_comps; ++c) {
+      comp_dims[c] = trial->GetComp(c)->Dim();
+    }
+    std::vector<Number*> sol_vals(n_scen*n_comps);
+    for (Index j=0; j<n_scen; ++j) {
+      sol[j] = trial->MakeNewIteratesVector();
+      for (Index c=0; c<n_comps; ++c) {
+	SmartPtr<DenseVector> dv = static_cast<DenseVector*>(GetRawPtr(sol[j]->GetCompNonConst(c)));
+	sol_vals[j*n_comps+c] = dv->Values();
+      }
+    }
+
+    // sol_j = base + P*delta_u_j, computed for blocks of scenarios
+    const Index block = 32;
+    const Index n_blocks = (n_scen+block-1)/block;
+    const Number* du_vals = delta_u.Values();
+    Index n_threads = 1;
+#ifdef _OPENMP
+    n_threads = num_threads_>0 ? num_threads_ : omp_get_max_threads();
+    n_threads = Min(n_threads, n_blocks);
+#endif
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(n_threads) if(n_threads > 1)
+#endif
+    {
+      std::vector<Number> buf(n_kkt*block);
+#ifdef _OPENMP
+      #pragma omp for schedule(static)
+#endif
+      for (Index b=0; b<n_blocks; ++b) {
+	const Index j0 = b*block;
+	const Index nb = Min(block, n_scen-j0);
+	for (Index j=0; j<nb; ++j) {
+	  IpBlasDcopy(n_kkt, &base_vals[0], 1, &buf[j*n_kkt], 1);
+	}
+	if (n_par>0 && n_kkt>0) {
+	  IpBlasDgemm(false, false, n_kkt, nb, n_par, 1., &P[0], n_kkt,
+		      du_vals+j0*n_par, n_par, 1., &buf[0], n_kkt);
+	}
+	for (Index j=0; j<nb; ++j) {
+	  const Number* col = &buf[j*n_kkt];
+	  for (Index c=0; c<n_comps; ++c) {
+	    if (comp_dims[c]>0) {
+	      IpBlasDcopy(comp_dims[c], col, 1, sol_vals[(j0+j)*n_comps+c], 1);
+	    }
+	    col += comp_dims[c];
+	  }
+	}
+      }
+    }
+
+    return retval;
+  }
+
   bool StdStepCalculator::BoundCheck(IteratesVector& sol,
 				     std::vector<Index>& x_bound_violations_idx,
 				     std::vector<Number>& x_bound_violations_du)
@@ -30,6 +30,15 @@ namespace Ipopt
      *  a step using its SchurDriver, checks bounds, and returns it */
     virtual bool Step(DenseVector& delta_u, IteratesVector& sol);
 
+    /** Computes the steps for all columns of delta_u with one
+     *  multi-RHS backsolve.  If there are more scenarios than
+     *  parameters, the backsolve is done for the parameters (giving
+     *  the sensitivity matrix), and the steps are obtained from dense
+     *  matrix products; otherwise, there is one right hand side per
+     *  scenario.  The bound check is not done here. */
+    virtual bool MultiStep(const DenseGenMatrix& delta_u,
+			   std::vector<SmartPtr<IteratesVector> >& sol);
+
     bool BoundCheck(IteratesVector& sol,
 		    std::vector<Index>& x_bound_violations_idx,
 		    std::vector<Number>& x_bound_violations_du);
@@ -39,6 +48,8 @@ namespace Ipopt
     SmartPtr<SensBacksolver> backsolver_;
     Number bound_eps_;
     bool kkt_residuals_;
+    /** Number of threads for the dense products in MultiStep */
+    Index num_threads_;
   };
 }
 
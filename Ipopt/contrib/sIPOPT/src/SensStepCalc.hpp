@@ -9,13 +9,14 @@
 
 #include "IpAlgStrategy.hpp"
 #include "SensSchurDriver.hpp"
+#include "IpDenseVector.hpp"
+#include "IpDenseGenMatrix.hpp"
+#include "IpIteratesVector.hpp"
+#include <vector>
 
 
 namespace Ipopt
 {
-  /** Forward declarations */
-  class DenseVector;
-  class IteratesVector;
 
   class SensitivityStepCalculator : public AlgorithmStrategyObject
   {
@@ -65,6 +66,28 @@ namespace Ipopt
      *  a step using its SchurDriver, checks bounds, and returns it */
     virtual bool Step(DenseVector& delta_u, IteratesVector& sol) =0;
 
+    /** Computes the steps for several perturbations. Column j of
+     *  delta_u holds the perturbation of the parameters for scenario j,
+     *  and sol[j] receives the corresponding new primal-dual
+     *  estimate. The default implementation calls Step for one column
+     *  after the other. */
+    virtual bool MultiStep(const DenseGenMatrix& delta_u,
+			   std::vector<SmartPtr<IteratesVector> >& sol)
+    {
+      const Index n_par = delta_u.NRows();
+      const Index n_scen = delta_u.NCols();
+      SmartPtr<DenseVectorSpace> du_space = new DenseVectorSpace(n_par);
+      sol.resize(n_scen);
+      bool retval = true;
+      for (Index j=0; j<n_scen && retval; ++j) {
+	SmartPtr<DenseVector> du = new DenseVector(GetRawPtr(du_space));
+	du->SetValues(delta_u.Values()+j*n_par);
+	sol[j] = IpData().trial()->MakeNewIteratesVector();
+	retval = Step(*du, *sol[j]);
+      }
+      return retval;
+    }
+
 
   private:
     SmartPtr<SchurDriver> driver_;
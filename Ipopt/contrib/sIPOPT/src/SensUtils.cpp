@@ -67,6 +67,9 @@ namespace Ipopt
     case Feasible_Point_Found:
       retval = FEASIBLE_POINT_FOUND;
       break;
+    case Objective_Cutoff_Reached:
+      retval = OBJECTIVE_CUTOFF_REACHED;
+      break;
     case Maximum_Iterations_Exceeded:
       retval = MAXITER_EXCEEDED;
       break;
@@ -41,7 +41,7 @@
 #include "IpMa57TSolverInterface.hpp"
 #include "IpMc19TSymScalingMethod.hpp"
 #include "IpInexactTSymScalingMethod.hpp"
-#include "IpIterativePardisoSolverInterface.hpp"
+#include "IpIterativeLdlSolverInterface.hpp"
 #include "IpInexactNormalTerminationTester.hpp"
 #include "IpInexactPDTerminationTester.hpp"
 
@@ -49,6 +49,9 @@
 # include "CoinHslConfig.h"
 #endif
 
+#ifdef HAVE_PARDISO
+# include "IpIterativePardisoSolverInterface.hpp"
+#endif
 #ifdef HAVE_WSMP
 # include "IpWsmpSolverInterface.hpp"
 #endif
@@ -176,27 +179,21 @@ namespace Ipopt
       NormalTester = new InexactNormalTerminationTester();
       SmartPtr<IterativeSolverTerminationTester> pd_tester =
         new InexactPDTerminationTester();
-#ifndef HAVE_PARDISO
-# ifdef HAVE_LINEARSOLVERLOADER
+      // The iterative version of Pardiso needs a callback function
+      // that is not available through the linear solver loader
+#ifdef HAVE_PARDISO
       SolverInterface = new IterativePardisoSolverInterface(*NormalTester, *pd_tester);
-      char buf[256];
-      int rc = LSL_loadPardisoLib(NULL, buf, 255);
-      if (rc) {
-        std::string errmsg;
-        errmsg = "Selected linear solver Pardiso not available.\nTried to obtain Pardiso from shared library \"";
-        errmsg += LSL_PardisoLibraryName();
-        errmsg += "\", but the following error occured:\n";
-        errmsg += buf;
-        THROW_EXCEPTION(OPTION_INVALID, errmsg.c_str());
-      }
-# else
-      THROW_EXCEPTION(OPTION_INVALID, "Support for Pardiso has not been compiled into Ipopt.");
-# endif
 #else
-      SolverInterface = new IterativePardisoSolverInterface(*NormalTester, *pd_tester);
+      THROW_EXCEPTION(OPTION_INVALID, "Support for Pardiso has not been compiled into Ipopt.  The built-in iterative solver is chosen with linear_solver=ldl.");
 #endif
 
     }
+    else if (linear_solver=="ldl") {
+      NormalTester = new InexactNormalTerminationTester();
+      SmartPtr<IterativeSolverTerminationTester> pd_tester =
+        new InexactPDTerminationTester();
+      SolverInterface = new IterativeLdlSolverInterface(*NormalTester, *pd_tester);
+    }
     else if (linear_solver=="wsmp") {
 #ifdef HAVE_WSMP
       SolverInterface = new WsmpSolverInterface();
@@ -312,7 +309,11 @@ namespace Ipopt
     // TODO: Find out about the following:
     //options_list.SetNumericValueIfUnset("bound_relax_factor", 0.);
     options_list.SetNumericValueIfUnset("kappa_d", 0.);
+#ifdef HAVE_PARDISO
     options_list.SetStringValueIfUnset("linear_solver", "pardiso");
+#else
+    options_list.SetStringValueIfUnset("linear_solver", "ldl");
+#endif
     options_list.SetStringValue("linear_scaling_on_demand", "no");
     options_list.SetStringValue("replace_bounds", "yes");
   }
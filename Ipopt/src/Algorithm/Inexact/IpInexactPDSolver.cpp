@@ -75,7 +75,7 @@ namespace Ipopt
 
     std::string linear_solver;
     options.GetStringValue("linear_solver", linear_solver, prefix);
-    is_pardiso_ = (linear_solver=="pardiso");
+    is_iterative_ = (linear_solver=="pardiso" || linear_solver=="ldl");
 
     if (!augSysSolver_->Initialize(Jnlst(), IpNLP(), IpData(), IpCq(),
                                    options, prefix)) {
@@ -249,7 +249,7 @@ namespace Ipopt
         InexData().set_tangential_x(tangential_x);
         InexData().set_tangential_s(tangential_s);
 
-        if (!is_pardiso_) {
+        if (!is_iterative_) {
           // check if we need to modify the system
           bool modify_hessian = HessianRequiresChange();
           if (modify_hessian) {
@@ -130,9 +130,10 @@ namespace Ipopt
     Index inexact_regularization_ls_count_trigger_;
     //@}
 
-    /** flag indicating if we are dealing with the Pardiso solver
-     *  (temporary) */
-    bool is_pardiso_;
+    /** flag indicating if we are dealing with an iterative solver
+     *  that runs the termination tests (Pardiso or the built-in
+     *  one) */
+    bool is_iterative_;
 
     Index last_info_ls_count_;
   };
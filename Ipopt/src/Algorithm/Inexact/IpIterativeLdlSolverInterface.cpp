@@ -0,0 +1,771 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#include "IpoptConfig.h"
+#include "IpIterativeLdlSolverInterface.hpp"
+#include "IpLdlSolverInterface.hpp"
+#include "IpBlas.hpp"
+
+#include <algorithm>
+
+#ifdef HAVE_CMATH
+# include <cmath>
+#else
+# ifdef HAVE_MATH_H
+#  include <math.h>
+# else
+#  error "don't have header file for math"
+# endif
+#endif
+
+extern Ipopt::IterativeSolverTerminationTester::ETerminationTest test_result_;
+
+namespace Ipopt
+{
+#if COIN_IPOPT_VERBOSITY > 0
+  static const Index dbg_verbosity = 0;
+#endif
+
+  /** Number of sweeps of the symmetric equilibration */
+  static const Index n_scaling_sweeps = 3;
+
+  /** Compare candidate entries of L by decreasing magnitude */
+  static bool LargerMagnitude(const std::pair<double, Index>& a,
+                              const std::pair<double, Index>& b)
+  {
+    return a.first > b.first;
+  }
+
+  IterativeLdlSolverInterface::
+  IterativeLdlSolverInterface(IterativeSolverTerminationTester& normal_tester,
+                              IterativeSolverTerminationTester& pd_tester)
+      :
+      dim_(0),
+      nonzeros_(0),
+      negevals_(-1),
+      initialized_(false),
+      analyzed_(false),
+      factor_droptol_(-1.),
+      factor_max_fill_(-1.),
+      normal_tester_(&normal_tester),
+      pd_tester_(&pd_tester)
+  {
+    DBG_START_METH("IterativeLdlSolverInterface::IterativeLdlSolverInterface()",dbg_verbosity);
+  }
+
+  IterativeLdlSolverInterface::~IterativeLdlSolverInterface()
+  {
+    DBG_START_METH("IterativeLdlSolverInterface::~IterativeLdlSolverInterface()",
+                   dbg_verbosity);
+  }
+
+  void IterativeLdlSolverInterface::RegisterOptions(SmartPtr<RegisteredOptions> roptions)
+  {
+    roptions->AddLowerBoundedIntegerOption(
+      "ldl_iter_max_iter",
+      "Maximal number of iterations of the built-in iterative solver.",
+      1, 500,
+      "This is the maximal number of SQMR iterations for one solve of the "
+      "inexact algorithm with linear_solver=ldl.  If the termination tests "
+      "are not satisfied within this number of iterations, the dropping "
+      "tolerance of the preconditioner is decreased.  The value for the "
+      "normal step computation can be set with the prefix \"normal.\".");
+    roptions->AddBoundedNumberOption(
+      "ldl_iter_relative_tol",
+      "Relative residual tolerance of the built-in iterative solver.",
+      0.0, true, 1.0, true, 1e-6,
+      "The iterations are stopped if the norm of the residual has been "
+      "reduced by this factor, even if the termination tests of the inexact "
+      "algorithm are not satisfied.");
+    roptions->AddBoundedNumberOption(
+      "ldl_iter_dropping_factor",
+      "Dropping tolerance of the incomplete factorization preconditioner.",
+      0.0, false, 1.0, true, 1e-3,
+      "Entries of the incomplete factor L that are smaller than this value "
+      "times the norm of the column of the (equilibrated) matrix are "
+      "dropped.  A smaller value gives a better but more expensive "
+      "preconditioner.");
+    roptions->AddLowerBoundedNumberOption(
+      "ldl_iter_max_fill",
+      "Fill limit of the incomplete factorization preconditioner.",
+      0.0, true, 5.0,
+      "Each column of the incomplete factor L keeps at most this many times "
+      "as many entries as the corresponding row of the matrix (the largest "
+      "ones).");
+    roptions->AddBoundedNumberOption(
+      "ldl_iter_pivtol",
+      "Pivot tolerance of the incomplete factorization preconditioner.",
+      0.0, true, 1.0, true, 1e-6,
+      "Pivots of the (equilibrated) matrix that are smaller than this value "
+      "in absolute value are replaced by this value.");
+    roptions->AddLowerBoundedIntegerOption(
+      "ldl_iter_max_droptol_corrections",
+      "Maximal number of decreases of the dropping tolerance during one solve.",
+      0, 4,
+      "This is relevant only for the inexact algorithm with "
+      "linear_solver=ldl.");
+    roptions->AddBoundedNumberOption(
+      "ldl_iter_decr_factor",
+      "Factor for decreasing the dropping tolerance of the preconditioner.",
+      0.0, true, 1.0, true, 1./3.,
+      "If the iterative solver fails, the dropping tolerance is multiplied "
+      "by this factor.  After a successful solve it is divided by this "
+      "factor again, up to the value of ldl_iter_dropping_factor.");
+    roptions->AddStringOption2(
+      "ldl_iter_skip_inertia_check",
+      "Always pretend the inertia of the preconditioner is correct.",
+      "no",
+      "no", "check inertia",
+      "yes", "skip inertia check",
+      "The number of negative pivots of the incomplete factorization is only "
+      "an estimate of the number of negative eigenvalues of the matrix.");
+  }
+
+  bool IterativeLdlSolverInterface::InitializeImpl(const OptionsList& options,
+      const std::string& prefix)
+  {
+    options.GetBoolValue("ldl_iter_skip_inertia_check",
+                         skip_inertia_check_, prefix);
+    options.GetIntegerValue("ldl_iter_max_droptol_corrections",
+                            max_droptol_corrections_, prefix);
+    options.GetNumericValue("ldl_iter_pivtol", pivtol_, prefix);
+    options.GetNumericValue("ldl_iter_decr_factor", decr_factor_, prefix);
+
+    // PD system
+    options.GetIntegerValue("ldl_iter_max_iter", max_iter_, prefix);
+    options.GetNumericValue("ldl_iter_relative_tol",
+                            iter_relative_tol_, prefix);
+    options.GetNumericValue("ldl_iter_dropping_factor",
+                            iter_dropping_factor_, prefix);
+    options.GetNumericValue("ldl_iter_max_fill", iter_max_fill_, prefix);
+    // Normal system
+    options.GetIntegerValue("ldl_iter_max_iter", normal_max_iter_,
+                            prefix+"normal.");
+    options.GetNumericValue("ldl_iter_relative_tol",
+                            normal_iter_relative_tol_, prefix+"normal.");
+    options.GetNumericValue("ldl_iter_dropping_factor",
+                            normal_iter_dropping_factor_, prefix+"normal.");
+    options.GetNumericValue("ldl_iter_max_fill", normal_iter_max_fill_,
+                            prefix+"normal.");
+
+    // Reset all private data
+    dim_ = 0;
+    nonzeros_ = 0;
+    initialized_ = false;
+    analyzed_ = false;
+    a_.clear();
+    factor_droptol_ = -1.;
+    factor_max_fill_ = -1.;
+
+    iter_dropping_factor_used_ = iter_dropping_factor_;
+    normal_iter_dropping_factor_used_ = normal_iter_dropping_factor_;
+
+    // Without the algorithm objects (after ReducedInitialize, e.g. in
+    // the unit test), all systems are solved with the primal-dual
+    // tester
+    bool retval;
+    if (HaveIpData()) {
+      retval = normal_tester_->Initialize(Jnlst(), IpNLP(), IpData(),
+                                          IpCq(), options, prefix);
+      if (retval) {
+        retval = pd_tester_->Initialize(Jnlst(), IpNLP(), IpData(),
+                                        IpCq(), options, prefix);
+      }
+    }
+    else {
+      retval = pd_tester_->ReducedInitialize(Jnlst(), options, prefix);
+    }
+
+    return retval;
+  }
+
+  double* IterativeLdlSolverInterface::GetValuesArrayPtr()
+  {
+    DBG_ASSERT(initialized_);
+    return nonzeros_ > 0 ? &a_[0] : NULL;
+  }
+
+  ESymSolverStatus IterativeLdlSolverInterface::InitializeStructure
+  (Index dim, Index nonzeros,
+   const Index* ia,
+   const Index* ja)
+  {
+    DBG_START_METH("IterativeLdlSolverInterface::InitializeStructure",dbg_verbosity);
+    dim_ = dim;
+    nonzeros_ = nonzeros;
+
+    // Make space for storing the matrix elements
+    a_.assign(nonzeros_, 0.);
+    scaling_.assign(dim_, 1.);
+    d_.assign(dim_, 0.);
+    work_.assign(9*dim_, 0.);
+    factor_droptol_ = -1.;
+    factor_max_fill_ = -1.;
+
+    initialized_ = true;
+    analyzed_ = false;
+
+    return SYMSOLVER_SUCCESS;
+  }
+
+  ESymSolverStatus IterativeLdlSolverInterface::MultiSolve(bool new_matrix,
+      const Index* ia,
+      const Index* ja,
+      Index nrhs,
+      double* rhs_vals,
+      bool check_NegEVals,
+      Index numberOfNegEVals)
+  {
+    DBG_START_METH("IterativeLdlSolverInterface::MultiSolve",dbg_verbosity);
+    DBG_ASSERT(!check_NegEVals || ProvidesInertia());
+    DBG_ASSERT(initialized_);
+    DBG_ASSERT(nrhs==1);
+
+    IterativeSolverTerminationTester* tester;
+    bool is_normal = false;
+    if (HaveIpData() && IsNull(InexData().normal_x()) &&
+        InexData().compute_normal()) {
+      tester = GetRawPtr(normal_tester_);
+      is_normal = true;
+    }
+    else {
+      tester = GetRawPtr(pd_tester_);
+    }
+    Number& droptol_used = is_normal ? normal_iter_dropping_factor_used_ :
+                           iter_dropping_factor_used_;
+    const Number droptol_option = is_normal ? normal_iter_dropping_factor_ :
+                                  iter_dropping_factor_;
+    const Number max_fill = is_normal ? normal_iter_max_fill_ : iter_max_fill_;
+    const Index max_iter = is_normal ? normal_max_iter_ : max_iter_;
+    const Number relative_tol = is_normal ? normal_iter_relative_tol_ :
+                                iter_relative_tol_;
+    Number droptol = droptol_used;
+
+    // Compute the preconditioner if the matrix or the parameters changed
+    if (new_matrix || droptol != factor_droptol_ ||
+        max_fill != factor_max_fill_) {
+      if (!analyzed_) {
+        if (HaveIpData()) {
+          IpData().TimingStats().LinearSystemSymbolicFactorization().Start();
+        }
+        ComputeOrdering(ia, ja);
+        if (HaveIpData()) {
+          IpData().TimingStats().LinearSystemSymbolicFactorization().End();
+        }
+        analyzed_ = true;
+      }
+      if (HaveIpData()) {
+        IpData().TimingStats().LinearSystemFactorization().Start();
+      }
+      Index nmodified = Factorization(ia, ja, droptol, max_fill);
+      if (HaveIpData()) {
+        IpData().TimingStats().LinearSystemFactorization().End();
+      }
+      if (nmodified > 0) {
+        Jnlst().Printf(J_DETAILED, J_LINEAR_ALGEBRA,
+                       "Number of modified pivots in incomplete factorization = %d.\n", nmodified);
+        if (HaveIpData()) {
+          IpData().Append_info_string("Pp");
+        }
+      }
+
+      // Check whether the number of negative pivots matches the
+      // requested count.  Since the preconditioner is only an
+      // approximation, only too many negative pivots are reported.
+      negevals_ = Max(negevals_, numberOfNegEVals);
+      if (skip_inertia_check_) {
+        numberOfNegEVals = negevals_;
+      }
+      if (check_NegEVals && (numberOfNegEVals!=negevals_)) {
+        Jnlst().Printf(J_DETAILED, J_LINEAR_ALGEBRA,
+                       "Wrong inertia: required are %d, but we got %d.\n",
+                       numberOfNegEVals, negevals_);
+        return SYMSOLVER_WRONG_INERTIA;
+      }
+    }
+
+    if (HaveIpData()) {
+      IpData().TimingStats().LinearSystemBackSolve().Start();
+    }
+
+    std::vector<double> orig_rhs(rhs_vals, rhs_vals+dim_);
+    IterativeSolverTerminationTester::ETerminationTest test_result =
+      IterativeSolverTerminationTester::CONTINUE;
+    Index attempts = 0;
+    while (true) {
+      bool retval = tester->InitializeSolve();
+      ASSERT_EXCEPTION(retval, INTERNAL_ABORT, "tester->InitializeSolve(); returned false");
+
+      IpBlasDcopy(dim_, &orig_rhs[0], 1, rhs_vals, 1);
+      bool converged = Solve(ia, ja, rhs_vals, max_iter, relative_tol,
+                             *tester, test_result);
+      Index iterations_used = tester->GetSolverIterations();
+      tester->Clear();
+      Jnlst().Printf(J_DETAILED, J_LINEAR_ALGEBRA,
+                     "Number of iterations in built-in iterative solver for %s step = %d.\n",
+                     is_normal ? "normal" : "PD", iterations_used);
+      if (converged || attempts >= max_droptol_corrections_) {
+        break;
+      }
+
+      attempts++;
+      Jnlst().Printf(J_WARNING, J_LINEAR_ALGEBRA,
+                     "Built-in iterative solver did not converge (%s step).\n",
+                     is_normal ? "normal" : "PD");
+      Jnlst().Printf(J_WARNING, J_LINEAR_ALGEBRA,
+                     "  Decreasing drop tolerance from %e to %e.\n",
+                     droptol, droptol*decr_factor_);
+      droptol *= decr_factor_;
+      if (HaveIpData()) {
+        IpData().TimingStats().LinearSystemFactorization().Start();
+      }
+      Factorization(ia, ja, droptol, max_fill);
+      if (HaveIpData()) {
+        IpData().TimingStats().LinearSystemFactorization().End();
+      }
+    }
+
+    // Go back slowly to the original dropping tolerance
+    droptol_used = Min(droptol/decr_factor_, droptol_option);
+    if (droptol < droptol_option) {
+      Jnlst().Printf(J_DETAILED, J_LINEAR_ALGEBRA,
+                     "Increasing drop tolerance from %e to %e for next iteration.\n",
+                     droptol, droptol_used);
+    }
+
+    if (HaveIpData()) {
+      IpData().TimingStats().LinearSystemBackSolve().End();
+    }
+
+    test_result_ = test_result;
+    if (test_result == IterativeSolverTerminationTester::MODIFY_HESSIAN) {
+      Jnlst().Printf(J_DETAILED, J_LINEAR_ALGEBRA,
+                     "Termination tester requests modification of Hessian\n");
+      return SYMSOLVER_WRONG_INERTIA;
+    }
+    if (test_result == IterativeSolverTerminationTester::TEST_2_SATISFIED) {
+      // Termination Test 2 is satisfied, set the step for the primal
+      // iterates to zero
+      Index nvars = IpData().curr()->x()->Dim() + IpData().curr()->s()->Dim();
+      const Number zero = 0.;
+      IpBlasDcopy(nvars, &zero, 0, rhs_vals, 1);
+    }
+    return SYMSOLVER_SUCCESS;
+  }
+
+  void IterativeLdlSolverInterface::ComputeOrdering(const Index* ia,
+      const Index* ja)
+  {
+    DBG_START_METH("IterativeLdlSolverInterface::ComputeOrdering",dbg_verbosity);
+
+    const Index n = dim_;
+    const double* a = nonzeros_ > 0 ? &a_[0] : NULL;
+
+    // Adjacency structure of the graph of the matrix (the upper
+    // triangle may contain duplicate entries)
+    std::vector<Index> adj_ptr(n+1, 0);
+    std::vector<bool> zero_diag(n, true);
+    for (Index i=0; i<n; i++) {
+      for (Index p=ia[i]-1; p<ia[i+1]-1; p++) {
+        const Index j = ja[p]-1;
+        if (j != i) {
+          adj_ptr[i+1]++;
+          adj_ptr[j+1]++;
+        }
+        else if (a[p] != 0.) {
+          zero_diag[i] = false;
+        }
+      }
+    }
+    for (Index i=0; i<n; i++) {
+      adj_ptr[i+1] += adj_ptr[i];
+    }
+    std::vector<Index> adj(adj_ptr[n]);
+    std::vector<Index> pos(adj_ptr.begin(), adj_ptr.end()-1);
+    for (Index i=0; i<n; i++) {
+      for (Index p=ia[i]-1; p<ia[i+1]-1; p++) {
+        const Index j = ja[p]-1;
+        if (j != i) {
+          adj[pos[i]++] = j;
+          adj[pos[j]++] = i;
+        }
+      }
+    }
+    Index nnz = 0;
+    Index start = 0;
+    for (Index i=0; i<n; i++) {
+      std::sort(adj.begin()+start, adj.begin()+adj_ptr[i+1]);
+      const Index end = adj_ptr[i+1];
+      adj_ptr[i] = nnz;
+      for (Index k=start; k<end; k++) {
+        if (k == start || adj[k] != adj[k-1]) {
+          adj[nnz++] = adj[k];
+        }
+      }
+      start = end;
+    }
+    adj_ptr[n] = nnz;
+    adj.resize(nnz);
+
+    LdlSolverInterface::ComputeOrdering(n, adj_ptr, adj, zero_diag, perm_);
+    std::vector<Index> iperm(n);
+    for (Index k=0; k<n; k++) {
+      iperm[perm_[k]] = k;
+    }
+
+    // Lower triangle of the permuted matrix by columns, with the
+    // positions of the values in a_
+    pcol_ptr_.assign(n+1, 0);
+    for (Index i=0; i<n; i++) {
+      for (Index p=ia[i]-1; p<ia[i+1]-1; p++) {
+        pcol_ptr_[Min(iperm[i], iperm[ja[p]-1])+1]++;
+      }
+    }
+    for (Index k=0; k<n; k++) {
+      pcol_ptr_[k+1] += pcol_ptr_[k];
+    }
+    prow_.resize(pcol_ptr_[n]);
+    pval_.resize(pcol_ptr_[n]);
+    pos.assign(pcol_ptr_.begin(), pcol_ptr_.end()-1);
+    for (Index i=0; i<n; i++) {
+      for (Index p=ia[i]-1; p<ia[i+1]-1; p++) {
+        const Index pi = iperm[i];
+        const Index pj = iperm[ja[p]-1];
+        const Index col = Min(pi, pj);
+        prow_[pos[col]] = Max(pi, pj);
+        pval_[pos[col]++] = p;
+      }
+    }
+  }
+
+  Index IterativeLdlSolverInterface::Factorization(const Index* ia,
+      const Index* ja,
+      Number droptol,
+      Number max_fill)
+  {
+    DBG_START_METH("IterativeLdlSolverInterface::Factorization",dbg_verbosity);
+
+    const Index n = dim_;
+    const double* a = nonzeros_ > 0 ? &a_[0] : NULL;
+
+    // Symmetric equilibration: scale rows and columns repeatedly by
+    // the square roots of their largest entries.  Also count the
+    // entries of each row of the full matrix.
+    std::vector<double> rowmax(n);
+    std::vector<Index> rowcnt(n, 0);
+    scaling_.assign(n, 1.);
+    for (Index sweep=0; sweep<n_scaling_sweeps; sweep++) {
+      std::fill(rowmax.begin(), rowmax.end(), 0.);
+      for (Index i=0; i<n; i++) {
+        for (Index p=ia[i]-1; p<ia[i+1]-1; p++) {
+          const Index j = ja[p]-1;
+          const double v = fabs(a[p])*scaling_[i]*scaling_[j];
+          rowmax[i] = Max(rowmax[i], v);
+          rowmax[j] = Max(rowmax[j], v);
+          if (sweep == 0) {
+            rowcnt[i]++;
+            if (j != i) {
+              rowcnt[j]++;
+            }
+          }
+        }
+      }
+      for (Index i=0; i<n; i++) {
+        if (rowmax[i] > 0.) {
+          scaling_[i] /= sqrt(rowmax[i]);
+        }
+      }
+    }
+
+    // Crout form of the incomplete factorization: column k of L is
+    // computed from column k of the matrix and the columns j<k with
+    // L(k,j) != 0.  For each such column, cursor[j] points to its
+    // first entry in a row >= k, and the columns are kept in linked
+    // lists (head, next) by the row of that entry.
+    l_ptr_.assign(1, 0);
+    l_row_.clear();
+    l_val_.clear();
+    d_.resize(n);
+    std::vector<double> w(n, 0.);
+    std::vector<char> in_pattern(n, 0);
+    std::vector<Index> pattern;
+    std::vector<Index> head(n, -1);
+    std::vector<Index> next(n, -1);
+    std::vector<Index> cursor(n, 0);
+    std::vector<std::pair<double, Index> > cand;
+
+    Index nmodified = 0;
+    negevals_ = 0;
+    for (Index k=0; k<n; k++) {
+      // Scatter column k of the permuted lower triangle
+      pattern.clear();
+      w[k] = 0.;
+      in_pattern[k] = 1;
+      pattern.push_back(k);
+      double colnorm = 0.;
+      const double sk = scaling_[perm_[k]];
+      for (Index p=pcol_ptr_[k]; p<pcol_ptr_[k+1]; p++) {
+        const Index i = prow_[p];
+        const double v = a[pval_[p]]*sk*scaling_[perm_[i]];
+        if (!in_pattern[i]) {
+          in_pattern[i] = 1;
+          pattern.push_back(i);
+        }
+        w[i] += v;
+        colnorm = Max(colnorm, fabs(v));
+      }
+      const double akk = w[k];
+
+      // Subtract L(k:n,j) D(j) L(k,j) for all columns j in row k of L
+      Index j = head[k];
+      while (j >= 0) {
+        const Index next_j = next[j];
+        const Index p0 = cursor[j];
+        DBG_ASSERT(l_row_[p0] == k);
+        const double f = l_val_[p0]*d_[j];
+        for (Index p=p0; p<l_ptr_[j+1]; p++) {
+          const Index i = l_row_[p];
+          if (!in_pattern[i]) {
+            in_pattern[i] = 1;
+            pattern.push_back(i);
+          }
+          w[i] -= f*l_val_[p];
+        }
+        cursor[j]++;
+        if (cursor[j] < l_ptr_[j+1]) {
+          const Index r = l_row_[cursor[j]];
+          next[j] = head[r];
+          head[r] = j;
+        }
+        j = next_j;
+      }
+
+      // Pivot; too small pivots are replaced by the pivot tolerance.
+      // A zero diagonal (the constraint rows of a KKT system) gets a
+      // negative pivot.
+      double dk = w[k];
+      if (fabs(dk) < pivtol_) {
+        if (dk > 0. || (dk == 0. && akk > 0.)) {
+          dk = pivtol_;
+        }
+        else {
+          dk = -pivtol_;
+        }
+        nmodified++;
+      }
+      d_[k] = dk;
+      if (dk < 0.) {
+        negevals_++;
+      }
+
+      // Dropping and fill limit for the off-diagonal entries
+      cand.clear();
+      const double dropval = droptol*Max(colnorm, fabs(dk));
+      for (size_t q=0; q<pattern.size(); q++) {
+        const Index i = pattern[q];
+        if (i != k && fabs(w[i]) > dropval) {
+          cand.push_back(std::make_pair(fabs(w[i]), i));
+        }
+      }
+      const size_t max_entries =
+        (size_t)Max(1., max_fill*(double)Max(rowcnt[perm_[k]]-1, Index(1)));
+      if (cand.size() > max_entries) {
+        std::nth_element(cand.begin(), cand.begin()+max_entries, cand.end(),
+                         LargerMagnitude);
+        cand.resize(max_entries);
+      }
+      for (size_t q=0; q<cand.size(); q++) {
+        cand[q].first = (double)cand[q].second;
+      }
+      std::sort(cand.begin(), cand.end());
+      for (size_t q=0; q<cand.size(); q++) {
+        const Index i = cand[q].second;
+        l_row_.push_back(i);
+        l_val_.push_back(w[i]/dk);
+      }
+      l_ptr_.push_back((Index)l_row_.size());
+      if (!cand.empty()) {
+        cursor[k] = l_ptr_[k];
+        const Index r = l_row_[cursor[k]];
+        next[k] = head[r];
+        head[r] = k;
+      }
+
+      for (size_t q=0; q<pattern.size(); q++) {
+        w[pattern[q]] = 0.;
+        in_pattern[pattern[q]] = 0;
+      }
+    }
+
+    factor_droptol_ = droptol;
+    factor_max_fill_ = max_fill;
+
+    Jnlst().Printf(J_DETAILED, J_LINEAR_ALGEBRA,
+                   "Incomplete factorization with dropping tolerance %e: %d nonzeros in L, %d negative pivots.\n",
+                   droptol, l_ptr_[n], negevals_);
+
+    return nmodified;
+  }
+
+  void IterativeLdlSolverInterface::MultVector(const Index* ia,
+      const Index* ja,
+      const double* x,
+      double* y) const
+  {
+    const double* a = nonzeros_ > 0 ? &a_[0] : NULL;
+    for (Index i=0; i<dim_; i++) {
+      y[i] = 0.;
+    }
+    for (Index i=0; i<dim_; i++) {
+      double yi = 0.;
+      const double xi = x[i];
+      for (Index p=ia[i]-1; p<ia[i+1]-1; p++) {
+        const Index j = ja[p]-1;
+        yi += a[p]*x[j];
+        if (j != i) {
+          y[j] += a[p]*xi;
+        }
+      }
+      y[i] += yi;
+    }
+  }
+
+  void IterativeLdlSolverInterface::ApplyPreconditioner(double* x,
+      double* y) const
+  {
+    const Index n = dim_;
+    for (Index k=0; k<n; k++) {
+      y[k] = x[perm_[k]]*scaling_[perm_[k]];
+    }
+    for (Index k=0; k<n; k++) {
+      const double yk = y[k];
+      if (yk != 0.) {
+        for (Index p=l_ptr_[k]; p<l_ptr_[k+1]; p++) {
+          y[l_row_[p]] -= l_val_[p]*yk;
+        }
+      }
+    }
+    for (Index k=0; k<n; k++) {
+      y[k] /= d_[k];
+    }
+    for (Index k=n-1; k>=0; k--) {
+      double yk = y[k];
+      for (Index p=l_ptr_[k]; p<l_ptr_[k+1]; p++) {
+        yk -= l_val_[p]*y[l_row_[p]];
+      }
+      y[k] = yk;
+    }
+    for (Index k=0; k<n; k++) {
+      x[perm_[k]] = y[k]*scaling_[perm_[k]];
+    }
+  }
+
+  bool IterativeLdlSolverInterface::Solve(const Index* ia,
+                                          const Index* ja,
+                                          double* rhs_vals,
+                                          Index max_iter,
+                                          Number relative_tol,
+                                          IterativeSolverTerminationTester& tester,
+                                          IterativeSolverTerminationTester::ETerminationTest& test_result)
+  {
+    DBG_START_METH("IterativeLdlSolverInterface::Solve",dbg_verbosity);
+
+    // SQMR without look-ahead (Freund and Nachtigal) with the
+    // preconditioner M, starting from x = 0.  r is the residual of
+    // the underlying BiCG iterates; the residual of the QMR iterate x
+    // is updated with s = A*d.
+    const Index n = dim_;
+    test_result = IterativeSolverTerminationTester::CONTINUE;
+    double* x = &work_[0];
+    double* resid = &work_[n];
+    double* r = &work_[2*n];
+    double* q = &work_[3*n];
+    double* t = &work_[4*n];
+    double* d = &work_[5*n];
+    double* s = &work_[6*n];
+    double* u = &work_[7*n];
+    double* y = &work_[8*n];
+
+    const Number norm2_rhs = IpBlasDnrm2(n, rhs_vals, 1);
+    if (norm2_rhs == 0.) {
+      return true;
+    }
+
+    const Number zero = 0.;
+    IpBlasDcopy(n, &zero, 0, x, 1);
+    IpBlasDcopy(n, &zero, 0, d, 1);
+    IpBlasDcopy(n, &zero, 0, s, 1);
+    IpBlasDcopy(n, rhs_vals, 1, resid, 1);
+    IpBlasDcopy(n, rhs_vals, 1, r, 1);
+    IpBlasDcopy(n, r, 1, q, 1);
+    ApplyPreconditioner(q, y);
+    Number tau = norm2_rhs;
+    Number theta = 0.;
+    Number rho = IpBlasDdot(n, r, 1, q, 1);
+
+    bool converged = false;
+    for (Index iter=1; iter<=max_iter; iter++) {
+      MultVector(ia, ja, q, t);
+      const Number sigma = IpBlasDdot(n, q, 1, t, 1);
+      if (sigma == 0. || rho == 0.) {
+        Jnlst().Printf(J_DETAILED, J_LINEAR_ALGEBRA,
+                       "Breakdown of SQMR in iteration %d.\n", iter);
+        break;
+      }
+      const Number alpha = rho/sigma;
+      IpBlasDaxpy(n, -alpha, t, 1, r, 1);
+
+      const Number theta_old = theta;
+      theta = IpBlasDnrm2(n, r, 1)/tau;
+      const Number c2 = 1./(1.+theta*theta);
+      tau *= theta*sqrt(c2);
+      const Number fd = c2*theta_old*theta_old;
+      const Number fq = c2*alpha;
+      for (Index i=0; i<n; i++) {
+        d[i] = fd*d[i] + fq*q[i];
+        s[i] = fd*s[i] + fq*t[i];
+        x[i] += d[i];
+        resid[i] -= s[i];
+      }
+
+      test_result = tester.TestTermination(n, x, resid, iter, norm2_rhs);
+      Jnlst().Printf(J_MOREDETAILED, J_LINEAR_ALGEBRA,
+                     "Termination Tester Result = %d.\n", test_result);
+      if (test_result != IterativeSolverTerminationTester::CONTINUE ||
+          IpBlasDnrm2(n, resid, 1) <= relative_tol*norm2_rhs) {
+        converged = true;
+        break;
+      }
+
+      IpBlasDcopy(n, r, 1, u, 1);
+      ApplyPreconditioner(u, y);
+      const Number rho_new = IpBlasDdot(n, r, 1, u, 1);
+      const Number beta = rho_new/rho;
+      rho = rho_new;
+      for (Index i=0; i<n; i++) {
+        q[i] = u[i] + beta*q[i];
+      }
+    }
+
+    IpBlasDcopy(n, x, 1, rhs_vals, 1);
+    return converged;
+  }
+
+  Index IterativeLdlSolverInterface::NumberOfNegEVals() const
+  {
+    DBG_START_METH("IterativeLdlSolverInterface::NumberOfNegEVals",dbg_verbosity);
+    DBG_ASSERT(negevals_>=0);
+    return negevals_;
+  }
+
+  bool IterativeLdlSolverInterface::IncreaseQuality()
+  {
+    // The quality of the solution is controlled by the termination
+    // tests; the preconditioner is improved when SQMR does not converge.
+    return false;
+  }
+
+} // namespace Ipopt
@@ -0,0 +1,284 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifndef __IPITERATIVELDLSOLVERINTERFACE_HPP__
+#define __IPITERATIVELDLSOLVERINTERFACE_HPP__
+
+#include "IpSparseSymLinearSolverInterface.hpp"
+#include "IpInexactCq.hpp"
+#include "IpIterativeSolverTerminationTester.hpp"
+
+#include <vector>
+
+namespace Ipopt
+{
+
+  /** Built-in iterative solver for the inexact algorithm, derived
+   *  from SparseSymLinearSolverInterface.  This is the counterpart of
+   *  IterativePardisoSolverInterface that does not need an external
+   *  package; it is chosen with linear_solver=ldl.
+   *
+   *  The system is solved with the symmetric QMR method (SQMR) of
+   *  Freund and Nachtigal, which works with an indefinite symmetric
+   *  preconditioner.  The preconditioner is an incomplete L D L^T
+   *  factorization with 1x1 pivots of the symmetrically equilibrated
+   *  matrix, computed column by column (Crout form).  The unknowns
+   *  are ordered with the approximate minimum degree ordering of
+   *  LdlSolverInterface, which eliminates each constraint row of the
+   *  KKT system only after one of its variables.  Entries of L below
+   *  a dropping tolerance are discarded and the number of entries per
+   *  column is limited; pivots that are too small are replaced by the
+   *  pivot tolerance, with the sign of the pivot (or negative for a
+   *  zero diagonal).  The number of negative pivots is reported as
+   *  the inertia estimate.
+   *
+   *  After each SQMR iteration the iterate and its residual are given
+   *  to the termination tester of the inexact algorithm.  If the
+   *  method does not converge, the dropping tolerance is decreased
+   *  and the preconditioner is recomputed.
+   */
+  class IterativeLdlSolverInterface: public SparseSymLinearSolverInterface
+  {
+  public:
+    /** @name Constructor/Destructor */
+    //@{
+    /** Constructor */
+    IterativeLdlSolverInterface(IterativeSolverTerminationTester& normal_tester,
+                                IterativeSolverTerminationTester& pd_tester);
+
+    /** Destructor */
+    virtual ~IterativeLdlSolverInterface();
+    //@}
+
+    /** overloaded from AlgorithmStrategyObject */
+    bool InitializeImpl(const OptionsList& options,
+                        const std::string& prefix);
+
+
+    /** @name Methods for requesting solution of the linear system. */
+    //@{
+    /** Method for initializing internal stuctures. */
+    virtual ESymSolverStatus InitializeStructure(Index dim, Index nonzeros,
+        const Index *ia,
+        const Index *ja);
+
+    /** Method returing an internal array into which the nonzero
+     *  elements are to be stored. */
+    virtual double* GetValuesArrayPtr();
+
+    /** Solve operation for multiple right hand sides. */
+    virtual ESymSolverStatus MultiSolve(bool new_matrix,
+                                        const Index* ia,
+                                        const Index* ja,
+                                        Index nrhs,
+                                        double* rhs_vals,
+                                        bool check_NegEVals,
+                                        Index numberOfNegEVals);
+
+    /** Number of negative eigenvalues detected during last
+     *  factorization (of the preconditioner).
+     */
+    virtual Index NumberOfNegEVals() const;
+    //@}
+
+    //* @name Options of Linear solver */
+    //@{
+    /** Request to increase quality of solution for next solve.
+     */
+    virtual bool IncreaseQuality();
+
+    /** Query whether inertia is computed by linear solver.
+     *  Returns true, if linear solver provides inertia.
+     */
+    virtual bool ProvidesInertia() const
+    {
+      return true;
+    }
+    /** Query of requested matrix type that the linear solver
+     *  understands.
+     */
+    EMatrixFormat MatrixFormat() const
+    {
+      return CSR_Format_1_Offset;
+    }
+    //@}
+
+    /** Methods for IpoptType */
+    //@{
+    static void RegisterOptions(SmartPtr<RegisteredOptions> roptions);
+    //@}
+
+  private:
+    /**@name Default Compiler Generated Methods
+     * (Hidden to avoid implicit creation/calling).
+     * These methods are not implemented and
+     * we do not want the compiler to implement
+     * them for us, so we declare them private
+     * and do not define them. This ensures that
+     * they will not be implicitly created/called. */
+    //@{
+    /** Default Constructor */
+    IterativeLdlSolverInterface();
+
+    /** Copy Constructor */
+    IterativeLdlSolverInterface(const IterativeLdlSolverInterface&);
+
+    /** Overloaded Equals Operator */
+    void operator=(const IterativeLdlSolverInterface&);
+    //@}
+
+    /** @name Information about the matrix */
+    //@{
+    /** Number of rows and columns of the matrix */
+    Index dim_;
+
+    /** Number of nonzeros of the matrix. */
+    Index nonzeros_;
+
+    /** Values of the matrix (upper triangle, row by row). */
+    std::vector<double> a_;
+    //@}
+
+    /** @name Information about most recent factorization/solve */
+    //@{
+    /** Number of negative pivots of the preconditioner */
+    Index negevals_;
+    //@}
+
+    /** @name Solver specific options */
+    //@{
+    /** Flag indicating if the interia is always assumed to be
+      *  correct. */
+    bool skip_inertia_check_;
+    /** Maximal number of decreases of drop tolerance during one solve. */
+    Index max_droptol_corrections_;
+    /** Pivot tolerance of the incomplete factorization */
+    Number pivtol_;
+    //@}
+
+    /** Options for the iterative solver (primal-dual and normal
+     *  system) */
+    //@{
+    Index max_iter_;
+    Number iter_relative_tol_;
+    Number iter_dropping_factor_;
+    Number iter_max_fill_;
+
+    Index normal_max_iter_;
+    Number normal_iter_relative_tol_;
+    Number normal_iter_dropping_factor_;
+    Number normal_iter_max_fill_;
+    //@}
+
+    /** Decrease factor for dropping tolerances */
+    Number decr_factor_;
+
+    /** Actualy used dropping tolerances */
+    //@{
+    Number iter_dropping_factor_used_;
+    Number normal_iter_dropping_factor_used_;
+    //@}
+
+    /** @name Initialization flags */
+    //@{
+    /** Flag indicating if internal data is initialized.
+     *  For initialization, this object needs to have seen a matrix */
+    bool initialized_;
+    /** Flag indicating if the ordering has been computed.  This
+     *  happens with the first matrix, since the ordering takes zero
+     *  diagonal entries into account. */
+    bool analyzed_;
+    //@}
+
+    /** @name Ordering */
+    //@{
+    /** Permutation: perm_[k] is the original index of the k-th pivot */
+    std::vector<Index> perm_;
+    /** Start of the columns of the permuted lower triangle */
+    std::vector<Index> pcol_ptr_;
+    /** Rows of the entries of the permuted lower triangle */
+    std::vector<Index> prow_;
+    /** Position of the entries of the permuted lower triangle in a_ */
+    std::vector<Index> pval_;
+    //@}
+
+    /** @name Incomplete factorization */
+    //@{
+    /** Symmetric scaling factors of the matrix */
+    std::vector<double> scaling_;
+    /** Start of the columns of L */
+    std::vector<Index> l_ptr_;
+    /** Row indices of the entries of L (sorted within each column) */
+    std::vector<Index> l_row_;
+    /** Values of the entries of L */
+    std::vector<double> l_val_;
+    /** Diagonal D */
+    std::vector<double> d_;
+    /** Dropping tolerance used for the current factors */
+    Number factor_droptol_;
+    /** Fill limit used for the current factors */
+    Number factor_max_fill_;
+    //@}
+
+    /** @name Work space for the Krylov iterations */
+    //@{
+    std::vector<double> work_;
+    //@}
+
+    /** @name Internal functions */
+    //@{
+    /** Compute the ordering and the structure of the permuted
+     *  matrix. */
+    void ComputeOrdering(const Index* ia,
+                         const Index* ja);
+
+    /** Compute the incomplete factorization of the matrix with the
+     *  given dropping tolerance and fill factor.  Returns the number
+     *  of pivots that had to be modified. */
+    Index Factorization(const Index* ia,
+                        const Index* ja,
+                        Number droptol,
+                        Number max_fill);
+
+    /** Run SQMR for the right hand side in rhs_vals and overwrite it
+     *  with the solution.  Returns false if the method did not
+     *  converge within max_iter iterations. */
+    bool Solve(const Index* ia,
+               const Index* ja,
+               double* rhs_vals,
+               Index max_iter,
+               Number relative_tol,
+               IterativeSolverTerminationTester& tester,
+               IterativeSolverTerminationTester::ETerminationTest& test_result);
+
+    /** Compute y = A x for the matrix in a_ */
+    void MultVector(const Index* ia, const Index* ja,
+                    const double* x, double* y) const;
+
+    /** Overwrite x with the solution of the preconditioner system,
+     *  using the work space y */
+    void ApplyPreconditioner(double* x, double* y) const;
+    //@}
+
+    /** Method to easily access Inexact data */
+    InexactData& InexData()
+    {
+      InexactData& inexact_data =
+        static_cast<InexactData&>(IpData().AdditionalData());
+      DBG_ASSERT(dynamic_cast<InexactData*>(&IpData().AdditionalData()));
+      return inexact_data;
+    }
+
+    /** Termination tester for normal step computation */
+    SmartPtr<IterativeSolverTerminationTester> normal_tester_;
+
+    /** Termination tester for primal-dual step computation */
+    SmartPtr<IterativeSolverTerminationTester> pd_tester_;
+
+  };
+
+} // namespace Ipopt
+#endif
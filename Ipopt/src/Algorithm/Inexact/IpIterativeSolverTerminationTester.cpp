@@ -9,6 +9,10 @@
 #include "IpIterativeSolverTerminationTester.hpp"
 #include "IpTripletHelper.hpp"
 
+/** Result of the last termination test of the iterative solver
+ *  (set by the solver interfaces, read by InexactPDSolver) */
+Ipopt::IterativeSolverTerminationTester::ETerminationTest test_result_;
+
 namespace Ipopt
 {
 
@@ -55,6 +55,7 @@
 #ifdef COIN_HAS_HSL
 #include "CoinHslConfig.h"
 #endif
+#include "IpLdlSolverInterface.hpp"
 #include "IpMa27TSolverInterface.hpp"
 #include "IpMa57TSolverInterface.hpp"
 #include "IpMa77SolverInterface.hpp"
@@ -63,6 +64,7 @@
 #include "IpMc19TSymScalingMethod.hpp"
 #include "IpPardisoSolverInterface.hpp"
 #include "IpSlackBasedTSymScalingMethod.hpp"
+#include "IpRuizTSymScalingMethod.hpp"
 
 #ifdef HAVE_WSMP
 # include "IpWsmpSolverInterface.hpp"
@@ -108,7 +110,14 @@ namespace Ipopt
       nlp_scaling = new GradientScaling(nlp);
     }
     else if (nlp_scaling_method == "equilibration-based") {
+#if defined(COINHSL_HAS_MC19) || defined(HAVE_LINEARSOLVERLOADER)
       nlp_scaling = new EquilibrationScaling(nlp);
+#else
+      nlp_scaling = new EquilibrationScaling(nlp, new RuizTSymScalingMethod());
+#endif
+    }
+    else if (nlp_scaling_method == "equilibration-ruiz") {
+      nlp_scaling = new EquilibrationScaling(nlp, new RuizTSymScalingMethod());
     }
     else {
       nlp_scaling = new NoNLPScalingObject();
@@ -140,7 +149,7 @@ namespace Ipopt
   void AlgorithmBuilder::RegisterOptions(SmartPtr<RegisteredOptions> roptions)
   {
     roptions->SetRegisteringCategory("Linear Solver");
-    roptions->AddStringOption9(
+    roptions->AddStringOption10(
       "linear_solver",
       "Linear solver used for step computations.",
 #ifdef COINHSL_HAS_MA27
@@ -167,7 +176,11 @@ namespace Ipopt
 #       ifdef COINHSL_HAS_MA77
         "ma77",
 #       else
+#        ifdef HAVE_LINEARSOLVERLOADER
         "ma27",
+#        else
+        "ldl",
+#        endif
 #       endif
 #      endif
 #     endif
@@ -184,15 +197,17 @@ namespace Ipopt
       "pardiso", "use the Pardiso package",
       "wsmp", "use WSMP package",
       "mumps", "use MUMPS package",
+      "ldl", "use the built-in supernodal LDL^T solver",
       "custom", "use custom linear solver",
       "Determines which linear algebra package is to be used for the "
       "solution of the augmented linear system (for obtaining the search "
       "directions). "
       "Note, the code must have been compiled with the linear solver you want "
       "to choose. Depending on your Ipopt installation, not all options are "
-      "available.");
+      "available.  With the inexact algorithm, \"ldl\" selects the built-in "
+      "iterative solver (SQMR with an incomplete LDL^T preconditioner).");
     roptions->SetRegisteringCategory("Linear Solver");
-    roptions->AddStringOption3(
+    roptions->AddStringOption4(
       "linear_system_scaling",
       "Method for scaling the linear system.",
 #ifdef COINHSL_HAS_MC19
@@ -203,22 +218,26 @@ namespace Ipopt
       "none", "no scaling will be performed",
       "mc19", "use the Harwell routine MC19",
       "slack-based", "use the slack values",
+      "ruiz", "use the built-in iterative equilibration",
       "Determines the method used to compute symmetric scaling "
       "factors for the augmented system (see also the "
       "\"linear_scaling_on_demand\" option).  This scaling is independent "
       "of the NLP problem scaling.  By default, MC19 is only used if MA27 or "
-      "MA57 are selected as linear solvers. This value is only available if "
-      "Ipopt has been compiled with MC19.");
+      "MA57 are selected as linear solvers. The value \"mc19\" is only "
+      "available if Ipopt has been compiled with MC19.  The value \"ruiz\" "
+      "equilibrates the rows of the matrix iteratively (see the "
+      "ruiz_scaling_* options) and does not need HSL.");
 
     roptions->SetRegisteringCategory("NLP Scaling");
-    roptions->AddStringOption4(
+    roptions->AddStringOption5(
       "nlp_scaling_method",
       "Select the technique used for scaling the NLP.",
       "gradient-based",
       "none", "no problem scaling will be performed",
       "user-scaling", "scaling parameters will come from the user",
       "gradient-based", "scale the problem so the maximum gradient at the starting point is scaling_max_gradient",
-      "equilibration-based", "scale the problem so that first derivatives are of order 1 at random points (only available with MC19)",
+      "equilibration-based", "scale the problem so that first derivatives are of order 1 at random points (with MC19 if available, otherwise as equilibration-ruiz)",
+      "equilibration-ruiz", "as equilibration-based, but with the built-in iterative equilibration instead of MC19",
       "Selects the technique used for scaling the problem internally before it is solved."
       " For user-scaling, the parameters come from the NLP. If you are using "
       "AMPL, they can be specified through suffixes (\"scaling_factor\")");
@@ -474,6 +493,9 @@ namespace Ipopt
 #endif
 
     }
+    else if (linear_solver=="ldl") {
+      SolverInterface = new LdlSolverInterface();
+    }
     else if (linear_solver=="custom") {
       ASSERT_EXCEPTION(IsValid(custom_solver_), OPTION_INVALID,
                        "Selected linear solver CUSTOM not available.");
@@ -519,6 +541,9 @@ namespace Ipopt
       else if (linear_system_scaling=="slack-based") {
         ScalingMethod = new SlackBasedTSymScalingMethod();
       }
+      else if (linear_system_scaling=="ruiz") {
+        ScalingMethod = new RuizTSymScalingMethod();
+      }
 
       SmartPtr<SymLinearSolver> ScaledSolver =
         new TSymLinearSolver(SolverInterface, ScalingMethod);
@@ -698,6 +723,7 @@ namespace Ipopt
       SmartPtr<HessianUpdater> resto_HessUpdater;
       switch (hessian_approximation) {
       case EXACT:
+      case FINDIFF_VALUES:
         resto_HessUpdater = new ExactHessianUpdater();
         break;
       case LIMITED_MEMORY:
@@ -824,6 +850,7 @@ namespace Ipopt
     SmartPtr<HessianUpdater> HessUpdater;
     switch (hessian_approximation) {
     case EXACT:
+    case FINDIFF_VALUES:
       HessUpdater = new ExactHessianUpdater();
       break;
     case LIMITED_MEMORY:
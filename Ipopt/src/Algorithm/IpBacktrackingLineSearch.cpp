@@ -571,7 +571,9 @@ namespace Ipopt
           IpData().Set_info_alpha_primal_char('R');
           IpData().Set_info_ls_count(n_steps+1);
 
+          IpData().TimingStats().RestorationPhase().Start();
           accept = resto_phase_->PerformRestoration();
+          IpData().TimingStats().RestorationPhase().End();
           if (!accept) {
             bool found_acceptable = RestoreAcceptablePoint();
             if (found_acceptable) {
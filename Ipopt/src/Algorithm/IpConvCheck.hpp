@@ -40,6 +40,8 @@ namespace Ipopt
       CPUTIME_EXCEEDED,
       DIVERGING,
       USER_STOP,
+      OBJECTIVE_CUTOFF,
+      CONVERGED_TO_FEASIBLE_POINT,
       FAILED
     };
 
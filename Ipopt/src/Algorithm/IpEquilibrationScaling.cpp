@@ -51,6 +51,14 @@ namespace Ipopt
   {
     options.GetNumericValue("point_perturbation_radius",
                             point_perturbation_radius_, prefix);
+    if (IsValid(equilibration_method_)) {
+      // This option is registered by GradientScaling
+      options.GetNumericValue("nlp_scaling_min_value",
+                              scaling_min_value_, prefix);
+      if (!equilibration_method_->ReducedInitialize(Jnlst(), options, prefix)) {
+        return false;
+      }
+    }
     return StandardScalingBase::InitializeImpl(options, prefix);
   }
 
@@ -132,7 +140,7 @@ namespace Ipopt
       }
       else {
         for (Index i=0; i<nnz_jac_c; i++) {
-          avrg_values[i] =+ fabs(val_buffer[i]);
+          avrg_values[i] += fabs(val_buffer[i]);
         }
       }
       TripletHelper::FillValues(nnz_jac_d, *jac_d, val_buffer);
@@ -143,7 +151,7 @@ namespace Ipopt
       }
       else {
         for (Index i=0; i<nnz_jac_d; i++) {
-          avrg_values[nnz_jac_c+i] =+ fabs(val_buffer[i]);
+          avrg_values[nnz_jac_c+i] += fabs(val_buffer[i]);
         }
       }
       TripletHelper::FillValuesFromVector(nx, *grad_f, val_buffer);
@@ -154,7 +162,7 @@ namespace Ipopt
       }
       else {
         for (Index i=0; i<nx; i++) {
-          avrg_values[nnz_jac_c+nnz_jac_d+i] =+ fabs(val_buffer[i]);
+          avrg_values[nnz_jac_c+nnz_jac_d+i] += fabs(val_buffer[i]);
         }
       }
     }
@@ -186,6 +194,57 @@ namespace Ipopt
       }
     }
 
+    if (IsValid(equilibration_method_)) {
+      // The rows of B = [J_c; J_d; grad_f^T] are the first nc+nd+1
+      // rows and columns of the symmetric matrix [0 B; B^T 0], its
+      // columns the remaining ones.  The symmetric factors of that
+      // matrix are the row and column factors of B.
+      const Index nrows = nc+nd+1;
+      const Index NZ = nnz_jac_c+nnz_jac_d+nnz_grad_f;
+      for (Index i=0; i<NZ; i++) {
+        AJCN[i] += nrows;
+      }
+      Number* factors = new Number[nrows+nx];
+      const bool success =
+        equilibration_method_->ComputeSymTScalingFactors(nrows+nx, NZ, AIRN,
+            AJCN, avrg_values, factors);
+      delete [] avrg_values;
+      delete [] AIRN;
+      delete [] AJCN;
+      if (!success) {
+        Jnlst().Printf(J_WARNING, J_INITIALIZATION,
+                       "Equilibration of the Jacobian failed - problem is not scaled.\n");
+        delete [] factors;
+        df = 1.;
+        dx = NULL;
+        dc = NULL;
+        dd = NULL;
+        return;
+      }
+
+      // The scaled Jacobian is dc*J*dx^{-1}, so that dx is the
+      // reciprocal of the column factor
+      const Number min_value = scaling_min_value_;
+      const Number max_value = 1./scaling_min_value_;
+      for (Index i=0; i<nrows; i++) {
+        factors[i] = Min(max_value, Max(min_value, factors[i]));
+      }
+      for (Index i=nrows; i<nrows+nx; i++) {
+        factors[i] = Min(max_value, Max(min_value, 1./factors[i]));
+      }
+
+      df = factors[nc+nd];
+      dc = c_space->MakeNew();
+      TripletHelper::PutValuesInVector(nc, &factors[0], *dc);
+      dd = d_space->MakeNew();
+      TripletHelper::PutValuesInVector(nd, &factors[nc], *dd);
+      dx = x_space->MakeNew();
+      TripletHelper::PutValuesInVector(nx, &factors[nrows], *dx);
+
+      delete [] factors;
+      return;
+    }
+
     // Now call MC19 to compute the scaling factors
     const ipfint N = Max(nc+nd+1,nx);
     float* R = new float[N];
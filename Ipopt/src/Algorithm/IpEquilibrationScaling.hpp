@@ -11,22 +11,29 @@
 
 #include "IpNLPScaling.hpp"
 #include "IpNLP.hpp"
+#include "IpTSymScalingMethod.hpp"
 
 namespace Ipopt
 {
   /** This class does problem scaling by setting the
-   *  scaling parameters based on the maximum of the
-   *  gradient at the user provided initial point.
+   *  scaling parameters so that the first derivatives, averaged over
+   *  random points around the user provided initial point, are
+   *  equilibrated.  The matrix of the constraint Jacobian and the
+   *  objective gradient is equilibrated with MC19, or, if an
+   *  equilibration method is given, with that method applied to the
+   *  symmetric matrix [0 B; B^T 0] built from this matrix B.
    */
   class EquilibrationScaling : public StandardScalingBase
   {
   public:
     /**@name Constructors/Destructors */
     //@{
-    EquilibrationScaling(const SmartPtr<NLP>& nlp)
+    EquilibrationScaling(const SmartPtr<NLP>& nlp,
+                         const SmartPtr<TSymScalingMethod>& equilibration_method = NULL)
         :
         StandardScalingBase(),
-        nlp_(nlp)
+        nlp_(nlp),
+        equilibration_method_(equilibration_method)
     {}
 
     /** Default destructor */
@@ -80,6 +87,14 @@ namespace Ipopt
     /** pointer to the NLP to get scaling parameters */
     SmartPtr<NLP> nlp_;
 
+    /** method for the equilibration of the symmetric matrix, NULL for
+     *  MC19 */
+    SmartPtr<TSymScalingMethod> equilibration_method_;
+
+    /** lower bound for the scaling factors computed by
+     *  equilibration_method_, the upper bound is its reciprocal */
+    Number scaling_min_value_;
+
     /** maximal radius for the random perturbation of the initial
      *  point. */
     Number point_perturbation_radius_;
@@ -48,7 +48,8 @@ namespace Ipopt
       "are huge, the scaling factors will otherwise become very small, and "
       "the (unscaled) final constraint violation, for example, might then be "
       "significant.  Note: This option is only used if \"nlp_scaling_method\" "
-      "is chosen as \"gradient-based\".");
+      "is chosen as \"gradient-based\" or \"equilibration-ruiz\".  For the "
+      "latter, its reciprocal is also the upper bound.");
   }
 
   bool GradientScaling::InitializeImpl(const OptionsList& options,
@@ -276,6 +276,12 @@ namespace Ipopt
 
     SolverReturn retval = UNASSIGNED;
 
+    // Flags for the per-iteration timing trace: whether it has been
+    // started, and whether an iteration is in progress that has not
+    // been recorded yet
+    bool phase_trace = false;
+    bool unrecorded_iteration = false;
+
     try {
       IpData().TimingStats().InitializeIterates().Start();
       // Initialize the iterates
@@ -293,8 +299,16 @@ namespace Ipopt
         conv_check_->CheckConvergence();
       IpData().TimingStats().CheckConvergence().End();
 
+      if (IpData().TimingStats().PhaseTraceEnabled()) {
+        IpData().TimingStats().StartPhaseTrace(
+          FunctionEvaluationWallclockTime());
+        phase_trace = true;
+      }
+
       // main loop
       while (conv_status == ConvergenceCheck::CONTINUE) {
+        unrecorded_iteration = true;
+
         // Set the Hessian Matrix
         IpData().TimingStats().UpdateHessian().Start();
         UpdateHessian();
@@ -356,6 +370,12 @@ namespace Ipopt
         IpData().TimingStats().CheckConvergence().Start();
         conv_status  = conv_check_->CheckConvergence();
         IpData().TimingStats().CheckConvergence().End();
+
+        if (phase_trace) {
+          IpData().TimingStats().RecordIterationPhases(
+            IpData().iter_count(), FunctionEvaluationWallclockTime());
+        }
+        unrecorded_iteration = false;
       }
 
       IpData().TimingStats().OutputIteration().Start();
@@ -389,6 +409,12 @@ namespace Ipopt
       case  ConvergenceCheck::USER_STOP:
         retval = USER_REQUESTED_STOP;
         break;
+      case ConvergenceCheck::OBJECTIVE_CUTOFF:
+        retval = OBJECTIVE_CUTOFF_REACHED;
+        break;
+      case ConvergenceCheck::CONVERGED_TO_FEASIBLE_POINT:
+        retval = FEASIBLE_POINT_FOUND;
+        break;
       default:
         retval = INTERNAL_ERROR;
         break;
@@ -402,6 +428,7 @@ namespace Ipopt
     catch (ACCEPTABLE_POINT_REACHED& exc) {
       exc.ReportException(Jnlst(), J_MOREDETAILED);
       IpData().TimingStats().ComputeAcceptableTrialPoint().EndIfStarted();
+      IpData().TimingStats().RestorationPhase().EndIfStarted();
       if (IpCq().IsSquareProblem()) {
         // make the sure multipliers are computed properly
         ComputeFeasibilityMultipliers();
@@ -411,47 +438,56 @@ namespace Ipopt
     catch (LOCALLY_INFEASIBLE& exc) {
       exc.ReportException(Jnlst(), J_MOREDETAILED);
       IpData().TimingStats().ComputeAcceptableTrialPoint().EndIfStarted();
+      IpData().TimingStats().RestorationPhase().EndIfStarted();
       IpData().TimingStats().CheckConvergence().EndIfStarted();
       retval = LOCAL_INFEASIBILITY;
     }
     catch (RESTORATION_CONVERGED_TO_FEASIBLE_POINT& exc) {
       exc.ReportException(Jnlst(), J_MOREDETAILED);
       IpData().TimingStats().ComputeAcceptableTrialPoint().EndIfStarted();
+      IpData().TimingStats().RestorationPhase().EndIfStarted();
       retval = RESTORATION_FAILURE;
     }
     catch (RESTORATION_FAILED& exc) {
       exc.ReportException(Jnlst(), J_MOREDETAILED);
       IpData().TimingStats().ComputeAcceptableTrialPoint().EndIfStarted();
+      IpData().TimingStats().RestorationPhase().EndIfStarted();
       retval = RESTORATION_FAILURE;
     }
     catch (RESTORATION_MAXITER_EXCEEDED& exc) {
       exc.ReportException(Jnlst(), J_MOREDETAILED);
       IpData().TimingStats().ComputeAcceptableTrialPoint().EndIfStarted();
+      IpData().TimingStats().RestorationPhase().EndIfStarted();
       retval = MAXITER_EXCEEDED;
     }
     catch (RESTORATION_CPUTIME_EXCEEDED& exc) {
       exc.ReportException(Jnlst(), J_MOREDETAILED);
       IpData().TimingStats().ComputeAcceptableTrialPoint().EndIfStarted();
+      IpData().TimingStats().RestorationPhase().EndIfStarted();
       retval = CPUTIME_EXCEEDED;
     }
     catch (RESTORATION_USER_STOP& exc) {
       exc.ReportException(Jnlst(), J_MOREDETAILED);
       IpData().TimingStats().ComputeAcceptableTrialPoint().EndIfStarted();
+      IpData().TimingStats().RestorationPhase().EndIfStarted();
       retval = USER_REQUESTED_STOP;
     }
     catch (STEP_COMPUTATION_FAILED& exc) {
       exc.ReportException(Jnlst(), J_MOREDETAILED);
       IpData().TimingStats().ComputeAcceptableTrialPoint().EndIfStarted();
+      IpData().TimingStats().RestorationPhase().EndIfStarted();
       retval = ERROR_IN_STEP_COMPUTATION;
     }
     catch (IpoptNLP::Eval_Error& exc) {
       exc.ReportException(Jnlst(), J_MOREDETAILED);
       IpData().TimingStats().ComputeAcceptableTrialPoint().EndIfStarted();
+      IpData().TimingStats().RestorationPhase().EndIfStarted();
       retval = INVALID_NUMBER_DETECTED;
     }
     catch (FEASIBILITY_PROBLEM_SOLVED& exc) {
       exc.ReportException(Jnlst(), J_MOREDETAILED);
       IpData().TimingStats().ComputeAcceptableTrialPoint().EndIfStarted();
+      IpData().TimingStats().RestorationPhase().EndIfStarted();
       if (IpCq().IsSquareProblem()) {
         // make the sure multipliers are computed properly
         ComputeFeasibilityMultipliers();
@@ -461,6 +497,7 @@ namespace Ipopt
     catch (TOO_FEW_DOF& exc) {
       exc.ReportException(Jnlst(), J_MOREDETAILED);
       IpData().TimingStats().ComputeAcceptableTrialPoint().EndIfStarted();
+      IpData().TimingStats().RestorationPhase().EndIfStarted();
       retval = TOO_FEW_DEGREES_OF_FREEDOM;
     }
     catch (INTERNAL_ABORT& exc) {
@@ -468,6 +505,13 @@ namespace Ipopt
       retval = INTERNAL_ERROR;
     }
 
+    // Also record the last iteration if it was ended by an exception
+    // (e.g., a failed restoration phase)
+    if (phase_trace && unrecorded_iteration) {
+      IpData().TimingStats().RecordIterationPhases(
+        IpData().iter_count()+1, FunctionEvaluationWallclockTime());
+    }
+
     DBG_ASSERT(retval != UNASSIGNED && "Unknown return code in the algorithm");
     IpData().TimingStats().OverallAlgorithm().End();
     return retval;
@@ -774,6 +818,15 @@ namespace Ipopt
                    ns_only_upper);
   }
 
+  Number IpoptAlgorithm::FunctionEvaluationWallclockTime()
+  {
+    OrigIpoptNLP* orig_nlp = dynamic_cast<OrigIpoptNLP*>(&IpNLP());
+    if (!orig_nlp) {
+      return 0.;
+    }
+    return orig_nlp->TotalFunctionEvaluationWallclockTime();
+  }
+
   void IpoptAlgorithm::ComputeFeasibilityMultipliers()
   {
     DBG_START_METH("IpoptAlgorithm::ComputeFeasibilityMultipliers",
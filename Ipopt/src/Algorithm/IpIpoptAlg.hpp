@@ -163,6 +163,10 @@ namespace Ipopt
 
     /** Compute the Lagrangian multipliers for a feasibility problem*/
     void ComputeFeasibilityMultipliers();
+
+    /** Wall clock time spent in function evaluations so far (zero if
+     *  the NLP is not an OrigIpoptNLP) */
+    Number FunctionEvaluationWallclockTime();
     //@}
 
     /** @name internal flags */
@@ -107,6 +107,17 @@ namespace Ipopt
       "default uses the regular update procedure and it improves results.  If "
       "for some reason you want to get back to the original update, set this "
       "option to \"yes\".");
+
+    roptions->AddLowerBoundedIntegerOption(
+      "limited_memory_num_threads",
+      "Number of threads for the dense operations of the limited-memory update.",
+      0, 0,
+      "The products of the stored update vectors with vectors and with each "
+      "other, here and in the solution of the low-rank augmented system, are "
+      "computed in blocks of rows that are distributed over this number of "
+      "threads.  The value 0 uses the OpenMP default.  This option has an "
+      "effect only if Ipopt has been compiled with OpenMP, and only for "
+      "large problems.");
   }
 
   bool LimMemQuasiNewtonUpdater::InitializeImpl(
@@ -131,6 +142,8 @@ namespace Ipopt
     options.GetBoolValue("limited_memory_special_for_resto",
                          limited_memory_special_for_resto_,
                          prefix);
+    options.GetIntegerValue("limited_memory_num_threads",
+                            limited_memory_num_threads_, prefix);
 
     h_space_ = NULL;
     curr_lm_memory_ = 0;
@@ -629,7 +642,8 @@ namespace Ipopt
         // Now get U as the Vtilde * Qminus
         if (IsValid(Qminus)) {
           SmartPtr<MultiVectorMatrixSpace> U_space =
-            new MultiVectorMatrixSpace(Qminus->NCols(), *s_new->OwnerSpace());
+            new MultiVectorMatrixSpace(Qminus->NCols(), *s_new->OwnerSpace(),
+                                       limited_memory_num_threads_);
           U_ = U_space->MakeNewMultiVectorMatrix();
           U_->AddRightMultMatrix(1., *Vtilde, *Qminus, 0.);
           DBG_PRINT_MATRIX(3, "U", *U_);
@@ -641,7 +655,8 @@ namespace Ipopt
         // Now get V as the Vtilde * Qplus
         if (IsValid(Qplus)) {
           SmartPtr<MultiVectorMatrixSpace> V_space =
-            new MultiVectorMatrixSpace(Qplus->NCols(), *s_new->OwnerSpace());
+            new MultiVectorMatrixSpace(Qplus->NCols(), *s_new->OwnerSpace(),
+                                       limited_memory_num_threads_);
           V_ = V_space->MakeNewMultiVectorMatrix();
           V_->AddRightMultMatrix(1., *Vtilde, *Qplus, 0.);
           DBG_PRINT_MATRIX(3, "V", *V_);
@@ -981,7 +996,8 @@ namespace Ipopt
 
     SmartPtr<const VectorSpace> vec_space = v_new.OwnerSpace();
     SmartPtr<MultiVectorMatrixSpace> new_Vspace =
-      new MultiVectorMatrixSpace(ncols+1, *vec_space);
+      new MultiVectorMatrixSpace(ncols+1, *vec_space,
+                                 limited_memory_num_threads_);
     SmartPtr<MultiVectorMatrix> new_V =
       new_Vspace->MakeNewMultiVectorMatrix();
     for (Index i=0; i<ncols; i++) {
@@ -1347,6 +1363,15 @@ namespace Ipopt
       new DenseGenMatrixSpace(dim, dim);
     L = space->MakeNewDenseGenMatrix();
     Number* Lvalues = L->Values();
+    // Compute the lower triangle in one pass over S and Y if possible
+    if (dim>0 && S.ComputeInnerProducts(Y, true, Lvalues)) {
+      for (Index j=0; j<dim; j++) {
+        for (Index i=0; i<=j; i++) {
+          Lvalues[i+j*dim] = 0.;
+        }
+      }
+      return;
+    }
     for (Index j=0; j<dim; j++) {
       for (Index i=0; i<=j; i++) {
         Lvalues[i+j*dim] = 0.;
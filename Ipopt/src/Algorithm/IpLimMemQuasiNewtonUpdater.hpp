@@ -103,6 +103,9 @@ namespace Ipopt
     /** Flag indicating if Hessian approximation should be done in a
      *  special manner for the restoration phase. */
     bool limited_memory_special_for_resto_;
+    /** Number of threads for the blocked operations of the
+     *  MultiVectorMatrices */
+    Index limited_memory_num_threads_;
     //@}
 
     /** Flag indicating if the update is to be done for the original
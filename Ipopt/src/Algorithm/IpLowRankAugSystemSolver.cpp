@@ -46,6 +46,10 @@ namespace Ipopt
     Wdiag_ = NULL;
     compound_sol_vecspace_ = NULL;
 
+    // The columns of the low-rank factors are processed with the
+    // number of threads of the limited-memory update
+    options.GetIntegerValue("limited_memory_num_threads", num_threads_, prefix);
+
     return aug_system_solver_->Initialize(Jnlst(), IpNLP(), IpData(), IpCq(),
                                           options, prefix);
   }
@@ -411,7 +415,8 @@ namespace Ipopt
     DBG_ASSERT(nrhs>0);
 
     SmartPtr<MultiVectorMatrixSpace> V_xspace =
-      new MultiVectorMatrixSpace(nrhs, *proto_rhs_x.OwnerSpace());
+      new MultiVectorMatrixSpace(nrhs, *proto_rhs_x.OwnerSpace(),
+                                 num_threads_);
     V_x = V_xspace->MakeNewMultiVectorMatrix();
 
     // Create the right hand sides
@@ -485,7 +490,8 @@ namespace Ipopt
       compound_sol_vecspace_ = ConstPtr(vecspace);
     }
     SmartPtr<MultiVectorMatrixSpace> V1space =
-      new MultiVectorMatrixSpace(nrhs, *compound_sol_vecspace_);
+      new MultiVectorMatrixSpace(nrhs, *compound_sol_vecspace_,
+                                 num_threads_);
     Vtilde = V1space->MakeNewMultiVectorMatrix();
     Vtilde_x = V_xspace->MakeNewMultiVectorMatrix();
     for (Index i=0; i<nrhs; i++) {
@@ -179,6 +179,10 @@ namespace Ipopt
      *  aug_system_solver returned. */
     Index num_neg_evals_;
 
+    /** Number of threads for the blocked operations of the
+     *  MultiVectorMatrices */
+    Index num_threads_;
+
     /** @name Internal functions */
     //@{
     /** Method for updating the factorization, including J1_, J2_,
@@ -136,6 +136,29 @@ namespace Ipopt
       "final value of the barrier parameter, and the termination tests are "
       "then defined with respect to the barrier problem for this value of the "
       "barrier parameter.");
+    roptions->AddNumberOption(
+      "obj_cutoff",
+      "Objective value beyond which the problem is of no interest.",
+      1e20,
+      "If a lower bound on the (unscaled) objective function that is derived "
+      "from the current constraint multipliers exceeds this value, the "
+      "algorithm terminates with the exit message that the objective cutoff "
+      "has been reached.  The bound minimizes the linearization of the "
+      "Lagrangian function over the variable and constraint bounds; it is only "
+      "valid if the objective and the constraints weighted by their "
+      "multipliers are convex.  A value of 1e20 or larger disables the test.  "
+      "The test is not done if the objective is maximized (negative "
+      "obj_scaling_factor).");
+    roptions->AddStringOption2(
+      "feasibility_only",
+      "Stop at the first feasible point below the objective cutoff.",
+      "no",
+      "no", "solve the problem to optimality",
+      "yes", "terminate as soon as a feasible point is found",
+      "If this option is set to yes, the algorithm terminates with the exit "
+      "message that a feasible point has been found as soon as an iterate "
+      "satisfies constr_viol_tol and its (unscaled) objective value does not "
+      "exceed obj_cutoff.");
   }
 
   bool
@@ -155,6 +178,8 @@ namespace Ipopt
     options.GetNumericValue("acceptable_obj_change_tol", acceptable_obj_change_tol_, prefix);
     options.GetNumericValue("diverging_iterates_tol", diverging_iterates_tol_, prefix);
     options.GetNumericValue("mu_target", mu_target_, prefix);
+    options.GetNumericValue("obj_cutoff", obj_cutoff_, prefix);
+    options.GetBoolValue("feasibility_only", feasibility_only_, prefix);
     acceptable_counter_ = 0;
     curr_obj_val_ = -1e50;
     last_obj_val_iter_ = -1;
@@ -235,6 +260,36 @@ namespace Ipopt
       return ConvergenceCheck::CONVERGED;
     }
 
+    if (feasibility_only_ && constr_viol <= constr_viol_tol_ &&
+        IpCq().unscaled_curr_f() <= obj_cutoff_) {
+      return ConvergenceCheck::CONVERGED_TO_FEASIBLE_POINT;
+    }
+
+    if (obj_cutoff_ < 1e20) {
+      Number bound;
+      if (LagrangianLowerBound(IpNLP(), *IpData().curr()->x(),
+                               *IpData().curr()->y_c(),
+                               *IpData().curr()->y_d(),
+                               IpCq().curr_f(), GetRawPtr(IpCq().curr_grad_f()),
+                               *IpCq().curr_c(), *IpCq().curr_d(),
+                               *IpCq().curr_jac_c(), *IpCq().curr_jac_d(),
+                               bound)) {
+        // The bound is on the scaled objective.  With a negative
+        // scaling factor (maximization) it bounds the unscaled
+        // objective from above and says nothing about the cutoff.
+        if (IpNLP().NLP_scaling()->apply_obj_scaling(1.) > 0.) {
+          Number unscaled_bound =
+            IpNLP().NLP_scaling()->unapply_obj_scaling(bound);
+          Jnlst().Printf(J_MOREDETAILED, J_MAIN,
+                         "  obj_bound     = %23.16e   obj_cutoff_      = %23.16e\n",
+                         unscaled_bound, obj_cutoff_);
+          if (unscaled_bound > obj_cutoff_) {
+            return ConvergenceCheck::OBJECTIVE_CUTOFF;
+          }
+        }
+      }
+    }
+
     if (acceptable_iter_>0 && CurrentIsAcceptable()) {
       IpData().Append_info_string("A");
       acceptable_counter_++;
@@ -328,5 +383,86 @@ namespace Ipopt
             fabs(curr_obj_val_-last_obj_val_)/Max(1., fabs(curr_obj_val_)) <= acceptable_obj_change_tol_);
   }
 
+  bool OptimalityErrorConvergenceCheck::LagrangianLowerBound(
+    const IpoptNLP& nlp,
+    const Vector& x,
+    const Vector& y_c,
+    const Vector& y_d,
+    Number f,
+    const Vector* grad_f,
+    const Vector& c,
+    const Vector& d,
+    const Matrix& jac_c,
+    const Matrix& jac_d,
+    Number& bound) const
+  {
+    DBG_START_METH("OptimalityErrorConvergenceCheck::LagrangianLowerBound",
+                   dbg_verbosity);
+
+    // Split y_d by sign.  A positive multiplier is paired with the
+    // upper bound of the slack, a negative one with the lower bound;
+    // components for which that bound is infinite are set to zero.
+    SmartPtr<Vector> zero_d = y_d.MakeNew();
+    zero_d->Set(0.);
+    SmartPtr<Vector> y_d_pos = y_d.MakeNewCopy();
+    y_d_pos->ElementWiseMax(*zero_d);
+    SmartPtr<Vector> y_d_neg = y_d.MakeNewCopy();
+    y_d_neg->ElementWiseMin(*zero_d);
+    SmartPtr<Vector> y_d_U = nlp.d_U()->MakeNew();
+    nlp.Pd_U()->TransMultVector(1., *y_d_pos, 0., *y_d_U);
+    SmartPtr<Vector> y_d_L = nlp.d_L()->MakeNew();
+    nlp.Pd_L()->TransMultVector(1., *y_d_neg, 0., *y_d_L);
+    SmartPtr<Vector> yd = y_d.MakeNew();
+    nlp.Pd_U()->MultVector(1., *y_d_U, 0., *yd);
+    nlp.Pd_L()->MultVector(1., *y_d_L, 1., *yd);
+
+    // Value of f + y_c^T c + y_d^T (d - s) at x, minimized over s
+    bound = f + y_c.Dot(c) + yd->Dot(d)
+            - y_d_U->Dot(*nlp.d_U()) - y_d_L->Dot(*nlp.d_L());
+
+    // Slope of the linearization in x
+    SmartPtr<Vector> g = x.MakeNew();
+    if (grad_f) {
+      g->Copy(*grad_f);
+    }
+    else {
+      g->Set(0.);
+    }
+    jac_c.TransMultVector(1., y_c, 1., *g);
+    jac_d.TransMultVector(1., *yd, 1., *g);
+
+    // Minimize g^T (x' - x) over the box.  Positive slopes go to the
+    // lower bounds, negative ones to the upper bounds; any slope left
+    // over after projecting onto the bounded components means that
+    // there is no finite bound.
+    SmartPtr<Vector> zero_x = x.MakeNew();
+    zero_x->Set(0.);
+    SmartPtr<Vector> g_pos = g->MakeNewCopy();
+    g_pos->ElementWiseMax(*zero_x);
+    SmartPtr<Vector> g_L = nlp.x_L()->MakeNew();
+    nlp.Px_L()->TransMultVector(1., *g_pos, 0., *g_L);
+    nlp.Px_L()->MultVector(-1., *g_L, 1., *g_pos);
+    if (g_pos->Amax() > 0.) {
+      return false;
+    }
+    SmartPtr<Vector> g_neg = g->MakeNewCopy();
+    g_neg->ElementWiseMin(*zero_x);
+    SmartPtr<Vector> g_U = nlp.x_U()->MakeNew();
+    nlp.Px_U()->TransMultVector(1., *g_neg, 0., *g_U);
+    nlp.Px_U()->MultVector(-1., *g_U, 1., *g_neg);
+    if (g_neg->Amax() > 0.) {
+      return false;
+    }
+
+    SmartPtr<Vector> dx_L = nlp.x_L()->MakeNewCopy();
+    nlp.Px_L()->TransMultVector(-1., x, 1., *dx_L);
+    SmartPtr<Vector> dx_U = nlp.x_U()->MakeNewCopy();
+    nlp.Px_U()->TransMultVector(-1., x, 1., *dx_U);
+    bound += g_L->Dot(*dx_L) + g_U->Dot(*dx_U);
+
+    DBG_PRINT((1, "Lagrangian lower bound = %e\n", bound));
+    return true;
+  }
+
 
 } // namespace Ipopt
@@ -79,8 +79,39 @@ namespace Ipopt
     Number mu_target_;
     /** Upper bound on CPU time */
     Number max_cpu_time_;
+    /** Objective value (unscaled) that the problem has to beat; a
+     *  value of 1e20 or larger disables the cutoff test */
+    Number obj_cutoff_;
+    /** Flag indicating whether the algorithm should stop at the
+     *  first feasible iterate with an objective below obj_cutoff_ */
+    bool feasibility_only_;
     //@}
 
+    /** Lower bound on the value of the Lagrangian function over the
+     *  bounds of the problem, computed from the linearization at x.
+     *
+     *  Only the multipliers y_c and y_d are used.  Components of y_d
+     *  whose sign refers to an infinite bound are dropped, and the
+     *  remaining linear term in x is minimized over the box [x_L,
+     *  x_U].  If the problem is convex (f and the weighted
+     *  constraints are convex), the returned value is a lower bound
+     *  on f over the feasible region; with grad_f NULL (and f=0) a
+     *  positive value proves that the constraints are infeasible.
+     *  Returns false if the bound is -infinity, i.e., if the
+     *  linearization has a nonzero slope in a direction without a
+     *  finite bound. */
+    bool LagrangianLowerBound(const IpoptNLP& nlp,
+                              const Vector& x,
+                              const Vector& y_c,
+                              const Vector& y_d,
+                              Number f,
+                              const Vector* grad_f,
+                              const Vector& c,
+                              const Vector& d,
+                              const Matrix& jac_c,
+                              const Matrix& jac_d,
+                              Number& bound) const;
+
   private:
     /**@name Default Compiler Generated Methods (Hidden to avoid
      * implicit creation/calling).  These methods are not implemented
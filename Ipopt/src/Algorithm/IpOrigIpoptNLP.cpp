@@ -122,14 +122,18 @@ namespace Ipopt
       "Lagrangian function only once from the NLP and reuse this information "
       "later.");
     roptions->SetRegisteringCategory("Hessian Approximation");
-    roptions->AddStringOption2(
+    roptions->AddStringOption3(
       "hessian_approximation",
       "Indicates what Hessian information is to be used.",
       "exact",
       "exact", "Use second derivatives provided by the NLP.",
       "limited-memory", "Perform a limited-memory quasi-Newton approximation",
+      "finite-difference-values", "Use the Hessian structure provided by the NLP, values by finite differences of first derivatives",
       "This determines which kind of information for the Hessian of the "
-      "Lagrangian function is used by the algorithm.");
+      "Lagrangian function is used by the algorithm.  The finite difference "
+      "approximation is only available for a TNLP; it differences the "
+      "gradient of the objective and the constraint Jacobian (see the "
+      "options findiff_perturbation and findiff_num_threads).");
     roptions->AddStringOption2(
       "hessian_approximation_space",
       "Indicates in which subspace the Hessian information is to be approximated.",
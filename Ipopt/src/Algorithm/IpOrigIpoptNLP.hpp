@@ -19,7 +19,8 @@ namespace Ipopt
   /** enumeration for the Hessian information type. */
   enum HessianApproximationType {
     EXACT=0,
-    LIMITED_MEMORY
+    LIMITED_MEMORY,
+    FINDIFF_VALUES
   };
 
   /** enumeration for the Hessian approximation space. */
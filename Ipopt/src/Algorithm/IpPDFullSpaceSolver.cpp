@@ -364,6 +364,251 @@ namespace Ipopt
     return true;
   }
 
+  bool PDFullSpaceSolver::MultiSolve(std::vector<SmartPtr<const IteratesVector> >& rhsV,
+                                     std::vector<SmartPtr<IteratesVector> >& resV,
+                                     bool allow_inexact)
+  {
+    DBG_START_METH("PDFullSpaceSolver::MultiSolve",dbg_verbosity);
+    DBG_ASSERT(rhsV.size() == resV.size());
+
+    const Index nrhs = (Index)rhsV.size();
+    if (nrhs == 0) {
+      return true;
+    }
+
+    // Receive data about matrix
+    SmartPtr<const SymMatrix> W = IpData().W();
+    SmartPtr<const Matrix> J_c = IpCq().curr_jac_c();
+    SmartPtr<const Matrix> J_d = IpCq().curr_jac_d();
+    SmartPtr<const Matrix> Px_L = IpNLP().Px_L();
+    SmartPtr<const Matrix> Px_U = IpNLP().Px_U();
+    SmartPtr<const Matrix> Pd_L = IpNLP().Pd_L();
+    SmartPtr<const Matrix> Pd_U = IpNLP().Pd_U();
+    SmartPtr<const Vector> z_L = IpData().curr()->z_L();
+    SmartPtr<const Vector> z_U = IpData().curr()->z_U();
+    SmartPtr<const Vector> v_L = IpData().curr()->v_L();
+    SmartPtr<const Vector> v_U = IpData().curr()->v_U();
+    SmartPtr<const Vector> slack_x_L = IpCq().curr_slack_x_L();
+    SmartPtr<const Vector> slack_x_U = IpCq().curr_slack_x_U();
+    SmartPtr<const Vector> slack_s_L = IpCq().curr_slack_s_L();
+    SmartPtr<const Vector> slack_s_U = IpCq().curr_slack_s_U();
+    SmartPtr<const Vector> sigma_x = IpCq().curr_sigma_x();
+    SmartPtr<const Vector> sigma_s = IpCq().curr_sigma_s();
+
+    // If the matrix has changed since the last solve, the first right
+    // hand side is solved by Solve, which factorizes the matrix and
+    // corrects its inertia if necessary
+    std::vector<const TaggedObject*> deps(13);
+    deps[0] = GetRawPtr(W);
+    deps[1] = GetRawPtr(J_c);
+    deps[2] = GetRawPtr(J_d);
+    deps[3] = GetRawPtr(z_L);
+    deps[4] = GetRawPtr(z_U);
+    deps[5] = GetRawPtr(v_L);
+    deps[6] = GetRawPtr(v_U);
+    deps[7] = GetRawPtr(slack_x_L);
+    deps[8] = GetRawPtr(slack_x_U);
+    deps[9] = GetRawPtr(slack_s_L);
+    deps[10] = GetRawPtr(slack_s_U);
+    deps[11] = GetRawPtr(sigma_x);
+    deps[12] = GetRawPtr(sigma_s);
+    void* dummy;
+    Index first = 0;
+    if (!dummy_cache_.GetCachedResult(dummy, deps)) {
+      if (!Solve(1., 0., *rhsV[0], *resV[0], allow_inexact)) {
+        return false;
+      }
+      first = 1;
+    }
+
+    std::vector<Index> idx;
+    for (Index i=first; i<nrhs; i++) {
+      idx.push_back(i);
+    }
+    if (idx.empty()) {
+      return true;
+    }
+
+    IpData().TimingStats().PDSystemSolverTotal().Start();
+    bool batch_ok =
+      MultiSolveOnce(*W, *J_c, *J_d, *Px_L, *Px_U, *Pd_L, *Pd_U, *z_L, *z_U,
+                     *v_L, *v_U, *slack_x_L, *slack_x_U, *slack_s_L, *slack_s_U,
+                     *sigma_x, *sigma_s, 1., 0., idx, rhsV, resV);
+
+    // Right hand sides that are left to Solve
+    std::vector<Index> individual;
+    if (!batch_ok) {
+      individual = idx;
+    }
+    else if (!allow_inexact) {
+      // Iterative refinement for all right hand sides together.  The
+      // criteria for continuing and giving up are the same as in Solve.
+      std::vector<SmartPtr<IteratesVector> > residV(nrhs);
+      std::vector<SmartPtr<const IteratesVector> > const_residV(nrhs);
+      std::vector<Number> ratio(nrhs);
+      std::vector<Number> ratio_old(nrhs);
+      for (size_t k=0; k<idx.size(); k++) {
+        const Index i = idx[k];
+        residV[i] = resV[i]->MakeNewIteratesVector(true);
+        const_residV[i] = ConstPtr(residV[i]);
+        ComputeResiduals(*W, *J_c, *J_d, *Px_L, *Px_U, *Pd_L, *Pd_U,
+                         *z_L, *z_U, *v_L, *v_U, *slack_x_L, *slack_x_U,
+                         *slack_s_L, *slack_s_U, *sigma_x, *sigma_s,
+                         1., 0., *rhsV[i], *resV[i], *residV[i]);
+        ratio[i] = ComputeResidualRatio(*rhsV[i], *resV[i], *residV[i]);
+      }
+
+      Index num_iter_ref = 0;
+      while (!idx.empty()) {
+        std::vector<Index> refine;
+        for (size_t k=0; k<idx.size(); k++) {
+          const Index i = idx[k];
+          if (num_iter_ref >= min_refinement_steps_ &&
+              ratio[i] <= residual_ratio_max_) {
+            continue;
+          }
+          if (num_iter_ref > min_refinement_steps_ &&
+              (num_iter_ref > max_refinement_steps_ ||
+               ratio[i] > residual_improvement_factor_*ratio_old[i])) {
+            Jnlst().Printf(J_DETAILED, J_LINEAR_ALGEBRA,
+                           "Iterative refinement for right hand side %d failed with residual_ratio = %e\n", i, ratio[i]);
+            individual.push_back(i);
+            continue;
+          }
+          refine.push_back(i);
+        }
+        idx.swap(refine);
+        if (idx.empty()) {
+          break;
+        }
+
+        if (!MultiSolveOnce(*W, *J_c, *J_d, *Px_L, *Px_U, *Pd_L, *Pd_U,
+                            *z_L, *z_U, *v_L, *v_U, *slack_x_L, *slack_x_U,
+                            *slack_s_L, *slack_s_U, *sigma_x, *sigma_s,
+                            -1., 1., idx, const_residV, resV)) {
+          individual.insert(individual.end(), idx.begin(), idx.end());
+          break;
+        }
+        for (size_t k=0; k<idx.size(); k++) {
+          const Index i = idx[k];
+          ComputeResiduals(*W, *J_c, *J_d, *Px_L, *Px_U, *Pd_L, *Pd_U,
+                           *z_L, *z_U, *v_L, *v_U, *slack_x_L, *slack_x_U,
+                           *slack_s_L, *slack_s_U, *sigma_x, *sigma_s,
+                           1., 0., *rhsV[i], *resV[i], *residV[i]);
+          ratio_old[i] = ratio[i];
+          ratio[i] = ComputeResidualRatio(*rhsV[i], *resV[i], *residV[i]);
+        }
+        num_iter_ref++;
+      }
+    }
+    IpData().TimingStats().PDSystemSolverTotal().End();
+
+    // Solve allows modifications of the linear system to get an
+    // accurate solution, so it does the rest
+    for (size_t k=0; k<individual.size(); k++) {
+      const Index i = individual[k];
+      if (!Solve(1., 0., *rhsV[i], *resV[i], allow_inexact, batch_ok)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool PDFullSpaceSolver::MultiSolveOnce(const SymMatrix& W,
+                                         const Matrix& J_c,
+                                         const Matrix& J_d,
+                                         const Matrix& Px_L,
+                                         const Matrix& Px_U,
+                                         const Matrix& Pd_L,
+                                         const Matrix& Pd_U,
+                                         const Vector& z_L,
+                                         const Vector& z_U,
+                                         const Vector& v_L,
+                                         const Vector& v_U,
+                                         const Vector& slack_x_L,
+                                         const Vector& slack_x_U,
+                                         const Vector& slack_s_L,
+                                         const Vector& slack_s_U,
+                                         const Vector& sigma_x,
+                                         const Vector& sigma_s,
+                                         Number alpha,
+                                         Number beta,
+                                         const std::vector<Index>& idx,
+                                         const std::vector<SmartPtr<const IteratesVector> >& rhsV,
+                                         std::vector<SmartPtr<IteratesVector> >& resV)
+  {
+    DBG_START_METH("PDFullSpaceSolver::MultiSolveOnce",dbg_verbosity);
+
+    IpData().TimingStats().PDSystemSolverSolveOnce().Start();
+
+    // Compute the right hand sides for the augmented system formulation
+    const Index nrhs = (Index)idx.size();
+    std::vector<SmartPtr<const Vector> > augRhs_xV(nrhs);
+    std::vector<SmartPtr<const Vector> > augRhs_sV(nrhs);
+    std::vector<SmartPtr<const Vector> > rhs_cV(nrhs);
+    std::vector<SmartPtr<const Vector> > rhs_dV(nrhs);
+    std::vector<SmartPtr<IteratesVector> > solV(nrhs);
+    std::vector<SmartPtr<Vector> > sol_xV(nrhs);
+    std::vector<SmartPtr<Vector> > sol_sV(nrhs);
+    std::vector<SmartPtr<Vector> > sol_cV(nrhs);
+    std::vector<SmartPtr<Vector> > sol_dV(nrhs);
+    for (Index k=0; k<nrhs; k++) {
+      const IteratesVector& rhs = *rhsV[idx[k]];
+      SmartPtr<Vector> augRhs_x = rhs.x()->MakeNewCopy();
+      Px_L.AddMSinvZ(1.0, slack_x_L, *rhs.z_L(), *augRhs_x);
+      Px_U.AddMSinvZ(-1.0, slack_x_U, *rhs.z_U(), *augRhs_x);
+      augRhs_xV[k] = ConstPtr(augRhs_x);
+
+      SmartPtr<Vector> augRhs_s = rhs.s()->MakeNewCopy();
+      Pd_L.AddMSinvZ(1.0, slack_s_L, *rhs.v_L(), *augRhs_s);
+      Pd_U.AddMSinvZ(-1.0, slack_s_U, *rhs.v_U(), *augRhs_s);
+      augRhs_sV[k] = ConstPtr(augRhs_s);
+
+      rhs_cV[k] = rhs.y_c();
+      rhs_dV[k] = rhs.y_d();
+
+      solV[k] = resV[idx[k]]->MakeNewIteratesVector(true);
+      sol_xV[k] = solV[k]->x_NonConst();
+      sol_sV[k] = solV[k]->s_NonConst();
+      sol_cV[k] = solV[k]->y_c_NonConst();
+      sol_dV[k] = solV[k]->y_d_NonConst();
+    }
+
+    Number delta_x;
+    Number delta_s;
+    Number delta_c;
+    Number delta_d;
+    perturbHandler_->CurrentPerturbation(delta_x, delta_s, delta_c, delta_d);
+
+    ESymSolverStatus retval =
+      augSysSolver_->MultiSolve(&W, 1.0, &sigma_x, delta_x,
+                                &sigma_s, delta_s, &J_c, NULL,
+                                delta_c, &J_d, NULL, delta_d,
+                                augRhs_xV, augRhs_sV, rhs_cV, rhs_dV,
+                                sol_xV, sol_sV, sol_cV, sol_dV,
+                                false, 0);
+    if (retval!=SYMSOLVER_SUCCESS) {
+      IpData().TimingStats().PDSystemSolverSolveOnce().End();
+      return false;
+    }
+
+    // Compute the remaining sol Vectors and assemble the results
+    for (Index k=0; k<nrhs; k++) {
+      const IteratesVector& rhs = *rhsV[idx[k]];
+      IteratesVector& sol = *solV[k];
+      Px_L.SinvBlrmZMTdBr(-1., slack_x_L, *rhs.z_L(), z_L, *sol.x(), *sol.z_L_NonConst());
+      Px_U.SinvBlrmZMTdBr(1., slack_x_U, *rhs.z_U(), z_U, *sol.x(), *sol.z_U_NonConst());
+      Pd_L.SinvBlrmZMTdBr(-1., slack_s_L, *rhs.v_L(), v_L, *sol.s(), *sol.v_L_NonConst());
+      Pd_U.SinvBlrmZMTdBr(1., slack_s_U, *rhs.v_U(), v_U, *sol.s(), *sol.v_U_NonConst());
+      resV[idx[k]]->AddOneVector(alpha, sol, beta);
+    }
+
+    IpData().TimingStats().PDSystemSolverSolveOnce().End();
+
+    return true;
+  }
+
   bool PDFullSpaceSolver::SolveOnce(bool resolve_with_better_quality,
                                     bool pretend_singular,
                                     const SymMatrix& W,
@@ -501,12 +746,21 @@ namespace Ipopt
           if (neg_curv_test_tol_ > 0.) {
             check_inertia = false;
           }
+          // Every factorization after the first one is a retry with
+          // modified perturbations
+          if (count > 1) {
+            IpData().TimingStats().AddInertiaCorrection();
+            IpData().TimingStats().InertiaCorrection().Start();
+          }
           retval = augSysSolver_->Solve(&W, 1.0, &sigma_x, delta_x,
                                         &sigma_s, delta_s, &J_c, NULL,
                                         delta_c, &J_d, NULL, delta_d,
                                         *augRhs_x, *augRhs_s, *rhs.y_c(), *rhs.y_d(),
                                         *sol->x_NonConst(), *sol->s_NonConst(),
                                         *sol->y_c_NonConst(), *sol->y_d_NonConst(),                                     check_inertia, numberOfEVals);
+          if (count > 1) {
+            IpData().TimingStats().InertiaCorrection().End();
+          }
         }
         if (retval==SYMSOLVER_FATAL_ERROR) return false;
         if (retval==SYMSOLVER_SINGULAR &&
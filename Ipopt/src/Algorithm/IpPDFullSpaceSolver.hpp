@@ -57,6 +57,18 @@ namespace Ipopt
                        bool allow_inexact=false,
                        bool improve_solution=false);
 
+    /** Solve the primal dual system for several right hand sides.
+     *  After the matrix has been factorized (by a call of Solve for
+     *  the first right hand side, if necessary), all remaining right
+     *  hand sides are passed to the augmented system solver in one
+     *  MultiSolve call, and iterative refinement is done for all of
+     *  them together.  Right hand sides for which the refinement does
+     *  not reach the required accuracy are handed to Solve
+     *  individually. */
+    virtual bool MultiSolve(std::vector<SmartPtr<const IteratesVector> >& rhsV,
+                            std::vector<SmartPtr<IteratesVector> >& resV,
+                            bool allow_inexact=false);
+
     /** Methods for IpoptType */
     //@{
     static void RegisterOptions(SmartPtr<RegisteredOptions> roptions);
@@ -144,6 +156,35 @@ namespace Ipopt
                    const IteratesVector& rhs,
                    IteratesVector& res);
 
+    /** Internal function for a backsolve with several right hand
+     *  sides, resV[i] = alpha*sol(rhsV[i]) + beta*resV[i], for the
+     *  right hand sides listed in idx.  The matrix must have been
+     *  factorized before (by SolveOnce); the current perturbation is
+     *  used and no inertia correction is done.  This method returns
+     *  false, if the augmented system solver fails. */
+    bool MultiSolveOnce(const SymMatrix& W,
+                        const Matrix& J_c,
+                        const Matrix& J_d,
+                        const Matrix& Px_L,
+                        const Matrix& Px_U,
+                        const Matrix& Pd_L,
+                        const Matrix& Pd_U,
+                        const Vector& z_L,
+                        const Vector& z_U,
+                        const Vector& v_L,
+                        const Vector& v_U,
+                        const Vector& slack_x_L,
+                        const Vector& slack_x_U,
+                        const Vector& slack_s_L,
+                        const Vector& slack_s_U,
+                        const Vector& sigma_x,
+                        const Vector& sigma_s,
+                        Number alpha,
+                        Number beta,
+                        const std::vector<Index>& idx,
+                        const std::vector<SmartPtr<const IteratesVector> >& rhsV,
+                        std::vector<SmartPtr<IteratesVector> >& resV);
+
     /** Internal function for computing the residual (resid) given the
      * right hand side (rhs) and the solution of the system (res).
      */
@@ -110,6 +110,26 @@ namespace Ipopt
                        bool allow_inexact=false,
                        bool improve_solution=false) =0;
 
+    /** Solve the primal dual system for several right hand sides
+     *  with the same matrix, resV[i] = sol(rhsV[i]).  The meaning of
+     *  allow_inexact is as for Solve.  The default implementation
+     *  solves for one right hand side after the other; derived
+     *  classes may hand all right hand sides to the linear solver at
+     *  once.  The return value is false, if the solution for one of
+     *  the right hand sides could not be computed. */
+    virtual bool MultiSolve(std::vector<SmartPtr<const IteratesVector> >& rhsV,
+                            std::vector<SmartPtr<IteratesVector> >& resV,
+                            bool allow_inexact=false)
+    {
+      DBG_ASSERT(rhsV.size() == resV.size());
+      for (size_t i=0; i<rhsV.size(); i++) {
+        if (!Solve(1., 0., *rhsV[i], *resV[i], allow_inexact)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
   private:
     /**@name Default Compiler Generated Methods
      * (Hidden to avoid implicit creation/calling).
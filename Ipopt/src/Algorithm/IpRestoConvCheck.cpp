@@ -49,6 +49,19 @@ namespace Ipopt
       "The algorithm terminates with an error message if the number of "
       "iterations successively taken in the restoration phase exceeds this "
       "number.");
+    roptions->AddStringOption2(
+      "infeasibility_certificate",
+      "Stop the restoration phase at a certificate of infeasibility.",
+      "no",
+      "no", "only stop when the restoration phase converges",
+      "yes", "test for an infeasibility certificate in every iteration",
+      "If this option is set to yes, the multipliers of the restoration phase "
+      "are used in every iteration to compute a lower bound on the weighted "
+      "sum of the original constraint violations over the variable bounds.  "
+      "As soon as this bound is positive, the algorithm terminates with the "
+      "message that the problem is locally infeasible.  The certificate is "
+      "only valid if the constraints weighted by their multipliers are "
+      "convex.");
   }
 
   bool RestoConvergenceCheck::InitializeImpl(const OptionsList& options,
@@ -61,10 +74,20 @@ namespace Ipopt
     // The original constraint violation tolerance
     options.GetNumericValue("constr_viol_tol", orig_constr_viol_tol_, "");
 
+    // The certificate is computed for the original problem
+    options.GetBoolValue("infeasibility_certificate", infeasibility_certificate_, "");
+
     first_resto_iter_ = true;
     successive_resto_iter_ = 0;
 
-    return OptimalityErrorConvergenceCheck::InitializeImpl(options, prefix);
+    bool retval = OptimalityErrorConvergenceCheck::InitializeImpl(options, prefix);
+
+    // The objective cutoff refers to the original problem and is not
+    // tested for the restoration phase problem
+    obj_cutoff_ = 1e20;
+    feasibility_only_ = false;
+
+    return retval;
   }
 
   ConvergenceCheck::ConvergenceStatus
@@ -192,6 +215,27 @@ namespace Ipopt
     // If the point is not yet acceptable to the filter, check if the problem
     // is maybe locally infeasible
 
+    if (status==CONTINUE && infeasibility_certificate_) {
+      Number bound;
+      if (LagrangianLowerBound(resto_ipopt_nlp->OrigIpNLP(), *cx->GetComp(0),
+                               *IpData().curr()->y_c(),
+                               *IpData().curr()->y_d(),
+                               0., NULL,
+                               *orig_ip_cq->trial_c(), *orig_ip_cq->trial_d(),
+                               *orig_ip_cq->trial_jac_c(),
+                               *orig_ip_cq->trial_jac_d(),
+                               bound)) {
+        Jnlst().Printf(J_DETAILED, J_MAIN,
+                       "Lower bound on weighted constraint violation = %8.2e\n",
+                       bound);
+        if (bound > orig_ip_data->tol()) {
+          first_resto_iter_ = false;
+          THROW_EXCEPTION(LOCALLY_INFEASIBLE,
+                          "Restoration phase multipliers certify local infeasibility");
+        }
+      }
+    }
+
     if (status==CONTINUE) {
       Jnlst().Printf(J_DETAILED, J_MAIN,
                      "Checking convergence for restoration phase problem...\n");
@@ -83,6 +83,9 @@ namespace Ipopt
     Index maximum_resto_iters_;
     /** Constraint violation tolerance for original algorithm */
     Number orig_constr_viol_tol_;
+    /** Flag indicating whether the restoration phase multipliers
+     *  should be tested for a certificate of infeasibility */
+    bool infeasibility_certificate_;
     //@}
 
     /** Flag indicating that this is the first call.  We don't want to
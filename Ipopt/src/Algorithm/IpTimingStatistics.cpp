@@ -35,12 +35,117 @@ namespace Ipopt
     LinearSystemStructureConverterInit_.Reset();
     QualityFunctionSearch_.Reset();
     TryCorrector_.Reset();
+    KKTAssembly_.Reset();
+    RestorationPhase_.Reset();
+    InertiaCorrection_.Reset();
     Task1_.Reset();
     Task2_.Reset();
     Task3_.Reset();
     Task4_.Reset();
     Task5_.Reset();
     Task6_.Reset();
+    inertia_corrections_ = 0;
+    phase_trace_.clear();
+  }
+
+  void
+  TimingStatistics::GetPhaseTotals(Number function_evaluation_time,
+                                   IterationPhaseTimes& totals) const
+  {
+    totals.function_evaluations = function_evaluation_time;
+    totals.kkt_assembly = KKTAssembly_.TotalWallclockTime();
+    totals.symbolic_factorization =
+      LinearSystemSymbolicFactorization_.TotalWallclockTime();
+    totals.numeric_factorization =
+      LinearSystemFactorization_.TotalWallclockTime();
+    totals.backsolve = LinearSystemBackSolve_.TotalWallclockTime();
+    totals.line_search = ComputeAcceptableTrialPoint_.TotalWallclockTime();
+    totals.restoration = RestorationPhase_.TotalWallclockTime();
+    totals.inertia_correction = InertiaCorrection_.TotalWallclockTime();
+    totals.inertia_corrections = inertia_corrections_;
+  }
+
+  void
+  TimingStatistics::StartPhaseTrace(Number function_evaluation_time)
+  {
+    phase_trace_.clear();
+    GetPhaseTotals(function_evaluation_time, phase_totals_);
+    phase_walltime_ = WallclockTime();
+  }
+
+  void
+  TimingStatistics::RecordIterationPhases(Index iter,
+                                          Number function_evaluation_time)
+  {
+    IterationPhaseTimes totals;
+    GetPhaseTotals(function_evaluation_time, totals);
+    Number walltime = WallclockTime();
+
+    IterationPhaseTimes rec;
+    rec.iter = iter;
+    rec.total = walltime - phase_walltime_;
+    rec.function_evaluations =
+      totals.function_evaluations - phase_totals_.function_evaluations;
+    rec.kkt_assembly = totals.kkt_assembly - phase_totals_.kkt_assembly;
+    rec.symbolic_factorization =
+      totals.symbolic_factorization - phase_totals_.symbolic_factorization;
+    rec.numeric_factorization =
+      totals.numeric_factorization - phase_totals_.numeric_factorization;
+    rec.backsolve = totals.backsolve - phase_totals_.backsolve;
+    rec.line_search = totals.line_search - phase_totals_.line_search;
+    rec.restoration = totals.restoration - phase_totals_.restoration;
+    rec.inertia_correction =
+      totals.inertia_correction - phase_totals_.inertia_correction;
+    rec.inertia_corrections =
+      totals.inertia_corrections - phase_totals_.inertia_corrections;
+    phase_trace_.push_back(rec);
+
+    phase_totals_ = totals;
+    phase_walltime_ = walltime;
+  }
+
+  void
+  TimingStatistics::WritePhaseTrace(FILE* fp, bool json, bool header,
+                                    Index solve, Index status) const
+  {
+    if (!json) {
+      if (header) {
+        fprintf(fp, "solve,status,iter,total,function_evaluations,"
+                "kkt_assembly,symbolic_factorization,numeric_factorization,"
+                "backsolve,line_search,restoration,inertia_correction,"
+                "inertia_corrections\n");
+      }
+      for (std::vector<IterationPhaseTimes>::const_iterator
+           it = phase_trace_.begin(); it != phase_trace_.end(); it++) {
+        fprintf(fp, "%d,%d,%d,%.6e,%.6e,%.6e,%.6e,%.6e,%.6e,%.6e,%.6e,%.6e,%d\n",
+                solve, status, it->iter, it->total, it->function_evaluations,
+                it->kkt_assembly, it->symbolic_factorization,
+                it->numeric_factorization, it->backsolve, it->line_search,
+                it->restoration, it->inertia_correction,
+                it->inertia_corrections);
+      }
+      return;
+    }
+
+    // One JSON object per solve, with the records in an array of
+    // objects, all on one line (JSON Lines)
+    fprintf(fp, "{\"solve\":%d,\"status\":%d,\"iterations\":[", solve, status);
+    for (std::vector<IterationPhaseTimes>::const_iterator
+         it = phase_trace_.begin(); it != phase_trace_.end(); it++) {
+      fprintf(fp, "%s{\"iter\":%d,\"total\":%.6e,"
+              "\"function_evaluations\":%.6e,\"kkt_assembly\":%.6e,"
+              "\"symbolic_factorization\":%.6e,"
+              "\"numeric_factorization\":%.6e,\"backsolve\":%.6e,"
+              "\"line_search\":%.6e,\"restoration\":%.6e,"
+              "\"inertia_correction\":%.6e,\"inertia_corrections\":%d}",
+              it == phase_trace_.begin() ? "" : ",",
+              it->iter, it->total, it->function_evaluations,
+              it->kkt_assembly, it->symbolic_factorization,
+              it->numeric_factorization, it->backsolve, it->line_search,
+              it->restoration, it->inertia_correction,
+              it->inertia_corrections);
+    }
+    fprintf(fp, "]}\n");
   }
 
   void
@@ -163,6 +268,24 @@ namespace Ipopt
                  TryCorrector_.TotalCpuTime(),
                  TryCorrector_.TotalSysTime(),
                  TryCorrector_.TotalWallclockTime());
+    jnlst.Printf(level, category,
+                 "KKTAssembly.........................: %10.3f (sys: %10.3f wall: %10.3f)\n",
+                 KKTAssembly_.TotalCpuTime(),
+                 KKTAssembly_.TotalSysTime(),
+                 KKTAssembly_.TotalWallclockTime());
+    jnlst.Printf(level, category,
+                 "RestorationPhase....................: %10.3f (sys: %10.3f wall: %10.3f)\n",
+                 RestorationPhase_.TotalCpuTime(),
+                 RestorationPhase_.TotalSysTime(),
+                 RestorationPhase_.TotalWallclockTime());
+    jnlst.Printf(level, category,
+                 "InertiaCorrection...................: %10.3f (sys: %10.3f wall: %10.3f)\n",
+                 InertiaCorrection_.TotalCpuTime(),
+                 InertiaCorrection_.TotalSysTime(),
+                 InertiaCorrection_.TotalWallclockTime());
+    jnlst.Printf(level, category,
+                 " (number of inertia corrections.....: %10d)\n",
+                 inertia_corrections_);
     jnlst.Printf(level, category,
                  "Task1...............................: %10.3f (sys: %10.3f wall: %10.3f)\n",
                  Task1_.TotalCpuTime(),
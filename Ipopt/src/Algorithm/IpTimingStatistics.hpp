@@ -13,8 +13,45 @@
 #include "IpJournalist.hpp"
 #include "IpTimedTask.hpp"
 
+#include <vector>
+
 namespace Ipopt
 {
+  /** Wall clock times (in seconds) spent in the main phases of one
+   *  iteration of the algorithm.  The phases overlap: the function
+   *  evaluations are also part of the line search and of the
+   *  restoration phase, and the inertia corrections are part of the
+   *  factorization times. */
+  struct IterationPhaseTimes
+  {
+    /** Iteration number */
+    Index iter;
+    /** Total time of the iteration */
+    Number total;
+    /** Evaluation of the problem functions and derivatives */
+    Number function_evaluations;
+    /** Transfer of the KKT matrix values to the linear solver */
+    Number kkt_assembly;
+    /** Symbolic factorization of the KKT matrix */
+    Number symbolic_factorization;
+    /** Numerical factorization of the KKT matrix */
+    Number numeric_factorization;
+    /** Solves with the factorized KKT matrix */
+    Number backsolve;
+    /** Computation of the trial point (line search), including the
+     *  restoration phase */
+    Number line_search;
+    /** Restoration phase.  The restoration phase has its own timing
+     *  statistics, so its linear algebra is not included in the
+     *  times of the KKT matrix above. */
+    Number restoration;
+    /** Factorizations repeated with a modified matrix because the
+     *  inertia was wrong or the matrix was singular */
+    Number inertia_correction;
+    /** Number of those repeated factorizations */
+    Index inertia_corrections;
+  };
+
   /** This class collects all timing statistics for Ipopt.
    */
   class TimingStatistics : public ReferencedObject
@@ -24,6 +61,9 @@ namespace Ipopt
     //@{
     /** Default constructor. */
     TimingStatistics()
+        :
+        inertia_corrections_(0),
+        phase_trace_enabled_(false)
     {}
 
     /** Default destructor */
@@ -39,6 +79,50 @@ namespace Ipopt
                                   EJournalLevel level,
                                   EJournalCategory category) const;
 
+    /**@name Per-iteration trace of the time spent in the main phases
+     *  of the algorithm. */
+    //@{
+    /** Switch the recording of the trace on or off. */
+    void EnablePhaseTrace(bool enable)
+    {
+      phase_trace_enabled_ = enable;
+    }
+    bool PhaseTraceEnabled() const
+    {
+      return phase_trace_enabled_;
+    }
+    /** Start a new trace.  The argument is the wall clock time spent
+     *  in function evaluations so far. */
+    void StartPhaseTrace(Number function_evaluation_time);
+    /** Add the record for iteration iter, which contains the time
+     *  spent since the last call of this method or of
+     *  StartPhaseTrace.  The argument is the wall clock time spent in
+     *  function evaluations so far. */
+    void RecordIterationPhases(Index iter, Number function_evaluation_time);
+    /** The records of all iterations so far. */
+    const std::vector<IterationPhaseTimes>& PhaseTrace() const
+    {
+      return phase_trace_;
+    }
+    /** Write the trace to fp.  In CSV format, one line is written for
+     *  each iteration, and the header is written if header is true.
+     *  In JSON format, the whole trace is written as one object on one
+     *  line.  solve and status identify the optimization run. */
+    void WritePhaseTrace(FILE* fp, bool json, bool header, Index solve,
+                         Index status) const;
+    //@}
+
+    /** Count one factorization repeated for inertia correction. */
+    void AddInertiaCorrection()
+    {
+      inertia_corrections_++;
+    }
+    /** Number of factorizations repeated for inertia correction. */
+    Index NumberOfInertiaCorrections() const
+    {
+      return inertia_corrections_;
+    }
+
     /**@name Accessor methods to all timed tasks. */
     //@{
     TimedTask& OverallAlgorithm()
@@ -130,6 +214,18 @@ namespace Ipopt
     {
       return TryCorrector_;
     }
+    TimedTask& KKTAssembly()
+    {
+      return KKTAssembly_;
+    }
+    TimedTask& RestorationPhase()
+    {
+      return RestorationPhase_;
+    }
+    TimedTask& InertiaCorrection()
+    {
+      return InertiaCorrection_;
+    }
 
     TimedTask& Task1()
     {
@@ -198,6 +294,9 @@ namespace Ipopt
     TimedTask LinearSystemStructureConverterInit_;
     TimedTask QualityFunctionSearch_;
     TimedTask TryCorrector_;
+    TimedTask KKTAssembly_;
+    TimedTask RestorationPhase_;
+    TimedTask InertiaCorrection_;
 
     TimedTask Task1_;
     TimedTask Task2_;
@@ -206,6 +305,23 @@ namespace Ipopt
     TimedTask Task5_;
     TimedTask Task6_;
     //@}
+
+    /** Number of factorizations repeated for inertia correction */
+    Index inertia_corrections_;
+
+    /**@name Data for the per-iteration trace */
+    //@{
+    bool phase_trace_enabled_;
+    std::vector<IterationPhaseTimes> phase_trace_;
+    /** Accumulated times at the end of the last recorded iteration */
+    IterationPhaseTimes phase_totals_;
+    /** Wall clock time at the end of the last recorded iteration */
+    Number phase_walltime_;
+    //@}
+
+    /** Fill totals with the accumulated times of the phases */
+    void GetPhaseTotals(Number function_evaluation_time,
+                        IterationPhaseTimes& totals) const;
   };
 
 } // namespace Ipopt
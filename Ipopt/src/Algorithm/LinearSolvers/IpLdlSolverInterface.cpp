@@ -0,0 +1,1360 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#include "IpoptConfig.h"
+#include "IpLdlSolverInterface.hpp"
+#include "IpBlas.hpp"
+
+#include <algorithm>
+
+#ifdef HAVE_CMATH
+# include <cmath>
+#else
+# ifdef HAVE_MATH_H
+#  include <math.h>
+# else
+#  error "don't have header file for math"
+# endif
+#endif
+
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+namespace Ipopt
+{
+#if COIN_IPOPT_VERBOSITY > 0
+  static const Index dbg_verbosity = 0;
+#endif
+
+  struct LdlSolverInterface::SupernodeFactor
+  {
+    /** Rows of the front (permuted indices).  The first nelim are the
+     *  pivots in the order they have been eliminated, followed by the
+     *  delayed columns and the rows below the supernode. */
+    std::vector<Index> rows;
+    /** Number of eliminated columns */
+    Index nelim;
+    /** Number of delayed columns (passed to the parent) */
+    Index ndelay;
+    /** Number of negative eigenvalues of the pivots */
+    Index negevals;
+    /** Flag indicating that the front could not be factorized */
+    bool singular;
+    /** Unit lower triangular factor, rows.size() x nelim, column major */
+    std::vector<double> L;
+    /** Diagonal of D */
+    std::vector<double> d;
+    /** Subdiagonal of D (nonzero only for the first column of 2x2
+     *  pivots) */
+    std::vector<double> e;
+    /** Pivot type: 1 for 1x1 pivots, 2 for the first and 0 for the
+     *  second column of 2x2 pivots */
+    std::vector<char> piv;
+    /** Lower triangle of the contribution block (column major) */
+    std::vector<double> contrib;
+  };
+
+  struct LdlSolverInterface::FrontWorkspace
+  {
+    /** Dense frontal matrix */
+    std::vector<double> F;
+    /** Pivot columns before scaling by D^{-1} */
+    std::vector<double> W;
+    /** Position of the rows of the current front */
+    std::vector<Index> map;
+  };
+
+  LdlSolverInterface::LdlSolverInterface()
+      :
+      dim_(0),
+      nonzeros_(0),
+      negevals_(-1),
+      ndelayed_(0),
+      initialized_(false),
+      analyzed_(false),
+      pivtol_changed_(false),
+      refactorize_(false),
+      nsuper_(0),
+      factors_(NULL)
+  {
+    DBG_START_METH("LdlSolverInterface::LdlSolverInterface()",dbg_verbosity);
+  }
+
+  LdlSolverInterface::~LdlSolverInterface()
+  {
+    DBG_START_METH("LdlSolverInterface::~LdlSolverInterface()",
+                   dbg_verbosity);
+    delete [] factors_;
+  }
+
+  void LdlSolverInterface::RegisterOptions(SmartPtr<RegisteredOptions> roptions)
+  {
+    roptions->AddBoundedNumberOption(
+      "ldl_pivtol",
+      "Pivot tolerance for the built-in linear solver.",
+      0.0, true, 0.5, false, 1e-6,
+      "A smaller number pivots for sparsity, a larger number pivots for "
+      "stability.  Columns that can not be pivoted on with this tolerance "
+      "are delayed to the parent front.");
+    roptions->AddBoundedNumberOption(
+      "ldl_pivtolmax",
+      "Maximum pivot tolerance for the built-in linear solver.",
+      0.0, true, 0.5, false, 1e-2,
+      "Ipopt may increase pivtol as high as pivtolmax to get a more accurate "
+      "solution to the linear system.");
+    roptions->AddLowerBoundedIntegerOption(
+      "ldl_nemin",
+      "Node amalgamation parameter of the built-in linear solver.",
+      1, 16,
+      "Two nodes in the elimination tree are merged if they both have fewer "
+      "than this number of columns.");
+    roptions->AddLowerBoundedIntegerOption(
+      "ldl_num_threads",
+      "Number of threads used by the built-in linear solver.",
+      0, 0,
+      "Independent fronts of the elimination tree are factorized in "
+      "parallel.  The value 0 uses the OpenMP default.  This option only "
+      "has an effect if Ipopt has been compiled with OpenMP.");
+  }
+
+  bool LdlSolverInterface::InitializeImpl(const OptionsList& options,
+                                          const std::string& prefix)
+  {
+    options.GetNumericValue("ldl_pivtol", pivtol_, prefix);
+    if (options.GetNumericValue("ldl_pivtolmax", pivtolmax_, prefix)) {
+      ASSERT_EXCEPTION(pivtolmax_>=pivtol_, OPTION_INVALID,
+                       "Option \"ldl_pivtolmax\": This value must be between "
+                       "ldl_pivtol and 0.5.");
+    }
+    else {
+      pivtolmax_ = Max(pivtolmax_, pivtol_);
+    }
+    options.GetIntegerValue("ldl_nemin", nemin_, prefix);
+    options.GetIntegerValue("ldl_num_threads", num_threads_, prefix);
+    // The following option is registered by OrigIpoptNLP
+    options.GetBoolValue("warm_start_same_structure",
+                         warm_start_same_structure_, prefix);
+
+    // Reset all private data
+    initialized_ = false;
+    pivtol_changed_ = false;
+    refactorize_ = false;
+
+    if (!warm_start_same_structure_) {
+      dim_=0;
+      nonzeros_=0;
+    }
+    else {
+      ASSERT_EXCEPTION(dim_>0 && nonzeros_>0, INVALID_WARMSTART,
+                       "LdlSolverInterface called with warm_start_same_structure, but the problem is solved for the first time.");
+    }
+
+    return true;
+  }
+
+  ESymSolverStatus LdlSolverInterface::MultiSolve(bool new_matrix,
+      const Index* airn,
+      const Index* ajcn,
+      Index nrhs,
+      double* rhs_vals,
+      bool check_NegEVals,
+      Index numberOfNegEVals)
+  {
+    DBG_START_METH("LdlSolverInterface::MultiSolve",dbg_verbosity);
+    DBG_ASSERT(!check_NegEVals || ProvidesInertia());
+    DBG_ASSERT(initialized_);
+
+    if (pivtol_changed_) {
+      DBG_PRINT((1,"Pivot tolerance has changed.\n"));
+      pivtol_changed_ = false;
+      // If the pivot tolerance has been changed but the matrix is not
+      // new, we have to request the values for the matrix again to do
+      // the factorization again.
+      if (!new_matrix) {
+        DBG_PRINT((1,"Ask caller to call again.\n"));
+        refactorize_ = true;
+        return SYMSOLVER_CALL_AGAIN;
+      }
+    }
+
+    // check if a factorization has to be done
+    DBG_PRINT((1, "new_matrix = %d\n", new_matrix));
+    if (new_matrix || refactorize_) {
+      ESymSolverStatus retval;
+      // The ordering depends on which diagonal entries are zero, so
+      // it is computed with the first matrix.
+      if (!analyzed_) {
+        retval = SymbolicFactorization(airn, ajcn);
+        if (retval != SYMSOLVER_SUCCESS) {
+          return retval;
+        }
+        analyzed_ = true;
+      }
+      retval = Factorization(check_NegEVals, numberOfNegEVals);
+      if (retval!=SYMSOLVER_SUCCESS) {
+        DBG_PRINT((1, "FACTORIZATION FAILED!\n"));
+        return retval;  // Matrix singular or error occurred
+      }
+      refactorize_ = false;
+    }
+
+    // do the backsolve
+    return Backsolve(nrhs, rhs_vals);
+  }
+
+  double* LdlSolverInterface::GetValuesArrayPtr()
+  {
+    DBG_START_METH("LdlSolverInterface::GetValuesArrayPtr",dbg_verbosity);
+    DBG_ASSERT(initialized_);
+    return nonzeros_ > 0 ? &a_[0] : NULL;
+  }
+
+  ESymSolverStatus LdlSolverInterface::InitializeStructure(Index dim, Index nonzeros,
+      const Index* airn,
+      const Index* ajcn)
+  {
+    DBG_START_METH("LdlSolverInterface::InitializeStructure",dbg_verbosity);
+
+    ESymSolverStatus retval = SYMSOLVER_SUCCESS;
+    if (!warm_start_same_structure_) {
+      dim_ = dim;
+      nonzeros_ = nonzeros;
+      a_.resize(nonzeros_);
+
+      // The symbolic factorization is done with the first matrix
+      analyzed_ = false;
+    }
+    else {
+      ASSERT_EXCEPTION(dim_==dim && nonzeros_==nonzeros, INVALID_WARMSTART,
+                       "LdlSolverInterface called with warm_start_same_structure, but the problem size has changed.");
+    }
+
+    initialized_ = true;
+
+    return retval;
+  }
+
+  void LdlSolverInterface::ComputeOrdering(Index n,
+      const std::vector<Index>& adj_ptr,
+      const std::vector<Index>& adj,
+      const std::vector<bool>& zero_diag,
+      std::vector<Index>& perm)
+  {
+    DBG_START_FUN("LdlSolverInterface::ComputeOrdering",dbg_verbosity);
+
+    // Minimum degree on the quotient graph: eliminated nodes become
+    // elements, and the degree of a variable is approximated by the
+    // number of its variable neighbours plus the sizes of its
+    // adjacent elements (without the current pivot element) as in
+    // AMD.  Dense rows are ordered last.  A node with a zero diagonal
+    // (like the constraint rows of a KKT system) only becomes
+    // eligible once one of its neighbours has been eliminated, so that
+    // its pivot is not structurally zero.
+    enum NodeStatus {VARIABLE, ELEMENT, ABSORBED, DENSE};
+    std::vector<char> status(n, VARIABLE);
+    std::vector<std::vector<Index> > A(n);   // variable neighbours
+    std::vector<std::vector<Index> > E(n);   // element neighbours
+    std::vector<std::vector<Index> > Le(n);  // variables of an element
+    std::vector<Index> deg(n);
+    std::vector<Index> mark(n, -1);
+    std::vector<Index> ext(n, 0);
+    std::vector<Index> ext_mark(n, -1);
+
+    const Index dense = Max(Index(16), Index(10.*sqrt(double(n))));
+    std::vector<Index> dense_nodes;
+    for (Index i=0; i<n; i++) {
+      if (adj_ptr[i+1]-adj_ptr[i] > dense) {
+        status[i] = DENSE;
+        dense_nodes.push_back(i);
+      }
+    }
+    for (Index i=0; i<n; i++) {
+      if (status[i] == DENSE) {
+        continue;
+      }
+      for (Index k=adj_ptr[i]; k<adj_ptr[i+1]; k++) {
+        if (status[adj[k]] != DENSE) {
+          A[i].push_back(adj[k]);
+        }
+      }
+      deg[i] = (Index)A[i].size();
+    }
+
+    // Degree buckets (doubly linked lists)
+    std::vector<Index> head(n+1, -1);
+    std::vector<Index> next(n, -1);
+    std::vector<Index> prev(n, -1);
+    Index mindeg = n;
+    std::vector<bool> eligible(n, false);
+    Index neligible = 0;
+    for (Index i=0; i<n; i++) {
+      if (status[i] == VARIABLE && !zero_diag[i]) {
+        eligible[i] = true;
+        neligible++;
+        next[i] = head[deg[i]];
+        if (next[i] >= 0) {
+          prev[next[i]] = i;
+        }
+        head[deg[i]] = i;
+        mindeg = Min(mindeg, deg[i]);
+      }
+    }
+
+    perm.clear();
+    perm.reserve(n);
+    Index remaining = n - (Index)dense_nodes.size();
+    std::vector<Index> Lp;
+    for (Index step=0; remaining>0; step++) {
+      if (neligible == 0) {
+        // Only nodes with zero diagonal and no eliminated neighbour are
+        // left; release them all
+        for (Index i=0; i<n; i++) {
+          if (status[i] == VARIABLE) {
+            eligible[i] = true;
+            neligible++;
+            prev[i] = -1;
+            next[i] = head[deg[i]];
+            if (next[i] >= 0) {
+              prev[next[i]] = i;
+            }
+            head[deg[i]] = i;
+            mindeg = Min(mindeg, deg[i]);
+          }
+        }
+      }
+      while (head[mindeg] < 0) {
+        mindeg++;
+      }
+      const Index p = head[mindeg];
+      head[mindeg] = next[p];
+      if (next[p] >= 0) {
+        prev[next[p]] = -1;
+      }
+      perm.push_back(p);
+      remaining--;
+      neligible--;
+
+      // Construct the new element
+      Lp.clear();
+      mark[p] = step;
+      for (size_t k=0; k<A[p].size(); k++) {
+        Index v = A[p][k];
+        if (status[v] == VARIABLE && mark[v] != step) {
+          mark[v] = step;
+          Lp.push_back(v);
+        }
+      }
+      for (size_t k=0; k<E[p].size(); k++) {
+        Index e = E[p][k];
+        if (status[e] != ELEMENT) {
+          continue;
+        }
+        for (size_t l=0; l<Le[e].size(); l++) {
+          Index v = Le[e][l];
+          if (status[v] == VARIABLE && mark[v] != step) {
+            mark[v] = step;
+            Lp.push_back(v);
+          }
+        }
+        status[e] = ABSORBED;
+        std::vector<Index>().swap(Le[e]);
+      }
+      status[p] = ELEMENT;
+      std::vector<Index>().swap(A[p]);
+      std::vector<Index>().swap(E[p]);
+      Le[p] = Lp;
+
+      // Remove the neighbours from the degree lists and compute the
+      // external sizes |Le \ Lp| of the elements adjacent to them
+      for (size_t k=0; k<Lp.size(); k++) {
+        Index i = Lp[k];
+        if (!eligible[i]) {
+          eligible[i] = true;
+          neligible++;
+        }
+        else {
+          if (prev[i] >= 0) {
+            next[prev[i]] = next[i];
+          }
+          else {
+            head[deg[i]] = next[i];
+          }
+          if (next[i] >= 0) {
+            prev[next[i]] = prev[i];
+          }
+        }
+        for (size_t l=0; l<E[i].size(); l++) {
+          Index e = E[i][l];
+          if (status[e] != ELEMENT || ext_mark[e] == step) {
+            continue;
+          }
+          ext_mark[e] = step;
+          std::vector<Index>& le = Le[e];
+          Index nalive = 0;
+          Index next_ext = 0;
+          for (size_t q=0; q<le.size(); q++) {
+            Index v = le[q];
+            if (status[v] == VARIABLE) {
+              le[nalive++] = v;
+              if (mark[v] != step) {
+                next_ext++;
+              }
+            }
+          }
+          le.resize(nalive);
+          ext[e] = next_ext;
+        }
+      }
+
+      // Update the neighbours
+      const Index lp_ext = (Index)Lp.size() - 1;
+      for (size_t k=0; k<Lp.size(); k++) {
+        Index i = Lp[k];
+        Index d = lp_ext;
+        Index ne = 0;
+        for (size_t l=0; l<E[i].size(); l++) {
+          Index e = E[i][l];
+          if (status[e] != ELEMENT) {
+            continue;
+          }
+          if (ext[e] == 0) {
+            // Aggressive absorption: e is a subset of the new element
+            status[e] = ABSORBED;
+            std::vector<Index>().swap(Le[e]);
+            continue;
+          }
+          d += ext[e];
+          E[i][ne++] = e;
+        }
+        E[i].resize(ne);
+        E[i].push_back(p);
+        Index na = 0;
+        for (size_t l=0; l<A[i].size(); l++) {
+          Index v = A[i][l];
+          if (status[v] == VARIABLE && mark[v] != step) {
+            A[i][na++] = v;
+          }
+        }
+        A[i].resize(na);
+        d = Min(d + na, remaining - 1);
+        deg[i] = d;
+        prev[i] = -1;
+        next[i] = head[d];
+        if (next[i] >= 0) {
+          prev[next[i]] = i;
+        }
+        head[d] = i;
+        mindeg = Min(mindeg, d);
+      }
+    }
+
+    for (size_t k=0; k<dense_nodes.size(); k++) {
+      perm.push_back(dense_nodes[k]);
+    }
+  }
+
+  ESymSolverStatus LdlSolverInterface::SymbolicFactorization(const Index* airn,
+      const Index* ajcn)
+  {
+    DBG_START_METH("LdlSolverInterface::SymbolicFactorization",dbg_verbosity);
+
+    if (HaveIpData()) {
+      IpData().TimingStats().LinearSystemSymbolicFactorization().Start();
+    }
+
+    const Index n = dim_;
+
+    // Adjacency structure of the graph of the matrix
+    std::vector<Index> adj_ptr(n+1, 0);
+    for (Index k=0; k<nonzeros_; k++) {
+      Index i = airn[k]-1;
+      Index j = ajcn[k]-1;
+      if (i<0 || i>=n || j<0 || j>=n) {
+        Jnlst().Printf(J_ERROR, J_LINEAR_ALGEBRA,
+                       "The index of a matrix is out of range.\nPlease check your implementation of the Jacobian and Hessian matrices.\n");
+        if (HaveIpData()) {
+          IpData().TimingStats().LinearSystemSymbolicFactorization().End();
+        }
+        return SYMSOLVER_FATAL_ERROR;
+      }
+      if (i != j) {
+        adj_ptr[i+1]++;
+        adj_ptr[j+1]++;
+      }
+    }
+    for (Index i=0; i<n; i++) {
+      adj_ptr[i+1] += adj_ptr[i];
+    }
+    std::vector<Index> adj(adj_ptr[n]);
+    {
+      std::vector<Index> pos(adj_ptr.begin(), adj_ptr.end()-1);
+      for (Index k=0; k<nonzeros_; k++) {
+        Index i = airn[k]-1;
+        Index j = ajcn[k]-1;
+        if (i != j) {
+          adj[pos[i]++] = j;
+          adj[pos[j]++] = i;
+        }
+      }
+      // Remove duplicate entries
+      Index nnz = 0;
+      Index start = 0;
+      for (Index i=0; i<n; i++) {
+        std::sort(adj.begin()+start, adj.begin()+adj_ptr[i+1]);
+        Index end = adj_ptr[i+1];
+        adj_ptr[i] = nnz;
+        for (Index k=start; k<end; k++) {
+          if (k == start || adj[k] != adj[k-1]) {
+            adj[nnz++] = adj[k];
+          }
+        }
+        start = end;
+      }
+      adj_ptr[n] = nnz;
+      adj.resize(nnz);
+    }
+
+    // Fill-reducing ordering
+    std::vector<bool> zero_diag(n, true);
+    for (Index k=0; k<nonzeros_; k++) {
+      if (airn[k] == ajcn[k] && a_[k] != 0.) {
+        zero_diag[airn[k]-1] = false;
+      }
+    }
+    ComputeOrdering(n, adj_ptr, adj, zero_diag, perm_);
+    std::vector<Index> iperm(n);
+    for (Index i=0; i<n; i++) {
+      iperm[perm_[i]] = i;
+    }
+
+    // Elimination tree of the permuted matrix
+    std::vector<Index> parent(n, -1);
+    {
+      std::vector<Index> ancestor(n, -1);
+      for (Index k=0; k<n; k++) {
+        const Index old = perm_[k];
+        for (Index l=adj_ptr[old]; l<adj_ptr[old+1]; l++) {
+          Index r = iperm[adj[l]];
+          if (r >= k) {
+            continue;
+          }
+          while (ancestor[r] != -1 && ancestor[r] != k) {
+            Index t = ancestor[r];
+            ancestor[r] = k;
+            r = t;
+          }
+          if (ancestor[r] == -1) {
+            ancestor[r] = k;
+            parent[r] = k;
+          }
+        }
+      }
+    }
+
+    // Postorder the tree so that the columns of a subtree are contiguous
+    {
+      std::vector<Index> first_child(n, -1);
+      std::vector<Index> sibling(n, -1);
+      for (Index j=n-1; j>=0; j--) {
+        if (parent[j] >= 0) {
+          sibling[j] = first_child[parent[j]];
+          first_child[parent[j]] = j;
+        }
+      }
+      std::vector<Index> post;
+      post.reserve(n);
+      std::vector<Index> stack;
+      for (Index root=0; root<n; root++) {
+        if (parent[root] != -1) {
+          continue;
+        }
+        stack.push_back(root);
+        while (!stack.empty()) {
+          Index j = stack.back();
+          if (first_child[j] >= 0) {
+            Index c = first_child[j];
+            first_child[j] = sibling[c];
+            stack.push_back(c);
+          }
+          else {
+            post.push_back(j);
+            stack.pop_back();
+          }
+        }
+      }
+      DBG_ASSERT((Index)post.size() == n);
+      std::vector<Index> new_perm(n);
+      std::vector<Index> new_parent(n);
+      for (Index t=0; t<n; t++) {
+        new_perm[t] = perm_[post[t]];
+        iperm[post[t]] = t;
+      }
+      for (Index t=0; t<n; t++) {
+        new_parent[t] = parent[post[t]] < 0 ? -1 : iperm[parent[post[t]]];
+      }
+      perm_.swap(new_perm);
+      parent.swap(new_parent);
+      for (Index i=0; i<n; i++) {
+        iperm[perm_[i]] = i;
+      }
+    }
+
+    // Column structures and fundamental supernodes
+    std::vector<Index> nchild(n, 0);
+    for (Index j=0; j<n; j++) {
+      if (parent[j] >= 0) {
+        nchild[parent[j]]++;
+      }
+    }
+    std::vector<Index> col_first_child(n, -1);
+    std::vector<Index> col_sibling(n, -1);
+    for (Index j=n-1; j>=0; j--) {
+      if (parent[j] >= 0) {
+        col_sibling[j] = col_first_child[parent[j]];
+        col_first_child[parent[j]] = j;
+      }
+    }
+    std::vector<std::vector<Index> > S(n);
+    std::vector<Index> count(n);
+    std::vector<Index> mark(n, -1);
+    std::vector<Index> fund_start;
+    std::vector<std::vector<Index> > fund_rows;
+    for (Index j=0; j<n; j++) {
+      std::vector<Index>& Sj = S[j];
+      mark[j] = j;
+      const Index old = perm_[j];
+      for (Index l=adj_ptr[old]; l<adj_ptr[old+1]; l++) {
+        Index i = iperm[adj[l]];
+        if (i > j && mark[i] != j) {
+          mark[i] = j;
+          Sj.push_back(i);
+        }
+      }
+      for (Index c=col_first_child[j]; c>=0; c=col_sibling[c]) {
+        for (size_t l=0; l<S[c].size(); l++) {
+          Index i = S[c][l];
+          if (mark[i] != j) {
+            mark[i] = j;
+            Sj.push_back(i);
+          }
+        }
+      }
+      std::sort(Sj.begin(), Sj.end());
+      count[j] = (Index)Sj.size();
+
+      bool same = j>0 && parent[j-1]==j && nchild[j]==1 &&
+                  count[j-1]==count[j]+1;
+      if (!same) {
+        if (j > 0) {
+          // S[j-1] is still needed by the parent of column j-1
+          fund_rows.push_back(S[j-1]);
+        }
+        fund_start.push_back(j);
+      }
+      for (Index c=col_first_child[j]; c>=0; c=col_sibling[c]) {
+        std::vector<Index>().swap(S[c]);
+      }
+    }
+    if (n > 0) {
+      fund_rows.push_back(std::vector<Index>());
+      fund_rows.back().swap(S[n-1]);
+    }
+    fund_start.push_back(n);
+    const Index nfund = (Index)fund_start.size()-1;
+
+    // Supernodal tree of the fundamental supernodes
+    std::vector<Index> col_sn(n);
+    for (Index s=0; s<nfund; s++) {
+      for (Index j=fund_start[s]; j<fund_start[s+1]; j++) {
+        col_sn[j] = s;
+      }
+    }
+    std::vector<Index> fund_parent(nfund);
+    for (Index s=0; s<nfund; s++) {
+      Index p = parent[fund_start[s+1]-1];
+      fund_parent[s] = p < 0 ? -1 : col_sn[p];
+    }
+
+    // Relaxed amalgamation: merge a supernode with its parent if the
+    // parent immediately follows it and both are small
+    sn_start_.clear();
+    sn_rows_ptr_.clear();
+    sn_rows_.clear();
+    std::vector<Index> fund_to_sn(nfund);
+    for (Index s=0; s<nfund; ) {
+      Index t = s;
+      while (t+1<nfund && fund_parent[t]==t+1 &&
+             fund_start[t+1]-fund_start[s] < nemin_ &&
+             fund_start[t+2]-fund_start[t+1] < nemin_) {
+        t++;
+      }
+      sn_start_.push_back(fund_start[s]);
+      sn_rows_ptr_.push_back((Index)sn_rows_.size());
+      sn_rows_.insert(sn_rows_.end(), fund_rows[t].begin(), fund_rows[t].end());
+      for (Index u=s; u<=t; u++) {
+        fund_to_sn[u] = (Index)sn_start_.size()-1;
+      }
+      s = t+1;
+    }
+    nsuper_ = (Index)sn_start_.size();
+    sn_start_.push_back(n);
+    sn_rows_ptr_.push_back((Index)sn_rows_.size());
+    std::vector<std::vector<Index> >().swap(fund_rows);
+
+    sn_parent_.resize(nsuper_);
+    for (Index s=0; s<nsuper_; s++) {
+      Index p = parent[sn_start_[s+1]-1];
+      sn_parent_[s] = p < 0 ? -1 : fund_to_sn[col_sn[p]];
+    }
+    for (Index s=0; s<nsuper_; s++) {
+      for (Index j=sn_start_[s]; j<sn_start_[s+1]; j++) {
+        col_sn[j] = s;
+      }
+    }
+
+    // Children and levels of the supernodal tree
+    sn_children_ptr_.assign(nsuper_+1, 0);
+    for (Index s=0; s<nsuper_; s++) {
+      if (sn_parent_[s] >= 0) {
+        sn_children_ptr_[sn_parent_[s]+1]++;
+      }
+    }
+    for (Index s=0; s<nsuper_; s++) {
+      sn_children_ptr_[s+1] += sn_children_ptr_[s];
+    }
+    sn_children_.resize(sn_children_ptr_[nsuper_]);
+    std::vector<Index> level(nsuper_, 0);
+    {
+      std::vector<Index> pos(sn_children_ptr_.begin(), sn_children_ptr_.end()-1);
+      for (Index s=0; s<nsuper_; s++) {
+        Index p = sn_parent_[s];
+        if (p >= 0) {
+          sn_children_[pos[p]++] = s;
+          level[p] = Max(level[p], level[s]+1);
+        }
+      }
+    }
+    Index nlevels = 0;
+    for (Index s=0; s<nsuper_; s++) {
+      nlevels = Max(nlevels, level[s]+1);
+    }
+    level_ptr_.assign(nlevels+1, 0);
+    for (Index s=0; s<nsuper_; s++) {
+      level_ptr_[level[s]+1]++;
+    }
+    for (Index l=0; l<nlevels; l++) {
+      level_ptr_[l+1] += level_ptr_[l];
+    }
+    level_sn_.resize(nsuper_);
+    {
+      std::vector<Index> pos(level_ptr_.begin(), level_ptr_.end()-1);
+      for (Index s=0; s<nsuper_; s++) {
+        level_sn_[pos[level[s]]++] = s;
+      }
+    }
+
+    // Position of the original entries in the fronts
+    sn_ent_ptr_.assign(nsuper_+1, 0);
+    for (Index k=0; k<nonzeros_; k++) {
+      Index c = Min(iperm[airn[k]-1], iperm[ajcn[k]-1]);
+      sn_ent_ptr_[col_sn[c]+1]++;
+    }
+    for (Index s=0; s<nsuper_; s++) {
+      sn_ent_ptr_[s+1] += sn_ent_ptr_[s];
+    }
+    ent_index_.resize(nonzeros_);
+    ent_row_.resize(nonzeros_);
+    ent_col_.resize(nonzeros_);
+    {
+      std::vector<Index> pos(sn_ent_ptr_.begin(), sn_ent_ptr_.end()-1);
+      for (Index k=0; k<nonzeros_; k++) {
+        Index i = iperm[airn[k]-1];
+        Index j = iperm[ajcn[k]-1];
+        Index r = Max(i, j);
+        Index c = Min(i, j);
+        Index s = col_sn[c];
+        Index ncol = sn_start_[s+1]-sn_start_[s];
+        Index e = pos[s]++;
+        ent_index_[e] = k;
+        ent_col_[e] = c - sn_start_[s];
+        if (r < sn_start_[s+1]) {
+          ent_row_[e] = r - sn_start_[s];
+        }
+        else {
+          const Index* rows = &sn_rows_[0] + sn_rows_ptr_[s];
+          const Index* end = &sn_rows_[0] + sn_rows_ptr_[s+1];
+          ent_row_[e] = ncol + (Index)(std::lower_bound(rows, end, r) - rows);
+          DBG_ASSERT(*std::lower_bound(rows, end, r) == r);
+        }
+      }
+    }
+
+    delete [] factors_;
+    factors_ = new SupernodeFactor[nsuper_];
+
+    Index nnzL = 0;
+    for (Index s=0; s<nsuper_; s++) {
+      Index ncol = sn_start_[s+1]-sn_start_[s];
+      Index nrow = sn_rows_ptr_[s+1]-sn_rows_ptr_[s];
+      nnzL += ncol*(ncol+1)/2 + ncol*nrow;
+    }
+    Jnlst().Printf(J_DETAILED, J_LINEAR_ALGEBRA,
+                   "LdlSolverInterface: %d supernodes (%d before amalgamation) in %d levels, predicted number of nonzeros in L: %d\n",
+                   nsuper_, nfund, nlevels, nnzL);
+
+    if (HaveIpData()) {
+      IpData().TimingStats().LinearSystemSymbolicFactorization().End();
+    }
+
+    return SYMSOLVER_SUCCESS;
+  }
+
+  /** Exchange rows and columns a and b (a<b) of the front F of size
+   *  m, of which the first p columns are stored completely. */
+  static void SymmetricSwap(std::vector<double>& F, Index m, Index p,
+                            Index a, Index b, std::vector<Index>& rows)
+  {
+    if (a == b) {
+      return;
+    }
+    for (Index c=0; c<p; c++) {
+      std::swap(F[a + c*m], F[b + c*m]);
+    }
+    double* Fa = &F[a*m];
+    double* Fb = &F[b*m];
+    for (Index i=0; i<m; i++) {
+      std::swap(Fa[i], Fb[i]);
+    }
+    std::swap(rows[a], rows[b]);
+  }
+
+  /** Largest absolute value in column j of F in rows [from, m) except
+   *  row j. */
+  static double ColumnMax(const std::vector<double>& F, Index m, Index j,
+                          Index from)
+  {
+    double cmax = 0.;
+    const double* Fj = &F[j*m];
+    for (Index i=from; i<m; i++) {
+      if (i != j) {
+        cmax = Max(cmax, fabs(Fj[i]));
+      }
+    }
+    return cmax;
+  }
+
+  void LdlSolverInterface::EliminatePivot(std::vector<double>& F,
+      std::vector<double>& W,
+      Index m, Index p, Index k,
+      Index pivsize, Index jpiv,
+      Index rpiv, Index wend,
+      SupernodeFactor& f) const
+  {
+    if (pivsize == 1) {
+      SymmetricSwap(F, m, p, k, jpiv, f.rows);
+      const double d = F[k + k*m];
+      double* Lk = &F[k*m];
+      double* Wk = &W[k*m];
+      for (Index i=k+1; i<m; i++) {
+        Wk[i] = Lk[i];
+        Lk[i] /= d;
+      }
+      for (Index j=k+1; j<wend; j++) {
+        const double wj = Wk[j];
+        if (wj != 0.) {
+          double* Fj = &F[j*m];
+          for (Index i=k+1; i<m; i++) {
+            Fj[i] -= Lk[i]*wj;
+          }
+        }
+      }
+      f.d[k] = d;
+      f.e[k] = 0.;
+      f.piv[k] = 1;
+      if (d < 0.) {
+        f.negevals++;
+      }
+    }
+    else {
+      // Bring the pair to positions k and k+1
+      Index j1 = Min(jpiv, rpiv);
+      Index j2 = Max(jpiv, rpiv);
+      SymmetricSwap(F, m, p, k, j1, f.rows);
+      SymmetricSwap(F, m, p, k+1, j2, f.rows);
+      const double a = F[k + k*m];
+      const double b = F[k+1 + k*m];
+      const double c = F[k+1 + (k+1)*m];
+      const double det = a*c - b*b;
+      double* L1 = &F[k*m];
+      double* L2 = &F[(k+1)*m];
+      double* W1 = &W[k*m];
+      double* W2 = &W[(k+1)*m];
+      for (Index i=k+2; i<m; i++) {
+        const double w1 = L1[i];
+        const double w2 = L2[i];
+        W1[i] = w1;
+        W2[i] = w2;
+        L1[i] = (c*w1 - b*w2)/det;
+        L2[i] = (a*w2 - b*w1)/det;
+      }
+      L1[k+1] = 0.;
+      W1[k+1] = 0.;
+      for (Index j=k+2; j<wend; j++) {
+        const double w1 = W1[j];
+        const double w2 = W2[j];
+        double* Fj = &F[j*m];
+        for (Index i=k+2; i<m; i++) {
+          Fj[i] -= L1[i]*w1 + L2[i]*w2;
+        }
+      }
+      f.d[k] = a;
+      f.d[k+1] = c;
+      f.e[k] = b;
+      f.e[k+1] = 0.;
+      f.piv[k] = 2;
+      f.piv[k+1] = 0;
+      if (det < 0.) {
+        f.negevals++;
+      }
+      else if (a + c < 0.) {
+        f.negevals += 2;
+      }
+    }
+  }
+
+  bool LdlSolverInterface::FactorizeSupernode(Index s, Number small,
+      FrontWorkspace& ws)
+  {
+    SupernodeFactor& f = factors_[s];
+    const Index first = sn_start_[s];
+    const Index ncol = sn_start_[s+1]-first;
+    const Index nstruct = sn_rows_ptr_[s+1]-sn_rows_ptr_[s];
+
+    // Rows of the front: own columns, columns delayed by the children
+    // and rows below the supernode
+    Index nd = 0;
+    for (Index l=sn_children_ptr_[s]; l<sn_children_ptr_[s+1]; l++) {
+      nd += factors_[sn_children_[l]].ndelay;
+    }
+    const Index m = ncol + nd + nstruct;
+    const Index p = ncol + nd;
+    f.rows.resize(m);
+    for (Index k=0; k<ncol; k++) {
+      f.rows[k] = first + k;
+    }
+    Index pos = ncol;
+    for (Index l=sn_children_ptr_[s]; l<sn_children_ptr_[s+1]; l++) {
+      const SupernodeFactor& fc = factors_[sn_children_[l]];
+      for (Index k=0; k<fc.ndelay; k++) {
+        f.rows[pos++] = fc.rows[fc.nelim+k];
+      }
+    }
+    for (Index k=0; k<nstruct; k++) {
+      f.rows[pos++] = sn_rows_[sn_rows_ptr_[s]+k];
+    }
+    for (Index k=0; k<m; k++) {
+      ws.map[f.rows[k]] = k;
+    }
+
+    // Assemble the lower triangle of the front
+    ws.F.assign((size_t)m*m, 0.);
+    ws.W.resize((size_t)m*p);
+    std::vector<double>& F = ws.F;
+    std::vector<double>& W = ws.W;
+    for (Index e=sn_ent_ptr_[s]; e<sn_ent_ptr_[s+1]; e++) {
+      Index r = ent_row_[e];
+      if (r >= ncol) {
+        r += nd;
+      }
+      F[r + ent_col_[e]*m] += a_[ent_index_[e]];
+    }
+    for (Index l=sn_children_ptr_[s]; l<sn_children_ptr_[s+1]; l++) {
+      SupernodeFactor& fc = factors_[sn_children_[l]];
+      const Index mc = (Index)fc.rows.size() - fc.nelim;
+      const Index* crows = mc > 0 ? &fc.rows[fc.nelim] : NULL;
+      for (Index jj=0; jj<mc; jj++) {
+        const Index lj = ws.map[crows[jj]];
+        const double* cj = &fc.contrib[jj*mc];
+        for (Index ii=jj; ii<mc; ii++) {
+          const Index li = ws.map[crows[ii]];
+          if (li >= lj) {
+            F[li + lj*m] += cj[ii];
+          }
+          else {
+            F[lj + li*m] += cj[ii];
+          }
+        }
+      }
+      std::vector<double>().swap(fc.contrib);
+    }
+    // The fully summed columns are stored completely
+    for (Index j=0; j<p; j++) {
+      for (Index i=0; i<j; i++) {
+        F[i + j*m] = F[j + i*m];
+      }
+    }
+
+    // Partial factorization of the fully summed columns.  Pivots are
+    // searched in a window of columns that is kept up to date; the
+    // columns right of the window are updated by blocks.  A root
+    // front has nowhere to delay columns to; after the threshold pass
+    // it accepts any nonzero pivot.
+    f.d.resize(p);
+    f.e.resize(p);
+    f.piv.resize(p);
+    f.negevals = 0;
+    f.singular = false;
+    const Index block_size = 32;
+    Index ne = 0;
+    const bool root = (sn_parent_[s] < 0);
+    for (Index pass=0; pass<(root ? 2 : 1) && ne<p; pass++) {
+      const Number u = (pass == 0) ? pivtol_ : 0.;
+      Index wstart = ne;
+      Index wend = Min(p, ne + block_size);
+      while (true) {
+        Index pivsize = 0;
+        Index jpiv = -1;
+        Index rpiv = -1;
+        for (Index j=ne; j<wend && pivsize==0; j++) {
+          const double ajj = F[j + j*m];
+          const double gamma = ColumnMax(F, m, j, ne);
+          if (fabs(ajj) > small && fabs(ajj) >= u*gamma) {
+            pivsize = 1;
+            jpiv = j;
+            break;
+          }
+          // Try a 2x2 pivot with the largest fully summed entry
+          Index r = -1;
+          double brj = 0.;
+          for (Index i=ne; i<wend; i++) {
+            if (i != j && fabs(F[i + j*m]) > brj) {
+              brj = fabs(F[i + j*m]);
+              r = i;
+            }
+          }
+          if (r < 0 || brj <= small) {
+            continue;
+          }
+          const double a = ajj;
+          const double b = F[r + j*m];
+          const double c = F[r + r*m];
+          const double det = a*c - b*b;
+          const double gamma_r = ColumnMax(F, m, r, ne);
+          if (fabs(det) > small*brj &&
+              u*(fabs(c)*gamma + brj*gamma_r) <= fabs(det) &&
+              u*(brj*gamma + fabs(a)*gamma_r) <= fabs(det)) {
+            pivsize = 2;
+            jpiv = j;
+            rpiv = r;
+          }
+        }
+        if (pivsize == 0 || ne + pivsize == wend) {
+          if (pivsize > 0) {
+            EliminatePivot(F, W, m, p, ne, pivsize, jpiv, rpiv, wend, f);
+            ne += pivsize;
+          }
+          // Update the columns right of the window and move it
+          if (ne > wstart && wend < p) {
+            IpBlasDgemm(false, true, m-ne, p-wend, ne-wstart, -1.,
+                        &F[ne + wstart*m], m, &W[wend + wstart*m], m,
+                        1., &F[ne + wend*m], m);
+          }
+          if (wend == p) {
+            break;
+          }
+          wstart = ne;
+          wend = Min(p, Max(wend, ne) + block_size);
+          continue;
+        }
+        EliminatePivot(F, W, m, p, ne, pivsize, jpiv, rpiv, wend, f);
+        ne += pivsize;
+      }
+    }
+    f.nelim = ne;
+    f.ndelay = p - ne;
+    if (root && f.ndelay > 0) {
+      f.singular = true;
+    }
+
+    // Update of the contribution block with the eliminated columns
+    if (ne > 0 && p < m) {
+      IpBlasDgemm(false, true, m-p, m-p, ne, -1., &F[p], m, &W[p], m,
+                  1., &F[p + p*m], m);
+    }
+
+    // Keep the factor and the contribution block for the parent
+    f.L.assign(F.begin(), F.begin() + (size_t)m*ne);
+    const Index mc = m - ne;
+    f.contrib.resize((size_t)mc*mc);
+    for (Index jj=0; jj<mc; jj++) {
+      const double* Fj = &F[ne + (ne+jj)*m];
+      double* cj = &f.contrib[jj*mc];
+      for (Index ii=jj; ii<mc; ii++) {
+        cj[ii] = Fj[ii];
+      }
+    }
+
+    return !f.singular;
+  }
+
+  ESymSolverStatus
+  LdlSolverInterface::Factorization(bool check_NegEVals,
+                                    Index numberOfNegEVals)
+  {
+    DBG_START_METH("LdlSolverInterface::Factorization",dbg_verbosity);
+    if (HaveIpData()) {
+      IpData().TimingStats().LinearSystemFactorization().Start();
+    }
+
+    // Pivots are treated as zero below an absolute threshold (as cntl(2)
+    // in MA57).  Scaling it with the largest entry rejects legitimate
+    // pivots once the barrier terms of nearly active bounds dominate amax.
+    const Number small = 1e-20;
+
+    Index nthreads = 1;
+#ifdef _OPENMP
+    nthreads = num_threads_ > 0 ? num_threads_ : omp_get_max_threads();
+#endif
+    std::vector<FrontWorkspace> ws(nthreads);
+    for (Index t=0; t<nthreads; t++) {
+      ws[t].map.resize(dim_);
+    }
+
+    const Index nlevels = (Index)level_ptr_.size()-1;
+    for (Index l=0; l<nlevels; l++) {
+      const Index begin = level_ptr_[l];
+      const Index end = level_ptr_[l+1];
+#ifdef _OPENMP
+      #pragma omp parallel for schedule(dynamic) num_threads(nthreads) if(nthreads > 1 && end-begin > 1)
+#endif
+      for (Index t=begin; t<end; t++) {
+        Index tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        FactorizeSupernode(level_sn_[t], small, ws[tid]);
+      }
+    }
+
+    negevals_ = 0;
+    ndelayed_ = 0;
+    bool singular = false;
+    for (Index s=0; s<nsuper_; s++) {
+      negevals_ += factors_[s].negevals;
+      if (sn_parent_[s] >= 0) {
+        ndelayed_ += factors_[s].ndelay;
+      }
+      singular = singular || factors_[s].singular;
+    }
+    Jnlst().Printf(J_MOREDETAILED, J_LINEAR_ALGEBRA,
+                   "LdlSolverInterface: %d delayed pivots, %d negative eigenvalues.\n",
+                   ndelayed_, negevals_);
+
+    if (HaveIpData()) {
+      IpData().TimingStats().LinearSystemFactorization().End();
+    }
+    if (singular) {
+      Jnlst().Printf(J_DETAILED, J_LINEAR_ALGEBRA,
+                     "LdlSolverInterface: matrix is singular.\n");
+      return SYMSOLVER_SINGULAR;
+    }
+    if (check_NegEVals && (numberOfNegEVals!=negevals_)) {
+      Jnlst().Printf(J_DETAILED, J_LINEAR_ALGEBRA,
+                     "In LdlSolverInterface::Factorization: negevals_ = %d, but numberOfNegEVals = %d\n",
+                     negevals_, numberOfNegEVals);
+      return SYMSOLVER_WRONG_INERTIA;
+    }
+
+    return SYMSOLVER_SUCCESS;
+  }
+
+  ESymSolverStatus LdlSolverInterface::Backsolve(Index nrhs,
+      double *rhs_vals)
+  {
+    DBG_START_METH("LdlSolverInterface::Backsolve",dbg_verbosity);
+    if (HaveIpData()) {
+      IpData().TimingStats().LinearSystemBackSolve().Start();
+    }
+
+    // The right hand sides are processed in blocks, so that each
+    // factor is read once per block and the updates with the
+    // off-diagonal parts are matrix-matrix products
+    const Index max_block = 16;
+    Index maxfront = 0;
+    for (Index s=0; s<nsuper_; s++) {
+      maxfront = Max(maxfront, (Index)factors_[s].rows.size());
+    }
+    const Index block = Min(nrhs, max_block);
+    solve_work_.resize((dim_ + maxfront)*block);
+    double* x = dim_ > 0 ? &solve_work_[0] : NULL;
+    double* y = maxfront > 0 ? &solve_work_[dim_*block] : NULL;
+
+    for (Index rhs0=0; rhs0<nrhs; rhs0+=block) {
+      const Index nb = Min(block, nrhs-rhs0);
+      for (Index r=0; r<nb; r++) {
+        const double* rhs = &rhs_vals[(rhs0+r)*dim_];
+        double* xr = &x[r*dim_];
+        for (Index i=0; i<dim_; i++) {
+          xr[i] = rhs[perm_[i]];
+        }
+      }
+
+      // Forward substitution with L
+      for (Index s=0; s<nsuper_; s++) {
+        const SupernodeFactor& f = factors_[s];
+        const Index m = (Index)f.rows.size();
+        const Index ne = f.nelim;
+        if (ne == 0) {
+          continue;
+        }
+        for (Index r=0; r<nb; r++) {
+          const double* xr = &x[r*dim_];
+          double* yr = &y[r*m];
+          for (Index k=0; k<m; k++) {
+            yr[k] = xr[f.rows[k]];
+          }
+          for (Index k=0; k<ne; k++) {
+            const double yk = yr[k];
+            if (yk != 0.) {
+              const double* Lk = &f.L[k*m];
+              for (Index i=k+1; i<ne; i++) {
+                yr[i] -= Lk[i]*yk;
+              }
+            }
+          }
+        }
+        if (m > ne) {
+          if (nb == 1) {
+            IpBlasDgemv(false, ne, m-ne, -1., &f.L[ne], m, y, 1, 1., &y[ne], 1);
+          }
+          else {
+            IpBlasDgemm(false, false, m-ne, nb, ne, -1., &f.L[ne], m, y, m,
+                        1., &y[ne], m);
+          }
+        }
+        for (Index r=0; r<nb; r++) {
+          double* xr = &x[r*dim_];
+          const double* yr = &y[r*m];
+          for (Index k=0; k<m; k++) {
+            xr[f.rows[k]] = yr[k];
+          }
+        }
+      }
+
+      // Solve with D
+      for (Index s=0; s<nsuper_; s++) {
+        const SupernodeFactor& f = factors_[s];
+        for (Index k=0; k<f.nelim; k++) {
+          if (f.piv[k] == 1) {
+            const double d = f.d[k];
+            const Index i = f.rows[k];
+            for (Index r=0; r<nb; r++) {
+              x[r*dim_ + i] /= d;
+            }
+          }
+          else {
+            const double a = f.d[k];
+            const double b = f.e[k];
+            const double c = f.d[k+1];
+            const double det = a*c - b*b;
+            const Index i1 = f.rows[k];
+            const Index i2 = f.rows[k+1];
+            for (Index r=0; r<nb; r++) {
+              double* xr = &x[r*dim_];
+              const double x1 = xr[i1];
+              const double x2 = xr[i2];
+              xr[i1] = (c*x1 - b*x2)/det;
+              xr[i2] = (a*x2 - b*x1)/det;
+            }
+            k++;
+          }
+        }
+      }
+
+      // Backward substitution with L^T
+      for (Index s=nsuper_-1; s>=0; s--) {
+        const SupernodeFactor& f = factors_[s];
+        const Index m = (Index)f.rows.size();
+        const Index ne = f.nelim;
+        if (ne == 0) {
+          continue;
+        }
+        for (Index r=0; r<nb; r++) {
+          const double* xr = &x[r*dim_];
+          double* yr = &y[r*m];
+          for (Index k=0; k<m; k++) {
+            yr[k] = xr[f.rows[k]];
+          }
+        }
+        if (m > ne) {
+          if (nb == 1) {
+            IpBlasDgemv(true, ne, m-ne, -1., &f.L[ne], m, &y[ne], 1, 1., y, 1);
+          }
+          else {
+            IpBlasDgemm(true, false, ne, nb, m-ne, -1., &f.L[ne], m, &y[ne], m,
+                        1., y, m);
+          }
+        }
+        for (Index r=0; r<nb; r++) {
+          double* xr = &x[r*dim_];
+          double* yr = &y[r*m];
+          for (Index k=ne-1; k>=0; k--) {
+            const double* Lk = &f.L[k*m];
+            double sum = 0.;
+            for (Index i=k+1; i<ne; i++) {
+              sum += Lk[i]*yr[i];
+            }
+            yr[k] -= sum;
+          }
+          for (Index k=0; k<ne; k++) {
+            xr[f.rows[k]] = yr[k];
+          }
+        }
+      }
+
+      for (Index r=0; r<nb; r++) {
+        double* rhs = &rhs_vals[(rhs0+r)*dim_];
+        const double* xr = &x[r*dim_];
+        for (Index i=0; i<dim_; i++) {
+          rhs[perm_[i]] = xr[i];
+        }
+      }
+    }
+
+    if (HaveIpData()) {
+      IpData().TimingStats().LinearSystemBackSolve().End();
+    }
+    return SYMSOLVER_SUCCESS;
+  }
+
+  Index LdlSolverInterface::NumberOfNegEVals() const
+  {
+    DBG_START_METH("LdlSolverInterface::NumberOfNegEVals",dbg_verbosity);
+    DBG_ASSERT(ProvidesInertia());
+    DBG_ASSERT(initialized_);
+    return negevals_;
+  }
+
+  bool LdlSolverInterface::IncreaseQuality()
+  {
+    DBG_START_METH("LdlSolverInterface::IncreaseQuality",dbg_verbosity);
+    if (pivtol_ == pivtolmax_) {
+      return false;
+    }
+    pivtol_changed_ = true;
+
+    Jnlst().Printf(J_DETAILED, J_LINEAR_ALGEBRA,
+                   "Increasing pivot tolerance for the built-in solver from %7.2e ",
+                   pivtol_);
+    pivtol_ = Min(pivtolmax_, pow(pivtol_,0.75));
+    Jnlst().Printf(J_DETAILED, J_LINEAR_ALGEBRA,
+                   "to %7.2e.\n",
+                   pivtol_);
+    return true;
+  }
+
+} // namespace Ipopt
@@ -0,0 +1,281 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifndef __IPLDLSOLVERINTERFACE_HPP__
+#define __IPLDLSOLVERINTERFACE_HPP__
+
+#include "IpSparseSymLinearSolverInterface.hpp"
+
+#include <vector>
+
+namespace Ipopt
+{
+  /** Built-in sparse symmetric indefinite solver, derived from
+   *  SparseSymLinearSolverInterface.
+   *
+   *  Unlike the other interfaces in this directory, this class does
+   *  not wrap an external package.  It computes a fill-reducing
+   *  ordering with an approximate minimum degree algorithm, builds
+   *  the supernodal elimination tree (with relaxed amalgamation of
+   *  small supernodes), and factorizes the matrix as P A P^T = L D L^T
+   *  with a multifrontal method.  The fully summed part of each front
+   *  is factorized with threshold Bunch-Kaufman pivoting (1x1 and 2x2
+   *  pivots); columns that cannot be pivoted on stably are delayed to
+   *  the parent front.  The inertia of the matrix is read off the
+   *  block diagonal D.
+   *
+   *  If Ipopt is compiled with OpenMP, the fronts of independent
+   *  subtrees are factorized in parallel, level by level of the
+   *  supernodal tree.
+   */
+  class LdlSolverInterface: public SparseSymLinearSolverInterface
+  {
+  public:
+    /** @name Constructor/Destructor */
+    //@{
+    /** Constructor */
+    LdlSolverInterface();
+
+    /** Destructor */
+    virtual ~LdlSolverInterface();
+    //@}
+
+    /** overloaded from AlgorithmStrategyObject */
+    bool InitializeImpl(const OptionsList& options,
+                        const std::string& prefix);
+
+
+    /** @name Methods for requesting solution of the linear system. */
+    //@{
+    /** Method for initializing internal stuctures.  Here, ndim gives
+     *  the number of rows and columns of the matrix, nonzeros give
+     *  the number of nonzero elements, and airn and acjn give the
+     *  positions of the nonzero elements.
+     */
+    virtual ESymSolverStatus InitializeStructure(Index dim, Index nonzeros,
+        const Index *airn,
+        const Index *ajcn);
+
+    /** Method returing an internal array into which the nonzero
+     *  elements (in the same order as airn and ajcn) are to be stored
+     *  by the calling routine before a call to MultiSolve with a
+     *  new_matrix=true.  The returned array must have space for at least
+     *  nonzero elements. */
+    virtual double* GetValuesArrayPtr();
+
+    /** Solve operation for multiple right hand sides.  Overloaded
+     *  from SparseSymLinearSolverInterface.
+     */
+    virtual ESymSolverStatus MultiSolve(bool new_matrix,
+                                        const Index* airn,
+                                        const Index* ajcn,
+                                        Index nrhs,
+                                        double* rhs_vals,
+                                        bool check_NegEVals,
+                                        Index numberOfNegEVals);
+
+    /** Number of negative eigenvalues detected during last
+     *  factorization.  Returns the number of negative eigenvalues of
+     *  the most recent factorized matrix.
+     */
+    virtual Index NumberOfNegEVals() const;
+
+    /** Number of pivots that have been delayed from a front to its
+     *  parent during the last factorization. */
+    Index NumberOfDelayedPivots() const
+    {
+      return ndelayed_;
+    }
+    //@}
+
+    //* @name Options of Linear solver */
+    //@{
+    /** Request to increase quality of solution for next solve.  The
+     *  pivot tolerance is increased, up to ldl_pivtolmax.
+     */
+    virtual bool IncreaseQuality();
+
+    /** Query whether inertia is computed by linear solver.
+     * Returns true, if linear solver provides inertia.
+     */
+    virtual bool ProvidesInertia() const
+    {
+      return true;
+    }
+    /** Query of requested matrix type that the linear solver
+     *  understands.
+     */
+    EMatrixFormat MatrixFormat() const
+    {
+      return Triplet_Format;
+    }
+    //@}
+
+    /** Methods for IpoptType */
+    //@{
+    static void RegisterOptions(SmartPtr<RegisteredOptions> roptions);
+    //@}
+
+    /** Approximate minimum degree ordering of the symmetric graph with
+     *  n nodes given by adjacency lists adj_ptr/adj (without
+     *  diagonal).  zero_diag marks the nodes whose diagonal entry is
+     *  zero; they are only ordered after one of their neighbours.  On
+     *  return, perm[k] is the node eliminated in step k. */
+    static void ComputeOrdering(Index n,
+                                const std::vector<Index>& adj_ptr,
+                                const std::vector<Index>& adj,
+                                const std::vector<bool>& zero_diag,
+                                std::vector<Index>& perm);
+
+  private:
+    /**@name Default Compiler Generated Methods
+     * (Hidden to avoid implicit creation/calling).
+     * These methods are not implemented and
+     * we do not want the compiler to implement
+     * them for us, so we declare them private
+     * and do not define them. This ensures that
+     * they will not be implicitly created/called. */
+    //@{
+    /** Copy Constructor */
+    LdlSolverInterface(const LdlSolverInterface&);
+
+    /** Overloaded Equals Operator */
+    void operator=(const LdlSolverInterface&);
+    //@}
+
+    /** Factor of one supernode (and contribution block passed to its
+     *  parent during the factorization). */
+    struct SupernodeFactor;
+
+    /** Work space of one thread during the factorization. */
+    struct FrontWorkspace;
+
+    /** @name Information about the matrix */
+    //@{
+    /** Number of rows and columns of the matrix */
+    Index dim_;
+
+    /** Number of nonzeros of the matrix */
+    Index nonzeros_;
+
+    /** Values of the matrix */
+    std::vector<double> a_;
+    //@}
+
+    /** @name Information about most recent factorization/solve */
+    //@{
+    /** Number of negative eigenvalues */
+    Index negevals_;
+    /** Number of delayed pivots */
+    Index ndelayed_;
+    //@}
+
+    /** @name Initialization flags */
+    //@{
+    /** Flag indicating if internal data is initialized.
+     *  For initialization, this object needs to have seen a matrix */
+    bool initialized_;
+    /** Flag indicating if the symbolic factorization has been done.
+     *  This happens with the first matrix, since the ordering takes
+     *  zero diagonal entries into account. */
+    bool analyzed_;
+    /** Flag indicating if the matrix has to be refactorized because
+     *  the pivot tolerance has been changed. */
+    bool pivtol_changed_;
+    /** Flag that is true if we just requested the values of the
+     *  matrix again (SYMSOLVER_CALL_AGAIN) and have to factorize
+     *  again. */
+    bool refactorize_;
+    //@}
+
+    /** @name Solver specific options */
+    //@{
+    /** Pivot tolerance */
+    Number pivtol_;
+    /** Maximal pivot tolerance */
+    Number pivtolmax_;
+    /** Supernodes with fewer columns than this are merged with their
+     *  parent */
+    Index nemin_;
+    /** Number of threads used in the factorization */
+    Index num_threads_;
+    /** Flag indicating whether the TNLP with identical structure has
+     *  already been solved before. */
+    bool warm_start_same_structure_;
+    //@}
+
+    /** @name Symbolic factorization */
+    //@{
+    /** Permutation: perm_[i] is the original index of the i-th pivot */
+    std::vector<Index> perm_;
+    /** Number of supernodes */
+    Index nsuper_;
+    /** First column of each supernode (size nsuper_+1) */
+    std::vector<Index> sn_start_;
+    /** Parent of each supernode, -1 for roots */
+    std::vector<Index> sn_parent_;
+    /** Start of the row structure of each supernode in sn_rows_ */
+    std::vector<Index> sn_rows_ptr_;
+    /** Rows below the diagonal block of each supernode (sorted) */
+    std::vector<Index> sn_rows_;
+    /** Start of the children of each supernode in sn_children_ */
+    std::vector<Index> sn_children_ptr_;
+    /** Children of the supernodes */
+    std::vector<Index> sn_children_;
+    /** Start of each level of the supernodal tree in level_sn_ */
+    std::vector<Index> level_ptr_;
+    /** Supernodes ordered by level (leaves first) */
+    std::vector<Index> level_sn_;
+    /** Start of the original entries of each supernode in ent_* */
+    std::vector<Index> sn_ent_ptr_;
+    /** Position of the entry in the values array */
+    std::vector<Index> ent_index_;
+    /** Row of the entry in the front (ignoring delayed columns) */
+    std::vector<Index> ent_row_;
+    /** Column of the entry in the front */
+    std::vector<Index> ent_col_;
+    //@}
+
+    /** @name Numeric factorization */
+    //@{
+    /** Factors of the supernodes */
+    SupernodeFactor* factors_;
+    /** Work space for the rhs in the solve */
+    std::vector<double> solve_work_;
+    //@}
+
+    /** @name Internal functions */
+    //@{
+    /** Compute the ordering, the supernodal elimination tree and the
+     *  assembly map for the structure in airn, ajcn (with the values
+     *  in a_). */
+    ESymSolverStatus SymbolicFactorization(const Index* airn,
+                                           const Index* ajcn);
+
+    /** Factorize the matrix in a_. */
+    ESymSolverStatus Factorization(bool check_NegEVals,
+                                   Index numberOfNegEVals);
+
+    /** Assemble and factorize the front of supernode s.  Returns false
+     *  if a root front is singular. */
+    bool FactorizeSupernode(Index s, Number small, FrontWorkspace& ws);
+
+    /** Eliminate the 1x1 (pivsize=1, column jpiv) or 2x2 (pivsize=2,
+     *  columns jpiv and rpiv) pivot at position k of the front F with
+     *  m rows and p fully summed columns.  The columns up to wend are
+     *  updated. */
+    void EliminatePivot(std::vector<double>& F, std::vector<double>& W,
+                        Index m, Index p, Index k, Index pivsize,
+                        Index jpiv, Index rpiv, Index wend,
+                        SupernodeFactor& f) const;
+
+    /** Solve with the factors for nrhs right hand sides. */
+    ESymSolverStatus Backsolve(Index nrhs, double *rhs_vals);
+    //@}
+  };
+
+} // namespace Ipopt
+#endif
@@ -13,7 +13,9 @@
 #include "IpLinearSolversRegOp.hpp"
 #include "IpRegOptions.hpp"
 #include "IpTSymLinearSolver.hpp"
+#include "IpRuizTSymScalingMethod.hpp"
 
+#include "IpLdlSolverInterface.hpp"
 #include "IpMa27TSolverInterface.hpp"
 #include "IpMa57TSolverInterface.hpp"
 #include "IpMa77SolverInterface.hpp"
@@ -36,6 +38,9 @@ namespace Ipopt
   {
     roptions->SetRegisteringCategory("Linear Solver");
     TSymLinearSolver::RegisterOptions(roptions);
+    RuizTSymScalingMethod::RegisterOptions(roptions);
+    roptions->SetRegisteringCategory("LDL Linear Solver");
+    LdlSolverInterface::RegisterOptions(roptions);
 #if defined(COINHSL_HAS_MA27) || defined(HAVE_LINEARSOLVERLOADER)
     roptions->SetRegisteringCategory("MA27 Linear Solver");
     Ma27TSolverInterface::RegisterOptions(roptions);
@@ -359,7 +359,6 @@ namespace Ipopt
     // The following option is registered by OrigIpoptNLP
     options.GetBoolValue("warm_start_same_structure",
                          warm_start_same_structure_, prefix);
-    DBG_ASSERT(!warm_start_same_structure_ && "warm_start_same_structure not yet implemented");
 
     bool ma57_automatic_scaling;
     options.GetBoolValue("ma57_automatic_scaling", ma57_automatic_scaling, prefix);
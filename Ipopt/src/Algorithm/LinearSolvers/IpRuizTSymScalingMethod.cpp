@@ -0,0 +1,230 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#include "IpoptConfig.h"
+#include "IpRuizTSymScalingMethod.hpp"
+
+#ifdef HAVE_CMATH
+# include <cmath>
+#else
+# ifdef HAVE_MATH_H
+#  include <math.h>
+# else
+#  error "don't have header file for math"
+# endif
+#endif
+
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+namespace Ipopt
+{
+#if COIN_IPOPT_VERBOSITY > 0
+  static const Index dbg_verbosity = 0;
+#endif
+
+  /** Minimal number of entries per thread */
+  static const Index min_nonzeros_per_thread = 50000;
+
+  void RuizTSymScalingMethod::RegisterOptions(SmartPtr<RegisteredOptions> roptions)
+  {
+    roptions->AddLowerBoundedIntegerOption(
+      "ruiz_scaling_max_iter",
+      "Maximal number of max norm iterations of the Ruiz equilibration.",
+      0, 10,
+      "The built-in equilibration (\"ruiz\" for linear_system_scaling, "
+      "\"equilibration-ruiz\" for nlp_scaling_method) divides the scaling "
+      "factors by the square root of the max norms of the rows of the "
+      "scaled matrix until they deviate from one by at most "
+      "ruiz_scaling_tol, or for at most this many iterations.");
+    roptions->AddLowerBoundedNumberOption(
+      "ruiz_scaling_tol",
+      "Tolerance for the row norms in the Ruiz equilibration.",
+      0.0, true, 1e-2,
+      "The max norm iterations stop when the max norms of all nonzero rows "
+      "of the scaled matrix are between 1-ruiz_scaling_tol and "
+      "1+ruiz_scaling_tol.");
+    roptions->AddLowerBoundedIntegerOption(
+      "ruiz_scaling_1norm_iter",
+      "Number of 1-norm iterations after the max norm iterations of the Ruiz equilibration.",
+      0, 0,
+      "The 1-norm iterations (Knight, Ruiz and Ucar) also balance the rows "
+      "with respect to their smaller entries.");
+    roptions->AddLowerBoundedIntegerOption(
+      "ruiz_scaling_num_threads",
+      "Number of threads for the Ruiz equilibration.",
+      0, 0,
+      "For large matrices, the row norms are computed in parallel.  The "
+      "value 0 uses the OpenMP default.  This option only has an effect if "
+      "Ipopt has been compiled with OpenMP.");
+  }
+
+  bool RuizTSymScalingMethod::InitializeImpl(const OptionsList& options,
+      const std::string& prefix)
+  {
+    options.GetIntegerValue("ruiz_scaling_max_iter", max_iter_, prefix);
+    options.GetNumericValue("ruiz_scaling_tol", tol_, prefix);
+    options.GetIntegerValue("ruiz_scaling_1norm_iter", one_norm_iter_, prefix);
+    options.GetIntegerValue("ruiz_scaling_num_threads", num_threads_, prefix);
+    return true;
+  }
+
+  Index RuizTSymScalingMethod::NumThreads(Index nonzeros) const
+  {
+#ifdef _OPENMP
+    Index nthreads = num_threads_ > 0 ? num_threads_ : omp_get_max_threads();
+    return Max(1, Min(nthreads, nonzeros/min_nonzeros_per_thread));
+#else
+    return 1;
+#endif
+  }
+
+  void RuizTSymScalingMethod::ComputeRowNorms(Index n,
+      const double* scaling_factors,
+      bool one_norm)
+  {
+    const Index* row_start = &row_start_[0];
+    const Index* row_col = row_col_.empty() ? NULL : &row_col_[0];
+    const double* row_val = row_val_.empty() ? NULL : &row_val_[0];
+    double* row_norm = &row_norm_[0];
+#ifdef _OPENMP
+    const Index nthreads = NumThreads(row_start[n]);
+    #pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads) if(nthreads > 1)
+#endif
+    for (Index i=0; i<n; i++) {
+      double norm = 0.;
+      if (one_norm) {
+        for (Index p=row_start[i]; p<row_start[i+1]; p++) {
+          norm += row_val[p]*scaling_factors[row_col[p]];
+        }
+      }
+      else {
+        for (Index p=row_start[i]; p<row_start[i+1]; p++) {
+          norm = Max(norm, row_val[p]*scaling_factors[row_col[p]]);
+        }
+      }
+      row_norm[i] = norm*scaling_factors[i];
+    }
+  }
+
+  bool RuizTSymScalingMethod::ComputeSymTScalingFactors(Index n,
+      Index nnz,
+      const ipfint* airn,
+      const ipfint* ajcn,
+      const double* a,
+      double* scaling_factors)
+  {
+    DBG_START_METH("RuizTSymScalingMethod::ComputeSymTScalingFactors",
+                   dbg_verbosity);
+
+    if (n==0) {
+      return true;
+    }
+
+    // Put the rows of the full matrix together: an off-diagonal entry
+    // of the triangle belongs to its row and to its column
+    row_start_.assign(n+1, 0);
+    for (Index k=0; k<nnz; k++) {
+      row_start_[airn[k]]++;
+      if (airn[k]!=ajcn[k]) {
+        row_start_[ajcn[k]]++;
+      }
+    }
+    for (Index i=0; i<n; i++) {
+      row_start_[i+1] += row_start_[i];
+    }
+    row_col_.resize(row_start_[n]);
+    row_val_.resize(row_start_[n]);
+    row_norm_.resize(n);
+    std::vector<Index> next(row_start_.begin(), row_start_.end()-1);
+    for (Index k=0; k<nnz; k++) {
+      const Index irow = airn[k]-1;
+      const Index jcol = ajcn[k]-1;
+      const double val = fabs(a[k]);
+      row_col_[next[irow]] = jcol;
+      row_val_[next[irow]++] = val;
+      if (irow!=jcol) {
+        row_col_[next[jcol]] = irow;
+        row_val_[next[jcol]++] = val;
+      }
+    }
+
+    for (Index i=0; i<n; i++) {
+      scaling_factors[i] = 1.;
+    }
+
+    // Max norm iterations; rows without nonzeros keep the factor one
+#ifdef _OPENMP
+    const Index nthreads = NumThreads(row_start_[n]);
+#endif
+    double* row_norm = &row_norm_[0];
+    Index iter = 0;
+    Number deviation;
+    while (true) {
+      ComputeRowNorms(n, scaling_factors, false);
+      deviation = 0.;
+      for (Index i=0; i<n; i++) {
+        if (row_norm[i] > 0.) {
+          deviation = Max(deviation, fabs(1.-row_norm[i]));
+        }
+      }
+      if (deviation <= tol_ || iter == max_iter_) {
+        break;
+      }
+#ifdef _OPENMP
+      #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+      for (Index i=0; i<n; i++) {
+        if (row_norm[i] > 0.) {
+          scaling_factors[i] /= sqrt(row_norm[i]);
+        }
+      }
+      iter++;
+    }
+    Jnlst().Printf(J_MOREDETAILED, J_LINEAR_ALGEBRA,
+                   "Ruiz scaling: %d max norm iterations, max. deviation of the row norms from one %e\n",
+                   iter, deviation);
+
+    for (Index k=0; k<one_norm_iter_; k++) {
+      ComputeRowNorms(n, scaling_factors, true);
+#ifdef _OPENMP
+      #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+      for (Index i=0; i<n; i++) {
+        if (row_norm[i] > 0.) {
+          scaling_factors[i] /= sqrt(row_norm[i]);
+        }
+      }
+    }
+
+    // As for MC19, do not use scaling factors that are not finite or
+    // extremely large
+    Number sum=0.;
+    Number smax=0.;
+    for (Index i=0; i<n; i++) {
+      sum += scaling_factors[i];
+      smax = Max(smax, scaling_factors[i]);
+    }
+    if (!IsFiniteNumber(sum) || smax > 1e40) {
+      Jnlst().Printf(J_WARNING, J_LINEAR_ALGEBRA,
+                     "Scaling factors are invalid - setting them all to 1.\n");
+      for (Index i=0; i<n; i++) {
+        scaling_factors[i] = 1.;
+      }
+    }
+
+    if (DBG_VERBOSITY()>=2) {
+      for (Index i=0; i<n; i++) {
+        DBG_PRINT((2, "scaling_factors[%5d] = %23.15e\n",
+                   i, scaling_factors[i]));
+      }
+    }
+
+    return true;
+  }
+
+} // namespace Ipopt
@@ -0,0 +1,113 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifndef __IPRUIZTSYMSCALINGMETHOD_HPP__
+#define __IPRUIZTSYMSCALINGMETHOD_HPP__
+
+#include "IpUtils.hpp"
+#include "IpTSymScalingMethod.hpp"
+
+#include <vector>
+
+namespace Ipopt
+{
+
+  /** Class for the method for computing scaling factors for symmetric
+   *  matrices in triplet format by iterative equilibration, without
+   *  HSL.
+   *
+   *  The factors d are computed with Ruiz's method: in each iteration
+   *  every d_i is divided by the square root of the max norm of row i
+   *  of D|A|D, until all rows of the scaled matrix have max norm close
+   *  to one.  Optionally, a few iterations with the 1-norm follow (as
+   *  proposed by Knight, Ruiz and Ucar), which balance the rows with
+   *  respect to all their entries and not only the largest.  The row
+   *  norms are computed in parallel over the rows if Ipopt has been
+   *  compiled with OpenMP.
+   *
+   *  An unsymmetric matrix B can be equilibrated with row and column
+   *  factors by applying this method to the symmetric matrix
+   *  [0 B; B^T 0] (see EquilibrationScaling).
+   */
+  class RuizTSymScalingMethod: public TSymScalingMethod
+  {
+  public:
+    /** @name Constructor/Destructor */
+    //@{
+    RuizTSymScalingMethod()
+    {}
+
+    virtual ~RuizTSymScalingMethod()
+    {}
+    //@}
+
+    /** overloaded from AlgorithmStrategyObject */
+    virtual bool InitializeImpl(const OptionsList& options,
+                                const std::string& prefix);
+
+    /** Method for computing the symmetric scaling factors, given the
+     *  symmtric matrix in triplet (MA27) format. */
+    virtual bool ComputeSymTScalingFactors(Index n,
+                                           Index nnz,
+                                           const ipfint* airn,
+                                           const ipfint* ajcn,
+                                           const double* a,
+                                           double* scaling_factors);
+
+    /** Methods for IpoptType */
+    //@{
+    static void RegisterOptions(SmartPtr<RegisteredOptions> roptions);
+    //@}
+
+  private:
+    /**@name Default Compiler Generated Methods (Hidden to avoid
+     * implicit creation/calling).  These methods are not implemented
+     * and we do not want the compiler to implement them for us, so we
+     * declare them private and do not define them. This ensures that
+     * they will not be implicitly created/called. */
+    //@{
+    /** Copy Constructor */
+    RuizTSymScalingMethod(const RuizTSymScalingMethod&);
+
+    /** Overloaded Equals Operator */
+    void operator=(const RuizTSymScalingMethod&);
+    //@}
+
+    /** Compute the max norms (or the 1-norms, if one_norm is true) of
+     *  the rows of D|A|D into row_norm_. */
+    void ComputeRowNorms(Index n, const double* scaling_factors,
+                         bool one_norm);
+
+    /** Number of threads for a matrix with nonzeros entries. */
+    Index NumThreads(Index nonzeros) const;
+
+    /** @name Algorithmic parameters */
+    //@{
+    /** Maximal number of max norm iterations */
+    Index max_iter_;
+    /** Tolerance for the deviation of the row max norms from one */
+    Number tol_;
+    /** Number of 1-norm iterations after the max norm iterations */
+    Index one_norm_iter_;
+    /** Number of threads, 0 for the OpenMP default */
+    Index num_threads_;
+    //@}
+
+    /** @name Rows of the matrix with both triangles (compressed row
+     *  format, absolute values) */
+    //@{
+    std::vector<Index> row_start_;
+    std::vector<Index> row_col_;
+    std::vector<double> row_val_;
+    //@}
+
+    /** Row norms of the current scaled matrix */
+    std::vector<double> row_norm_;
+  };
+
+} // namespace Ipopt
+
+#endif
@@ -10,6 +10,10 @@
 #include "IpTripletHelper.hpp"
 #include "IpBlas.hpp"
 
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
 namespace Ipopt
 {
 #if COIN_IPOPT_VERBOSITY > 0
@@ -31,7 +35,8 @@ namespace Ipopt
       scaling_method_(scaling_method),
       scaling_factors_(NULL),
       airn_(NULL),
-      ajcn_(NULL)
+      ajcn_(NULL),
+      have_scatter_plan_(false)
   {
     DBG_START_METH("TSymLinearSolver::TSymLinearSolver()",dbg_verbosity);
     DBG_ASSERT(IsValid(solver_interface));
@@ -60,6 +65,14 @@ namespace Ipopt
       "Choosing \"yes\" means that the algorithm will start the scaling "
       "method only when the solutions to the linear system seem not good, and "
       "then use it until the end.");
+    roptions->AddLowerBoundedIntegerOption(
+      "csr_conversion_num_threads",
+      "Number of threads for the conversion of the linear system to the compressed format.",
+      0, 0,
+      "For large matrices, the structure of the compressed format is "
+      "computed and the values are copied in parallel.  The value 0 uses "
+      "the OpenMP default.  This option only has an effect if Ipopt has "
+      "been compiled with OpenMP.");
   }
 
   bool TSymLinearSolver::InitializeImpl(const OptionsList& options,
@@ -75,6 +88,8 @@ namespace Ipopt
     // This option is registered by OrigIpoptNLP
     options.GetBoolValue("warm_start_same_structure",
                          warm_start_same_structure_, prefix);
+    Index num_threads;
+    options.GetIntegerValue("csr_conversion_num_threads", num_threads, prefix);
 
     bool retval;
     if (HaveIpData()) {
@@ -95,22 +110,29 @@ namespace Ipopt
       nonzeros_triplet_=0;
       nonzeros_compressed_=0;
       have_structure_=false;
+      have_scatter_plan_=false;
 
       matrix_format_ = solver_interface_->MatrixFormat();
       switch (matrix_format_) {
       case SparseSymLinearSolverInterface::CSR_Format_0_Offset:
-        triplet_to_csr_converter_ = new TripletToCSRConverter(0);
+        triplet_to_csr_converter_ =
+          new TripletToCSRConverter(0, TripletToCSRConverter::Triangular_Format,
+                                    num_threads);
         break;
       case SparseSymLinearSolverInterface::CSR_Format_1_Offset:
-        triplet_to_csr_converter_ = new TripletToCSRConverter(1);
+        triplet_to_csr_converter_ =
+          new TripletToCSRConverter(1, TripletToCSRConverter::Triangular_Format,
+                                    num_threads);
         break;
       case SparseSymLinearSolverInterface::CSR_Full_Format_0_Offset:
         triplet_to_csr_converter_ = new TripletToCSRConverter(0,
-                                    TripletToCSRConverter::Full_Format);
+                                    TripletToCSRConverter::Full_Format,
+                                    num_threads);
         break;
       case SparseSymLinearSolverInterface::CSR_Full_Format_1_Offset:
         triplet_to_csr_converter_ = new TripletToCSRConverter(1,
-                                    TripletToCSRConverter::Full_Format);
+                                    TripletToCSRConverter::Full_Format,
+                                    num_threads);
         break;
       case SparseSymLinearSolverInterface::Triplet_Format:
         triplet_to_csr_converter_ = NULL;
@@ -183,7 +205,13 @@ namespace Ipopt
     // values, compute the new scaling factors (if required), and
     // scale the matrix
     if (new_matrix || just_switched_on_scaling_) {
+      if (HaveIpData()) {
+        IpData().TimingStats().KKTAssembly().Start();
+      }
       GiveMatrixToSolver(true, sym_A);
+      if (HaveIpData()) {
+        IpData().TimingStats().KKTAssembly().End();
+      }
       new_matrix = true;
     }
 
@@ -245,7 +273,13 @@ namespace Ipopt
                                              numberOfNegEVals);
       if (retval==SYMSOLVER_CALL_AGAIN) {
         DBG_PRINT((1, "Solver interface asks to be called again.\n"));
+        if (HaveIpData()) {
+          IpData().TimingStats().KKTAssembly().Start();
+        }
         GiveMatrixToSolver(false, sym_A);
+        if (HaveIpData()) {
+          IpData().TimingStats().KKTAssembly().End();
+        }
       }
       else {
         done = true;
@@ -310,6 +344,7 @@ namespace Ipopt
       ajcn_ = new Index[nonzeros_triplet_];
 
       TripletHelper::FillRowCol(nonzeros_triplet_, sym_A, airn_, ajcn_);
+      have_scatter_plan_ = false;
 
       // If the solver wants the compressed format, the converter has to
       // be initialized
@@ -415,22 +450,64 @@ namespace Ipopt
     return solver_interface_->ProvidesInertia();
   }
 
+  void TSymLinearSolver::BuildScatterPlan()
+  {
+    DBG_START_METH("TSymLinearSolver::BuildScatterPlan",dbg_verbosity);
+
+    if (matrix_format_==SparseSymLinearSolverInterface::Triplet_Format) {
+      // The values are written directly into the solver's array, we
+      // only need the positions for the scaling factors
+      atriplet_.clear();
+      plan_src_.clear();
+      plan_dup_src_.clear();
+      plan_dup_dst_.clear();
+      plan_row_.resize(nonzeros_triplet_);
+      plan_col_.resize(nonzeros_triplet_);
+      for (Index i=0; i<nonzeros_triplet_; i++) {
+        plan_row_[i] = airn_[i]-1;
+        plan_col_[i] = ajcn_[i]-1;
+      }
+    }
+    else {
+      atriplet_.resize(nonzeros_triplet_);
+      const Index* ipos_first = triplet_to_csr_converter_->iPosFirst();
+      plan_src_.assign(ipos_first, ipos_first+nonzeros_compressed_);
+      plan_row_.resize(nonzeros_compressed_);
+      plan_col_.resize(nonzeros_compressed_);
+      for (Index i=0; i<nonzeros_compressed_; i++) {
+        // For the full format, the entries in the upper and lower
+        // triangle get the same scaling factors
+        plan_row_[i] = airn_[plan_src_[i]]-1;
+        plan_col_[i] = ajcn_[plan_src_[i]]-1;
+      }
+      const Index ndoubles = triplet_to_csr_converter_->NumDoubles();
+      const Index* ipos_double_triplet =
+        triplet_to_csr_converter_->iPosDoubleTriplet();
+      const Index* ipos_double_compressed =
+        triplet_to_csr_converter_->iPosDoubleCompressed();
+      plan_dup_src_.assign(ipos_double_triplet,
+                           ipos_double_triplet+ndoubles);
+      plan_dup_dst_.assign(ipos_double_compressed,
+                           ipos_double_compressed+ndoubles);
+    }
+    have_scatter_plan_ = true;
+  }
+
   void TSymLinearSolver::GiveMatrixToSolver(bool new_matrix,
       const SymMatrix& sym_A)
   {
     DBG_START_METH("TSymLinearSolver::GiveMatrixToSolver",dbg_verbosity);
     DBG_PRINT((1,"new_matrix = %d\n",new_matrix));
 
-    double* pa = solver_interface_->GetValuesArrayPtr();
-    double* atriplet;
-
-    if (matrix_format_!=SparseSymLinearSolverInterface::Triplet_Format) {
-      atriplet = new double[nonzeros_triplet_];
-    }
-    else {
-      atriplet = pa;
+    if (!have_scatter_plan_) {
+      BuildScatterPlan();
     }
 
+    double* pa = solver_interface_->GetValuesArrayPtr();
+    const bool compressed =
+      (matrix_format_!=SparseSymLinearSolverInterface::Triplet_Format);
+    double* atriplet = compressed ? &atriplet_[0] : pa;
+
     //DBG_PRINT_MATRIX(3, "Aunscaled", sym_A);
     TripletHelper::FillValues(nonzeros_triplet_, sym_A, atriplet);
     if (DBG_VERBOSITY()>=3) {
@@ -439,6 +516,7 @@ namespace Ipopt
       }
     }
 
+    const double* sf = NULL;
     if (use_scaling_) {
       IpData().TimingStats().LinearSystemScaling().Start();
       DBG_ASSERT(scaling_factors_);
@@ -464,24 +542,61 @@ namespace Ipopt
         }
         just_switched_on_scaling_ = false;
       }
-      for (Index i=0; i<nonzeros_triplet_; i++) {
-        atriplet[i] *=
-          scaling_factors_[airn_[i]-1] * scaling_factors_[ajcn_[i]-1];
-      }
-      if (DBG_VERBOSITY()>=3) {
+      sf = scaling_factors_;
+      if (!compressed) {
+        // Scale in place in the solver's array
+        const Index* prow = &plan_row_[0];
+        const Index* pcol = &plan_col_[0];
         for (Index i=0; i<nonzeros_triplet_; i++) {
-          DBG_PRINT((3, "KKTscaled(%6d,%6d) = %24.16e\n", airn_[i], ajcn_[i], atriplet[i]));
+          pa[i] *= sf[prow[i]] * sf[pcol[i]];
+        }
+        if (DBG_VERBOSITY()>=3) {
+          for (Index i=0; i<nonzeros_triplet_; i++) {
+            DBG_PRINT((3, "KKTscaled(%6d,%6d) = %24.16e\n", airn_[i], ajcn_[i], pa[i]));
+          }
         }
       }
       IpData().TimingStats().LinearSystemScaling().End();
     }
 
-    if (matrix_format_!=SparseSymLinearSolverInterface::Triplet_Format) {
+    if (compressed) {
+      // Scatter the triplet values into the compressed format, and
+      // scale them at the same time
       IpData().TimingStats().LinearSystemStructureConverter().Start();
-      triplet_to_csr_converter_->ConvertValues(nonzeros_triplet_, atriplet,
-          nonzeros_compressed_, pa);
+      const Index* psrc = &plan_src_[0];
+      const Index ndoubles = (Index)plan_dup_src_.size();
+      const Index* pdsrc = ndoubles>0 ? &plan_dup_src_[0] : NULL;
+      const Index* pddst = ndoubles>0 ? &plan_dup_dst_[0] : NULL;
+#ifdef _OPENMP
+      const Index nthreads =
+        triplet_to_csr_converter_->NumThreads(nonzeros_compressed_);
+#endif
+      if (sf) {
+        const Index* prow = &plan_row_[0];
+        const Index* pcol = &plan_col_[0];
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+        for (Index i=0; i<nonzeros_compressed_; i++) {
+          pa[i] = atriplet[psrc[i]] * (sf[prow[i]] * sf[pcol[i]]);
+        }
+        for (Index i=0; i<ndoubles; i++) {
+          const Index k = pddst[i];
+          pa[k] += atriplet[pdsrc[i]] * (sf[prow[k]] * sf[pcol[k]]);
+        }
+      }
+      else {
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+        for (Index i=0; i<nonzeros_compressed_; i++) {
+          pa[i] = atriplet[psrc[i]];
+        }
+        for (Index i=0; i<ndoubles; i++) {
+          pa[pddst[i]] += atriplet[pdsrc[i]];
+        }
+      }
       IpData().TimingStats().LinearSystemStructureConverter().End();
-      delete[] atriplet;
     }
 
   }
@@ -511,6 +626,7 @@ namespace Ipopt
     delete [] ajcn_;
     airn_ = new Index[nonzeros_triplet_];
     ajcn_ = new Index[nonzeros_triplet_];
+    have_scatter_plan_ = false;
 
     for (int i=0; i<n_jac_nz; i++) {
       airn_[i] = jac_c_iRow[i] + n_cols;
@@ -187,6 +187,35 @@ namespace Ipopt
     SparseSymLinearSolverInterface::EMatrixFormat matrix_format_;
     //@}
 
+    /** @name Scatter plan for the assembly of the matrix values.
+     *  The plan is computed once for the nonzero structure and maps
+     *  the triplet entries of the matrix directly into the array of
+     *  the linear solver, applying the scaling factors on the way. */
+    //@{
+    /** Flag indicating if the plan is valid for the current
+     *  structure. */
+    bool have_scatter_plan_;
+    /** Values of the matrix in triplet format.  This is only used if
+     *  the linear solver works with the compressed format; otherwise
+     *  the values are written directly into the solver's array. */
+    std::vector<Number> atriplet_;
+    /** For each entry in the solver's array, position of the first
+     *  triplet entry that contributes to it (only for the compressed
+     *  format). */
+    std::vector<Index> plan_src_;
+    /** For each entry in the solver's array, row and column (counting
+     *  from 0) for the scaling factors. */
+    std::vector<Index> plan_row_;
+    std::vector<Index> plan_col_;
+    /** Positions of the triplet entries that are added to an entry in
+     *  the solver's array that already has a value (only for the
+     *  compressed format). */
+    std::vector<Index> plan_dup_src_;
+    /** Positions in the solver's array to which the repeated entries
+     *  are added. */
+    std::vector<Index> plan_dup_dst_;
+    //@}
+
     /** @name Algorithmic parameters */
     //@{
     /** Flag indicating whether the TNLP with identical structure has
@@ -205,6 +234,9 @@ namespace Ipopt
     /** Copy the elements of the matrix in the required format into
      *  the array that is provided by the solver interface. */
     void GiveMatrixToSolver(bool new_matrix, const SymMatrix& sym_A);
+
+    /** Compute the scatter plan for the current nonzero structure. */
+    void BuildScatterPlan();
     //@}
   };
 
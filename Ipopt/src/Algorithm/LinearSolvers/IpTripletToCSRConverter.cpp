@@ -7,7 +7,8 @@
 // Authors:  Carl Laird, Andreas Waechter     IBM    2005-03-13
 
 #include "IpTripletToCSRConverter.hpp"
-#include <list>
+#include <algorithm>
+#include <vector>
 
 #ifdef HAVE_CSTDDEF
 # include <cstddef>
@@ -19,17 +20,99 @@
 # endif
 #endif
 
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+// Prefetching of the values in the scatter loops
+#ifdef __GNUC__
+# define IPOPT_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+# define IPOPT_PREFETCH(addr)
+#endif
+
 namespace Ipopt
 {
 #if COIN_IPOPT_VERBOSITY > 0
   static const Index dbg_verbosity = 0;
 #endif
 
+  /** Minimal number of entries per thread */
+  static const Index min_nonzeros_per_thread = 50000;
+
+  /** Distance (in entries) of the prefetches in the scatter loops */
+  static const Index prefetch_distance = 64;
+
+  /** Rows up to this length are sorted by insertion sort */
+  static const Index insertion_sort_length = 32;
+
+  /** Start of the t-th of nthreads chunks of n entries */
+  static inline Index ChunkStart(Index n, Index t, Index nthreads)
+  {
+    return (Index)(((double)n*(double)t)/(double)nthreads);
+  }
+
+  /** Comparison of two entries of the triplet format by their
+   *  columns, and by their position for the same column. */
+  class ColumnLess
+  {
+  public:
+    ColumnLess(const Index* col)
+        :
+        col_(col)
+    {}
+
+    bool operator()(Index k1, Index k2) const
+    {
+      return col_[k1] < col_[k2] || (col_[k1] == col_[k2] && k1 < k2);
+    }
+
+  private:
+    const Index* col_;
+  };
+
+  /** Sort the triplet positions in [first, last), which are given in
+   *  increasing order, by the columns of the entries. */
+  static void SortByColumn(Index* first, Index* last, const Index* col)
+  {
+    if (last - first <= insertion_sort_length) {
+      for (Index* p = first + 1; p < last; p++) {
+        const Index k = *p;
+        const Index c = col[k];
+        Index* q = p;
+        while (q > first && col[*(q-1)] > c) {
+          *q = *(q-1);
+          q--;
+        }
+        *q = k;
+      }
+    }
+    else {
+      std::sort(first, last, ColumnLess(col));
+    }
+  }
+
+  /** dst[i] = src[pos[i]] for i in [begin, end) */
+  static void GatherValues(Index begin, Index end, const Index* pos,
+                           const Number* src, Number* dst)
+  {
+    Index i = begin;
+    for (; i < end - prefetch_distance; i++) {
+      IPOPT_PREFETCH(&src[pos[i+prefetch_distance]]);
+      dst[i] = src[pos[i]];
+    }
+    for (; i < end; i++) {
+      dst[i] = src[pos[i]];
+    }
+  }
+
   TripletToCSRConverter::
-  TripletToCSRConverter(Index offset, ETriFull hf /*= Triangular_Format*/)
+  TripletToCSRConverter(Index offset, ETriFull hf /*= Triangular_Format*/,
+                        Index num_threads /*= 0*/)
       :
       offset_(offset),
       hf_(hf),
+      num_threads_(num_threads),
       ia_(NULL),
       ja_(NULL),
       dim_(0),
@@ -38,7 +121,8 @@ namespace Ipopt
       initialized_(false),
       ipos_first_(NULL),
       ipos_double_triplet_(NULL),
-      ipos_double_compressed_(NULL)
+      ipos_double_compressed_(NULL),
+      doubles_sorted_(true)
   {
     DBG_ASSERT(offset==0|| offset==1);
   }
@@ -52,6 +136,16 @@ namespace Ipopt
     delete[] ipos_double_compressed_;
   }
 
+  Index TripletToCSRConverter::NumThreads(Index nonzeros) const
+  {
+#ifdef _OPENMP
+    Index nthreads = num_threads_ > 0 ? num_threads_ : omp_get_max_threads();
+    return Max(1, Min(nthreads, nonzeros/min_nonzeros_per_thread));
+#else
+    return 1;
+#endif
+  }
+
   Index TripletToCSRConverter::InitializeConverter(Index dim, Index nonzeros,
       const Index* airn,
       const Index* ajcn)
@@ -71,150 +165,182 @@ namespace Ipopt
     dim_ = dim;
     nonzeros_triplet_ = nonzeros;
 
-    // Create a list with all triplet entries
-    std::list<TripletEntry> entry_list(nonzeros);
-    std::list<TripletEntry>::iterator list_iterator = entry_list.begin();
-    for (Index i=0; i<nonzeros; i++) {
-      list_iterator->Set(airn[i], ajcn[i], i);
-      list_iterator++;
-    }
-    DBG_ASSERT(list_iterator == entry_list.end());
-
     if (DBG_VERBOSITY()>=2) {
       for (Index i=0; i<nonzeros; i++) {
         DBG_PRINT((2, "airn[%5d] = %5d acjn[%5d] = %5d\n", i, airn[i], i, ajcn[i]));
       }
     }
 
-    // sort the list
-    entry_list.sort();
+    const Index nthreads = NumThreads(nonzeros);
 
-    // Now got through the list and compute ipos_ arrays and the
-    // number of elements in the compressed format
-    Index* ja_tmp = new Index[nonzeros];    // overestimate memory requirement
-    Index* rc_tmp = NULL;
-    if (hf_ == Full_Format) {
-      rc_tmp = new Index[dim_+1];
+    // Row and column (counted from 0) of the entries, moved into the
+    // upper triangle
+    std::vector<Index> row(nonzeros);
+    std::vector<Index> col(nonzeros);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+    for (Index k=0; k<nonzeros; k++) {
+      if (airn[k]>ajcn[k]) {
+        row[k] = ajcn[k]-1;
+        col[k] = airn[k]-1;
+      }
+      else {
+        row[k] = airn[k]-1;
+        col[k] = ajcn[k]-1;
+      }
     }
-    ia_ = new Index[dim_+1];
-    Index* ipos_first_tmp = new Index[nonzeros];  // overestimate memory requirement
-    Index* ipos_double_triplet_tmp = new Index[nonzeros];  // overestimate memory requirement
-    Index* ipos_double_compressed_tmp = new Index[nonzeros];  // overestimate memory requirement
-
-    Index nonzeros_compressed_full = 0;
-    nonzeros_compressed_ = 0;
-    Index cur_row = 1;
 
-    if (hf_ == Full_Format) {
-      // Zero row counts
-      for (Index i=0; i<dim_+1; i++) {
-        rc_tmp[i] = 0;
+    // Counting sort of the entries by rows.  Each thread takes a
+    // contiguous chunk of the entries and has its own counters, so
+    // that the entries of a row stay in the order of the triplet
+    // format.
+    std::vector<Index> count((size_t)nthreads*dim_, 0);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+    for (Index t=0; t<nthreads; t++) {
+      Index* cnt = &count[(size_t)t*dim_];
+      const Index end = ChunkStart(nonzeros, t+1, nthreads);
+      for (Index k=ChunkStart(nonzeros, t, nthreads); k<end; k++) {
+        cnt[row[k]]++;
       }
     }
-
-    // Take care of possible emply rows
-    list_iterator = entry_list.begin();
-    while (cur_row < list_iterator->IRow()) {
-      ia_[cur_row-1] = 0;
-      cur_row++;
+    std::vector<Index> row_start(dim_+1);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+    for (Index i=0; i<dim_; i++) {
+      Index sum = 0;
+      for (Index t=0; t<nthreads; t++) {
+        const Index c = count[(size_t)t*dim_+i];
+        count[(size_t)t*dim_+i] = sum;
+        sum += c;
+      }
+      row_start[i+1] = sum;
+    }
+    row_start[0] = 0;
+    for (Index i=0; i<dim_; i++) {
+      row_start[i+1] += row_start[i];
     }
-    ia_[cur_row-1] = 0;
-    ja_tmp[0] = list_iterator->JCol();
-    ipos_first_tmp[0] = list_iterator->PosTriplet();
-    if (hf_ == Full_Format) {
-      // Count in both lower and upper triangles. Count diagonal only once.
-      nonzeros_compressed_full++;
-      rc_tmp[cur_row-1]++;
-      if (cur_row!=list_iterator->JCol()) {
-        nonzeros_compressed_full++;
-        rc_tmp[list_iterator->JCol()-1]++;
+    std::vector<Index> perm(nonzeros);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+    for (Index t=0; t<nthreads; t++) {
+      Index* cnt = &count[(size_t)t*dim_];
+      const Index end = ChunkStart(nonzeros, t+1, nthreads);
+      for (Index k=ChunkStart(nonzeros, t, nthreads); k<end; k++) {
+        const Index i = row[k];
+        perm[row_start[i] + cnt[i]++] = k;
       }
     }
-
-    list_iterator++;
-    Index idouble = 0;
-    Index idouble_full = 0;
-    while (list_iterator != entry_list.end()) {
-      Index irow = list_iterator->IRow();
-      Index jcol = list_iterator->JCol();
-      if (cur_row == irow && ja_tmp[nonzeros_compressed_] == jcol) {
-        // This element appears repeatedly, add to the double list
-        ipos_double_triplet_tmp[idouble] = list_iterator->PosTriplet();
-        ipos_double_compressed_tmp[idouble] = nonzeros_compressed_;
-        idouble++;
-        idouble_full++;
-        if (hf_==Full_Format && irow!=jcol) {
-          idouble_full++;
+    std::vector<Index>().swap(count);
+
+    // Sort the rows by columns, and count the different columns and
+    // the repeated entries in each row
+    std::vector<Index> row_nz(dim_+1);
+    std::vector<Index> row_doubles(dim_+1);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads) if(nthreads > 1)
+#endif
+    for (Index i=0; i<dim_; i++) {
+      Index* first = &perm[0] + row_start[i];
+      Index* last = &perm[0] + row_start[i+1];
+      SortByColumn(first, last, &col[0]);
+      Index nz = 0;
+      for (Index* p = first; p < last; p++) {
+        if (p == first || col[*p] != col[*(p-1)]) {
+          nz++;
         }
       }
-      else {
-        // This is a new element
-        if (hf_==Full_Format) {
-          // Count in both lower and upper triangles. Count diagonal only once.
-          nonzeros_compressed_full++;
-          rc_tmp[jcol-1]++;
-          if (irow!=jcol) {
-            nonzeros_compressed_full++;
-            rc_tmp[irow-1]++;
-          }
+      row_nz[i+1] = nz;
+      row_doubles[i+1] = (Index)(last - first) - nz;
+    }
+    row_nz[0] = 0;
+    row_doubles[0] = 0;
+    for (Index i=0; i<dim_; i++) {
+      row_nz[i+1] += row_nz[i];
+      row_doubles[i+1] += row_doubles[i];
+    }
+    nonzeros_compressed_ = row_nz[dim_];
+    const Index idouble = row_doubles[dim_];
+    DBG_ASSERT(idouble == nonzeros_triplet_-nonzeros_compressed_);
+
+    // Now go through the rows and compute the columns, the ipos_
+    // arrays and the positions of the repeated entries
+    Index* ja_tmp = new Index[nonzeros_compressed_];
+    Index* ipos_first_tmp = new Index[nonzeros_compressed_];
+    Index* ipos_double_triplet_tmp = new Index[idouble];
+    Index* ipos_double_compressed_tmp = new Index[idouble];
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads) if(nthreads > 1)
+#endif
+    for (Index i=0; i<dim_; i++) {
+      Index pos = row_nz[i] - 1;
+      Index jd = row_doubles[i];
+      for (Index p=row_start[i]; p<row_start[i+1]; p++) {
+        const Index k = perm[p];
+        if (p == row_start[i] || col[k] != col[perm[p-1]]) {
+          // This is a new element
+          pos++;
+          ja_tmp[pos] = col[k];
+          ipos_first_tmp[pos] = k;
         }
-        nonzeros_compressed_++;
-        ja_tmp[nonzeros_compressed_] = jcol;
-        ipos_first_tmp[nonzeros_compressed_] = list_iterator->PosTriplet();
-        if (cur_row != irow) {
-          // this is in a new row
-
-          ia_[cur_row] = nonzeros_compressed_;
-          cur_row++;
+        else {
+          // This element appears repeatedly, add to the double list
+          ipos_double_triplet_tmp[jd] = k;
+          ipos_double_compressed_tmp[jd] = pos;
+          jd++;
         }
       }
-
-      list_iterator++;
-    }
-    nonzeros_compressed_++;
-    for (Index i=cur_row; i<=dim_; i++) {
-      ia_[i] = nonzeros_compressed_;
     }
-    DBG_ASSERT(idouble == nonzeros_triplet_-nonzeros_compressed_);
 
-    // Now copy the ja_tmp array to the (shorter) final one and make
-    // sure that the correct offset is used
+    ia_ = new Index[dim_+1];
     if (hf_==Triangular_Format) {
-      ja_ = new Index[nonzeros_compressed_];
-      if (offset_==0) {
-        for (Index i=0; i<nonzeros_compressed_; i++) {
-          ja_[i] = ja_tmp[i] - 1;
-        }
+      // The arrays are used as they are, with the correct offset
+      ja_ = ja_tmp;
+      for (Index i=0; i<=dim_; i++) {
+        ia_[i] = row_nz[i] + offset_;
       }
-      else {
+      if (offset_!=0) {
         for (Index i=0; i<nonzeros_compressed_; i++) {
-          ja_[i] = ja_tmp[i];
-        }
-        for (Index i=0; i<=dim_; i++) {
-          ia_[i] = ia_[i] + 1;
+          ja_[i] += offset_;
         }
       }
-      delete[] ja_tmp;
+      ipos_first_ = ipos_first_tmp;
+      ipos_double_triplet_ = ipos_double_triplet_tmp;
+      ipos_double_compressed_ = ipos_double_compressed_tmp;
+      num_doubles_ = idouble;
+      doubles_sorted_ = true;
+    }
+    else { // hf_==Full_Format
 
-      // Reallocate memory for the "first" array
-      ipos_first_ = new Index[nonzeros_compressed_];
-      for (Index i=0; i<nonzeros_compressed_; i++) {
-        ipos_first_[i] = ipos_first_tmp[i];
+      // Count the entries of each row in both lower and upper
+      // triangles, and the diagonal only once.
+      Index* rc_tmp = new Index[dim_+1];
+      for (Index i=0; i<dim_+1; i++) {
+        rc_tmp[i] = 0;
       }
-      delete[] ipos_first_tmp;
-
-      // Reallocate memory for the "double" arrays
-      ipos_double_triplet_ = new Index[idouble];
-      ipos_double_compressed_ = new Index[idouble];
-      for (Index i=0; i<idouble; i++) {
-        ipos_double_triplet_[i] = ipos_double_triplet_tmp[i];
-        ipos_double_compressed_[i] = ipos_double_compressed_tmp[i];
+      Index nonzeros_compressed_full = 0;
+      for (Index i=0; i<dim_; i++) {
+        for (Index j=row_nz[i]; j<row_nz[i+1]; j++) {
+          nonzeros_compressed_full++;
+          rc_tmp[ja_tmp[j]]++;
+          if (ja_tmp[j]!=i) {
+            nonzeros_compressed_full++;
+            rc_tmp[i]++;
+          }
+        }
+      }
+      Index idouble_full = 0;
+      for (Index jd=0; jd<idouble; jd++) {
+        const Index k = ipos_double_triplet_tmp[jd];
+        idouble_full++;
+        if (row[k]!=col[k]) {
+          idouble_full++;
+        }
       }
-      delete[] ipos_double_triplet_tmp;
-      delete[] ipos_double_compressed_tmp;
-      num_doubles_ = nonzeros_triplet_ - nonzeros_compressed_;
-    }
-    else { // hf_==Full_Format
 
       // Setup ia_tmp to contain insert position for column i as ia_tmp[i+1]
       Index *ia_tmp = new Index[dim_+1];
@@ -233,8 +359,8 @@ namespace Ipopt
       Index jd1=0; // Entry into ipos_double_compressed_tmp
       Index jd2=0; // Entry into ipos_double_compressed_
       for (Index i=0; i<dim_; i++) {
-        for (Index j=ia_[i]; j<ia_[i+1]; j++) {
-          Index jrow = ja_tmp[j]-1;
+        for (Index j=row_nz[i]; j<row_nz[i+1]; j++) {
+          Index jrow = ja_tmp[j];
           ja_[ia_tmp[i+1]] = jrow + offset_;
           ipos_first_[ia_tmp[i+1]] = ipos_first_tmp[j];
           while (jd1<idouble && j==ipos_double_compressed_tmp[jd1]) {
@@ -244,6 +370,7 @@ namespace Ipopt
             if (jrow!=i) {
               ipos_double_triplet_[jd2] = ipos_double_triplet_tmp[jd1];
               ipos_double_compressed_[jd2] = ia_tmp[jrow+1];
+              jd2++;
             }
             jd1++;
           }
@@ -269,6 +396,14 @@ namespace Ipopt
       // Set nonzeros_compressed_ to correct size
       nonzeros_compressed_ = nonzeros_compressed_full;
       num_doubles_ = idouble_full;
+
+      doubles_sorted_ = true;
+      for (Index i=1; i<num_doubles_; i++) {
+        if (ipos_double_compressed_[i] < ipos_double_compressed_[i-1]) {
+          doubles_sorted_ = false;
+          break;
+        }
+      }
     }
 
     initialized_ = true;
@@ -301,12 +436,39 @@ namespace Ipopt
     DBG_ASSERT(nonzeros_triplet_==nonzeros_triplet);
     DBG_ASSERT(nonzeros_compressed_==nonzeros_compressed);
 
-    for (Index i=0; i<nonzeros_compressed_; i++) {
-      a_compressed[i] = a_triplet[ipos_first_[i]];
+    // Each thread copies a contiguous part of the values
+    const Index nthreads = NumThreads(nonzeros_compressed_);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+    for (Index t=0; t<nthreads; t++) {
+      GatherValues(ChunkStart(nonzeros_compressed_, t, nthreads),
+                   ChunkStart(nonzeros_compressed_, t+1, nthreads),
+                   ipos_first_, a_triplet, a_compressed);
     }
-    for (Index i=0; i<num_doubles_; i++) {
-      a_compressed[ipos_double_compressed_[i]] +=
-        a_triplet[ipos_double_triplet_[i]];
+
+    // The repeated entries can be added in parallel if they are
+    // ordered by their position in the compressed format, with the
+    // chunks starting at a new position.
+    const Index ndthreads = doubles_sorted_ ? NumThreads(num_doubles_) : 1;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) num_threads(ndthreads) if(ndthreads > 1)
+#endif
+    for (Index t=0; t<ndthreads; t++) {
+      Index begin = ChunkStart(num_doubles_, t, ndthreads);
+      Index end = ChunkStart(num_doubles_, t+1, ndthreads);
+      while (begin>0 && begin<num_doubles_ &&
+             ipos_double_compressed_[begin]==ipos_double_compressed_[begin-1]) {
+        begin++;
+      }
+      while (end>0 && end<num_doubles_ &&
+             ipos_double_compressed_[end]==ipos_double_compressed_[end-1]) {
+        end++;
+      }
+      for (Index i=begin; i<end; i++) {
+        a_compressed[ipos_double_compressed_[i]] +=
+          a_triplet[ipos_double_triplet_[i]];
+      }
     }
 
     if (DBG_VERBOSITY()>=2) {
@@ -19,109 +19,15 @@ namespace Ipopt
    *  triangual part (or, equivalently, compressed sparse column (CSC)
    *  format for the lower triangular part).  In the description for
    *  this class, we assume that we discuss the CSR format.
+   *
+   *  The entries are ordered with a counting sort by rows, after
+   *  which each row is sorted by columns.  Both steps keep repeated
+   *  entries in the order of the triplet format, and they are done
+   *  in parallel for large matrices if Ipopt is compiled with
+   *  OpenMP.
    */
   class TripletToCSRConverter: public ReferencedObject
   {
-    /** Class for one triplet position entry. */
-    class TripletEntry
-    {
-    public:
-      /** @name Constructor/Destructor */
-      //@{
-      /** Constructor. */
-      TripletEntry()
-      {}
-
-      /** Destructor */
-      ~TripletEntry()
-      {}
-
-      /** Copy constructor, required for std::list */
-      TripletEntry(const TripletEntry& rhs)
-      {
-        i_row_ = rhs.i_row_;
-        j_col_ = rhs.j_col_;
-        i_pos_triplet_ = rhs.i_pos_triplet_;
-      }
-
-      /** Equals Operator, required for std::list */
-      TripletEntry& operator=(const TripletEntry& rhs)
-      {
-        if (this!=&rhs) {
-          i_row_ = rhs.i_row_;
-          j_col_ = rhs.j_col_;
-          i_pos_triplet_ = rhs.i_pos_triplet_;
-        }
-        return *this;
-      }
-      //@}
-
-      /** Set the values of an entry */
-      void Set(Index i_row, Index j_col, Index i_pos_triplet)
-      {
-        if (i_row>j_col) {
-          i_row_ = j_col;
-          j_col_ = i_row;
-        }
-        else {
-          i_row_ = i_row;
-          j_col_ = j_col;
-        }
-        i_pos_triplet_ = i_pos_triplet;
-      }
-
-      /** @name Accessor methods. */
-      //@{
-      /** Row position. */
-      Index IRow() const
-      {
-        return i_row_;
-      }
-      /** Column position. */
-      Index JCol() const
-      {
-        return j_col_;
-      }
-      /** Index in original triplet matrix. */
-      Index PosTriplet() const
-      {
-        return i_pos_triplet_;
-      }
-      //@}
-
-      /** Comparison operator.  This is required for the sort function. */
-      bool operator< (const TripletEntry& Tentry) const
-      {
-        return ((i_row_ < Tentry.i_row_) ||
-                (i_row_==Tentry.i_row_ && j_col_<Tentry.j_col_));
-      }
-
-    private:
-      /**@name Default Compiler Generated Methods
-       * (Hidden to avoid implicit creation/calling).
-       * These methods are not implemented and 
-       * we do not want the compiler to implement
-       * them for us, so we declare them private
-       * and do not define them. This ensures that
-       * they will not be implicitly created/called. */
-      //@{
-      /** Default Constructor */
-      //TripletEntry();
-
-      /** Copy Constructor */
-      /*
-      TripletEntry(const TripletEntry&);
-      */
-      //@}
-
-      /** @name Entry content. */
-      //@{
-      Index i_row_;
-      Index j_col_;
-      Index i_pos_triplet_;
-      //@}
-    };
-
   public:
     /** Enum to specifiy half or full matrix storage */
     enum ETriFull {
@@ -136,8 +42,11 @@ namespace Ipopt
     /* Constructor.  If offset is 0, then the counting of indices in
        the compressed format starts a 0 (C-style numbering); if offset
        is 1, then the counting starts at 1 (Fortran-type
-       numbering). */
-    TripletToCSRConverter(Index offset, ETriFull hf = Triangular_Format);
+       numbering).  num_threads is the number of threads used for
+       large matrices if Ipopt is compiled with OpenMP (0 for the
+       OpenMP default). */
+    TripletToCSRConverter(Index offset, ETriFull hf = Triangular_Format,
+                          Index num_threads = 0);
 
     /** Destructor */
     virtual ~TripletToCSRConverter();
@@ -157,6 +66,11 @@ namespace Ipopt
                               const Index* airn,
                               const Index* ajcn);
 
+    /** Number of threads to be used for an operation on the given
+     *  number of entries.  This is 1 for small matrices and if Ipopt
+     *  is compiled without OpenMP. */
+    Index NumThreads(Index nonzeros) const;
+
     /** @name Accessor methods */
     //@{
     /** Return the IA array for the condensed format. */
@@ -177,6 +91,30 @@ namespace Ipopt
       DBG_ASSERT(initialized_);
       return ipos_first_;
     }
+
+    /** Return the number of triplet entries that are added to an
+     *  entry in the compressed format that already has a value. */
+    Index NumDoubles() const
+    {
+      DBG_ASSERT(initialized_);
+      return num_doubles_;
+    }
+
+    /** Return the positions of the repeated entries in the triplet
+     *  format. */
+    const Index* iPosDoubleTriplet() const
+    {
+      DBG_ASSERT(initialized_);
+      return ipos_double_triplet_;
+    }
+
+    /** Return the positions in the compressed format to which the
+     *  repeated entries are added. */
+    const Index* iPosDoubleCompressed() const
+    {
+      DBG_ASSERT(initialized_);
+      return ipos_double_compressed_;
+    }
     //@}
 
     /** Convert the values of the nonzero elements.  Given the values
@@ -212,6 +150,9 @@ namespace Ipopt
     /** Indicator of half (ie lower only) or full (both upr and lwr) matrix */
     ETriFull hf_;
 
+    /** Number of threads (0 for the OpenMP default) */
+    Index num_threads_;
+
     /** Array storing the values for IA in the condensed format */
     Index* ia_;
 
@@ -248,6 +189,9 @@ namespace Ipopt
     Index* ipos_double_triplet_;
     /** Position of multiple elements in compressed matrix. */
     Index* ipos_double_compressed_;
+    /** Flag indicating if ipos_double_compressed_ is nondecreasing,
+     *  so that the repeated elements can be added in parallel */
+    bool doubles_sorted_;
     //@}
   };
 
@@ -0,0 +1,1100 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#include "IpoptConfig.h"
+#include "AmplExprTape.hpp"
+
+#ifdef HAVE_CMATH
+# include <cmath>
+#else
+# ifdef HAVE_MATH_H
+#  include <math.h>
+# else
+#  error "don't have header file for math"
+# endif
+#endif
+
+#include <algorithm>
+#include <functional>
+
+namespace Ipopt
+{
+#if COIN_IPOPT_VERBOSITY > 0
+  static const Index dbg_verbosity = 0;
+#endif
+
+  static Number Trunc(Number a)
+  {
+    return a<0. ? ceil(a) : floor(a);
+  }
+
+  static Number Asinh(Number a)
+  {
+    if (a<0.) {
+      return -log(-a + sqrt(a*a + 1.));
+    }
+    return log(a + sqrt(a*a + 1.));
+  }
+
+  ExprTape::ExprTape(Index n_vars)
+      :
+      n_vars_(n_vars),
+      var_node_(n_vars, -1)
+  {}
+
+  ExprTape::~ExprTape()
+  {}
+
+  Index ExprTape::AddNodeImpl(Index op, const std::vector<Index>& args,
+                              const std::vector<Number>& coefs, Number param)
+  {
+    DBG_ASSERT(args.size() == coefs.size());
+    const Index nargs = (Index)args.size();
+
+    // Fold constant subexpressions
+    bool all_const = (op != OP_CONST && op != OP_VAR && nargs > 0);
+    for (Index i=0; i<nargs && all_const; i++) {
+      all_const = is_const_[args[i]];
+    }
+    if (all_const) {
+      Node node;
+      node.op = op;
+      node.nargs = nargs;
+      node.first = (Index)args_.size();
+      node.param = param;
+      args_.insert(args_.end(), args.begin(), args.end());
+      coefs_.insert(coefs_.end(), coefs.begin(), coefs.end());
+      Number value = NodeValue(node, &const_val_[0], NULL);
+      args_.resize(node.first);
+      coefs_.resize(node.first);
+      return AddConstant(value);
+    }
+
+    NodeKey key;
+    key.first.reserve(nargs+1);
+    key.first.push_back(op);
+    key.first.insert(key.first.end(), args.begin(), args.end());
+    key.second.push_back(param);
+    if (op == OP_SUM) {
+      key.second.insert(key.second.end(), coefs.begin(), coefs.end());
+    }
+    std::map<NodeKey, Index>::iterator it = node_map_.find(key);
+    if (it != node_map_.end()) {
+      return it->second;
+    }
+
+    Node node;
+    node.op = op;
+    node.nargs = nargs;
+    node.first = (Index)args_.size();
+    node.param = param;
+    args_.insert(args_.end(), args.begin(), args.end());
+    coefs_.insert(coefs_.end(), coefs.begin(), coefs.end());
+
+    Index idx = (Index)nodes_.size();
+    nodes_.push_back(node);
+    is_const_.push_back(op == OP_CONST);
+    const_val_.push_back(op == OP_CONST ? param : 0.);
+    node_map_[key] = idx;
+    return idx;
+  }
+
+  Index ExprTape::AddConstant(Number value)
+  {
+    std::vector<Index> args;
+    std::vector<Number> coefs;
+    return AddNodeImpl(OP_CONST, args, coefs, value);
+  }
+
+  Index ExprTape::AddVariable(Index var)
+  {
+    DBG_ASSERT(var >= 0 && var < n_vars_);
+    if (var_node_[var] < 0) {
+      Node node;
+      node.op = OP_VAR;
+      node.nargs = 0;
+      node.first = var;
+      node.param = 0.;
+      var_node_[var] = (Index)nodes_.size();
+      nodes_.push_back(node);
+      is_const_.push_back(false);
+      const_val_.push_back(0.);
+    }
+    return var_node_[var];
+  }
+
+  Index ExprTape::AddSum(const std::vector<Index>& args,
+                         const std::vector<Number>& coefs,
+                         Number param)
+  {
+    DBG_ASSERT(args.size() == coefs.size());
+    // Canonical form: constant arguments go into param, the other
+    // arguments are sorted and merged
+    std::vector<std::pair<Index, Number> > terms;
+    terms.reserve(args.size());
+    for (size_t i=0; i<args.size(); i++) {
+      if (is_const_[args[i]]) {
+        param += coefs[i]*const_val_[args[i]];
+      }
+      else {
+        terms.push_back(std::make_pair(args[i], coefs[i]));
+      }
+    }
+    std::sort(terms.begin(), terms.end());
+
+    std::vector<Index> sargs;
+    std::vector<Number> scoefs;
+    for (size_t i=0; i<terms.size(); i++) {
+      if (!sargs.empty() && sargs.back() == terms[i].first) {
+        scoefs.back() += terms[i].second;
+      }
+      else {
+        sargs.push_back(terms[i].first);
+        scoefs.push_back(terms[i].second);
+      }
+    }
+    Index k = 0;
+    for (size_t i=0; i<sargs.size(); i++) {
+      if (scoefs[i] != 0.) {
+        sargs[k] = sargs[i];
+        scoefs[k] = scoefs[i];
+        k++;
+      }
+    }
+    sargs.resize(k);
+    scoefs.resize(k);
+
+    if (k == 0) {
+      return AddConstant(param);
+    }
+    if (k == 1 && scoefs[0] == 1. && param == 0.) {
+      return sargs[0];
+    }
+    return AddNodeImpl(OP_SUM, sargs, scoefs, param);
+  }
+
+  Index ExprTape::AddNode(Op op, Index arg0, Index arg1, Index arg2,
+                          Number param)
+  {
+    DBG_ASSERT(op != OP_CONST && op != OP_VAR && op != OP_SUM &&
+               op != OP_MIN && op != OP_MAX);
+    std::vector<Index> args;
+    if (arg0 >= 0) {
+      args.push_back(arg0);
+    }
+    if (arg1 >= 0) {
+      args.push_back(arg1);
+    }
+    if (arg2 >= 0) {
+      args.push_back(arg2);
+    }
+
+    // A few simplifications that keep the Hessian elements small
+    std::vector<Number> coefs(1, 1.);
+    switch (op) {
+    case OP_MUL:
+      DBG_ASSERT(args.size() == 2);
+      if (is_const_[args[0]] && !is_const_[args[1]]) {
+        std::vector<Index> sarg(1, args[1]);
+        coefs[0] = const_val_[args[0]];
+        return AddSum(sarg, coefs);
+      }
+      if (is_const_[args[1]] && !is_const_[args[0]]) {
+        std::vector<Index> sarg(1, args[0]);
+        coefs[0] = const_val_[args[1]];
+        return AddSum(sarg, coefs);
+      }
+      if (args[1] < args[0]) {
+        std::swap(args[0], args[1]);
+      }
+      break;
+    case OP_DIV:
+      DBG_ASSERT(args.size() == 2);
+      if (is_const_[args[1]] && !is_const_[args[0]] &&
+          const_val_[args[1]] != 0.) {
+        std::vector<Index> sarg(1, args[0]);
+        coefs[0] = 1./const_val_[args[1]];
+        return AddSum(sarg, coefs);
+      }
+      break;
+    case OP_POW:
+      DBG_ASSERT(args.size() == 2);
+      if (is_const_[args[1]] && !is_const_[args[0]]) {
+        return AddNode(OP_POWC, args[0], -1, -1, const_val_[args[1]]);
+      }
+      if (is_const_[args[0]] && !is_const_[args[1]]) {
+        return AddNode(OP_CPOW, args[1], -1, -1, const_val_[args[0]]);
+      }
+      break;
+    case OP_POWC:
+      DBG_ASSERT(args.size() == 1);
+      if (param == 1.) {
+        return args[0];
+      }
+      if (param == 0.) {
+        return AddConstant(1.);
+      }
+      break;
+    default:
+      break;
+    }
+
+    coefs.assign(args.size(), 1.);
+    return AddNodeImpl(op, args, coefs, param);
+  }
+
+  Index ExprTape::AddList(Op op, const std::vector<Index>& args)
+  {
+    DBG_ASSERT(op == OP_MIN || op == OP_MAX);
+    DBG_ASSERT(!args.empty());
+    std::vector<Index> sargs(args);
+    std::sort(sargs.begin(), sargs.end());
+    sargs.erase(std::unique(sargs.begin(), sargs.end()), sargs.end());
+    if (sargs.size() == 1) {
+      return sargs[0];
+    }
+    std::vector<Number> coefs(sargs.size(), 1.);
+    return AddNodeImpl(op, sargs, coefs, 0.);
+  }
+
+  Index ExprTape::AddFunction(Index root,
+                              const std::vector<Index>& lin_vars,
+                              const std::vector<Number>& lin_coefs)
+  {
+    DBG_ASSERT(lin_vars.size() == lin_coefs.size());
+    DBG_ASSERT(root < (Index)nodes_.size());
+    if (lin_start_.empty()) {
+      lin_start_.push_back(0);
+    }
+    func_root_.push_back(root);
+    lin_var_.insert(lin_var_.end(), lin_vars.begin(), lin_vars.end());
+    lin_coef_.insert(lin_coef_.end(), lin_coefs.begin(), lin_coefs.end());
+    lin_start_.push_back((Index)lin_var_.size());
+    return (Index)func_root_.size() - 1;
+  }
+
+  void ExprTape::CollectNodes(Index root, std::vector<Index>& stamp,
+                              Index mark, std::vector<Index>& stack,
+                              std::vector<Index>& list) const
+  {
+    list.clear();
+    stack.clear();
+    stamp[root] = mark;
+    stack.push_back(root);
+    while (!stack.empty()) {
+      Index i = stack.back();
+      stack.pop_back();
+      list.push_back(i);
+      const Node& node = nodes_[i];
+      for (Index s=0; s<node.nargs; s++) {
+        Index a = args_[node.first+s];
+        if (stamp[a] != mark) {
+          stamp[a] = mark;
+          stack.push_back(a);
+        }
+      }
+    }
+    std::sort(list.begin(), list.end());
+  }
+
+  void ExprTape::Finalize()
+  {
+    DBG_START_METH("ExprTape::Finalize", dbg_verbosity);
+
+    node_map_.clear();
+    is_const_.clear();
+    const_val_.clear();
+    if (lin_start_.empty()) {
+      lin_start_.push_back(0);
+    }
+
+    const Index n_nodes = (Index)nodes_.size();
+    const Index n_funcs = (Index)func_root_.size();
+    std::vector<Index> stamp(n_nodes, -1);
+    Index mark = 0;
+    std::vector<Index> stack;
+    std::vector<Index> list;
+
+    // Nodes and variables of each function
+    std::vector<Index> var_pos(n_vars_, -1);
+    fnode_start_.assign(1, 0);
+    fnode_list_.clear();
+    fvar_start_.assign(1, 0);
+    fvar_list_.clear();
+    fvar_node_.clear();
+    fvar_lin_.clear();
+    for (Index f=0; f<n_funcs; f++) {
+      list.clear();
+      if (func_root_[f] >= 0) {
+        CollectNodes(func_root_[f], stamp, mark, stack, list);
+      }
+      fnode_list_.insert(fnode_list_.end(), list.begin(), list.end());
+      fnode_start_.push_back((Index)fnode_list_.size());
+
+      std::vector<Index> vars;
+      for (size_t k=0; k<list.size(); k++) {
+        if (nodes_[list[k]].op == OP_VAR) {
+          vars.push_back(nodes_[list[k]].first);
+        }
+      }
+      for (Index k=lin_start_[f]; k<lin_start_[f+1]; k++) {
+        vars.push_back(lin_var_[k]);
+      }
+      std::sort(vars.begin(), vars.end());
+      vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+
+      const Index start = (Index)fvar_list_.size();
+      for (size_t k=0; k<vars.size(); k++) {
+        Index v = vars[k];
+        var_pos[v] = start + (Index)k;
+        fvar_list_.push_back(v);
+        Index vnode = var_node_[v];
+        fvar_node_.push_back((vnode >= 0 && stamp[vnode] == mark) ? vnode : -1);
+        fvar_lin_.push_back(0.);
+      }
+      for (Index k=lin_start_[f]; k<lin_start_[f+1]; k++) {
+        fvar_lin_[var_pos[lin_var_[k]]] += lin_coef_[k];
+      }
+      fvar_start_.push_back((Index)fvar_list_.size());
+      mark++;
+    }
+
+    // Nonlinear elements: the arguments of the sums at the top of
+    // each function.  The nodes are processed in decreasing order, so
+    // that every node is expanded only once.
+    std::map<Index, Index> elem_of_node;
+    std::vector<std::vector<std::pair<Index, Number> > > elem_funcs;
+    elem_root_.clear();
+    for (Index f=0; f<n_funcs; f++) {
+      if (func_root_[f] < 0) {
+        continue;
+      }
+      std::map<Index, Number, std::greater<Index> > pending;
+      std::map<Index, Number> elems;
+      pending[func_root_[f]] = 1.;
+      while (!pending.empty()) {
+        Index i = pending.begin()->first;
+        Number c = pending.begin()->second;
+        pending.erase(pending.begin());
+        const Node& node = nodes_[i];
+        if (node.op == OP_SUM) {
+          for (Index s=0; s<node.nargs; s++) {
+            pending[args_[node.first+s]] += c*coefs_[node.first+s];
+          }
+        }
+        else if (node.op != OP_VAR && node.op != OP_CONST) {
+          elems[i] += c;
+        }
+      }
+      for (std::map<Index, Number>::iterator it = elems.begin();
+           it != elems.end(); it++) {
+        if (it->second == 0.) {
+          continue;
+        }
+        std::map<Index, Index>::iterator e = elem_of_node.find(it->first);
+        Index ie;
+        if (e == elem_of_node.end()) {
+          ie = (Index)elem_root_.size();
+          elem_of_node[it->first] = ie;
+          elem_root_.push_back(it->first);
+          elem_funcs.push_back(std::vector<std::pair<Index, Number> >());
+        }
+        else {
+          ie = e->second;
+        }
+        elem_funcs[ie].push_back(std::make_pair(f, it->second));
+      }
+    }
+
+    const Index n_elems = (Index)elem_root_.size();
+    elem_func_start_.assign(1, 0);
+    elem_func_.clear();
+    elem_func_coef_.clear();
+    enode_start_.assign(1, 0);
+    enode_list_.clear();
+    evar_start_.assign(1, 0);
+    evar_node_.clear();
+    for (Index e=0; e<n_elems; e++) {
+      for (size_t k=0; k<elem_funcs[e].size(); k++) {
+        elem_func_.push_back(elem_funcs[e][k].first);
+        elem_func_coef_.push_back(elem_funcs[e][k].second);
+      }
+      elem_func_start_.push_back((Index)elem_func_.size());
+
+      CollectNodes(elem_root_[e], stamp, mark, stack, list);
+      mark++;
+      enode_list_.insert(enode_list_.end(), list.begin(), list.end());
+      enode_start_.push_back((Index)enode_list_.size());
+
+      std::vector<Index> vars;
+      for (size_t k=0; k<list.size(); k++) {
+        if (nodes_[list[k]].op == OP_VAR) {
+          vars.push_back(nodes_[list[k]].first);
+        }
+      }
+      std::sort(vars.begin(), vars.end());
+      for (size_t k=0; k<vars.size(); k++) {
+        evar_node_.push_back(var_node_[vars[k]]);
+      }
+      evar_start_.push_back((Index)evar_node_.size());
+    }
+
+    // Hessian structure, and the position of each entry of the
+    // element Hessians
+    std::map<std::pair<Index, Index>, Index> hess_map;
+    for (Index e=0; e<n_elems; e++) {
+      for (Index s=evar_start_[e]; s<evar_start_[e+1]; s++) {
+        Index vs = nodes_[evar_node_[s]].first;
+        for (Index t=evar_start_[e]; t<=s; t++) {
+          Index vt = nodes_[evar_node_[t]].first;
+          hess_map[std::make_pair(vs, vt)] = -1;
+        }
+      }
+    }
+    hess_row_.clear();
+    hess_col_.clear();
+    for (std::map<std::pair<Index, Index>, Index>::iterator it = hess_map.begin();
+         it != hess_map.end(); it++) {
+      it->second = (Index)hess_row_.size();
+      hess_row_.push_back(it->first.first);
+      hess_col_.push_back(it->first.second);
+    }
+    epos_start_.assign(1, 0);
+    epos_.clear();
+    for (Index e=0; e<n_elems; e++) {
+      for (Index s=evar_start_[e]; s<evar_start_[e+1]; s++) {
+        Index vs = nodes_[evar_node_[s]].first;
+        for (Index t=evar_start_[e]; t<=s; t++) {
+          Index vt = nodes_[evar_node_[t]].first;
+          epos_.push_back(hess_map[std::make_pair(vs, vt)]);
+        }
+      }
+      epos_start_.push_back((Index)epos_.size());
+    }
+  }
+
+  SmartPtr<ExprTapeWorkspace> ExprTape::MakeWorkspace() const
+  {
+    return new ExprTapeWorkspace((Index)nodes_.size(), (Index)args_.size());
+  }
+
+  Number ExprTape::NodeValue(const Node& node, const Number* val,
+                             const Number* x) const
+  {
+    const Index* a = node.nargs > 0 ? &args_[node.first] : NULL;
+    switch (node.op) {
+    case OP_CONST:
+      return node.param;
+    case OP_VAR:
+      return x[node.first];
+    case OP_SUM: {
+        const Number* c = &coefs_[node.first];
+        Number r = node.param;
+        for (Index s=0; s<node.nargs; s++) {
+          r += c[s]*val[a[s]];
+        }
+        return r;
+      }
+    case OP_MUL:
+      return val[a[0]]*val[a[1]];
+    case OP_DIV:
+      return val[a[0]]/val[a[1]];
+    case OP_POW:
+      return pow(val[a[0]], val[a[1]]);
+    case OP_POWC: {
+        Number v = val[a[0]];
+        if (node.param == 2.) {
+          return v*v;
+        }
+        return pow(v, node.param);
+      }
+    case OP_CPOW:
+      return pow(node.param, val[a[0]]);
+    case OP_SQRT:
+      return sqrt(val[a[0]]);
+    case OP_EXP:
+      return exp(val[a[0]]);
+    case OP_LOG:
+      return log(val[a[0]]);
+    case OP_LOG10:
+      return log10(val[a[0]]);
+    case OP_SIN:
+      return sin(val[a[0]]);
+    case OP_COS:
+      return cos(val[a[0]]);
+    case OP_TAN:
+      return tan(val[a[0]]);
+    case OP_SINH:
+      return sinh(val[a[0]]);
+    case OP_COSH:
+      return cosh(val[a[0]]);
+    case OP_TANH:
+      return tanh(val[a[0]]);
+    case OP_ASIN:
+      return asin(val[a[0]]);
+    case OP_ACOS:
+      return acos(val[a[0]]);
+    case OP_ATAN:
+      return atan(val[a[0]]);
+    case OP_ASINH:
+      return Asinh(val[a[0]]);
+    case OP_ACOSH: {
+        Number v = val[a[0]];
+        return log(v + sqrt(v*v - 1.));
+      }
+    case OP_ATANH: {
+        Number v = val[a[0]];
+        return 0.5*log((1. + v)/(1. - v));
+      }
+    case OP_ATAN2:
+      return atan2(val[a[0]], val[a[1]]);
+    case OP_ABS:
+      return fabs(val[a[0]]);
+    case OP_FLOOR:
+      return floor(val[a[0]]);
+    case OP_CEIL:
+      return ceil(val[a[0]]);
+    case OP_MIN: {
+        Number r = val[a[0]];
+        for (Index s=1; s<node.nargs; s++) {
+          r = Min(r, val[a[s]]);
+        }
+        return r;
+      }
+    case OP_MAX: {
+        Number r = val[a[0]];
+        for (Index s=1; s<node.nargs; s++) {
+          r = Max(r, val[a[s]]);
+        }
+        return r;
+      }
+    case OP_REM:
+      return fmod(val[a[0]], val[a[1]]);
+    case OP_INTDIV:
+      return Trunc(val[a[0]]/val[a[1]]);
+    case OP_LESS: {
+        Number r = val[a[0]] - val[a[1]];
+        return r < 0. ? 0. : r;
+      }
+    case OP_IF:
+      return val[a[0]] != 0. ? val[a[1]] : val[a[2]];
+    case OP_LT:
+      return val[a[0]] < val[a[1]] ? 1. : 0.;
+    case OP_LE:
+      return val[a[0]] <= val[a[1]] ? 1. : 0.;
+    case OP_EQ:
+      return val[a[0]] == val[a[1]] ? 1. : 0.;
+    case OP_GE:
+      return val[a[0]] >= val[a[1]] ? 1. : 0.;
+    case OP_GT:
+      return val[a[0]] > val[a[1]] ? 1. : 0.;
+    case OP_NE:
+      return val[a[0]] != val[a[1]] ? 1. : 0.;
+    case OP_AND:
+      return (val[a[0]] != 0. && val[a[1]] != 0.) ? 1. : 0.;
+    case OP_OR:
+      return (val[a[0]] != 0. || val[a[1]] != 0.) ? 1. : 0.;
+    case OP_NOT:
+      return val[a[0]] == 0. ? 1. : 0.;
+    default:
+      DBG_ASSERT(false && "Unknown operation in ExprTape");
+    }
+    return 0.;
+  }
+
+  void ExprTape::NodePartials(const Node& node, const Number* val,
+                              Number* d1, Number* d2) const
+  {
+    const Index* a = &args_[node.first];
+    d2[0] = d2[1] = d2[2] = 0.;
+    switch (node.op) {
+    case OP_SUM: {
+        const Number* c = &coefs_[node.first];
+        for (Index s=0; s<node.nargs; s++) {
+          d1[s] = c[s];
+        }
+      }
+      break;
+    case OP_MUL:
+      d1[0] = val[a[1]];
+      d1[1] = val[a[0]];
+      d2[1] = 1.;
+      break;
+    case OP_DIV: {
+        Number b = val[a[1]];
+        Number r = val[a[0]]/b;
+        d1[0] = 1./b;
+        d1[1] = -r/b;
+        d2[1] = -1./(b*b);
+        d2[2] = 2.*r/(b*b);
+      }
+      break;
+    case OP_POW: {
+        Number u = val[a[0]];
+        Number b = val[a[1]];
+        Number pm1 = pow(u, b - 1.);
+        d1[0] = b*pm1;
+        d2[0] = b*(b - 1.)*pow(u, b - 2.);
+        // The derivatives with respect to the exponent are only
+        // defined for a positive base
+        if (u > 0.) {
+          Number lu = log(u);
+          Number r = pm1*u;
+          d1[1] = r*lu;
+          d2[1] = pm1*(1. + b*lu);
+          d2[2] = r*lu*lu;
+        }
+        else {
+          d1[1] = 0.;
+        }
+      }
+      break;
+    case OP_POWC: {
+        Number u = val[a[0]];
+        Number p = node.param;
+        if (p == 2.) {
+          d1[0] = 2.*u;
+          d2[0] = 2.;
+        }
+        else {
+          d1[0] = p*pow(u, p - 1.);
+          d2[0] = p*(p - 1.)*pow(u, p - 2.);
+        }
+      }
+      break;
+    case OP_CPOW: {
+        Number lc = log(node.param);
+        Number r = pow(node.param, val[a[0]]);
+        d1[0] = r*lc;
+        d2[0] = r*lc*lc;
+      }
+      break;
+    case OP_SQRT: {
+        Number u = val[a[0]];
+        Number r = sqrt(u);
+        d1[0] = 0.5/r;
+        d2[0] = -0.25/(r*u);
+      }
+      break;
+    case OP_EXP: {
+        Number r = exp(val[a[0]]);
+        d1[0] = r;
+        d2[0] = r;
+      }
+      break;
+    case OP_LOG: {
+        Number u = val[a[0]];
+        d1[0] = 1./u;
+        d2[0] = -1./(u*u);
+      }
+      break;
+    case OP_LOG10: {
+        static const Number c = 1./log(10.);
+        Number u = val[a[0]];
+        d1[0] = c/u;
+        d2[0] = -c/(u*u);
+      }
+      break;
+    case OP_SIN: {
+        Number u = val[a[0]];
+        d1[0] = cos(u);
+        d2[0] = -sin(u);
+      }
+      break;
+    case OP_COS: {
+        Number u = val[a[0]];
+        d1[0] = -sin(u);
+        d2[0] = -cos(u);
+      }
+      break;
+    case OP_TAN: {
+        Number r = tan(val[a[0]]);
+        d1[0] = 1. + r*r;
+        d2[0] = 2.*r*d1[0];
+      }
+      break;
+    case OP_SINH: {
+        Number u = val[a[0]];
+        d1[0] = cosh(u);
+        d2[0] = sinh(u);
+      }
+      break;
+    case OP_COSH: {
+        Number u = val[a[0]];
+        d1[0] = sinh(u);
+        d2[0] = cosh(u);
+      }
+      break;
+    case OP_TANH: {
+        Number r = tanh(val[a[0]]);
+        d1[0] = 1. - r*r;
+        d2[0] = -2.*r*d1[0];
+      }
+      break;
+    case OP_ASIN: {
+        Number u = val[a[0]];
+        Number t = 1./sqrt(1. - u*u);
+        d1[0] = t;
+        d2[0] = u*t*t*t;
+      }
+      break;
+    case OP_ACOS: {
+        Number u = val[a[0]];
+        Number t = 1./sqrt(1. - u*u);
+        d1[0] = -t;
+        d2[0] = -u*t*t*t;
+      }
+      break;
+    case OP_ATAN: {
+        Number u = val[a[0]];
+        Number t = 1./(1. + u*u);
+        d1[0] = t;
+        d2[0] = -2.*u*t*t;
+      }
+      break;
+    case OP_ASINH: {
+        Number u = val[a[0]];
+        Number t = 1./sqrt(1. + u*u);
+        d1[0] = t;
+        d2[0] = -u*t*t*t;
+      }
+      break;
+    case OP_ACOSH: {
+        Number u = val[a[0]];
+        Number t = 1./sqrt(u*u - 1.);
+        d1[0] = t;
+        d2[0] = -u*t*t*t;
+      }
+      break;
+    case OP_ATANH: {
+        Number u = val[a[0]];
+        Number t = 1./(1. - u*u);
+        d1[0] = t;
+        d2[0] = 2.*u*t*t;
+      }
+      break;
+    case OP_ATAN2: {
+        Number u = val[a[0]];
+        Number v = val[a[1]];
+        Number t = 1./(u*u + v*v);
+        d1[0] = v*t;
+        d1[1] = -u*t;
+        d2[0] = -2.*u*v*t*t;
+        d2[1] = (u*u - v*v)*t*t;
+        d2[2] = 2.*u*v*t*t;
+      }
+      break;
+    case OP_ABS:
+      d1[0] = val[a[0]] < 0. ? -1. : 1.;
+      break;
+    case OP_MIN:
+    case OP_MAX: {
+        Index best = 0;
+        for (Index s=1; s<node.nargs; s++) {
+          if (node.op == OP_MIN ? val[a[s]] < val[a[best]] : val[a[s]] > val[a[best]]) {
+            best = s;
+          }
+        }
+        for (Index s=0; s<node.nargs; s++) {
+          d1[s] = (s == best) ? 1. : 0.;
+        }
+      }
+      break;
+    case OP_REM:
+      d1[0] = 1.;
+      d1[1] = -Trunc(val[a[0]]/val[a[1]]);
+      break;
+    case OP_LESS:
+      if (val[a[0]] - val[a[1]] < 0.) {
+        d1[0] = d1[1] = 0.;
+      }
+      else {
+        d1[0] = 1.;
+        d1[1] = -1.;
+      }
+      break;
+    case OP_IF:
+      d1[0] = 0.;
+      d1[1] = (val[a[0]] != 0.) ? 1. : 0.;
+      d1[2] = 1. - d1[1];
+      break;
+    default:
+      // piecewise constant operations
+      for (Index s=0; s<node.nargs; s++) {
+        d1[s] = 0.;
+      }
+      break;
+    }
+  }
+
+  void ExprTape::Forward(const Number* x, ExprTapeWorkspace& ws) const
+  {
+    DBG_START_METH("ExprTape::Forward", dbg_verbosity);
+    const Index n_nodes = (Index)nodes_.size();
+    if (n_nodes > 0) {
+      Number* val = &ws.val_[0];
+      for (Index i=0; i<n_nodes; i++) {
+        val[i] = NodeValue(nodes_[i], val, x);
+      }
+    }
+    ws.forward_done_ = true;
+    ws.partials_done_ = false;
+  }
+
+  void ExprTape::ComputePartials(ExprTapeWorkspace& ws) const
+  {
+    DBG_ASSERT(ws.forward_done_);
+    const Index n_nodes = (Index)nodes_.size();
+    for (Index i=0; i<n_nodes; i++) {
+      const Node& node = nodes_[i];
+      if (node.nargs > 0) {
+        NodePartials(node, &ws.val_[0], &ws.d1_[node.first], &ws.d2_[3*i]);
+      }
+    }
+    ws.partials_done_ = true;
+  }
+
+  void ExprTape::ForwardNodes(const Index* list, Index n, const Number* x,
+                              ExprTapeWorkspace& ws, bool partials) const
+  {
+    if (n == 0) {
+      return;
+    }
+    Number* val = &ws.val_[0];
+    for (Index k=0; k<n; k++) {
+      const Index i = list[k];
+      const Node& node = nodes_[i];
+      val[i] = NodeValue(node, val, x);
+      if (partials && node.nargs > 0) {
+        NodePartials(node, val, &ws.d1_[node.first], &ws.d2_[3*i]);
+      }
+    }
+  }
+
+  void ExprTape::ReverseNodes(Index root, const Index* list, Index n,
+                              ExprTapeWorkspace& ws) const
+  {
+    Number* adj = &ws.adj_[0];
+    const Number* d1 = &ws.d1_[0];
+    for (Index k=0; k<n; k++) {
+      adj[list[k]] = 0.;
+    }
+    adj[root] = 1.;
+    for (Index k=n-1; k>=0; k--) {
+      const Index i = list[k];
+      const Number ai = adj[i];
+      const Node& node = nodes_[i];
+      // Skipping nodes without adjoint also keeps invalid values in
+      // the branch of a conditional that is not taken from spreading
+      if (ai == 0. || node.nargs == 0) {
+        continue;
+      }
+      const Index* a = &args_[node.first];
+      const Number* d = d1 + node.first;
+      for (Index s=0; s<node.nargs; s++) {
+        adj[a[s]] += d[s]*ai;
+      }
+    }
+  }
+
+  void ExprTape::GatherGradient(Index f, const ExprTapeWorkspace& ws,
+                                Number* grad) const
+  {
+    const Index start = fvar_start_[f];
+    const Index end = fvar_start_[f+1];
+    for (Index k=start; k<end; k++) {
+      Index node = fvar_node_[k];
+      grad[k-start] = fvar_lin_[k] + (node >= 0 ? ws.adj_[node] : 0.);
+    }
+  }
+
+  Number ExprTape::FunctionValue(Index f, const Number* x,
+                                 const ExprTapeWorkspace& ws) const
+  {
+    Number r = func_root_[f] >= 0 ? ws.val_[func_root_[f]] : 0.;
+    for (Index k=lin_start_[f]; k<lin_start_[f+1]; k++) {
+      r += lin_coef_[k]*x[lin_var_[k]];
+    }
+    return r;
+  }
+
+  void ExprTape::FunctionGradient(Index f, ExprTapeWorkspace& ws,
+                                  Number* grad) const
+  {
+    DBG_ASSERT(ws.forward_done_);
+    const Index root = func_root_[f];
+    if (root >= 0) {
+      if (!ws.partials_done_) {
+        ComputePartials(ws);
+      }
+      ReverseNodes(root, &fnode_list_[fnode_start_[f]],
+                   fnode_start_[f+1] - fnode_start_[f], ws);
+    }
+    GatherGradient(f, ws, grad);
+  }
+
+  Number ExprTape::EvalFunction(Index f, const Number* x,
+                                ExprTapeWorkspace& ws) const
+  {
+    ws.Invalidate();
+    const Index n = fnode_start_[f+1] - fnode_start_[f];
+    if (n > 0) {
+      ForwardNodes(&fnode_list_[fnode_start_[f]], n, x, ws, false);
+    }
+    return FunctionValue(f, x, ws);
+  }
+
+  void ExprTape::EvalFunctionGradient(Index f, const Number* x,
+                                      ExprTapeWorkspace& ws,
+                                      Number* grad) const
+  {
+    ws.Invalidate();
+    const Index n = fnode_start_[f+1] - fnode_start_[f];
+    if (n > 0) {
+      const Index* list = &fnode_list_[fnode_start_[f]];
+      ForwardNodes(list, n, x, ws, true);
+      ReverseNodes(func_root_[f], list, n, ws);
+    }
+    GatherGradient(f, ws, grad);
+  }
+
+  void ExprTape::HessianStructure(Index* iRow, Index* jCol) const
+  {
+    for (size_t k=0; k<hess_row_.size(); k++) {
+      iRow[k] = hess_row_[k];
+      jCol[k] = hess_col_[k];
+    }
+  }
+
+  void ExprTape::HessianValues(const Number* weights, ExprTapeWorkspace& ws,
+                               Number* values) const
+  {
+    DBG_START_METH("ExprTape::HessianValues", dbg_verbosity);
+    DBG_ASSERT(ws.forward_done_);
+
+    const Index nnz = (Index)hess_row_.size();
+    for (Index k=0; k<nnz; k++) {
+      values[k] = 0.;
+    }
+    const Index n_elems = (Index)elem_root_.size();
+    if (n_elems == 0) {
+      return;
+    }
+    if (!ws.partials_done_) {
+      ComputePartials(ws);
+    }
+
+    const Number* adj = &ws.adj_[0];
+    Number* dot = &ws.dot_[0];
+    Number* adjdot = &ws.adjdot_[0];
+    const Number* d1 = &ws.d1_[0];
+    const Number* d2 = &ws.d2_[0];
+
+    for (Index e=0; e<n_elems; e++) {
+      Number w = 0.;
+      for (Index k=elem_func_start_[e]; k<elem_func_start_[e+1]; k++) {
+        w += weights[elem_func_[k]]*elem_func_coef_[k];
+      }
+      if (w == 0.) {
+        continue;
+      }
+
+      const Index* list = &enode_list_[enode_start_[e]];
+      const Index n = enode_start_[e+1] - enode_start_[e];
+      const Index* vnodes = &evar_node_[evar_start_[e]];
+      const Index nv = evar_start_[e+1] - evar_start_[e];
+      const Index* pos = &epos_[epos_start_[e]];
+
+      // First order adjoints are the same for all directions
+      ReverseNodes(elem_root_[e], list, n, ws);
+
+      for (Index t=0; t<nv; t++) {
+        // Tangent in the direction of the t-th variable
+        for (Index k=0; k<n; k++) {
+          dot[list[k]] = 0.;
+          adjdot[list[k]] = 0.;
+        }
+        dot[vnodes[t]] = 1.;
+        for (Index k=0; k<n; k++) {
+          const Index i = list[k];
+          const Node& node = nodes_[i];
+          if (node.nargs == 0) {
+            continue;
+          }
+          const Index* a = &args_[node.first];
+          const Number* d = d1 + node.first;
+          Number r = 0.;
+          for (Index s=0; s<node.nargs; s++) {
+            if (d[s] != 0. && dot[a[s]] != 0.) {
+              r += d[s]*dot[a[s]];
+            }
+          }
+          dot[i] = r;
+        }
+
+        // Second order adjoints
+        for (Index k=n-1; k>=0; k--) {
+          const Index i = list[k];
+          const Node& node = nodes_[i];
+          const Number ai = adj[i];
+          const Number adi = adjdot[i];
+          if (node.nargs == 0 || (ai == 0. && adi == 0.)) {
+            continue;
+          }
+          const Index* a = &args_[node.first];
+          if (adi != 0.) {
+            const Number* d = d1 + node.first;
+            for (Index s=0; s<node.nargs; s++) {
+              adjdot[a[s]] += d[s]*adi;
+            }
+          }
+          if (ai != 0. && node.op != OP_SUM && node.nargs <= 2) {
+            const Number* h = d2 + 3*i;
+            if (node.nargs == 1) {
+              if (dot[a[0]] != 0. && h[0] != 0.) {
+                adjdot[a[0]] += ai*h[0]*dot[a[0]];
+              }
+            }
+            else {
+              const Number t0 = dot[a[0]];
+              const Number t1 = dot[a[1]];
+              Number r0 = 0.;
+              Number r1 = 0.;
+              if (t0 != 0.) {
+                r0 += h[0]*t0;
+                r1 += h[1]*t0;
+              }
+              if (t1 != 0.) {
+                r0 += h[1]*t1;
+                r1 += h[2]*t1;
+              }
+              adjdot[a[0]] += ai*r0;
+              adjdot[a[1]] += ai*r1;
+            }
+          }
+        }
+
+        for (Index s=t; s<nv; s++) {
+          values[pos[(s*(s+1))/2 + t]] += w*adjdot[vnodes[s]];
+        }
+      }
+    }
+  }
+
+  void ExprTape::PrintStatistics(const Journalist& jnlst, EJournalLevel level,
+                                 EJournalCategory category) const
+  {
+    jnlst.Printf(level, category,
+                 "Expression tape: %d nodes, %d arguments, %d functions, %d nonlinear elements.\n",
+                 (Index)nodes_.size(), (Index)args_.size(),
+                 (Index)func_root_.size(), (Index)elem_root_.size());
+    jnlst.Printf(level, category,
+                 "                 %d function nodes, %d element nodes, %d Hessian nonzeros.\n",
+                 (Index)fnode_list_.size(), (Index)enode_list_.size(),
+                 (Index)hess_row_.size());
+  }
+
+} // namespace Ipopt
@@ -0,0 +1,408 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifndef __IPAMPLEXPRTAPE_HPP__
+#define __IPAMPLEXPRTAPE_HPP__
+
+#include "IpUtils.hpp"
+#include "IpReferenced.hpp"
+#include "IpSmartPtr.hpp"
+#include "IpJournalist.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Ipopt
+{
+  class ExprTapeWorkspace;
+
+  /** Flat representation of the functions of an NLP as an expression
+   *  DAG.
+   *
+   *  The nodes are stored in one contiguous array in topological
+   *  order (every node comes after its arguments), and the arguments
+   *  of all nodes are stored in one contiguous index array.  While the
+   *  tape is built, identical nodes (same operation, same constant and
+   *  same arguments) are merged, so that common subexpressions are
+   *  evaluated only once.  Constant subexpressions are folded.
+   *
+   *  Each function is the sum of a nonlinear part (a node of the
+   *  tape) and a linear part.  After Finalize has been called, the
+   *  tape is not changed anymore; all evaluation methods are const
+   *  and keep their intermediate results in an ExprTapeWorkspace, so
+   *  that several threads can evaluate the same tape, each with its
+   *  own workspace.
+   *
+   *  Gradients are computed by a reverse sweep over the nodes a
+   *  function depends on.  For the Hessian of the Lagrangian, each
+   *  function is split into its nonlinear elements (the arguments of
+   *  the sums at its top), and the dense Hessian of every element is
+   *  obtained by forward-over-reverse sweeps over the nodes of the
+   *  element, one per variable of the element.
+   */
+  class ExprTape : public ReferencedObject
+  {
+  public:
+    /** Operations of the nodes */
+    enum Op {
+      OP_CONST=0, /**< constant, value in param */
+      OP_VAR,     /**< variable */
+      OP_SUM,     /**< param + sum of coef_i*arg_i */
+      OP_MUL,     /**< arg_0*arg_1 */
+      OP_DIV,     /**< arg_0/arg_1 */
+      OP_POW,     /**< arg_0^arg_1 */
+      OP_POWC,    /**< arg_0^param */
+      OP_CPOW,    /**< param^arg_0 */
+      OP_SQRT,
+      OP_EXP,
+      OP_LOG,
+      OP_LOG10,
+      OP_SIN,
+      OP_COS,
+      OP_TAN,
+      OP_SINH,
+      OP_COSH,
+      OP_TANH,
+      OP_ASIN,
+      OP_ACOS,
+      OP_ATAN,
+      OP_ASINH,
+      OP_ACOSH,
+      OP_ATANH,
+      OP_ATAN2,   /**< atan2(arg_0, arg_1) */
+      OP_ABS,
+      OP_FLOOR,
+      OP_CEIL,
+      OP_MIN,     /**< minimum of all arguments */
+      OP_MAX,     /**< maximum of all arguments */
+      OP_REM,     /**< remainder of arg_0/arg_1 */
+      OP_INTDIV,  /**< integer part of arg_0/arg_1 */
+      OP_LESS,    /**< max(arg_0-arg_1, 0) */
+      OP_IF,      /**< arg_0!=0 ? arg_1 : arg_2 */
+      OP_LT,
+      OP_LE,
+      OP_EQ,
+      OP_GE,
+      OP_GT,
+      OP_NE,
+      OP_AND,
+      OP_OR,
+      OP_NOT
+    };
+
+    /**@name Constructors/Destructors */
+    //@{
+    /** Constructor for a tape over n_vars variables. */
+    ExprTape(Index n_vars);
+
+    /** Default destructor */
+    virtual ~ExprTape();
+    //@}
+
+    /**@name Methods for building the tape.  They return the index of
+     * the (possibly already existing) node. */
+    //@{
+    /** Constant node */
+    Index AddConstant(Number value);
+    /** Node for variable var (0-based) */
+    Index AddVariable(Index var);
+    /** Node param + sum of coefs[i]*args[i] */
+    Index AddSum(const std::vector<Index>& args,
+                 const std::vector<Number>& coefs,
+                 Number param=0.);
+    /** Node for an operation with one, two, or three arguments (the
+     *  unused ones are -1), or with the constant param for OP_POWC
+     *  and OP_CPOW. */
+    Index AddNode(Op op, Index arg0, Index arg1=-1, Index arg2=-1,
+                  Number param=0.);
+    /** Node for OP_MIN or OP_MAX */
+    Index AddList(Op op, const std::vector<Index>& args);
+    /** Adds a function with the nonlinear part root (-1 if there is
+     *  none) and the linear part sum of lin_coefs[i]*x[lin_vars[i]].
+     *  Returns the index of the function. */
+    Index AddFunction(Index root,
+                      const std::vector<Index>& lin_vars,
+                      const std::vector<Number>& lin_coefs);
+    /** Computes the dependencies and the Hessian structure.  Must be
+     *  called after the last node and function have been added and
+     *  before the first evaluation. */
+    void Finalize();
+    //@}
+
+    /**@name Sizes */
+    //@{
+    Index NumVariables() const
+    {
+      return n_vars_;
+    }
+    Index NumNodes() const
+    {
+      return (Index)nodes_.size();
+    }
+    Index NumFunctions() const
+    {
+      return (Index)func_root_.size();
+    }
+    /** Number of variables function f depends on */
+    Index FunctionNumVariables(Index f) const
+    {
+      return fvar_start_[f+1] - fvar_start_[f];
+    }
+    /** The variables function f depends on, in increasing order.  The
+     *  gradients are returned in this order. */
+    const Index* FunctionVariables(Index f) const
+    {
+      return &fvar_list_[fvar_start_[f]];
+    }
+    /** Number of (lower triangular) nonzeros in the Hessian of a
+     *  weighted sum of all functions. */
+    Index NumHessianNonzeros() const
+    {
+      return (Index)hess_row_.size();
+    }
+    //@}
+
+    /** Creates a workspace for the evaluation of this tape. */
+    SmartPtr<ExprTapeWorkspace> MakeWorkspace() const;
+
+    /**@name Evaluation methods */
+    //@{
+    /** Evaluates all nodes at x. */
+    void Forward(const Number* x, ExprTapeWorkspace& ws) const;
+    /** Value of function f at the x of the last call of Forward. */
+    Number FunctionValue(Index f, const Number* x,
+                         const ExprTapeWorkspace& ws) const;
+    /** Gradient of function f at the x of the last call of Forward.
+     *  grad has FunctionNumVariables(f) entries. */
+    void FunctionGradient(Index f, ExprTapeWorkspace& ws,
+                          Number* grad) const;
+    /** Evaluates only the nodes function f depends on, and returns its
+     *  value.  This invalidates the result of the last call of
+     *  Forward. */
+    Number EvalFunction(Index f, const Number* x,
+                        ExprTapeWorkspace& ws) const;
+    /** Like EvalFunction, but computes the gradient of f. */
+    void EvalFunctionGradient(Index f, const Number* x,
+                              ExprTapeWorkspace& ws, Number* grad) const;
+    /** Row and column indices (0-based, row>=col) of the Hessian
+     *  nonzeros. */
+    void HessianStructure(Index* iRow, Index* jCol) const;
+    /** Values of the Hessian of the sum of weights[f]*f at the x of
+     *  the last call of Forward. */
+    void HessianValues(const Number* weights, ExprTapeWorkspace& ws,
+                       Number* values) const;
+    //@}
+
+    /** Prints statistics about the tape. */
+    void PrintStatistics(const Journalist& jnlst, EJournalLevel level,
+                         EJournalCategory category) const;
+
+  private:
+    /**@name Default Compiler Generated Methods
+     * (Hidden to avoid implicit creation/calling).
+     * These methods are not implemented and
+     * we do not want the compiler to implement
+     * them for us, so we declare them private
+     * and do not define them. This ensures that
+     * they will not be implicitly created/called. */
+    //@{
+    /** Default Constructor */
+    ExprTape();
+
+    /** Copy Constructor */
+    ExprTape(const ExprTape&);
+
+    /** Overloaded Equals Operator */
+    void operator=(const ExprTape&);
+    //@}
+
+    /** One node of the tape */
+    struct Node
+    {
+      /** Operation */
+      Index op;
+      /** Number of arguments */
+      Index nargs;
+      /** Position of the first argument in args_ (the variable index
+       *  for OP_VAR) */
+      Index first;
+      /** Constant of the operation */
+      Number param;
+    };
+
+    /** Key of a node for the detection of common subexpressions */
+    typedef std::pair<std::vector<Index>, std::vector<Number> > NodeKey;
+
+    /** Number of variables */
+    Index n_vars_;
+
+    /**@name The tape */
+    //@{
+    std::vector<Node> nodes_;
+    /** Arguments of all nodes */
+    std::vector<Index> args_;
+    /** Coefficients of the arguments of OP_SUM nodes (1 otherwise) */
+    std::vector<Number> coefs_;
+    /** Node of each variable, or -1 */
+    std::vector<Index> var_node_;
+    /** Map from node keys to nodes, only used while building */
+    std::map<NodeKey, Index> node_map_;
+    /** true for the constant nodes, and the values of the constant
+     *  nodes, only used while building */
+    std::vector<bool> is_const_;
+    std::vector<Number> const_val_;
+    //@}
+
+    /**@name Functions */
+    //@{
+    /** Root node of each function (-1 if it has no nonlinear part) */
+    std::vector<Index> func_root_;
+    /** Linear parts of the functions */
+    std::vector<Index> lin_start_;
+    std::vector<Index> lin_var_;
+    std::vector<Number> lin_coef_;
+    /** Nodes each function depends on, in increasing order */
+    std::vector<Index> fnode_start_;
+    std::vector<Index> fnode_list_;
+    /** Variables each function depends on, in increasing order, with
+     *  their node (or -1 if the variable appears only linearly) and
+     *  their linear coefficient */
+    std::vector<Index> fvar_start_;
+    std::vector<Index> fvar_list_;
+    std::vector<Index> fvar_node_;
+    std::vector<Number> fvar_lin_;
+    //@}
+
+    /**@name Nonlinear elements for the Hessian */
+    //@{
+    /** Root node of each element */
+    std::vector<Index> elem_root_;
+    /** Functions (and coefficients) each element contributes to */
+    std::vector<Index> elem_func_start_;
+    std::vector<Index> elem_func_;
+    std::vector<Number> elem_func_coef_;
+    /** Nodes of each element, in increasing order */
+    std::vector<Index> enode_start_;
+    std::vector<Index> enode_list_;
+    /** Variable nodes of each element */
+    std::vector<Index> evar_start_;
+    std::vector<Index> evar_node_;
+    /** Position in the Hessian values of each entry (s,t), s>=t, of
+     *  the dense element Hessians */
+    std::vector<Index> epos_start_;
+    std::vector<Index> epos_;
+    /** Hessian structure */
+    std::vector<Index> hess_row_;
+    std::vector<Index> hess_col_;
+    //@}
+
+    /** Adds a node, unless an identical node exists already */
+    Index AddNodeImpl(Index op, const std::vector<Index>& args,
+                      const std::vector<Number>& coefs, Number param);
+
+    /** Collects the nodes root depends on, in increasing order */
+    void CollectNodes(Index root, std::vector<Index>& stamp, Index mark,
+                      std::vector<Index>& stack,
+                      std::vector<Index>& list) const;
+
+    /** Value of a node from the values of the nodes in val */
+    Number NodeValue(const Node& node, const Number* val,
+                     const Number* x) const;
+
+    /** First derivatives of a node with respect to its arguments (in
+     *  d1, one per argument), and the second derivatives for
+     *  operations with one (d2[0]) or two (d2[0..2] for the entries
+     *  (0,0), (0,1), (1,1)) arguments. */
+    void NodePartials(const Node& node, const Number* val,
+                      Number* d1, Number* d2) const;
+
+    /** Evaluates the nodes in list at x */
+    void ForwardNodes(const Index* list, Index n, const Number* x,
+                      ExprTapeWorkspace& ws, bool partials) const;
+
+    /** Reverse sweep with adjoint 1 for root over the nodes in list,
+     *  using the partials in ws */
+    void ReverseNodes(Index root, const Index* list, Index n,
+                      ExprTapeWorkspace& ws) const;
+
+    /** Gradient of f from the adjoints in ws */
+    void GatherGradient(Index f, const ExprTapeWorkspace& ws,
+                        Number* grad) const;
+
+    /** Computes the partial derivatives of all nodes */
+    void ComputePartials(ExprTapeWorkspace& ws) const;
+  };
+
+  /** Intermediate values of the evaluation of an ExprTape.  Each
+   *  thread evaluating a tape needs its own workspace. */
+  class ExprTapeWorkspace : public ReferencedObject
+  {
+  public:
+    ExprTapeWorkspace(Index n_nodes, Index n_args)
+        :
+        val_(n_nodes),
+        adj_(n_nodes),
+        dot_(n_nodes),
+        adjdot_(n_nodes),
+        d1_(n_args),
+        d2_(3*n_nodes),
+        forward_done_(false),
+        partials_done_(false)
+    {}
+
+    virtual ~ExprTapeWorkspace()
+    {}
+
+    /** Marks the results of the last forward sweep as outdated */
+    void Invalidate()
+    {
+      forward_done_ = false;
+      partials_done_ = false;
+    }
+
+    /** true if Forward has been called since the last call of
+     *  Invalidate */
+    bool ForwardDone() const
+    {
+      return forward_done_;
+    }
+
+  private:
+    friend class ExprTape;
+
+    /** Values of the nodes */
+    std::vector<Number> val_;
+    /** Adjoints */
+    std::vector<Number> adj_;
+    /** Tangents for the Hessian sweeps */
+    std::vector<Number> dot_;
+    /** Second order adjoints */
+    std::vector<Number> adjdot_;
+    /** First derivatives, one per argument */
+    std::vector<Number> d1_;
+    /** Second derivatives, three per node */
+    std::vector<Number> d2_;
+    /** true if val_ holds the values of all nodes */
+    bool forward_done_;
+    /** true if d1_ and d2_ hold the derivatives of all nodes */
+    bool partials_done_;
+  };
+
+  /** Compiles the objectives and constraints of an AMPL model into an
+   *  ExprTape.  The .nl file (given by its stub or its content, as
+   *  for AmplTNLP) is read a second time with the fg reader of the
+   *  ASL.  Functions 0 to n_con-1 of the tape are the constraints,
+   *  functions n_con to n_con+n_obj-1 are the objectives.  Returns
+   *  NULL (and the reason in msg) if the model contains an operation
+   *  the tape does not support, e.g. an imported function. */
+  SmartPtr<ExprTape> ReadAmplExprTape(const char* stub,
+                                      const std::string* nl_file_content,
+                                      std::string& msg);
+
+} // namespace Ipopt
+
+#endif
@@ -9,6 +9,7 @@
 #include "IpoptConfig.h"
 
 #include "AmplTNLP.hpp"
+#include "AmplExprTape.hpp"
 #include "IpDenseVector.hpp"
 #include "IpGenTMatrix.hpp"
 #include "IpSymTMatrix.hpp"
@@ -35,6 +36,30 @@ namespace Ipopt
   static const Index dbg_verbosity = 0;
 #endif
 
+#ifdef __GNUC__
+  /** Number of the calling thread for the tape evaluations (0 until
+   *  the thread evaluates its first function) */
+  static __thread Index tape_thread_number = 0;
+  /** Number of threads that evaluated functions on a tape */
+  static volatile Index tape_thread_count = 0;
+#endif
+
+  /** Returns a number identifying the calling thread.  Without
+   *  compiler support for thread local storage, all threads get the
+   *  same number, and evaluations on one AmplTNLP must not be run
+   *  concurrently. */
+  static Index TapeThreadNumber()
+  {
+#ifdef __GNUC__
+    if (tape_thread_number == 0) {
+      tape_thread_number = AtomicIncrement(tape_thread_count);
+    }
+    return tape_thread_number;
+#else
+    return 0;
+#endif
+  }
+
   AmplTNLP::AmplTNLP(const SmartPtr<const Journalist>& jnlst,
                      const SmartPtr<OptionsList> options,
                      char**& argv,
@@ -62,7 +87,9 @@ namespace Ipopt
       hesset_called_(false),
       set_active_objective_called_(false),
       Oinfo_ptr_(NULL),
-      suffix_handler_(suffix_handler)
+      suffix_handler_(suffix_handler),
+      tape_max_nvars_(0),
+      tape_states_lock_(0)
   {
     DBG_START_METH("AmplTNLP::AmplTNLP",
                    dbg_verbosity);
@@ -190,6 +217,119 @@ namespace Ipopt
       }
       break;
     }
+
+    // compile the expressions into a tape, if requested
+    std::string nl_evaluator;
+    options->GetStringValue("nl_evaluator", nl_evaluator, "");
+    if (nl_evaluator == "tape") {
+      std::string msg;
+      tape_ = ReadAmplExprTape(stub, nl_file_content, msg);
+      if (IsNull(tape_)) {
+        jnlst_->Printf(J_WARNING, J_MAIN,
+                       "Cannot evaluate the model on an expression tape (%s).\nThe AMPL solver library is used instead.\n",
+                       msg.c_str());
+      }
+      else if (!setup_tape()) {
+        jnlst_->Printf(J_WARNING, J_MAIN,
+                       "The expression tape does not match the Jacobian structure of the AMPL solver library.\nThe AMPL solver library is used instead.\n");
+        tape_ = NULL;
+      }
+      else {
+        tape_->PrintStatistics(*jnlst_, J_DETAILED, J_MAIN);
+      }
+    }
+  }
+
+  void AmplTNLP::RegisterOptions(const SmartPtr<RegisteredOptions>& roptions)
+  {
+    roptions->SetRegisteringCategory("NLP");
+    roptions->AddStringOption2(
+      "nl_evaluator",
+      "Determines how the functions of an AMPL model are evaluated.",
+      "asl",
+      "asl", "use the evaluation routines of the AMPL solver library",
+      "tape", "use an expression tape compiled from the .nl file",
+      "This option is only used when the problem is read from an AMPL .nl "
+      "file.  With \"tape\", the expressions of the model are compiled into "
+      "a flat tape, on which common subexpressions are evaluated only once, "
+      "and function values, gradients and the Hessian of the Lagrangian are "
+      "computed by sweeps over this tape.  If the model contains an operation "
+      "that the tape does not support (e.g., an imported function), the AMPL "
+      "solver library is used.");
+    roptions->SetRegisteringCategory("Uncategorized");
+  }
+
+  bool AmplTNLP::setup_tape()
+  {
+    ASL_pfgh* asl = asl_;
+    DBG_ASSERT(IsValid(tape_));
+
+    if (tape_->NumVariables() != n_var ||
+        tape_->NumFunctions() != n_con + n_obj) {
+      return false;
+    }
+
+    // positions of the entries of each row in the Jacobian and in the
+    // Cgrad list of the row
+    std::vector<Index> var_goff(n_var, -1);
+    std::vector<Index> var_pos(n_var, -1);
+    tape_jac_start_.resize(n_con+1);
+    tape_jac_pos_.clear();
+    tape_grad_pos_.clear();
+    Index max_nvars = 0;
+    for (Index i=0; i<n_con; i++) {
+      Index pos = 0;
+      for (cgrad* cg=Cgrad[i]; cg; cg = cg->next) {
+        var_goff[cg->varno] = cg->goff;
+        var_pos[cg->varno] = pos++;
+      }
+      tape_jac_start_[i] = (Index)tape_jac_pos_.size();
+      const Index nvars = tape_->FunctionNumVariables(i);
+      const Index* vars = tape_->FunctionVariables(i);
+      for (Index k=0; k<nvars; k++) {
+        if (var_goff[vars[k]] < 0) {
+          return false;
+        }
+        tape_jac_pos_.push_back(var_goff[vars[k]]);
+        tape_grad_pos_.push_back(var_pos[vars[k]]);
+      }
+      for (cgrad* cg=Cgrad[i]; cg; cg = cg->next) {
+        var_goff[cg->varno] = -1;
+        var_pos[cg->varno] = -1;
+      }
+      max_nvars = Max(max_nvars, nvars);
+    }
+    tape_jac_start_[n_con] = (Index)tape_jac_pos_.size();
+    for (Index i=0; i<n_obj; i++) {
+      max_nvars = Max(max_nvars, tape_->FunctionNumVariables(n_con+i));
+    }
+
+    tape_max_nvars_ = Max(max_nvars, 1);
+    return true;
+  }
+
+  AmplTNLP::TapeState& AmplTNLP::tape_state()
+  {
+    DBG_ASSERT(IsValid(tape_));
+    const Index thread = TapeThreadNumber();
+    AcquireSpinLock(tape_states_lock_);
+    TapeState*& state = tape_states_[thread];
+    if (!state) {
+      state = new TapeState;
+      state->ws = tape_->MakeWorkspace();
+      state->weights.resize(tape_->NumFunctions());
+      state->grad.resize(tape_max_nvars_);
+    }
+    TapeState& retval = *state;
+    ReleaseSpinLock(tape_states_lock_);
+    return retval;
+  }
+
+  void AmplTNLP::tape_forward(const Number* x, TapeState& state)
+  {
+    if (!state.ws->ForwardDone()) {
+      tape_->Forward(x, *state.ws);
+    }
   }
 
   void AmplTNLP::set_active_objective(Index in_obj_no)
@@ -244,6 +384,11 @@ namespace Ipopt
   {
     ASL_pfgh* asl = asl_;
 
+    for (std::map<Index, TapeState*>::iterator it = tape_states_.begin();
+         it != tape_states_.end(); ++it) {
+      delete it->second;
+    }
+
     if (asl) {
       if (X0) {
         delete [] X0;
@@ -302,6 +447,9 @@ namespace Ipopt
     m = n_con; // # of constraints
     nnz_jac_g = nzc; // # of non-zeros in the jacobian
     nnz_h_lag = nz_h_full_; // # of non-zeros in the hessian
+    if (IsValid(tape_)) {
+      nnz_h_lag = tape_->NumHessianNonzeros();
+    }
 
     index_style = TNLP::FORTRAN_STYLE;
 
@@ -450,6 +598,24 @@ namespace Ipopt
         grad_f[i] = 0.;
       }
     }
+    else if (IsValid(tape_)) {
+      for (Index i=0; i<n; i++) {
+        grad_f[i] = 0.;
+      }
+      TapeState& state = tape_state();
+      tape_forward(x, state);
+      const Index f = n_con + obj_no;
+      Number* grad = &state.grad[0];
+      tape_->FunctionGradient(f, *state.ws, grad);
+      const Index nvars = tape_->FunctionNumVariables(f);
+      const Index* vars = tape_->FunctionVariables(f);
+      for (Index k=0; k<nvars; k++) {
+        if (!IsFiniteNumber(grad[k])) {
+          return false;
+        }
+        grad_f[vars[k]] = obj_sign_*grad[k];
+      }
+    }
     else {
       objgrd(obj_no, const_cast<Number*>(x), grad_f, (fint*)nerror_);
       if (!nerror_ok(nerror_)) {
@@ -511,6 +677,27 @@ namespace Ipopt
         return false;
       }
 
+      if (IsValid(tape_)) {
+        for (Index k=0; k<nele_jac; k++) {
+          values[k] = 0.;
+        }
+        TapeState& state = tape_state();
+        tape_forward(x, state);
+        Number* grad = &state.grad[0];
+        for (Index i=0; i<n_con; i++) {
+          tape_->FunctionGradient(i, *state.ws, grad);
+          const Index* pos = &tape_jac_pos_[tape_jac_start_[i]];
+          const Index nvars = tape_jac_start_[i+1] - tape_jac_start_[i];
+          for (Index k=0; k<nvars; k++) {
+            if (!IsFiniteNumber(grad[k])) {
+              return false;
+            }
+            values[pos[k]] = grad[k];
+          }
+        }
+        return true;
+      }
+
       jacval(const_cast<Number*>(x), values, (fint*)nerror_);
       if (nerror_ok(nerror_)) {
         return true;
@@ -535,7 +722,16 @@ namespace Ipopt
     DBG_ASSERT(n == n_var);
     DBG_ASSERT(m == n_con);
 
-    if (iRow && jCol && !values) {
+    if (iRow && jCol && !values && IsValid(tape_)) {
+      DBG_ASSERT(nele_hess == tape_->NumHessianNonzeros());
+      tape_->HessianStructure(iRow, jCol);
+      for (Index k=0; k<nele_hess; k++) {
+        iRow[k]++;
+        jCol[k]++;
+      }
+      return true;
+    }
+    else if (iRow && jCol && !values) {
       // setup the structure
       int k=0;
       for (int i=0; i<n; i++) {
@@ -552,6 +748,22 @@ namespace Ipopt
       if (!apply_new_x(new_x, n, x)) {
         return false;
       }
+      if (IsValid(tape_)) {
+        TapeState& state = tape_state();
+        Number* weights = &state.weights[0];
+        for (Index i=0; i<n_con; i++) {
+          weights[i] = lambda[i];
+        }
+        for (Index i=0; i<n_obj; i++) {
+          weights[n_con+i] = 0.;
+        }
+        if (n_obj>0) {
+          weights[n_con+obj_no] = obj_sign_*obj_factor;
+        }
+        tape_forward(x, state);
+        tape_->HessianValues(weights, *state.ws, values);
+        return true;
+      }
       if (!objval_called_with_current_x_) {
         Number dummy;
         internal_objval(x, dummy);
@@ -648,6 +860,10 @@ namespace Ipopt
       message = "Found feasible point for square problem.";
       solve_result_num = 2;
     }
+    else if (status == OBJECTIVE_CUTOFF_REACHED) {
+      message = "Lower bound on objective exceeds cutoff.";
+      solve_result_num = 402;
+    }
     else if (status == LOCAL_INFEASIBILITY) {
       message = "Converged to a locally infeasible point. Problem may be infeasible.";
       solve_result_num = 200;
@@ -689,6 +905,16 @@ namespace Ipopt
       objval_called_with_current_x_ = true;
       return true;
     }
+    else if (IsValid(tape_)) {
+      TapeState& state = tape_state();
+      tape_forward(x, state);
+      Number retval = tape_->FunctionValue(n_con+obj_no, x, *state.ws);
+      if (IsFiniteNumber(retval)) {
+        obj_val = obj_sign_*retval;
+        objval_called_with_current_x_ = true;
+        return true;
+      }
+    }
     else {
       Number retval = objval(obj_no, const_cast<Number*>(x), (fint*)nerror_);
       if (nerror_ok(nerror_)) {
@@ -710,6 +936,21 @@ namespace Ipopt
     DBG_ASSERT(m == n_con);
     conval_called_with_current_x_ = false; // in case the call below fails
 
+    if (IsValid(tape_)) {
+      TapeState& state = tape_state();
+      tape_forward(x, state);
+      if (g) {
+        for (Index i=0; i<m; i++) {
+          g[i] = tape_->FunctionValue(i, x, *state.ws);
+          if (!IsFiniteNumber(g[i])) {
+            return false;
+          }
+        }
+      }
+      conval_called_with_current_x_ = true;
+      return true;
+    }
+
     bool allocated = false;
     if (!g) {
       g = new double[m];
@@ -749,6 +990,13 @@ namespace Ipopt
       conval_called_with_current_x_ = false;
       objval_called_with_current_x_ = false;
 
+      if (IsValid(tape_)) {
+        // the ASL is not used for the evaluations; x is the new
+        // point of the calling thread only
+        tape_state().ws->Invalidate();
+        return true;
+      }
+
       // tell ampl that we have a new x
       xknowne(const_cast<Number*>(x), (fint*)nerror_);
       return nerror_ok(nerror_);
@@ -757,6 +1005,83 @@ namespace Ipopt
     return true;
   }
 
+  bool AmplTNLP::eval_gi(Index n, const Number* x, bool new_x, Index i,
+                         Number& gi)
+  {
+    DBG_START_METH("AmplTNLP::eval_gi",
+                   dbg_verbosity);
+    ASL_pfgh* asl = asl_;
+    DBG_ASSERT(asl_);
+    DBG_ASSERT(n == n_var);
+    DBG_ASSERT(i >= 0 && i < n_con);
+
+    if (IsValid(tape_)) {
+      // only the subtape of the constraint is evaluated; this
+      // invalidates the values of the last forward sweep
+      gi = tape_->EvalFunction(i, x, *tape_state().ws);
+      return IsFiniteNumber(gi);
+    }
+
+    // ASL_pfgh's conival needs to know x has changed
+    xunknown();
+    fint nerror = 0;
+    gi = conival(i, const_cast<Number*>(x), &nerror);
+    return nerror_ok(&nerror);
+  }
+
+  bool AmplTNLP::eval_grad_gi(Index n, const Number* x, bool new_x, Index i,
+                              Index& nele_grad_gi, Index* jCol, Number* values)
+  {
+    DBG_START_METH("AmplTNLP::eval_grad_gi",
+                   dbg_verbosity);
+    ASL_pfgh* asl = asl_;
+    DBG_ASSERT(asl_);
+    DBG_ASSERT(n == n_var);
+    DBG_ASSERT(i >= 0 && i < n_con);
+
+    if (jCol) {
+      // Only compute the number of nonzeros and the indices
+      DBG_ASSERT(!values);
+      nele_grad_gi = 0;
+      for (cgrad* cg=Cgrad[i]; cg; cg = cg->next) {
+        jCol[nele_grad_gi++] = cg->varno + 1;
+      }
+      return true;
+    }
+    DBG_ASSERT(values);
+
+    if (IsValid(tape_)) {
+      nele_grad_gi = 0;
+      for (cgrad* cg=Cgrad[i]; cg; cg = cg->next) {
+        values[nele_grad_gi++] = 0.;
+      }
+      TapeState& state = tape_state();
+      Number* grad = &state.grad[0];
+      tape_->EvalFunctionGradient(i, x, *state.ws, grad);
+      const Index* pos = &tape_grad_pos_[tape_jac_start_[i]];
+      const Index nvars = tape_jac_start_[i+1] - tape_jac_start_[i];
+      for (Index k=0; k<nvars; k++) {
+        if (!IsFiniteNumber(grad[k])) {
+          return false;
+        }
+        values[pos[k]] = grad[k];
+      }
+      return true;
+    }
+
+    // ASL_pfgh's congrd needs to know x has changed
+    xunknown();
+    asl->i.congrd_mode = 1;
+    fint nerror = 0;
+    congrd(i, const_cast<Number*>(x), values, &nerror);
+    nele_grad_gi = 0;
+    for (cgrad* cg=Cgrad[i]; cg; cg = cg->next) {
+      nele_grad_gi++;
+    }
+    asl->i.congrd_mode = 0;
+    return nerror_ok(&nerror);
+  }
+
   void AmplTNLP::write_solution_file(const std::string& message) const
   {
     ASL_pfgh* asl = asl_;
@@ -1299,6 +1624,11 @@ namespace Ipopt
                                      "hessian_approximation",
                                      AmplOptionsList::String_Option,
                                      "Can enable Quasi-Newton approximation of hessian");
+    // Function evaluation
+    ampl_options_list->AddAmplOption("nl_evaluator",
+                                     "nl_evaluator",
+                                     AmplOptionsList::String_Option,
+                                     "Evaluate the functions with the AMPL solver library or on an expression tape");
     // Linear solver
     ampl_options_list->AddAmplOption("linear_solver",
                                      "linear_solver",
@@ -24,6 +24,9 @@ struct SufDesc;
 
 namespace Ipopt
 {
+  class ExprTape;
+  class ExprTapeWorkspace;
+
   class AmplSuffixHandler : public ReferencedObject
   {
   public:
@@ -291,6 +294,11 @@ namespace Ipopt
     /** Exceptions */
     DECLARE_STD_EXCEPTION(NONPOSITIVE_SCALING_FACTOR);
 
+    /** Registers the options read by the AMPL interface.  They have
+     *  to be registered before the options are read by the
+     *  application. */
+    static void RegisterOptions(const SmartPtr<RegisteredOptions>& roptions);
+
     /**@name methods to gather information about the NLP. These
     * methods are overloaded from TNLP. See TNLP for their more
     * detailed documentation. */
@@ -416,6 +424,19 @@ namespace Ipopt
      *  AMPL model, it MUST be called. */
     void set_active_objective(Index obj_no);
 
+    /**@name Evaluation of single constraints (used by Bonmin) */
+    //@{
+    /** Compute the value of the i-th constraint at x. */
+    bool eval_gi(Index n, const Number* x, bool new_x, Index i, Number& gi);
+
+    /** Compute the gradient of the i-th constraint at x.  The
+     *  nonzeros are in the order of the i-th row of the Jacobian
+     *  given by Cgrad; if jCol is not NULL, the (1-based) column
+     *  indices are returned as well. */
+    bool eval_grad_gi(Index n, const Number* x, bool new_x, Index i,
+                      Index& nele_grad_gi, Index* jCol, Number* values);
+    //@}
+
     /**@name Methods to set meta data for the variables
      * and constraints. These values will be passed on
      * to the TNLP in get_var_con_meta_data
@@ -528,6 +549,54 @@ namespace Ipopt
     /** Suffix Handler */
     SmartPtr<AmplSuffixHandler> suffix_handler_;
 
+    /**@name Expression tape evaluation (nl_evaluator=tape) */
+    //@{
+    /** Tape with the constraints (functions 0..n_con-1) and the
+     *  objectives (functions n_con..n_con+n_obj-1); NULL if the ASL
+     *  is used for the evaluations */
+    SmartPtr<ExprTape> tape_;
+    /** Start of the entries of constraint i in tape_jac_pos_ */
+    std::vector<Index> tape_jac_start_;
+    /** Position (goff) of each tape gradient entry in the Jacobian */
+    std::vector<Index> tape_jac_pos_;
+    /** Position of each tape gradient entry in the Cgrad list of its
+     *  constraint */
+    std::vector<Index> tape_grad_pos_;
+    /** Largest number of variables of a function on the tape */
+    Index tape_max_nvars_;
+
+    /** Buffers of one thread evaluating the functions on tape_ */
+    struct TapeState
+    {
+      /** Workspace for the evaluations; its forward sweep is
+       *  invalidated in apply_new_x */
+      SmartPtr<ExprTapeWorkspace> ws;
+      /** Weights of the functions for the Hessian of the Lagrangian */
+      std::vector<Number> weights;
+      /** Buffer for function gradients */
+      std::vector<Number> grad;
+    };
+    /** Buffers of the threads that evaluated the functions, by
+     *  thread number.  Several threads may evaluate the functions on
+     *  the tape concurrently, each at its own current point.  The
+     *  buffers are kept until the AmplTNLP is deleted. */
+    std::map<Index, TapeState*> tape_states_;
+    /** Lock protecting tape_states_ */
+    volatile int tape_states_lock_;
+
+    /** Returns the buffers of the calling thread */
+    TapeState& tape_state();
+
+    /** Sets up the positions of the tape gradients in the Jacobian.
+     *  Returns false if the tape does not match the Jacobian
+     *  structure of the ASL. */
+    bool setup_tape();
+
+    /** Runs the forward sweep on the workspace of state, if it has
+     *  not been done for the current x */
+    void tape_forward(const Number* x, TapeState& state);
+    //@}
+
     /** Make the objective call to ampl */
     bool internal_objval(const Number* x, Number& obj_val);
 
@@ -0,0 +1,473 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#include "IpoptConfig.h"
+#include "AmplExprTape.hpp"
+
+#ifdef HAVE_CSTRING
+# include <cstring>
+#else
+# ifdef HAVE_STRING_H
+#  include <string.h>
+# else
+#  error "don't have header file for string"
+# endif
+#endif
+
+/* AMPL includes.  This file uses the fg reader of the ASL, which
+ * keeps the expression graph of the model, and therefore must not
+ * include asl_pfgh.h like AmplTNLP.cpp. */
+#include "asl.h"
+#include "opcode.hd"
+
+namespace Ipopt
+{
+
+  /** Translates the expression graph of an ASL_fg structure into an
+   *  ExprTape.  The ASL must have been read with the operation codes
+   *  stored in the op fields of the expressions (see
+   *  ReadAmplExprTape). */
+  class AmplTapeBuilder
+  {
+  public:
+    AmplTapeBuilder(ASL_fg* asl, ExprTape& tape)
+        :
+        asl_(asl),
+        tape_(tape)
+    {
+      n_var_ = n_var;
+      ncom0_ = comb + comc + como;
+      ndefined_ = ncom0_ + comc1 + como1;
+      defvar_node_.assign(ndefined_, -2);
+    }
+
+    /** Returns the node for the expression e, or -1 if e contains
+     *  an unsupported operation (the reason is then in msg_) */
+    Index Translate(expr* e);
+
+    /** Node for variable j, where j >= n_var are the defined
+     *  variables (common expressions) */
+    Index Variable(Index j);
+
+    /** Reason for the failure of Translate */
+    std::string msg_;
+
+  private:
+    ASL_fg* asl_;
+    ExprTape& tape_;
+    Index n_var_;
+    /** Number of defined variables in cexps_ */
+    Index ncom0_;
+    /** Number of defined variables in cexps_ and cexps1_ */
+    Index ndefined_;
+    /** Node of each defined variable, -2 if it has not been translated
+     *  yet, -1 if it cannot be translated */
+    std::vector<Index> defvar_node_;
+
+    /** Index of the variable of a linear term */
+    Index LinearVariable(const linpart& L) const
+    {
+      return (Index)(((const char*)L.v.rp - (const char*)asl_->I.var_e_)/sizeof(expr_v));
+    }
+
+    Index Unsupported(int op)
+    {
+      char buf[64];
+      Snprintf(buf, 63, "AMPL operation %d is not supported", op);
+      msg_ = buf;
+      return -1;
+    }
+  };
+
+  Index AmplTapeBuilder::Variable(Index j)
+  {
+    if (j < n_var_) {
+      return tape_.AddVariable(j);
+    }
+    Index k = j - n_var_;
+    if (k >= ndefined_) {
+      msg_ = "reference to an unknown variable";
+      return -1;
+    }
+    if (defvar_node_[k] != -2) {
+      return defvar_node_[k];
+    }
+
+    expr* e;
+    int nlin;
+    linpart* L;
+    if (k < ncom0_) {
+      cexp* ce = asl_->I.cexps_ + k;
+      e = ce->e;
+      nlin = ce->nlin;
+      L = ce->L;
+    }
+    else {
+      cexp1* ce = asl_->I.cexps1_ + (k - ncom0_);
+      e = ce->e;
+      nlin = ce->nlin;
+      L = ce->L;
+    }
+
+    Index node = Translate(e);
+    if (node >= 0 && nlin > 0) {
+      std::vector<Index> args(1, node);
+      std::vector<Number> coefs(1, 1.);
+      for (int i=0; i<nlin && node>=0; i++) {
+        Index v = Variable(LinearVariable(L[i]));
+        if (v < 0) {
+          node = -1;
+        }
+        args.push_back(v);
+        coefs.push_back(L[i].fac);
+      }
+      if (node >= 0) {
+        node = tape_.AddSum(args, coefs);
+      }
+    }
+    defvar_node_[k] = node;
+    return node;
+  }
+
+  Index AmplTapeBuilder::Translate(expr* e)
+  {
+    const int op = (int)(size_t)e->op;
+    ExprTape::Op top;
+
+    switch (op) {
+    case OPNUM:
+      return tape_.AddConstant(((expr_n*)e)->v);
+
+    case OPVARVAL: {
+        Index j = ((expr_v*)e)->a;
+        if (j >= n_var_) {
+          // defined variables are identified by their position
+          j = (Index)((expr_v*)e - asl_->I.var_e_);
+        }
+        return Variable(j);
+      }
+
+    case OPPLUS:
+    case OPMINUS: {
+        Index a = Translate(e->L.e);
+        Index b = a < 0 ? -1 : Translate(e->R.e);
+        if (b < 0) {
+          return -1;
+        }
+        std::vector<Index> args(2);
+        std::vector<Number> coefs(2, 1.);
+        args[0] = a;
+        args[1] = b;
+        if (op == OPMINUS) {
+          coefs[1] = -1.;
+        }
+        return tape_.AddSum(args, coefs);
+      }
+
+    case OPUMINUS: {
+        Index a = Translate(e->L.e);
+        if (a < 0) {
+          return -1;
+        }
+        return tape_.AddSum(std::vector<Index>(1, a), std::vector<Number>(1, -1.));
+      }
+
+    case OPSUMLIST: {
+        std::vector<Index> args;
+        for (expr** ep = e->L.ep; ep < e->R.ep; ep++) {
+          Index a = Translate(*ep);
+          if (a < 0) {
+            return -1;
+          }
+          args.push_back(a);
+        }
+        std::vector<Number> coefs(args.size(), 1.);
+        return tape_.AddSum(args, coefs);
+      }
+
+    case MINLIST:
+    case MAXLIST: {
+        std::vector<Index> args;
+        for (de* d = ((expr_va*)e)->L.d; d->e; d++) {
+          Index a = Translate(d->e);
+          if (a < 0) {
+            return -1;
+          }
+          args.push_back(a);
+        }
+        return tape_.AddList(op == MINLIST ? ExprTape::OP_MIN : ExprTape::OP_MAX, args);
+      }
+
+    case OPIFnl: {
+        expr_if* eif = (expr_if*)e;
+        Index c = Translate(eif->e);
+        Index t = c < 0 ? -1 : Translate(eif->T);
+        Index f = t < 0 ? -1 : Translate(eif->F);
+        if (f < 0) {
+          return -1;
+        }
+        return tape_.AddNode(ExprTape::OP_IF, c, t, f);
+      }
+
+    case OP1POW: {
+        Index a = Translate(e->L.e);
+        if (a < 0) {
+          return -1;
+        }
+        return tape_.AddNode(ExprTape::OP_POWC, a, -1, -1, ((expr_n*)e->R.e)->v);
+      }
+
+    case OP2POW: {
+        Index a = Translate(e->L.e);
+        if (a < 0) {
+          return -1;
+        }
+        return tape_.AddNode(ExprTape::OP_POWC, a, -1, -1, 2.);
+      }
+
+    case OPCPOW: {
+        Index a = Translate(e->R.e);
+        if (a < 0) {
+          return -1;
+        }
+        return tape_.AddNode(ExprTape::OP_CPOW, a, -1, -1, ((expr_n*)e->L.e)->v);
+      }
+
+      // operations with two arguments
+    case OPMULT:
+      top = ExprTape::OP_MUL;
+      break;
+    case OPDIV:
+      top = ExprTape::OP_DIV;
+      break;
+    case OPREM:
+      top = ExprTape::OP_REM;
+      break;
+    case OPPOW:
+      top = ExprTape::OP_POW;
+      break;
+    case OPLESS:
+      top = ExprTape::OP_LESS;
+      break;
+    case OPintDIV:
+      top = ExprTape::OP_INTDIV;
+      break;
+    case OP_atan2:
+      top = ExprTape::OP_ATAN2;
+      break;
+    case OPOR:
+      top = ExprTape::OP_OR;
+      break;
+    case OPAND:
+      top = ExprTape::OP_AND;
+      break;
+    case LT:
+      top = ExprTape::OP_LT;
+      break;
+    case LE:
+      top = ExprTape::OP_LE;
+      break;
+    case EQ:
+      top = ExprTape::OP_EQ;
+      break;
+    case GE:
+      top = ExprTape::OP_GE;
+      break;
+    case GT:
+      top = ExprTape::OP_GT;
+      break;
+    case NE:
+      top = ExprTape::OP_NE;
+      break;
+
+      // operations with one argument
+    case FLOOR:
+      top = ExprTape::OP_FLOOR;
+      break;
+    case CEIL:
+      top = ExprTape::OP_CEIL;
+      break;
+    case ABS:
+      top = ExprTape::OP_ABS;
+      break;
+    case OPNOT:
+      top = ExprTape::OP_NOT;
+      break;
+    case OP_tanh:
+      top = ExprTape::OP_TANH;
+      break;
+    case OP_tan:
+      top = ExprTape::OP_TAN;
+      break;
+    case OP_sqrt:
+      top = ExprTape::OP_SQRT;
+      break;
+    case OP_sinh:
+      top = ExprTape::OP_SINH;
+      break;
+    case OP_sin:
+      top = ExprTape::OP_SIN;
+      break;
+    case OP_log10:
+      top = ExprTape::OP_LOG10;
+      break;
+    case OP_log:
+      top = ExprTape::OP_LOG;
+      break;
+    case OP_exp:
+      top = ExprTape::OP_EXP;
+      break;
+    case OP_cosh:
+      top = ExprTape::OP_COSH;
+      break;
+    case OP_cos:
+      top = ExprTape::OP_COS;
+      break;
+    case OP_atanh:
+      top = ExprTape::OP_ATANH;
+      break;
+    case OP_atan:
+      top = ExprTape::OP_ATAN;
+      break;
+    case OP_asinh:
+      top = ExprTape::OP_ASINH;
+      break;
+    case OP_asin:
+      top = ExprTape::OP_ASIN;
+      break;
+    case OP_acosh:
+      top = ExprTape::OP_ACOSH;
+      break;
+    case OP_acos:
+      top = ExprTape::OP_ACOS;
+      break;
+
+    default:
+      // imported functions, piecewise linear terms, string and
+      // counting operations, ...
+      return Unsupported(op);
+    }
+
+    Index a = Translate(e->L.e);
+    if (a < 0) {
+      return -1;
+    }
+    switch (top) {
+    case ExprTape::OP_MUL:
+    case ExprTape::OP_DIV:
+    case ExprTape::OP_REM:
+    case ExprTape::OP_POW:
+    case ExprTape::OP_LESS:
+    case ExprTape::OP_INTDIV:
+    case ExprTape::OP_ATAN2:
+    case ExprTape::OP_OR:
+    case ExprTape::OP_AND:
+    case ExprTape::OP_LT:
+    case ExprTape::OP_LE:
+    case ExprTape::OP_EQ:
+    case ExprTape::OP_GE:
+    case ExprTape::OP_GT:
+    case ExprTape::OP_NE: {
+        Index b = Translate(e->R.e);
+        if (b < 0) {
+          return -1;
+        }
+        return tape_.AddNode(top, a, b);
+      }
+    default:
+      return tape_.AddNode(top, a);
+    }
+  }
+
+  SmartPtr<ExprTape> ReadAmplExprTape(const char* stub,
+                                      const std::string* nl_file_content,
+                                      std::string& msg)
+  {
+    // The ASL functions work on the most recently allocated ASL
+    // structure; the one of the caller is restored at the end.
+    ASL* caller_asl = cur_ASL;
+
+    ASL_fg* asl = (ASL_fg*)ASL_alloc(ASL_read_fg);
+    FILE* nl = NULL;
+    if (nl_file_content) {
+      nl = jac0dim(const_cast<char*>(nl_file_content->c_str()),
+                   -(ftnlen)nl_file_content->length());
+    }
+    else {
+      DBG_ASSERT(stub);
+      std::vector<char> stub_copy(stub, stub + strlen(stub) + 1);
+      nl = jac0dim(&stub_copy[0], (fint)strlen(stub));
+    }
+
+    // Let the reader store the operation codes instead of the
+    // evaluation functions in the expressions, and don't let it set
+    // up the derivative computations
+    efunc* r_ops_int[N_OPS];
+    for (int i=0; i<N_OPS; i++) {
+      r_ops_int[i] = (efunc*)(size_t)i;
+    }
+    asl->I.r_ops_ = r_ops_int;
+    want_derivs = 0;
+    int retcode = fg_read(nl, ASL_return_read_err);
+    asl->I.r_ops_ = NULL;
+
+    SmartPtr<ExprTape> tape;
+    if (retcode != ASL_readerr_none) {
+      char buf[64];
+      Snprintf(buf, 63, "reading the .nl file failed with code %d", retcode);
+      msg = buf;
+    }
+    else {
+      tape = new ExprTape(n_var);
+      AmplTapeBuilder builder(asl, *tape);
+      bool ok = true;
+      std::vector<Index> lin_vars;
+      std::vector<Number> lin_coefs;
+      // constraints
+      for (Index i=0; i<n_con && ok; i++) {
+        Index root = builder.Translate(asl->I.con_de_[i].e);
+        ok = (root >= 0);
+        lin_vars.clear();
+        lin_coefs.clear();
+        for (cgrad* cg=Cgrad[i]; cg; cg = cg->next) {
+          if (cg->coef != 0.) {
+            lin_vars.push_back(cg->varno);
+            lin_coefs.push_back(cg->coef);
+          }
+        }
+        tape->AddFunction(root, lin_vars, lin_coefs);
+      }
+      // objectives
+      for (Index i=0; i<n_obj && ok; i++) {
+        Index root = builder.Translate(asl->I.obj_de_[i].e);
+        ok = (root >= 0);
+        lin_vars.clear();
+        lin_coefs.clear();
+        for (ograd* og=Ograd[i]; og; og = og->next) {
+          if (og->coef != 0.) {
+            lin_vars.push_back(og->varno);
+            lin_coefs.push_back(og->coef);
+          }
+        }
+        tape->AddFunction(root, lin_vars, lin_coefs);
+      }
+      if (ok) {
+        tape->Finalize();
+      }
+      else {
+        msg = builder.msg_;
+        tape = NULL;
+      }
+    }
+
+    ASL* asl_to_free = (ASL*)asl;
+    ASL_free(&asl_to_free);
+    cur_ASL = caller_asl;
+
+    return tape;
+  }
+
+} // namespace Ipopt
@@ -38,6 +38,10 @@ int main(int argc, char**args)
   SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
   app->RethrowNonIpoptException(false);
 
+  // Register the options of the AMPL interface, so that they can be
+  // set in the options file and are printed with the documentation
+  AmplTNLP::RegisterOptions(app->RegOptions());
+
   // Check if executable is run only to print out options documentation
   if (argc == 2) {
     bool print_options = false;
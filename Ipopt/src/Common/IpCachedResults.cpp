@@ -0,0 +1,15 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#include "IpCachedResults.hpp"
+
+namespace Ipopt
+{
+#ifdef IP_CACHE_STATISTICS
+  unsigned long CachedResultsStatistics::num_lookups_ = 0;
+  unsigned long CachedResultsStatistics::num_hits_ = 0;
+#endif
+} // namespace Ipopt
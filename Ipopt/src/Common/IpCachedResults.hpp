@@ -23,6 +23,9 @@ namespace Ipopt
 #endif
 #ifdef IP_DEBUG_CACHE
 # include "IpDebug.hpp"
+#endif
+#if COIN_IPOPT_CHECKLEVEL > 0
+# define IP_CACHE_STATISTICS
 #endif
 
   // Forward Declarations
@@ -41,6 +44,46 @@ namespace Ipopt
   //     CP_Iterate
   //   };
 
+#ifdef IP_CACHE_STATISTICS
+  /** Counters for the lookups in all CachedResults objects.  They are
+   *  meant for profiling and only compiled into builds with checks
+   *  (or with IP_CACHE_STATISTICS defined).  They are not
+   *  synchronized, so that the numbers are only approximate if
+   *  several threads use cached results at the same time.
+   */
+  class CachedResultsStatistics
+  {
+  public:
+    /** Set all counters to zero */
+    static void Reset()
+    {
+      num_lookups_ = 0;
+      num_hits_ = 0;
+    }
+    /** Number of calls of the GetCachedResult methods */
+    static unsigned long NumLookups()
+    {
+      return num_lookups_;
+    }
+    /** Number of lookups that found a result */
+    static unsigned long NumHits()
+    {
+      return num_hits_;
+    }
+    /** Record a lookup */
+    static void CountLookup(bool hit)
+    {
+      num_lookups_++;
+      if (hit) {
+        num_hits_++;
+      }
+    }
+  private:
+    static unsigned long num_lookups_;
+    static unsigned long num_hits_;
+  };
+#endif
+
   /** Templated class for Cached Results.  This class stores up to a
    *  given number of "results", entities that are stored here
    *  together with identifiers, that can be used to later retrieve the
@@ -65,6 +108,14 @@ namespace Ipopt
    *  DependentResult, inherits off an Observer.  This Observer
    *  retrieves notification whenever a TaggedObject dependency has
    *  changed.  Stale results are later removed from the cache.
+   *
+   *  The results are kept in a flat array of slots.  A slot is
+   *  allocated the first time it is needed and then reused for later
+   *  results, so that adding a result does not allocate memory once
+   *  the cache is full.  Each slot stores a hash of the tags of its
+   *  dependencies, which is compared before the dependencies
+   *  themselves.  The methods with explicit dependencies
+   *  (GetCachedResult1Dep etc.) do not create temporary vectors.
    */
   template <class T>
   class CachedResults
@@ -216,7 +267,7 @@ namespace Ipopt
   private:
     /**@name Default Compiler Generated Methods
      * (Hidden to avoid implicit creation/calling).
-     * These methods are not implemented and 
+     * These methods are not implemented and
      * we do not want the compiler to implement
      * them for us, so we declare them private
      * and do not define them. This ensures that
@@ -235,13 +286,33 @@ namespace Ipopt
     /** maximum number of cached results */
     Int max_cache_size_;
 
-    /** list of currently cached results. */
-    mutable std::list<DependentResult<T>*>* cached_results_;
-
-    /** internal method for removing stale DependentResults from the
-     *  list.  It is called at the beginning of every
-     *  GetDependentResult method.
-     */
+    /** Slots for the cached results.  Slots are never removed
+     *  (unless the maximum cache size is decreased); unused slots
+     *  are marked as stale. */
+    mutable std::vector<DependentResult<T>*> slots_;
+
+    /** Counter for the age of the results; the slot with the oldest
+     *  result is reused if the cache is full. */
+    unsigned long add_count_;
+
+    /** internal method for adding a result, given the dependencies as
+     *  arrays */
+    void AddResult(const T& result,
+                   const TaggedObject* const* dependents,
+                   Index n_dependents,
+                   const Number* scalar_dependents,
+                   Index n_scalar_dependents);
+
+    /** internal method for finding the slot with the given
+     *  dependencies.  Stale slots that still hold a result are
+     *  released on the way.  Returns NULL if there is no such
+     *  slot. */
+    DependentResult<T>* FindResult(const TaggedObject* const* dependents,
+                                   Index n_dependents,
+                                   const Number* scalar_dependents,
+                                   Index n_scalar_dependents) const;
+
+    /** internal method for releasing the results in stale slots. */
     void CleanupInvalidatedResults() const;
 
     /** Print list of currently cached results */
@@ -251,7 +322,8 @@ namespace Ipopt
   /** Templated class which stores one entry for the CachedResult
    *  class.  It stores the result (of type T), together with its
    *  dependencies (vector of TaggedObjects and vector of Numbers).
-   *  It also stores a priority.
+   *  An object can be reused for another result with the Assign
+   *  method.
    */
   template <class T>
   class DependentResult : public Observer
@@ -264,6 +336,9 @@ namespace Ipopt
 
     /** @name Constructor, Destructors */
     //@{
+    /** Constructor for an empty (stale) entry. */
+    DependentResult();
+
     /** Constructor, given all information about the result. */
     DependentResult(const T& result, const std::vector<const TaggedObject*>& dependents,
                     const std::vector<Number>& scalar_dependents);
@@ -284,6 +359,35 @@ namespace Ipopt
     const T& GetResult() const;
     //@}
 
+    /** Store a new result with its dependencies, replacing the
+     *  previous content.  The memory of the dependency arrays is
+     *  reused. */
+    void Assign(const T& result, const TaggedObject* const* dependents,
+                Index n_dependents, const Number* scalar_dependents,
+                Index n_scalar_dependents, unsigned long hash);
+
+    /** Drop the result and the dependencies; the entry is stale
+     *  afterwards. */
+    void Release();
+
+    /** Returns true if the entry is stale and still holds a result
+     *  that can be released. */
+    bool NeedsRelease() const
+    {
+      return stale_ && holds_result_;
+    }
+
+    /** Number that is increased with every Assign of the owning
+     *  cache; used to find the oldest entry. */
+    unsigned long Age() const
+    {
+      return age_;
+    }
+    void SetAge(unsigned long age)
+    {
+      age_ = age;
+    }
+
     /** This method returns true if the dependencies provided to this
      *  function are identical to the ones stored with the
      *  DependentResult.
@@ -291,6 +395,19 @@ namespace Ipopt
     bool DependentsIdentical(const std::vector<const TaggedObject*>& dependents,
                              const std::vector<Number>& scalar_dependents) const;
 
+    /** Same as above, for dependencies given as arrays together with
+     *  their hash (see ComputeHash). */
+    bool DependentsIdentical(const TaggedObject* const* dependents,
+                             Index n_dependents,
+                             const Number* scalar_dependents,
+                             Index n_scalar_dependents,
+                             unsigned long hash) const;
+
+    /** Hash of the tags of the given dependencies. */
+    static unsigned long ComputeHash(const TaggedObject* const* dependents,
+                                     Index n_dependents,
+                                     Index n_scalar_dependents);
+
     /** Print information about this DependentResults. */
     void DebugPrint() const;
 
@@ -308,15 +425,12 @@ namespace Ipopt
 
     /**@name Default Compiler Generated Methods
      * (Hidden to avoid implicit creation/calling).
-     * These methods are not implemented and 
+     * These methods are not implemented and
      * we do not want the compiler to implement
      * them for us, so we declare them private
      * and do not define them. This ensures that
      * they will not be implicitly created/called. */
     //@{
-    /** Default Constructor */
-    DependentResult();
-
     /** Copy Constructor */
     DependentResult(const DependentResult&);
 
@@ -328,8 +442,15 @@ namespace Ipopt
     result becomes invalid, if the RecieveNotification method is
     called with NT_Changed */
     bool stale_;
+    /** Flag indicating whether result_ and the observed subjects
+     *  still have to be released */
+    bool holds_result_;
     /** The value of the dependent results */
-    const T result_;
+    T result_;
+    /** Hash of the dependencies */
+    unsigned long hash_;
+    /** Age of the entry */
+    unsigned long age_;
     /** Dependencies in form of TaggedObjects */
     std::vector<TaggedObject::Tag> dependent_tags_;
     /** Dependencies in form a Numbers */
@@ -344,22 +465,67 @@ namespace Ipopt
   const Index DependentResult<T>::dbg_verbosity = 0;
 #endif
 
+  template <class T>
+  DependentResult<T>::DependentResult()
+      :
+      stale_(true),
+      holds_result_(false),
+      result_(),
+      hash_(0),
+      age_(0)
+  {}
+
   template <class T>
   DependentResult<T>::DependentResult(
     const T& result,
     const std::vector<const TaggedObject*>& dependents,
     const std::vector<Number>& scalar_dependents)
       :
-      stale_(false),
-      result_(result),
-      dependent_tags_(dependents.size()),
-      scalar_dependents_(scalar_dependents)
+      stale_(true),
+      holds_result_(false),
+      result_(),
+      hash_(0),
+      age_(0)
   {
 #ifdef IP_DEBUG_CACHE
     DBG_START_METH("DependentResult<T>::DependentResult()", dbg_verbosity);
 #endif
 
-    for (Index i=0; i<(Index)dependents.size(); i++) {
+    const Index n_dependents = (Index)dependents.size();
+    const Index n_scalar_dependents = (Index)scalar_dependents.size();
+    const TaggedObject* const* deps =
+      n_dependents > 0 ? &dependents[0] : NULL;
+    Assign(result, deps, n_dependents,
+           n_scalar_dependents > 0 ? &scalar_dependents[0] : NULL,
+           n_scalar_dependents,
+           ComputeHash(deps, n_dependents, n_scalar_dependents));
+  }
+
+  template <class T>
+  DependentResult<T>::~DependentResult()
+  {
+#ifdef IP_DEBUG_CACHE
+    DBG_START_METH("DependentResult<T>::~DependentResult()", dbg_verbosity);
+    //DBG_ASSERT(stale_ == true);
+#endif
+    // Nothing to be done here, destructor
+    // of T should sufficiently remove
+    // any memory, etc.
+  }
+
+  template <class T>
+  void DependentResult<T>::Assign(const T& result,
+                                  const TaggedObject* const* dependents,
+                                  Index n_dependents,
+                                  const Number* scalar_dependents,
+                                  Index n_scalar_dependents,
+                                  unsigned long hash)
+  {
+    RequestDetachAll();
+    result_ = result;
+    hash_ = hash;
+    dependent_tags_.resize(n_dependents);
+    for (Index i=0; i<n_dependents; i++) {
       if (dependents[i]) {
         // Call the RequestAttach method of the Observer base class.
         // This will add this dependent result in the Observer list
@@ -375,18 +541,19 @@ namespace Ipopt
         dependent_tags_[i] = TaggedObject::Tag();
       }
     }
+    scalar_dependents_.assign(scalar_dependents,
+                              scalar_dependents + n_scalar_dependents);
+    stale_ = false;
+    holds_result_ = true;
   }
 
   template <class T>
-  DependentResult<T>::~DependentResult()
+  void DependentResult<T>::Release()
   {
-#ifdef IP_DEBUG_CACHE
-    DBG_START_METH("DependentResult<T>::~DependentResult()", dbg_verbosity);
-    //DBG_ASSERT(stale_ == true);
-#endif
-    // Nothing to be done here, destructor
-    // of T should sufficiently remove
-    // any memory, etc.
+    RequestDetachAll();
+    result_ = T();
+    stale_ = true;
+    holds_result_ = false;
   }
 
   template <class T>
@@ -419,37 +586,66 @@ namespace Ipopt
   bool DependentResult<T>::DependentsIdentical(const std::vector<const TaggedObject*>& dependents,
       const std::vector<Number>& scalar_dependents) const
   {
+    const Index n_dependents = (Index)dependents.size();
+    const Index n_scalar_dependents = (Index)scalar_dependents.size();
+    const TaggedObject* const* deps =
+      n_dependents > 0 ? &dependents[0] : NULL;
+    return DependentsIdentical(deps, n_dependents,
+                               n_scalar_dependents > 0 ? &scalar_dependents[0] : NULL,
+                               n_scalar_dependents,
+                               ComputeHash(deps, n_dependents, n_scalar_dependents));
+  }
+
+  template <class T>
+  bool DependentResult<T>::DependentsIdentical(const TaggedObject* const* dependents,
+      Index n_dependents,
+      const Number* scalar_dependents,
+      Index n_scalar_dependents,
+      unsigned long hash) const
+  {
 #ifdef IP_DEBUG_CACHE
     DBG_START_METH("DependentResult<T>::DependentsIdentical", dbg_verbosity);
     DBG_ASSERT(stale_ == false);
-    DBG_ASSERT(dependents.size() == dependent_tags_.size());
 #endif
 
-    bool retVal = true;
-
-    if (dependents.size() != dependent_tags_.size()
-        || scalar_dependents.size() != scalar_dependents_.size()) {
-      retVal = false;
+    if (hash != hash_
+        || n_dependents != (Index)dependent_tags_.size()
+        || n_scalar_dependents != (Index)scalar_dependents_.size()) {
+      return false;
     }
-    else {
-      for (Index i=0; i<(Index)dependents.size(); i++) {
-        if ( (dependents[i] && dependents[i]->GetTag() != dependent_tags_[i])
-             || (!dependents[i] && dependent_tags_[i] != TaggedObject::Tag()) ) {
-          retVal = false;
-          break;
-        }
+    for (Index i=0; i<n_dependents; i++) {
+      if ( (dependents[i] && dependents[i]->GetTag() != dependent_tags_[i])
+           || (!dependents[i] && dependent_tags_[i] != TaggedObject::Tag()) ) {
+        return false;
       }
-      if (retVal) {
-        for (Index i=0; i<(Index)scalar_dependents.size(); i++) {
-          if (scalar_dependents[i] != scalar_dependents_[i]) {
-            retVal = false;
-            break;
-          }
-        }
+    }
+    for (Index i=0; i<n_scalar_dependents; i++) {
+      if (scalar_dependents[i] != scalar_dependents_[i]) {
+        return false;
       }
     }
+    return true;
+  }
 
-    return retVal;
+  template <class T>
+  unsigned long DependentResult<T>::ComputeHash(
+    const TaggedObject* const* dependents,
+    Index n_dependents,
+    Index n_scalar_dependents)
+  {
+    // The scalar dependencies are only compared, not hashed
+    unsigned long hash = 0x9e3779b9UL*(unsigned long)(n_dependents + 1) +
+                         (unsigned long)n_scalar_dependents;
+    for (Index i=0; i<n_dependents; i++) {
+      unsigned long h = 0;
+      if (dependents[i]) {
+        TaggedObject::Tag tag = dependents[i]->GetTag();
+        h = ((unsigned long)(size_t)tag.first >> 3) ^
+            ((unsigned long)tag.second*0x9e3779b9UL);
+      }
+      hash ^= h + 0x9e3779b9UL + (hash << 6) + (hash >> 2);
+    }
+    return hash;
   }
 
   template <class T>
@@ -476,7 +672,7 @@ namespace Ipopt
   CachedResults<T>::CachedResults(Int max_cache_size)
       :
       max_cache_size_(max_cache_size),
-      cached_results_(NULL)
+      add_count_(0)
   {
 #ifdef IP_DEBUG_CACHE
     DBG_START_METH("CachedResults<T>::CachedResults", dbg_verbosity);
@@ -491,64 +687,126 @@ namespace Ipopt
     DBG_START_METH("CachedResults<T>::!CachedResults()", dbg_verbosity);
 #endif
 
-    if (cached_results_) {
-      for (typename std::list< DependentResult<T>* >::iterator iter = cached_results_->
-           begin();
-           iter != cached_results_->end();
-           iter++) {
-        delete *iter;
-      }
-      delete cached_results_;
+    for (size_t i=0; i<slots_.size(); i++) {
+      delete slots_[i];
     }
-    /*
-    while (!cached_results_.empty()) {
-      DependentResult<T>* result = cached_results_.back();
-      cached_results_.pop_back();
-      delete result;
-    }
-    */
   }
 
   template <class T>
-  void CachedResults<T>::AddCachedResult(const T& result,
-                                         const std::vector<const TaggedObject*>& dependents,
-                                         const std::vector<Number>& scalar_dependents)
+  void CachedResults<T>::AddResult(const T& result,
+                                   const TaggedObject* const* dependents,
+                                   Index n_dependents,
+                                   const Number* scalar_dependents,
+                                   Index n_scalar_dependents)
   {
 #ifdef IP_DEBUG_CACHE
-    DBG_START_METH("CachedResults<T>::AddCachedResult", dbg_verbosity);
+    DBG_START_METH("CachedResults<T>::AddResult", dbg_verbosity);
 #endif
 
-    CleanupInvalidatedResults();
-
-    // insert the new one here
-    DependentResult<T>* newResult = new DependentResult<T>(result, dependents, scalar_dependents);
-    if (!cached_results_) {
-      cached_results_ = new std::list<DependentResult<T>*>;
+    if (max_cache_size_ == 0) {
+      return;
     }
-    cached_results_->push_front(newResult);
 
-    // keep the list small enough
-    if (max_cache_size_ >= 0) { // if negative, allow infinite cache
-      // non-negative - limit size of list to max_cache_size
-      DBG_ASSERT((Int)cached_results_->size()<=max_cache_size_+1);
-      if ((Int)cached_results_->size() > max_cache_size_) {
-        delete cached_results_->back();
-        cached_results_->pop_back();
+    const unsigned long hash =
+      DependentResult<T>::ComputeHash(dependents, n_dependents,
+                                      n_scalar_dependents);
+
+    // Find the slot for the new result: the one with the same
+    // dependencies, a stale one, a new one, or the oldest one (in
+    // this order of preference)
+    DependentResult<T>* slot = NULL;
+    DependentResult<T>* stale_slot = NULL;
+    DependentResult<T>* oldest_slot = NULL;
+    for (size_t i=0; i<slots_.size(); i++) {
+      DependentResult<T>* s = slots_[i];
+      if (s->IsStale()) {
+        if (s->NeedsRelease()) {
+          s->Release();
+        }
+        if (!stale_slot) {
+          stale_slot = s;
+        }
+      }
+      else if (s->DependentsIdentical(dependents, n_dependents,
+                                      scalar_dependents,
+                                      n_scalar_dependents, hash)) {
+        slot = s;
+        break;
+      }
+      else if (!oldest_slot || s->Age() < oldest_slot->Age()) {
+        oldest_slot = s;
+      }
+    }
+    if (!slot) {
+      slot = stale_slot;
+    }
+    if (!slot) {
+      if (max_cache_size_ < 0 || (Int)slots_.size() < max_cache_size_) {
+        slot = new DependentResult<T>();
+        slots_.push_back(slot);
+      }
+      else {
+        slot = oldest_slot;
       }
     }
 
+    slot->Assign(result, dependents, n_dependents, scalar_dependents,
+                 n_scalar_dependents, hash);
+    slot->SetAge(++add_count_);
+
 #ifdef IP_DEBUG_CACHE
     DBG_EXEC(2, DebugPrintCachedResults());
 #endif
 
   }
 
+  template <class T>
+  DependentResult<T>* CachedResults<T>::FindResult(
+    const TaggedObject* const* dependents,
+    Index n_dependents,
+    const Number* scalar_dependents,
+    Index n_scalar_dependents) const
+  {
+    const unsigned long hash =
+      DependentResult<T>::ComputeHash(dependents, n_dependents,
+                                      n_scalar_dependents);
+    // AddResult reuses the slot of a valid result with the same
+    // dependencies, so there is at most one match
+    DependentResult<T>* found = NULL;
+    for (size_t i=0; i<slots_.size(); i++) {
+      DependentResult<T>* s = slots_[i];
+      if (s->IsStale()) {
+        if (s->NeedsRelease()) {
+          s->Release();
+        }
+      }
+      else if (!found &&
+               s->DependentsIdentical(dependents, n_dependents,
+                                      scalar_dependents,
+                                      n_scalar_dependents, hash)) {
+        found = s;
+      }
+    }
+    return found;
+  }
+
+  template <class T>
+  void CachedResults<T>::AddCachedResult(const T& result,
+                                         const std::vector<const TaggedObject*>& dependents,
+                                         const std::vector<Number>& scalar_dependents)
+  {
+    AddResult(result, dependents.empty() ? NULL : &dependents[0],
+              (Index)dependents.size(),
+              scalar_dependents.empty() ? NULL : &scalar_dependents[0],
+              (Index)scalar_dependents.size());
+  }
+
   template <class T>
   void CachedResults<T>::AddCachedResult(const T& result,
                                          const std::vector<const TaggedObject*>& dependents)
   {
-    std::vector<Number> scalar_dependents;
-    AddCachedResult(result, dependents, scalar_dependents);
+    AddResult(result, dependents.empty() ? NULL : &dependents[0],
+              (Index)dependents.size(), NULL, 0);
   }
 
   template <class T>
@@ -559,34 +817,39 @@ namespace Ipopt
     DBG_START_METH("CachedResults<T>::GetCachedResult", dbg_verbosity);
 #endif
 
-    if (!cached_results_)
-      return false;
-
-    CleanupInvalidatedResults();
-
-    bool retValue = false;
-    typename std::list< DependentResult<T>* >::const_iterator iter;
-    for (iter = cached_results_->begin(); iter != cached_results_->end(); iter++) {
-      if ((*iter)->DependentsIdentical(dependents, scalar_dependents)) {
-        retResult = (*iter)->GetResult();
-        retValue = true;
-        break;
-      }
+    DependentResult<T>* found =
+      FindResult(dependents.empty() ? NULL : &dependents[0],
+                 (Index)dependents.size(),
+                 scalar_dependents.empty() ? NULL : &scalar_dependents[0],
+                 (Index)scalar_dependents.size());
+#ifdef IP_CACHE_STATISTICS
+    CachedResultsStatistics::CountLookup(found != NULL);
+#endif
+    if (found) {
+      retResult = found->GetResult();
     }
 
 #ifdef IP_DEBUG_CACHE
     DBG_EXEC(2, DebugPrintCachedResults());
 #endif
 
-    return retValue;
+    return found != NULL;
   }
 
   template <class T>
   bool CachedResults<T>::GetCachedResult(
     T& retResult, const std::vector<const TaggedObject*>& dependents) const
   {
-    std::vector<Number> scalar_dependents;
-    return GetCachedResult(retResult, dependents, scalar_dependents);
+    DependentResult<T>* found =
+      FindResult(dependents.empty() ? NULL : &dependents[0],
+                 (Index)dependents.size(), NULL, 0);
+#ifdef IP_CACHE_STATISTICS
+    CachedResultsStatistics::CountLookup(found != NULL);
+#endif
+    if (found) {
+      retResult = found->GetResult();
+    }
+    return found != NULL;
   }
 
   template <class T>
@@ -597,10 +860,8 @@ namespace Ipopt
     DBG_START_METH("CachedResults<T>::AddCachedResult1Dep", dbg_verbosity);
 #endif
 
-    std::vector<const TaggedObject*> dependents(1);
-    dependents[0] = dependent1;
-
-    AddCachedResult(result, dependents);
+    const TaggedObject* dependents[1] = {dependent1};
+    AddResult(result, dependents, 1, NULL, 0);
   }
 
   template <class T>
@@ -610,10 +871,15 @@ namespace Ipopt
     DBG_START_METH("CachedResults<T>::GetCachedResult1Dep", dbg_verbosity);
 #endif
 
-    std::vector<const TaggedObject*> dependents(1);
-    dependents[0] = dependent1;
-
-    return GetCachedResult(retResult, dependents);
+    const TaggedObject* dependents[1] = {dependent1};
+    DependentResult<T>* found = FindResult(dependents, 1, NULL, 0);
+#ifdef IP_CACHE_STATISTICS
+    CachedResultsStatistics::CountLookup(found != NULL);
+#endif
+    if (found) {
+      retResult = found->GetResult();
+    }
+    return found != NULL;
   }
 
   template <class T>
@@ -625,11 +891,8 @@ namespace Ipopt
     DBG_START_METH("CachedResults<T>::AddCachedResult2dDep", dbg_verbosity);
 #endif
 
-    std::vector<const TaggedObject*> dependents(2);
-    dependents[0] = dependent1;
-    dependents[1] = dependent2;
-
-    AddCachedResult(result, dependents);
+    const TaggedObject* dependents[2] = {dependent1, dependent2};
+    AddResult(result, dependents, 2, NULL, 0);
   }
 
   template <class T>
@@ -639,11 +902,15 @@ namespace Ipopt
     DBG_START_METH("CachedResults<T>::GetCachedResult2Dep", dbg_verbosity);
 #endif
 
-    std::vector<const TaggedObject*> dependents(2);
-    dependents[0] = dependent1;
-    dependents[1] = dependent2;
-
-    return GetCachedResult(retResult, dependents);
+    const TaggedObject* dependents[2] = {dependent1, dependent2};
+    DependentResult<T>* found = FindResult(dependents, 2, NULL, 0);
+#ifdef IP_CACHE_STATISTICS
+    CachedResultsStatistics::CountLookup(found != NULL);
+#endif
+    if (found) {
+      retResult = found->GetResult();
+    }
+    return found != NULL;
   }
 
   template <class T>
@@ -656,12 +923,8 @@ namespace Ipopt
     DBG_START_METH("CachedResults<T>::AddCachedResult2dDep", dbg_verbosity);
 #endif
 
-    std::vector<const TaggedObject*> dependents(3);
-    dependents[0] = dependent1;
-    dependents[1] = dependent2;
-    dependents[2] = dependent3;
-
-    AddCachedResult(result, dependents);
+    const TaggedObject* dependents[3] = {dependent1, dependent2, dependent3};
+    AddResult(result, dependents, 3, NULL, 0);
   }
 
   template <class T>
@@ -673,47 +936,37 @@ namespace Ipopt
     DBG_START_METH("CachedResults<T>::GetCachedResult2Dep", dbg_verbosity);
 #endif
 
-    std::vector<const TaggedObject*> dependents(3);
-    dependents[0] = dependent1;
-    dependents[1] = dependent2;
-    dependents[2] = dependent3;
-
-    return GetCachedResult(retResult, dependents);
+    const TaggedObject* dependents[3] = {dependent1, dependent2, dependent3};
+    DependentResult<T>* found = FindResult(dependents, 3, NULL, 0);
+#ifdef IP_CACHE_STATISTICS
+    CachedResultsStatistics::CountLookup(found != NULL);
+#endif
+    if (found) {
+      retResult = found->GetResult();
+    }
+    return found != NULL;
   }
 
   template <class T>
   bool CachedResults<T>::InvalidateResult(const std::vector<const TaggedObject*>& dependents,
                                           const std::vector<Number>& scalar_dependents)
   {
-    if (!cached_results_)
-      return false;
-
-    CleanupInvalidatedResults();
-
-    bool retValue = false;
-    typename std::list< DependentResult<T>* >::const_iterator iter;
-    for (iter = cached_results_->begin(); iter != cached_results_->end();
-         iter++) {
-      if ((*iter)->DependentsIdentical(dependents, scalar_dependents)) {
-        (*iter)->Invalidate();
-        retValue = true;
-        break;
-      }
+    DependentResult<T>* found =
+      FindResult(dependents.empty() ? NULL : &dependents[0],
+                 (Index)dependents.size(),
+                 scalar_dependents.empty() ? NULL : &scalar_dependents[0],
+                 (Index)scalar_dependents.size());
+    if (found) {
+      found->Release();
     }
-
-    return retValue;
+    return found != NULL;
   }
 
   template <class T>
   void CachedResults<T>::Clear()
   {
-    if (!cached_results_)
-      return;
-
-    typename std::list< DependentResult<T>* >::const_iterator iter;
-    for (iter = cached_results_->begin(); iter != cached_results_->end();
-         iter++) {
-      (*iter)->Invalidate();
+    for (size_t i=0; i<slots_.size(); i++) {
+      slots_[i]->Invalidate();
     }
 
     CleanupInvalidatedResults();
@@ -724,6 +977,12 @@ namespace Ipopt
   {
     Clear();
     max_cache_size_ = max_cache_size;
+    if (max_cache_size_ >= 0 && (Int)slots_.size() > max_cache_size_) {
+      for (size_t i=max_cache_size_; i<slots_.size(); i++) {
+        delete slots_[i];
+      }
+      slots_.resize(max_cache_size_);
+    }
   }
 
   template <class T>
@@ -733,22 +992,9 @@ namespace Ipopt
     DBG_START_METH("CachedResults<T>::CleanupInvalidatedResults", dbg_verbosity);
 #endif
 
-    if (!cached_results_)
-      return;
-
-    typename std::list< DependentResult<T>* >::iterator iter;
-    iter = cached_results_->begin();
-    while (iter != cached_results_->end()) {
-      if ((*iter)->IsStale()) {
-        typename std::list< DependentResult<T>* >::iterator
-        iter_to_remove = iter;
-        iter++;
-        DependentResult<T>* result_to_delete = (*iter_to_remove);
-        cached_results_->erase(iter_to_remove);
-        delete result_to_delete;
-      }
-      else {
-        iter++;
+    for (size_t i=0; i<slots_.size(); i++) {
+      if (slots_[i]->NeedsRelease()) {
+        slots_[i]->Release();
       }
     }
   }
@@ -759,14 +1005,10 @@ namespace Ipopt
 #ifdef IP_DEBUG_CACHE
     DBG_START_METH("CachedResults<T>::DebugPrintCachedResults", dbg_verbosity);
     if (DBG_VERBOSITY()>=2 ) {
-      if (!cached_results_) {
-        DBG_PRINT((2,"Currentlt no cached results:\n"));
-      }
-      else {
-        typename std::list< DependentResult<T>* >::const_iterator iter;
-        DBG_PRINT((2,"Current set of cached results:\n"));
-        for (iter = cached_results_->begin(); iter != cached_results_->end(); iter++) {
-          DBG_PRINT((2,"  DependentResult:0x%x\n", (*iter)));
+      DBG_PRINT((2,"Current set of cached results:\n"));
+      for (size_t i=0; i<slots_.size(); i++) {
+        if (!slots_[i]->IsStale()) {
+          DBG_PRINT((2,"  DependentResult:0x%x\n", slots_[i]));
         }
       }
     }
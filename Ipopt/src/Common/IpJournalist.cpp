@@ -9,6 +9,7 @@
 #include "IpoptConfig.h"
 #include "IpJournalist.hpp"
 #include "IpDebug.hpp"
+#include "IpUtils.hpp"
 
 #ifdef HAVE_CSTDIO
 # include <cstdio>
@@ -34,16 +35,26 @@ namespace Ipopt
 {
 
   Journalist::Journalist()
-  {}
+      :
+      lock_(0)
+  {
+    for (Index category=0; category<(Index)J_LAST_CATEGORY; category++) {
+      max_print_levels_[category] = (Index)J_INSUPPRESSIBLE - 1;
+    }
+  }
 
   Journalist::~Journalist()
   {
-    journals_.clear();
+    DeleteAllJournals();
   }
 
   void Journalist::Printf( EJournalLevel level, EJournalCategory category,
                            const char* pformat, ... ) const
   {
+    if (!IsAccepted(level, category)) {
+      return;
+    }
+
     // wrap the arguments and pass to VPrintf
     va_list ap;
     va_start(ap, pformat);
@@ -58,6 +69,9 @@ namespace Ipopt
                                         Index indent_spaces, Index max_length,
                                         const std::string& line) const
   {
+    if (!IsAccepted(level, category)) {
+      return;
+    }
     DBG_ASSERT(indent_spaces + max_length + 1 < 1024);
     char buffer[1024];
     std::string::size_type last_line_pos = 0;
@@ -119,6 +133,10 @@ namespace Ipopt
                                    EJournalCategory category, Index indent_level,
                                    const char* pformat, ... ) const
   {
+    if (!IsAccepted(level, category)) {
+      return;
+    }
+
     // wrap the arguments and pass to VPrintfIndented
     va_list ap;
     va_start(ap, pformat);
@@ -167,19 +185,25 @@ namespace Ipopt
     EJournalCategory category,
     const char* pformat, va_list ap) const
   {
+    if (!IsAccepted(level, category)) {
+      return;
+    }
+
     // print the msg on every journal that accepts
     // the category and output level
-    for (Index i=0; i<(Index)journals_.size(); i++) {
-      if (journals_[i]->IsAccepted(category, level)) {
+    std::vector<Journal*> journals;
+    CopyJournals(journals);
+    for (Index i=0; i<(Index)journals.size(); i++) {
+      if (journals[i]->IsAccepted(category, level)) {
         // print the message
 #ifdef HAVE_VA_COPY
         va_list apcopy;
         va_copy(apcopy, ap);
-        journals_[i]->Printf(category, level, pformat, apcopy);
+        journals[i]->Printf(category, level, pformat, apcopy);
         va_end(apcopy);
 #else
 
-        journals_[i]->Printf(category, level, pformat, ap);
+        journals[i]->Printf(category, level, pformat, ap);
 #endif
 
       }
@@ -192,40 +216,74 @@ namespace Ipopt
     Index indent_level,
     const char* pformat, va_list ap) const
   {
+    if (!IsAccepted(level, category)) {
+      return;
+    }
+
     // print the msg on every journal that accepts
     // the category and output level
-    for (Index i=0; i<(Index)journals_.size(); i++) {
-      if (journals_[i]->IsAccepted(category, level)) {
+    std::vector<Journal*> journals;
+    CopyJournals(journals);
+    for (Index i=0; i<(Index)journals.size(); i++) {
+      if (journals[i]->IsAccepted(category, level)) {
 
         // indent the appropriate amount
         for (Index s=0; s<indent_level; s++) {
-          journals_[i]->Print(category, level, "  ");
+          journals[i]->Print(category, level, "  ");
         }
 
         // print the message
 #ifdef HAVE_VA_COPY
         va_list apcopy;
         va_copy(apcopy, ap);
-        journals_[i]->Printf(category, level, pformat, apcopy);
+        journals[i]->Printf(category, level, pformat, apcopy);
         va_end(apcopy);
 #else
 
-        journals_[i]->Printf(category, level, pformat, ap);
+        journals[i]->Printf(category, level, pformat, ap);
 #endif
 
       }
     }
   }
 
+  void Journalist::CopyJournals(std::vector<Journal*>& journals) const
+  {
+    AcquireSpinLock(lock_);
+    journals.resize(journals_.size());
+    for (Index i=0; i<(Index)journals_.size(); i++) {
+      journals[i] = GetRawPtr(journals_[i]);
+    }
+    ReleaseSpinLock(lock_);
+  }
+
   bool Journalist::ProduceOutput(EJournalLevel level,
                                  EJournalCategory category) const
   {
-    for (Index i=0; i<(Index)journals_.size(); i++) {
-      if (journals_[i]->IsAccepted(category, level)) {
-        return true;
+    return IsAccepted(level, category);
+  }
+
+  void Journalist::UpdateMaxPrintLevels()
+  {
+    // The levels are computed aside and only the changed ones are
+    // stored, so that solves printing in other threads never see an
+    // intermediate value.
+    AcquireSpinLock(lock_);
+    Index levels[J_LAST_CATEGORY];
+    for (Index category=0; category<(Index)J_LAST_CATEGORY; category++) {
+      levels[category] = (Index)J_INSUPPRESSIBLE - 1;
+      for (Index i=0; i<(Index)journals_.size(); i++) {
+        if (journals_[i]->print_levels_[category] > levels[category]) {
+          levels[category] = journals_[i]->print_levels_[category];
+        }
       }
     }
-    return false;
+    for (Index category=0; category<(Index)J_LAST_CATEGORY; category++) {
+      if (max_print_levels_[category] != levels[category]) {
+        max_print_levels_[category] = levels[category];
+      }
+    }
+    ReleaseSpinLock(lock_);
   }
 
   bool Journalist::AddJournal(const SmartPtr<Journal> jrnl)
@@ -239,7 +297,13 @@ namespace Ipopt
       return false;
     }
 
+    AcquireSpinLock(lock_);
     journals_.push_back(jrnl);
+    ReleaseSpinLock(lock_);
+    AcquireSpinLock(jrnl->journalists_lock_);
+    jrnl->journalists_.push_back(this);
+    ReleaseSpinLock(jrnl->journalists_lock_);
+    UpdateMaxPrintLevels();
     return true;
   }
 
@@ -261,8 +325,10 @@ namespace Ipopt
 
   void Journalist::FlushBuffer() const
   {
-    for (Index i=0; i<(Index)journals_.size(); i++) {
-      journals_[i]->FlushBuffer();
+    std::vector<Journal*> journals;
+    CopyJournals(journals);
+    for (Index i=0; i<(Index)journals.size(); i++) {
+      journals[i]->FlushBuffer();
     }
   }
 
@@ -286,10 +352,25 @@ namespace Ipopt
 
   void Journalist::DeleteAllJournals()
   {
-    for (Index i=0; i<(Index)journals_.size(); i++) {
-      journals_[i]=NULL;
+    // The journals notify this journalist while holding their own
+    // lock, so ours is released before taking theirs.
+    std::vector< SmartPtr<Journal> > journals;
+    AcquireSpinLock(lock_);
+    journals.swap(journals_);
+    ReleaseSpinLock(lock_);
+    for (Index i=0; i<(Index)journals.size(); i++) {
+      AcquireSpinLock(journals[i]->journalists_lock_);
+      std::vector<Journalist*>& journalists = journals[i]->journalists_;
+      for (Index j=0; j<(Index)journalists.size(); j++) {
+        if (journalists[j] == this) {
+          journalists.erase(journalists.begin()+j);
+          break;
+        }
+      }
+      ReleaseSpinLock(journals[i]->journalists_lock_);
+      journals[i]=NULL;
     }
-    journals_.resize(0);
+    UpdateMaxPrintLevels();
   }
 
   ///////////////////////////////////////////////////////////////////////////
@@ -301,7 +382,8 @@ namespace Ipopt
     EJournalLevel default_level
   )
       :
-      name_(name)
+      name_(name),
+      journalists_lock_(0)
   {
     for (Index i=0; i<J_LAST_CATEGORY; i++) {
       print_levels_[i] = default_level;
@@ -309,7 +391,9 @@ namespace Ipopt
   }
 
   Journal::~Journal()
-  {}
+  {
+    DBG_ASSERT(journalists_.empty());
+  }
 
   std::string Journal::Name()
   {
@@ -332,17 +416,36 @@ namespace Ipopt
     EJournalCategory category,
     EJournalLevel level)
   {
-    print_levels_[(Index)category] = (Index) level;
+    if (print_levels_[(Index)category] != (Index) level) {
+      print_levels_[(Index)category] = (Index) level;
+      NotifyJournalists();
+    }
   }
 
   void Journal::SetAllPrintLevels(
     EJournalLevel level)
   {
+    bool changed = false;
     for (Index category=(Index)J_DBG;
          category<(Index)J_USER_APPLICATION;
          category++) {
-      print_levels_[category] = (Index) level;
+      if (print_levels_[category] != (Index) level) {
+        print_levels_[category] = (Index) level;
+        changed = true;
+      }
+    }
+    if (changed) {
+      NotifyJournalists();
+    }
+  }
+
+  void Journal::NotifyJournalists()
+  {
+    AcquireSpinLock(journalists_lock_);
+    for (Index i=0; i<(Index)journalists_.size(); i++) {
+      journalists_[i]->UpdateMaxPrintLevels();
     }
+    ReleaseSpinLock(journalists_lock_);
   }
 
 
@@ -188,7 +188,9 @@ namespace Ipopt
      *  write output for the given JournalLevel and JournalCategory.
      *  This is useful if expensive computation would be required for
      *  a particular output.  The author code can check with this
-     *  method if the computations are indeed required.
+     *  method if the computations are indeed required.  This only
+     *  looks up the largest print level of all journals for the
+     *  category, which the Journalist keeps up to date.
      */
     virtual bool ProduceOutput(EJournalLevel level,
                                EJournalCategory category) const;
@@ -259,9 +261,37 @@ namespace Ipopt
     void operator=(const Journalist&);
     //@}
 
+    friend class Journal;
+
+    /** Recompute max_print_levels_, called when journals are added
+     *  or removed and when a journal changes its print levels. */
+    void UpdateMaxPrintLevels();
+
+    /** Copy journals_ under lock_, so that messages can be written
+     *  while other threads add journals.  Raw pointers are taken
+     *  because the reference counts are not thread-safe; the journals
+     *  are kept alive by journals_. */
+    void CopyJournals(std::vector<Journal*>& journals) const;
+
+    /** True if the message would be written by at least one
+     *  journal.  All print methods check this before doing any
+     *  work for the message. */
+    bool IsAccepted(EJournalLevel level, EJournalCategory category) const
+    {
+      return max_print_levels_[(Index)category] >= (Index)level;
+    }
+
     //** Private Data Members. */
     //@{
     std::vector< SmartPtr<Journal> > journals_;
+
+    /** For each category the largest print level of all journals,
+     *  J_INSUPPRESSIBLE-1 if there is no journal. */
+    Index max_print_levels_[J_LAST_CATEGORY];
+
+    /** Spin lock serializing the accesses to journals_ and the
+     *  changes of max_print_levels_ (see AcquireSpinLock) */
+    mutable volatile int lock_;
     //@}
   };
 
@@ -301,7 +331,10 @@ namespace Ipopt
      */
     //@{
     /** Ask if a particular print level/category is accepted by the
-     * journal.
+     * journal.  The Journalist only asks a journal once the print
+     * levels set with SetPrintLevel say that the message may be
+     * accepted, so derived classes may reject more messages here but
+     * not accept more.
      */
     virtual bool IsAccepted(
       EJournalCategory category, EJournalLevel level
@@ -364,11 +397,23 @@ namespace Ipopt
     void operator=(const Journal&);
     //@}
 
+    friend class Journalist;
+
+    /** Tell the journalists holding this journal that the print
+     *  levels changed */
+    void NotifyJournalists();
+
     /** Name of the output location */
     std::string name_;
 
     /** vector of integers indicating the level for each category */
     Index print_levels_[J_LAST_CATEGORY];
+
+    /** Journalists this journal has been added to (not owned) */
+    std::vector<Journalist*> journalists_;
+
+    /** Spin lock serializing the accesses to journalists_ */
+    volatile int journalists_lock_;
   };
 
 
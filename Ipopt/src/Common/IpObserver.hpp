@@ -80,6 +80,13 @@ namespace Ipopt
     inline
     void RequestDetach(NotifyType notify_type, const Subject* subject);
 
+    /** Derived classes can call this method to detach from all
+     *  Subjects they are currently attached to.  The list of subjects
+     *  keeps its memory, so that attaching again is cheap.
+     */
+    inline
+    void RequestDetachAll();
+
     /** Derived classes should overload this method to
      * recieve the requested notification from 
      * attached Subjects
@@ -206,13 +213,7 @@ namespace Ipopt
     }
 #endif
     // Detach all subjects
-    for (Int i=(Int)(subjects_.size()-1); i>=0; i--) {
-#ifdef IP_DEBUG_OBSERVER
-      DBG_PRINT((1,"About to detach subjects_[%d] = 0x%x\n", i, subjects_[i]));
-#endif
-
-      RequestDetach(NT_All, subjects_[i]);
-    }
+    RequestDetachAll();
   }
 
   inline
@@ -264,6 +265,21 @@ namespace Ipopt
     }
   }
 
+  inline
+  void Observer::RequestDetachAll()
+  {
+#ifdef IP_DEBUG_OBSERVER
+    DBG_START_METH("Observer::RequestDetachAll", dbg_verbosity);
+#endif
+    for (Int i=(Int)(subjects_.size()-1); i>=0; i--) {
+#ifdef IP_DEBUG_OBSERVER
+      DBG_PRINT((1,"About to detach subjects_[%d] = 0x%x\n", i, subjects_[i]));
+#endif
+      subjects_[i]->DetachObserver(NT_All, this);
+    }
+    subjects_.clear();
+  }
+
   inline
   void Observer::ProcessNotification(NotifyType notify_type, const Subject* subject)
   {
@@ -301,4 +301,33 @@ namespace Ipopt
     return ret;
   }
 
+  void AcquireSpinLock(volatile int& lock)
+  {
+#ifdef __GNUC__
+    while (__sync_lock_test_and_set(&lock, 1)) {
+      while (lock) {}
+    }
+#else
+    lock = 1;
+#endif
+  }
+
+  void ReleaseSpinLock(volatile int& lock)
+  {
+#ifdef __GNUC__
+    __sync_lock_release(&lock);
+#else
+    lock = 0;
+#endif
+  }
+
+  Index AtomicIncrement(volatile Index& counter)
+  {
+#ifdef __GNUC__
+    return __sync_add_and_fetch(&counter, 1);
+#else
+    return ++counter;
+#endif
+  }
+
 } //namespace Ipopt
@@ -123,6 +123,23 @@ namespace Ipopt
   */
   int Snprintf(char* str, long size, const char* format, ...);
 
+  /**@name Synchronization of threads sharing an object (e.g., a
+   * journal written by solves running in several threads).  These
+   * functions use the atomic builtins of GCC; with other compilers
+   * they are not atomic, and such objects must not be used by several
+   * threads at a time. */
+  //@{
+  /** Waits until the spin lock lock (0 if free) is free and takes
+   *  it. */
+  void AcquireSpinLock(volatile int& lock);
+
+  /** Releases a spin lock taken with AcquireSpinLock. */
+  void ReleaseSpinLock(volatile int& lock);
+
+  /** Increments counter and returns its new value. */
+  Index AtomicIncrement(volatile Index& counter);
+  //@}
+
 } //namespace Ipopt
 
 #endif
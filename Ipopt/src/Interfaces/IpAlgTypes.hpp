@@ -28,6 +28,7 @@ namespace Ipopt
     LOCAL_INFEASIBILITY,
     USER_REQUESTED_STOP,
     FEASIBLE_POINT_FOUND,
+    OBJECTIVE_CUTOFF_REACHED,
     DIVERGING_ITERATES,
     RESTORATION_FAILURE,
     ERROR_IN_STEP_COMPUTATION,
@@ -20,6 +20,8 @@
 #include "IpAlgorithmRegOp.hpp"
 #include "IpCGPenaltyRegOp.hpp"
 #include "IpNLPBoundsRemover.hpp"
+#include "IpDenseVector.hpp"
+#include "IpUtils.hpp"
 
 #ifdef COIN_HAS_HSL
 #include "CoinHslConfig.h"
@@ -41,6 +43,7 @@
 #endif
 
 #include <fstream>
+#include <set>
 
 // Factory to facilitate creating IpoptApplication objects from within a DLL
 
@@ -55,13 +58,68 @@ namespace Ipopt
   static const Index dbg_verbosity = 0;
 #endif
 
+  /** Sets the print levels of the console journal.  The journal may
+   *  be shared with solves running in other threads, so the levels are
+   *  set one category at a time, which leaves the unchanged ones (and
+   *  J_DBG) untouched instead of resetting them all. */
+  static void SetConsolePrintLevels(Journal& jrnl, EJournalLevel print_level)
+  {
+    jrnl.SetPrintLevel(J_DBG, J_NONE);
+    for (Index category=(Index)J_DBG+1;
+         category<(Index)J_USER_APPLICATION;
+         category++) {
+      jrnl.SetPrintLevel((EJournalCategory)category, print_level);
+    }
+  }
+
+  /** Serializes the writing of timing traces by the solves in all
+   *  threads, and protects phase_trace_count. */
+  static volatile int phase_trace_lock = 0;
+
+  /** Number of the last optimization written to a timing trace */
+  static Index phase_trace_count = 0;
+
+  /** Number of the optimization in the last record of the timing
+   *  trace fp, 0 if there is none. */
+  static Index LastPhaseTraceSolve(FILE* fp, bool json)
+  {
+    // Look for the start of the last line (the file ends with a
+    // newline), reading backwards since JSON lines can be long
+    fseek(fp, 0, SEEK_END);
+    long start = ftell(fp) - 1;
+    char buffer[1024];
+    while (start > 0) {
+      long chunk = start < (long)sizeof(buffer) ? start : (long)sizeof(buffer);
+      fseek(fp, start - chunk, SEEK_SET);
+      if (fread(buffer, 1, chunk, fp) != (size_t)chunk) {
+        return 0;
+      }
+      long k = chunk - 1;
+      while (k >= 0 && buffer[k] != '\n') {
+        k--;
+      }
+      start -= chunk;
+      if (k >= 0) {
+        start += k + 1;
+        break;
+      }
+    }
+    int solve;
+    fseek(fp, start, SEEK_SET);
+    if (fscanf(fp, json ? "{\"solve\":%d" : "%d", &solve) != 1) {
+      return 0;
+    }
+    return solve;
+  }
+
   IpoptApplication::IpoptApplication(bool create_console_out /* = true */,
                                      bool create_empty /* = false */)
       :
       read_params_dat_(true),
       rethrow_nonipoptexception_(false),
       inexact_algorithm_(false),
-      replace_bounds_(false)
+      replace_bounds_(false),
+      structure_reusable_(false)
   {
     options_ = new OptionsList();
     if (create_empty)
@@ -119,7 +177,8 @@ namespace Ipopt
       reg_options_(reg_options),
       options_(options),
       inexact_algorithm_(false),
-      replace_bounds_(false)
+      replace_bounds_(false),
+      structure_reusable_(false)
   {}
 
   SmartPtr<IpoptApplication> IpoptApplication::clone()
@@ -159,8 +218,7 @@ namespace Ipopt
         SmartPtr<Journal> stdout_jrnl = jnlst_->GetJournal("console");
         if (IsValid(stdout_jrnl)) {
           // Set printlevel for stdout
-          stdout_jrnl->SetAllPrintLevels(print_level);
-          stdout_jrnl->SetPrintLevel(J_DBG, J_NONE);
+          SetConsolePrintLevels(*stdout_jrnl, print_level);
         }
 
         bool option_set;
@@ -649,6 +707,34 @@ namespace Ipopt
       "yes", "print all timing statistics",
       "If selected, the program will print the CPU usage (user time) for "
       "selected tasks.");
+    roptions->AddStringOption1(
+      "phase_trace_file",
+      "File name for the per-iteration timing trace.",
+      "",
+      "*", "Any acceptable standard file name",
+      "If not empty, the wall clock time spent in each iteration in "
+      "function evaluations, assembly of the KKT matrix, symbolic and "
+      "numerical factorization, backsolves, line search, restoration phase "
+      "and inertia correction is recorded and written to this file at the "
+      "end of the optimization.");
+    roptions->AddStringOption2(
+      "phase_trace_format",
+      "Format of the per-iteration timing trace.",
+      "csv",
+      "csv", "one line with comma separated values per iteration",
+      "json", "one JSON object per optimization",
+      "In the CSV format, a header line is written if the file is empty.  "
+      "In both formats, each record contains a running number of the "
+      "optimization and the return status.  When appending, the numbers "
+      "continue the ones already in the file.");
+    roptions->AddStringOption2(
+      "phase_trace_append",
+      "Append the per-iteration timing trace to the file.",
+      "no",
+      "no", "overwrite the file",
+      "yes", "append to the file",
+      "Appending is useful to collect the traces of a sequence of "
+      "optimizations, e.g., of all NLPs solved in a branch-and-bound.");
 
     roptions->AddStringOption1(
       "option_file_name",
@@ -678,6 +764,24 @@ namespace Ipopt
       "will cause the IpoptApplication object to suppress the default call to "
       "that method.");
 
+    roptions->SetRegisteringCategory("Warm Start");
+    roptions->AddStringOption2(
+      "warm_start_reuse_structure",
+      "Indicates whether a repeated solve should reuse the structure of the previous one if it is unchanged.",
+      "no",
+      "no", "let warm_start_same_structure decide",
+      "yes", "reuse the structure if the problem permits it",
+      "If \"yes\" is chosen, ReOptimizeTNLP checks whether the TNLP has the "
+      "same dimensions, numbers of nonzeros, fixed variables, finite bounds "
+      "and equality constraints as in the previous solve.  If so, the "
+      "problem is solved as with warm_start_same_structure, so that the "
+      "fixed variable maps, the scaling factors, the work vectors of the "
+      "calculated quantities and the symbolic factorization of the linear "
+      "solver are reused, and only the bounds, the starting point and the "
+      "function values are obtained anew.  Otherwise, the structure is "
+      "set up again.  The value of warm_start_same_structure is ignored "
+      "in this case.");
+
     roptions->SetRegisteringCategory("Undocumented");
     roptions->AddStringOption2(
       "print_options_latex_mode",
@@ -720,7 +824,43 @@ namespace Ipopt
     ASSERT_EXCEPTION(adapter->tnlp()==tnlp, INVALID_WARMSTART,
                      "ReOptimizeTNLP called for different TNLP.")
 
-    return ReOptimizeNLP(nlp_adapter_);
+    bool reuse_structure;
+    options_->GetBoolValue("warm_start_reuse_structure", reuse_structure, "");
+    if (!reuse_structure || replace_bounds_) {
+      return ReOptimizeNLP(nlp_adapter_);
+    }
+    ASSERT_EXCEPTION(IsValid(alg_), INVALID_WARMSTART,
+                     "ReOptimizeTNLP called before OptimizeTNLP.");
+
+    // The structure can only be reused if the previous run got far
+    // enough to set it up completely, and if nothing in the TNLP
+    // changed it since then
+    bool same_structure = structure_reusable_ && adapter->HasSameStructure();
+    jnlst_->Printf(J_DETAILED, J_MAIN,
+                   "ReOptimizeTNLP: %s the structure of the previous solve.\n",
+                   same_structure ? "Reusing" : "Not reusing");
+
+    // The decision is passed on to the algorithm objects with a copy
+    // of the options, so that the options of the user are not changed
+    SmartPtr<OptionsList> user_options = UseSolveOptions();
+    if (options_ == user_options) {
+      options_ = new OptionsList();
+      *options_ = *user_options;
+    }
+    options_->SetStringValue("warm_start_same_structure",
+                             same_structure ? "yes" : "no", true, true);
+
+    ApplicationReturnStatus retValue;
+    try {
+      retValue = call_optimize();
+    }
+    catch (...) {
+      options_ = user_options;
+      throw;
+    }
+    options_ = user_options;
+
+    return retValue;
   }
 
   ApplicationReturnStatus
@@ -730,10 +870,26 @@ namespace Ipopt
     return OptimizeNLP(nlp, alg_builder);
   }
 
+  SmartPtr<OptionsList> IpoptApplication::UseSolveOptions()
+  {
+    SmartPtr<OptionsList> user_options = options_;
+    if (!solve_integer_values_.empty()) {
+      options_ = new OptionsList();
+      *options_ = *user_options;
+      std::map<std::string, Index>::const_iterator it;
+      for (it = solve_integer_values_.begin();
+           it != solve_integer_values_.end(); it++) {
+        options_->SetIntegerValue(it->first, it->second, true, true);
+      }
+    }
+    return user_options;
+  }
+
   ApplicationReturnStatus
   IpoptApplication::OptimizeNLP(const SmartPtr<NLP>& nlp, SmartPtr<AlgorithmBuilder>& alg_builder)
   {
     ApplicationReturnStatus retValue = Internal_Error;
+    SmartPtr<OptionsList> user_options = UseSolveOptions();
 
     // Prepare internal data structures of the algorithm
     try {
@@ -789,9 +945,11 @@ namespace Ipopt
       }
       else
       {
+        options_ = user_options;
         throw;
       }
     }
+    options_ = user_options;
 
     jnlst_->FlushBuffer();
 
@@ -809,7 +967,18 @@ namespace Ipopt
     ASSERT_EXCEPTION(orig_nlp->nlp()==nlp, INVALID_WARMSTART,
                      "ReOptimizeTNLP called for different NLP.")
 
-    return call_optimize();
+    SmartPtr<OptionsList> user_options = UseSolveOptions();
+    ApplicationReturnStatus retValue;
+    try {
+      retValue = call_optimize();
+    }
+    catch (...) {
+      options_ = user_options;
+      throw;
+    }
+    options_ = user_options;
+
+    return retValue;
   }
 
 
@@ -822,8 +991,7 @@ namespace Ipopt
     SmartPtr<Journal> stdout_jrnl = jnlst_->GetJournal("console");
     if (IsValid(stdout_jrnl)) {
       // Set printlevel for stdout
-      stdout_jrnl->SetAllPrintLevels(print_level);
-      stdout_jrnl->SetPrintLevel(J_DBG, J_NONE);
+      SetConsolePrintLevels(*stdout_jrnl, print_level);
     }
 
     statistics_ = NULL; /* delete old statistics */
@@ -844,8 +1012,14 @@ namespace Ipopt
     ip_data_->TimingStats().ResetTimes();
     p2ip_nlp->ResetTimes();
 
+    // The per-iteration trace is only recorded if it is written
+    std::string phase_trace_file;
+    options_->GetStringValue("phase_trace_file", phase_trace_file, "");
+    ip_data_->TimingStats().EnablePhaseTrace(!phase_trace_file.empty());
+
     ApplicationReturnStatus retValue = Internal_Error;
     SolverReturn status = INTERNAL_ERROR;
+    structure_reusable_ = false;
     /** Flag indicating if the NLP:FinalizeSolution method should not
      *  be called after optimization. */
     bool skip_finalize_solution_call = false;
@@ -879,6 +1053,10 @@ namespace Ipopt
       // Run the algorithm
       status = p2alg->Optimize();
 
+      // After the first iteration, all structures of the problem and
+      // of the linear solver have been set up
+      structure_reusable_ = p2ip_data->iter_count() > 0;
+
       // Since all the output below doesn't make any sense in this
       // case, we rethrow the TOO_FEW_DOF exception here
       ASSERT_EXCEPTION(status != TOO_FEW_DEGREES_OF_FREEDOM, TOO_FEW_DOF,
@@ -971,6 +1149,24 @@ namespace Ipopt
             J_TIMING_STATISTICS);
         p2ip_nlp->PrintTimingStatistics(*jnlst_, J_SUMMARY,
                                         J_TIMING_STATISTICS);
+
+        // Reuse of the storage of the iterate vectors by the spaces
+        SmartPtr<const IteratesVector> curr = p2ip_data->curr();
+        std::set<const DenseVectorSpace*> spaces;
+        Number n_requests = 0.;
+        Number n_reused = 0.;
+        for (Index i=0; i<curr->NComps(); i++) {
+          const DenseVectorSpace* space =
+            dynamic_cast<const DenseVectorSpace*>(GetRawPtr(curr->GetComp(i)->OwnerSpace()));
+          if (space && spaces.insert(space).second) {
+            n_requests += space->StoragePool().NumberOfRequests();
+            n_reused += space->StoragePool().NumberOfReused();
+          }
+        }
+        jnlst_->Printf(J_SUMMARY, J_TIMING_STATISTICS,
+                       "\nVector storage requests: %.0f, reused from free lists: %.0f (%.1f%%)\n",
+                       n_requests, n_reused,
+                       n_requests > 0. ? 100.*n_reused/n_requests : 0.);
       }
 
       // Write EXIT message
@@ -996,7 +1192,16 @@ namespace Ipopt
       }
       else if (status == FEASIBLE_POINT_FOUND) {
         retValue = Feasible_Point_Found;
-        jnlst_->Printf(J_SUMMARY, J_MAIN, "\nEXIT: Feasible point for square problem found.\n");
+        if (p2ip_cq->IsSquareProblem()) {
+          jnlst_->Printf(J_SUMMARY, J_MAIN, "\nEXIT: Feasible point for square problem found.\n");
+        }
+        else {
+          jnlst_->Printf(J_SUMMARY, J_MAIN, "\nEXIT: Feasible point below objective cutoff found.\n");
+        }
+      }
+      else if (status == OBJECTIVE_CUTOFF_REACHED) {
+        retValue = Objective_Cutoff_Reached;
+        jnlst_->Printf(J_SUMMARY, J_MAIN, "\nEXIT: Lower bound on objective exceeds cutoff.\n");
       }
       else if (status == DIVERGING_ITERATES) {
         retValue = Diverging_Iterates;
@@ -1083,6 +1288,10 @@ namespace Ipopt
       }
     }
 
+    if (!phase_trace_file.empty()) {
+      WritePhaseTrace(phase_trace_file, retValue);
+    }
+
     if (!skip_finalize_solution_call)
       options_->GetBoolValue("skip_finalize_solution_call", skip_finalize_solution_call, "");
 
@@ -1103,6 +1312,7 @@ namespace Ipopt
       case LOCAL_INFEASIBILITY:
       case USER_REQUESTED_STOP:
       case FEASIBLE_POINT_FOUND:
+      case OBJECTIVE_CUTOFF_REACHED:
       case DIVERGING_ITERATES:
       case RESTORATION_FAILURE:
       case ERROR_IN_STEP_COMPUTATION:
@@ -1143,6 +1353,45 @@ namespace Ipopt
     return retValue;
   }
 
+  void IpoptApplication::WritePhaseTrace(const std::string& file_name,
+                                         ApplicationReturnStatus status)
+  {
+    std::string format;
+    options_->GetStringValue("phase_trace_format", format, "");
+    bool json = (format == "json");
+    bool append;
+    options_->GetBoolValue("phase_trace_append", append, "");
+
+    // Solves in other threads may write to the same file
+    AcquireSpinLock(phase_trace_lock);
+    FILE* fp = fopen(file_name.c_str(), append ? "a+" : "w");
+    if (!fp) {
+      ReleaseSpinLock(phase_trace_lock);
+      jnlst_->Printf(J_ERROR, J_MAIN,
+                     "Cannot open file \"%s\" for the timing trace.\n",
+                     file_name.c_str());
+      return;
+    }
+    fseek(fp, 0, SEEK_END);
+    bool empty_file = (ftell(fp) == 0);
+
+    // Running number of the optimizations, so that the records of
+    // several optimizations in one file can be told apart.  When
+    // appending, it continues the numbers of the file, which may have
+    // been written by another process.
+    Index solve = phase_trace_count + 1;
+    if (append && !empty_file) {
+      solve = Max(solve, LastPhaseTraceSolve(fp, json) + 1);
+      fseek(fp, 0, SEEK_END);
+    }
+    phase_trace_count = solve;
+
+    ip_data_->TimingStats().WritePhaseTrace(fp, json, empty_file,
+                                            solve, (Index)status);
+    fclose(fp);
+    ReleaseSpinLock(phase_trace_lock);
+  }
+
   bool IpoptApplication::OpenOutputFile(std::string file_name,
                                         EJournalLevel print_level)
   {
@@ -22,6 +22,8 @@
 #endif
 
 #include <iostream>
+#include <map>
+#include <string>
 
 #include "IpJournalist.hpp"
 #include "IpTNLP.hpp"
@@ -105,7 +107,11 @@ namespace Ipopt
      *  The OptimizeTNLP method must have been called before.  The
      *  TNLP must be the same object, and the structure (number of
      *  variables and constraints and position of nonzeros in Jacobian
-     *  and Hessian must be the same). */
+     *  and Hessian must be the same).  If the option
+     *  warm_start_reuse_structure is set, the problem structure, the
+     *  scaling and the symbolic factorization of the previous solve
+     *  are kept whenever the fixed variables and the kinds of bounds
+     *  are unchanged. */
     virtual ApplicationReturnStatus ReOptimizeTNLP(const SmartPtr<TNLP>& tnlp);
 
     /** Solve a problem (that inherits from NLP) for a repeated time.
@@ -170,6 +176,25 @@ namespace Ipopt
      *  method at the convenient time.  */
     void PrintCopyrightMessage();
 
+    /** @name Options for single solves.
+     *
+     *  The integer options set here override Options() in the
+     *  following solves until they are cleared.  They are set on a
+     *  copy of Options() during each solve, so that an OptionsList
+     *  shared with other applications (maybe solving in other
+     *  threads) is not changed. */
+    //@{
+    void SetSolveIntegerValue(const std::string& tag, Index value)
+    {
+      solve_integer_values_[tag] = value;
+    }
+
+    void ClearSolveIntegerValues()
+    {
+      solve_integer_values_.clear();
+    }
+    //@}
+
     /** Method to set whether non-ipopt non-bad_alloc exceptions
      * are rethrown by Ipopt.
      * By default, non-Ipopt and non-std::bad_alloc exceptions are
@@ -214,6 +239,17 @@ namespace Ipopt
      *  This is used both for Optimize and ReOptimize */
     ApplicationReturnStatus call_optimize();
 
+    /** Replace options_ by a copy with the values of
+     *  solve_integer_values_ (if there are any), and return the
+     *  previous options_, which the caller restores after the
+     *  solve */
+    SmartPtr<OptionsList> UseSolveOptions();
+
+    /** Write the per-iteration timing trace of the last optimization
+     *  to the file given by the phase_trace_file option */
+    void WritePhaseTrace(const std::string& file_name,
+                         ApplicationReturnStatus status);
+
     /**@name Variables that customize the application behavior */
     //@{
     /** Decide whether or not the ipopt.opt file should be read */
@@ -232,6 +268,9 @@ namespace Ipopt
     /** OptionsList used for the application */
     SmartPtr<OptionsList> options_;
 
+    /** Integer options overriding options_ in the solves */
+    std::map<std::string, Index> solve_integer_values_;
+
     /** Object for storing statistics about the most recent
      *  optimization run. */
     SmartPtr<SolveStatistics> statistics_;
@@ -266,6 +305,11 @@ namespace Ipopt
      *  constraints.  This is necessary for the inexact algorithm. */
     bool replace_bounds_;
     //@}
+
+    /** Flag indicating if the most recent optimization set up all
+     *  structures of the problem, so that they can be reused by
+     *  ReOptimizeTNLP with warm_start_reuse_structure. */
+    bool structure_reusable_;
   };
 
 } // namespace Ipopt
@@ -22,6 +22,7 @@ enum ApplicationReturnStatus
     Diverging_Iterates=4,
     User_Requested_Stop=5,
     Feasible_Point_Found=6,
+    Objective_Cutoff_Reached=7,
 
     Maximum_Iterations_Exceeded=-1,
     Restoration_Failed=-2,
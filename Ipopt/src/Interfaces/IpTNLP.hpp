@@ -276,6 +276,80 @@ namespace Ipopt
     }
     //@}
 
+    /** @name Methods for block-separable problems.  If the
+     *  constraints fall into independent blocks (for example, one
+     *  block per time period of a multi-period model), the user can
+     *  declare them here, and Ipopt then evaluates the blocks in
+     *  parallel (if it has been compiled with OpenMP; the number of
+     *  threads is set with the option block_eval_num_threads).
+     *
+     *  A block b consists of the constraints g_start[b] to
+     *  g_start[b+1]-1, of the Jacobian nonzeros jac_start[b] to
+     *  jac_start[b+1]-1, and of the Hessian nonzeros h_start[b] to
+     *  h_start[b+1]-1, where the nonzeros are counted in the order
+     *  in which eval_jac_g and eval_h return their structure.  The
+     *  blocks must cover all constraints and nonzeros, so g_start[0],
+     *  jac_start[0] and h_start[0] are 0 and the last entries are m,
+     *  nele_jac and nele_hess.  Each Hessian nonzero belongs to
+     *  exactly one block; the objective terms can be split among the
+     *  blocks in any way.
+     *
+     *  The block evaluation methods are called concurrently for
+     *  different blocks, so they must be thread-safe; an exception
+     *  thrown by one of them is treated like an evaluation error
+     *  (return value false).  The arrays
+     *  g_block and values_block point to the first entry of the
+     *  block.  The standard eval_g, eval_jac_g and eval_h methods
+     *  must still be implemented; they are used to obtain the
+     *  sparsity structure, and by the derivative checker and the
+     *  finite difference approximations. */
+    //@{
+    /** overload this method to return the number of independent
+     *  constraint blocks.  The default (0) means that the problem has
+     *  no block structure. */
+    virtual Index get_number_of_blocks()
+    {
+      return 0;
+    }
+
+    /** overload this method to return the block boundaries.  The
+     *  arrays have length num_blocks+1.  h_start is NULL if the
+     *  Hessian is not required. */
+    virtual bool get_block_structure(Index num_blocks, Index* g_start,
+                                     Index* jac_start, Index* h_start)
+    {
+      return false;
+    }
+
+    /** overload this method to return the values of the constraints
+     *  in block block. */
+    virtual bool eval_g_block(Index block, Index n, const Number* x,
+                              bool new_x, Index m_block, Number* g_block)
+    {
+      return false;
+    }
+
+    /** overload this method to return the values of the Jacobian
+     *  nonzeros in block block. */
+    virtual bool eval_jac_g_block(Index block, Index n, const Number* x,
+                                  bool new_x, Index nele_block,
+                                  Number* values_block)
+    {
+      return false;
+    }
+
+    /** overload this method to return the values of the Hessian
+     *  nonzeros in block block.  The full vector of multipliers is
+     *  passed in lambda. */
+    virtual bool eval_h_block(Index block, Index n, const Number* x,
+                              bool new_x, Number obj_factor, Index m,
+                              const Number* lambda, bool new_lambda,
+                              Index nele_block, Number* values_block)
+    {
+      return false;
+    }
+    //@}
+
   private:
     /**@name Default Compiler Generated Methods
      * (Hidden to avoid implicit creation/calling).
@@ -55,6 +55,12 @@
 # endif
 #endif
 
+#include <algorithm>
+
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
 namespace Ipopt
 {
 #if COIN_IPOPT_VERBOSITY > 0
@@ -78,7 +84,9 @@ namespace Ipopt
       findiff_jac_ja_(NULL),
       findiff_jac_postriplet_(NULL),
       findiff_x_l_(NULL),
-      findiff_x_u_(NULL)
+      findiff_x_u_(NULL),
+      num_blocks_(0),
+      block_scatter_(false)
   {
     ASSERT_EXCEPTION(IsValid(tnlp_), INVALID_TNLP,
                      "The TNLP passed to TNLPAdapter is NULL. This MUST be a valid TNLP!");
@@ -152,6 +160,15 @@ namespace Ipopt
       "num_linear_variables variables are linear.  The Hessian is then not "
       "approximated in this space.  If the get_number_of_nonlinear_variables "
       "method in the TNLP is implemented, this option is ignored.");
+    roptions->AddLowerBoundedIntegerOption(
+      "block_eval_num_threads",
+      "Number of threads for evaluating independent constraint blocks.",
+      0, 0,
+      "If the TNLP declares independent constraint blocks "
+      "(get_number_of_blocks), the constraints and their derivatives are "
+      "evaluated block by block with this number of threads.  The value 0 "
+      "uses the OpenMP default.  This option only has an effect if Ipopt "
+      "has been compiled with OpenMP.");
 
     roptions->SetRegisteringCategory("Derivative Checker");
     roptions->AddStringOption4(
@@ -181,6 +198,33 @@ namespace Ipopt
       0., true,
       1e-8,
       "This determines the relative perturbation of the variable entries.");
+    roptions->AddStringOption2(
+      "findiff_jac_coloring",
+      "Indicates whether columns of the finite difference Jacobian are grouped.",
+      "no",
+      "no", "perturb one variable per constraint evaluation",
+      "yes", "perturb groups of structurally orthogonal variables together",
+      "If enabled, the variables are partitioned into groups such that no "
+      "two variables in a group appear in the same constraint (greedy "
+      "coloring of the column intersection graph of the declared Jacobian "
+      "structure, as proposed by Curtis, Powell and Reid).  All variables of "
+      "a group are perturbed at once, so that one Jacobian approximation "
+      "needs about as many constraint evaluations as the largest number of "
+      "nonzeros in a row.  This requires that the declared structure "
+      "contains all entries that can be nonzero; otherwise the "
+      "approximation differs from the one without grouping.");
+    roptions->AddLowerBoundedIntegerOption(
+      "findiff_num_threads",
+      "Number of threads for evaluating the finite difference groups.",
+      0, 1,
+      "The functions for the different groups of perturbed variables (of the "
+      "finite difference Jacobian and Hessian) are evaluated concurrently "
+      "with this number of threads.  The value 0 uses the OpenMP default.  "
+      "Values other than 1 require that eval_g (for the Jacobian) or "
+      "eval_grad_f and eval_jac_g (for the Hessian) of the TNLP can be called "
+      "from several threads at the same time; an exception thrown by them "
+      "is then treated like an evaluation error.  This option only has an "
+      "effect if Ipopt has been compiled with OpenMP.");
     roptions->AddLowerBoundedNumberOption(
       "derivative_test_tol",
       "Threshold for indicating wrong derivative.",
@@ -256,11 +300,17 @@ namespace Ipopt
     hessian_approximation_ = HessianApproximationType(enum_int);
     options.GetIntegerValue("num_linear_variables", num_linear_variables_,
                             prefix);
+    options.GetIntegerValue("block_eval_num_threads", block_eval_num_threads_,
+                            prefix);
 
     options.GetEnumValue("jacobian_approximation", enum_int, prefix);
     jacobian_approximation_ = JacobianApproxEnum(enum_int);
     options.GetNumericValue("findiff_perturbation",
                             findiff_perturbation_, prefix);
+    options.GetBoolValue("findiff_jac_coloring", findiff_jac_coloring_,
+                         prefix);
+    options.GetIntegerValue("findiff_num_threads", findiff_num_threads_,
+                            prefix);
 
     options.GetNumericValue("point_perturbation_radius",
                             point_perturbation_radius_, prefix);
@@ -333,6 +383,80 @@ namespace Ipopt
     return true;
   }
 
+  void TNLPAdapter::ComputeBoundsPattern(const Number* x_l, const Number* x_u,
+                                         const Number* g_l, const Number* g_u,
+                                         std::vector<char>& pattern) const
+  {
+    // Inconsistent bounds get a code of their own, GetSpaces rejects
+    // them, so that such a problem never has the structure of the
+    // previous one and GetSpaces is run again to report them.
+    pattern.resize(n_full_x_+n_full_g_);
+    for (Index i=0; i<n_full_x_; i++) {
+      if (x_l[i] == x_u[i]) {
+        pattern[i] = 4;
+      }
+      else if (x_l[i] > x_u[i]) {
+        pattern[i] = 5;
+      }
+      else {
+        pattern[i] = (char)((x_l[i] > nlp_lower_bound_inf_ ? 1 : 0) +
+                            (x_u[i] < nlp_upper_bound_inf_ ? 2 : 0));
+      }
+    }
+    for (Index i=0; i<n_full_g_; i++) {
+      if (g_l[i] == g_u[i]) {
+        pattern[n_full_x_+i] = 4;
+      }
+      else if (g_l[i] > g_u[i]) {
+        pattern[n_full_x_+i] = 5;
+      }
+      else {
+        pattern[n_full_x_+i] =
+          (char)((g_l[i] > nlp_lower_bound_inf_ ? 1 : 0) +
+                 (g_u[i] < nlp_upper_bound_inf_ ? 2 : 0));
+      }
+    }
+  }
+
+  bool TNLPAdapter::HasSameStructure()
+  {
+    DBG_START_METH("TNLPAdapter::HasSameStructure", dbg_verbosity);
+
+    if (!full_x_ || bounds_pattern_.empty()) {
+      return false;
+    }
+
+    Index n_full_x, n_full_g, nz_full_jac_g, nz_full_h;
+    TNLP::IndexStyleEnum index_style;
+    bool retval = tnlp_->get_nlp_info(n_full_x, n_full_g, nz_full_jac_g,
+                                      nz_full_h, index_style);
+    if (!retval || n_full_x != n_full_x_ || n_full_g != n_full_g_ ||
+        nz_full_jac_g != nz_full_jac_g_ || nz_full_h != nz_full_h_ ||
+        index_style != index_style_) {
+      return false;
+    }
+
+    std::vector<Number> x_l(n_full_x_);
+    std::vector<Number> x_u(n_full_x_);
+    std::vector<Number> g_l(n_full_g_);
+    std::vector<Number> g_u(n_full_g_);
+    retval = tnlp_->get_bounds_info(n_full_x_,
+                                    n_full_x_ ? &x_l[0] : NULL,
+                                    n_full_x_ ? &x_u[0] : NULL,
+                                    n_full_g_,
+                                    n_full_g_ ? &g_l[0] : NULL,
+                                    n_full_g_ ? &g_u[0] : NULL);
+    if (!retval) {
+      return false;
+    }
+    std::vector<char> pattern;
+    ComputeBoundsPattern(n_full_x_ ? &x_l[0] : NULL,
+                         n_full_x_ ? &x_u[0] : NULL,
+                         n_full_g_ ? &g_l[0] : NULL,
+                         n_full_g_ ? &g_u[0] : NULL, pattern);
+    return pattern == bounds_pattern_;
+  }
+
   bool TNLPAdapter::GetSpaces(SmartPtr<const VectorSpace>& x_space,
                               SmartPtr<const VectorSpace>& c_space,
                               SmartPtr<const VectorSpace>& d_space,
@@ -387,6 +511,7 @@ namespace Ipopt
       h_idx_map_ = NULL;
       delete [] x_fixed_map_;
       x_fixed_map_ = NULL;
+      bounds_pattern_.clear();
     }
 
     // Get the full dimensions of the problem
@@ -443,6 +568,7 @@ namespace Ipopt
       Number* g_u = new Number[n_full_g_];
       bool retval = tnlp_->get_bounds_info(n_full_x_, x_l, x_u, n_full_g_, g_l, g_u);
       ASSERT_EXCEPTION(retval, INVALID_TNLP, "get_bounds_info returned false in GetSpaces");
+      ComputeBoundsPattern(x_l, x_u, g_l, g_u, bounds_pattern_);
 
       //*********************************************************
       // Create the spaces and permutation spaces
@@ -1084,6 +1210,16 @@ namespace Ipopt
           jacobian_approximation_ == JAC_FINDIFF_VALUES) {
         initialize_findiff_jac(g_iRow, g_jCol);
       }
+      if (hessian_approximation_ == FINDIFF_VALUES) {
+        // Keep the Jacobian structure for the constraint part of the
+        // gradient of the Lagrangian
+        findiff_jac_irow_.resize(nz_full_jac_g_);
+        findiff_jac_jcol_.resize(nz_full_jac_g_);
+        for (Index i=0; i<nz_full_jac_g_; i++) {
+          findiff_jac_irow_[i] = g_iRow[i] - 1;
+          findiff_jac_jcol_[i] = g_jCol[i] - 1;
+        }
+      }
 
       // ... build the non-zero structure for jac_c
       // ... (the permutation from rows in jac_g to jac_c is
@@ -1193,7 +1329,13 @@ namespace Ipopt
       delete [] g_jCol;
       g_jCol = NULL;
 
-      if (hessian_approximation_==EXACT) {
+      if (hessian_approximation_ == FINDIFF_VALUES &&
+          jacobian_approximation_ != JAC_EXACT) {
+        jnlst_->Printf(J_ERROR, J_INITIALIZATION,
+                       "Option \"hessian_approximation\" is chosen as \"finite-difference-values\", which requires exact values of the constraint Jacobian.\n");
+        THROW_EXCEPTION(OPTION_INVALID, "finite difference Hessian requires exact Jacobian");
+      }
+      if (hessian_approximation_ != LIMITED_MEMORY) {
         /** Create the matrix space for the hessian of the lagrangian */
         Index* full_h_iRow = new Index[nz_full_h_];
         Index* full_h_jCol = new Index[nz_full_h_];
@@ -1247,6 +1389,9 @@ namespace Ipopt
         }
         nz_h_ = current_nz;
         Hess_lagrangian_space_ = new SymTMatrixSpace(n_x_var, nz_h_, h_iRow, h_jCol);
+        if (hessian_approximation_ == FINDIFF_VALUES) {
+          initialize_findiff_hess(full_h_iRow, full_h_jCol);
+        }
         delete [] full_h_iRow;
         full_h_iRow = NULL;
         delete [] full_h_jCol;
@@ -1278,6 +1423,8 @@ namespace Ipopt
     Jac_d_space = Jac_d_space_;
     Hess_lagrangian_space = Hess_lagrangian_space_;
 
+    initialize_blocks();
+
     if (IsValid(jnlst_)) {
       jnlst_->Printf(J_ITERSUMMARY, J_STATISTICS,
                      "Number of nonzeros in equality constraint Jacobian...:%9d\n", nz_jac_c_);
@@ -1419,7 +1566,8 @@ namespace Ipopt
     }
 
     // In case we are doing finite differences, keep a copy of the bounds
-    if (jacobian_approximation_ != JAC_EXACT) {
+    if (jacobian_approximation_ != JAC_EXACT ||
+        hessian_approximation_ == FINDIFF_VALUES) {
       delete [] findiff_x_l_;
       delete [] findiff_x_u_;
       findiff_x_l_ = x_l;
@@ -1625,9 +1773,22 @@ namespace Ipopt
       Number* values = dc->Values();
       const Index* c_pos = P_c_g_->ExpandedPosIndices();
       Index n_c_no_fixed = P_c_g_->NCols();
-      for (Index i=0; i<n_c_no_fixed; i++) {
-        values[i] = full_g_[c_pos[i]];
-        values[i] -= c_rhs_[i];
+      if (block_scatter_) {
+#ifdef _OPENMP
+        const Index nthreads = num_block_threads();
+        #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+        for (Index b=0; b<num_blocks_; b++) {
+          for (Index i=block_c_start_[b]; i<block_c_start_[b+1]; i++) {
+            values[i] = full_g_[c_pos[i]] - c_rhs_[i];
+          }
+        }
+      }
+      else {
+        for (Index i=0; i<n_c_no_fixed; i++) {
+          values[i] = full_g_[c_pos[i]];
+          values[i] -= c_rhs_[i];
+        }
       }
       if (fixed_variable_treatment_==MAKE_CONSTRAINT) {
         for (Index i=0; i<n_x_fixed_; i++) {
@@ -1653,9 +1814,22 @@ namespace Ipopt
       DBG_ASSERT(dynamic_cast<GenTMatrix*>(&jac_c));
       Number* values = gt_jac_c->Values();
 
-      for (Index i=0; i<nz_jac_c_no_extra_; i++) {
-        // Assume the same structure as initially given
-        values[i] = jac_g_[jac_idx_map_[i]];
+      if (block_scatter_) {
+#ifdef _OPENMP
+        const Index nthreads = num_block_threads();
+        #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+        for (Index b=0; b<num_blocks_; b++) {
+          for (Index i=block_jac_c_start_[b]; i<block_jac_c_start_[b+1]; i++) {
+            values[i] = jac_g_[jac_idx_map_[i]];
+          }
+        }
+      }
+      else {
+        for (Index i=0; i<nz_jac_c_no_extra_; i++) {
+          // Assume the same structure as initially given
+          values[i] = jac_g_[jac_idx_map_[i]];
+        }
       }
       if (fixed_variable_treatment_==MAKE_CONSTRAINT) {
         const Number one = 1.;
@@ -1678,8 +1852,21 @@ namespace Ipopt
     Number* values = dd->Values();
     if (internal_eval_g(new_x)) {
       const Index* d_pos = P_d_g_->ExpandedPosIndices();
-      for (Index i=0; i<d.Dim(); i++) {
-        values[i] = full_g_[d_pos[i]];
+      if (block_scatter_) {
+#ifdef _OPENMP
+        const Index nthreads = num_block_threads();
+        #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+        for (Index b=0; b<num_blocks_; b++) {
+          for (Index i=block_d_start_[b]; i<block_d_start_[b+1]; i++) {
+            values[i] = full_g_[d_pos[i]];
+          }
+        }
+      }
+      else {
+        for (Index i=0; i<d.Dim(); i++) {
+          values[i] = full_g_[d_pos[i]];
+        }
       }
       return true;
     }
@@ -1699,9 +1886,23 @@ namespace Ipopt
       DBG_ASSERT(dynamic_cast<GenTMatrix*>(&jac_d));
       Number* values = gt_jac_d->Values();
 
-      for (Index i=0; i<nz_jac_d_; i++) {
-        // Assume the same structure as initially given
-        values[i] = jac_g_[jac_idx_map_[nz_jac_c_no_extra_ + i]];
+      const Index* jac_d_map = jac_idx_map_ + nz_jac_c_no_extra_;
+      if (block_scatter_) {
+#ifdef _OPENMP
+        const Index nthreads = num_block_threads();
+        #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+        for (Index b=0; b<num_blocks_; b++) {
+          for (Index i=block_jac_d_start_[b]; i<block_jac_d_start_[b+1]; i++) {
+            values[i] = jac_g_[jac_d_map[i]];
+          }
+        }
+      }
+      else {
+        for (Index i=0; i<nz_jac_d_; i++) {
+          // Assume the same structure as initially given
+          values[i] = jac_g_[jac_d_map[i]];
+        }
       }
       return true;
     }
@@ -1742,7 +1943,22 @@ namespace Ipopt
     DBG_ASSERT(dynamic_cast<SymTMatrix*>(&h));
     Number* values = st_h->Values();
 
-    if (h_idx_map_) {
+    if (hessian_approximation_ == FINDIFF_VALUES) {
+      Number* full_h = h_idx_map_ ? new Number[nz_full_h_] : values;
+      retval = internal_eval_findiff_h(obj_factor, full_h);
+      if (retval && h_idx_map_) {
+        for (Index i=0; i<nz_h_; i++) {
+          values[i] = full_h[h_idx_map_[i]];
+        }
+      }
+      if (h_idx_map_) {
+        delete [] full_h;
+      }
+    }
+    else if (!block_h_start_.empty()) {
+      retval = internal_eval_h_blocks(new_x, obj_factor, new_y, values);
+    }
+    else if (h_idx_map_) {
       Number* full_h = new Number[nz_full_h_];
 
       if (tnlp_->eval_h(n_full_x_, full_x_, new_x, obj_factor, n_full_g_,
@@ -2350,7 +2566,13 @@ namespace Ipopt
 
     x_tag_for_g_ = x_tag_for_iterates_;
 
-    bool retval = tnlp_->eval_g(n_full_x_, full_x_, new_x, n_full_g_, full_g_);
+    bool retval;
+    if (num_blocks_ > 0) {
+      retval = internal_eval_g_blocks(new_x);
+    }
+    else {
+      retval = tnlp_->eval_g(n_full_x_, full_x_, new_x, n_full_g_, full_g_);
+    }
 
     if (!retval) {
       x_tag_for_jac_g_ = TaggedObject::Tag();
@@ -2369,7 +2591,10 @@ namespace Ipopt
     x_tag_for_jac_g_ = x_tag_for_iterates_;
 
     bool retval;
-    if (jacobian_approximation_ == JAC_EXACT) {
+    if (jacobian_approximation_ == JAC_EXACT && num_blocks_ > 0) {
+      retval = internal_eval_jac_g_blocks(new_x);
+    }
+    else if (jacobian_approximation_ == JAC_EXACT) {
       retval = tnlp_->eval_jac_g(n_full_x_, full_x_, new_x, n_full_g_,
                                  nz_full_jac_g_, NULL, NULL, jac_g_);
     }
@@ -2377,33 +2602,7 @@ namespace Ipopt
       // make sure we have the value of the constraints at the point
       retval = internal_eval_g(new_x);
       if (retval) {
-        Number* full_g_pert = new Number[n_full_g_];
-        Number* full_x_pert = new Number[n_full_x_];
-        IpBlasDcopy(n_full_x_, full_x_, 1, full_x_pert, 1);
-        // Compute the finite difference Jacobian
-        for (Index ivar = 0; ivar<n_full_x_; ivar++) {
-          if (findiff_x_l_[ivar] < findiff_x_u_[ivar]) {
-            const Number xorig = full_x_pert[ivar];
-            Number this_perturbation =
-              findiff_perturbation_*Max(1., fabs(full_x_[ivar]));
-            full_x_pert[ivar] += this_perturbation;
-            if (full_x_pert[ivar] > findiff_x_u_[ivar]) {
-              full_x_pert[ivar] = xorig - this_perturbation;
-            }
-            retval = tnlp_->eval_g(n_full_x_, full_x_pert, true, n_full_g_,
-                                   full_g_pert);
-            if (!retval) break;
-            for (Index i=findiff_jac_ia_[ivar]; i<findiff_jac_ia_[ivar+1]; i++) {
-              const Index& icon = findiff_jac_ja_[i];
-              const Index& ipos = findiff_jac_postriplet_[i];
-              jac_g_[ipos] =
-                (full_g_pert[icon]-full_g_[icon])/this_perturbation;
-            }
-            full_x_pert[ivar] = xorig;
-          }
-        }
-        delete [] full_g_pert;
-        delete [] full_x_pert;
+        retval = internal_eval_findiff_jac();
       }
     }
 
@@ -2463,6 +2662,793 @@ namespace Ipopt
       findiff_jac_postriplet_[i] = postrip[i];
     }
 
+    initialize_findiff_jac_groups();
+  }
+
+  /** Comparison of columns of the finite difference Jacobian by their
+   *  number of nonzeros (more nonzeros first) */
+  class FindiffColumnLonger
+  {
+  public:
+    FindiffColumnLonger(const Index* ia)
+        : ia_(ia)
+    {}
+    bool operator()(Index i, Index j) const
+    {
+      return ia_[i+1]-ia_[i] > ia_[j+1]-ia_[j];
+    }
+  private:
+    const Index* ia_;
+  };
+
+  void TNLPAdapter::initialize_findiff_jac_groups()
+  {
+    // Row-wise copy of the structure, to find the columns that share
+    // a row with a given column
+    std::vector<Index> row_start(n_full_g_+1, 0);
+    for (Index i=0; i<findiff_jac_nnz_; i++) {
+      row_start[findiff_jac_ja_[i]+1]++;
+    }
+    for (Index icon=0; icon<n_full_g_; icon++) {
+      row_start[icon+1] += row_start[icon];
+    }
+    std::vector<Index> row_col(findiff_jac_nnz_);
+    std::vector<Index> next(row_start.begin(), row_start.end()-1);
+    for (Index ivar=0; ivar<n_full_x_; ivar++) {
+      for (Index i=findiff_jac_ia_[ivar]; i<findiff_jac_ia_[ivar+1]; i++) {
+        row_col[next[findiff_jac_ja_[i]]++] = ivar;
+      }
+    }
+
+    // Columns with structural nonzeros, the ones with most nonzeros
+    // first (the largest-first ordering usually needs fewer colors
+    // than the natural order).  Empty columns need no evaluation.
+    std::vector<Index> order;
+    order.reserve(n_full_x_);
+    for (Index ivar=0; ivar<n_full_x_; ivar++) {
+      if (findiff_jac_ia_[ivar+1] > findiff_jac_ia_[ivar]) {
+        order.push_back(ivar);
+      }
+    }
+    if (findiff_jac_coloring_) {
+      std::stable_sort(order.begin(), order.end(),
+                       FindiffColumnLonger(findiff_jac_ia_));
+    }
+
+    // Greedy distance-2 coloring: a column gets the smallest color
+    // that none of the columns sharing a row with it has.  Without
+    // grouping, each column gets its own color.
+    std::vector<Index> color(n_full_x_, -1);
+    std::vector<Index> forbidden;
+    Index ncolors = 0;
+    for (size_t k=0; k<order.size(); k++) {
+      const Index ivar = order[k];
+      Index c = (Index)k;
+      if (findiff_jac_coloring_) {
+        for (Index i=findiff_jac_ia_[ivar]; i<findiff_jac_ia_[ivar+1]; i++) {
+          const Index icon = findiff_jac_ja_[i];
+          for (Index j=row_start[icon]; j<row_start[icon+1]; j++) {
+            const Index cj = color[row_col[j]];
+            if (cj >= 0) {
+              forbidden[cj] = ivar;
+            }
+          }
+        }
+        for (c=0; c<ncolors && forbidden[c] == ivar; c++) {}
+      }
+      if (c == ncolors) {
+        ncolors++;
+        forbidden.push_back(-1);
+      }
+      color[ivar] = c;
+    }
+
+    // Columns ordered by color
+    findiff_jac_group_start_.assign(ncolors+1, 0);
+    for (Index ivar=0; ivar<n_full_x_; ivar++) {
+      if (color[ivar] >= 0) {
+        findiff_jac_group_start_[color[ivar]+1]++;
+      }
+    }
+    for (Index c=0; c<ncolors; c++) {
+      findiff_jac_group_start_[c+1] += findiff_jac_group_start_[c];
+    }
+    findiff_jac_group_var_.resize(findiff_jac_group_start_[ncolors]);
+    next.assign(findiff_jac_group_start_.begin(),
+                findiff_jac_group_start_.end()-1);
+    for (Index ivar=0; ivar<n_full_x_; ivar++) {
+      if (color[ivar] >= 0) {
+        findiff_jac_group_var_[next[color[ivar]]++] = ivar;
+      }
+    }
+
+    if (IsValid(jnlst_)) {
+      jnlst_->Printf(J_DETAILED, J_INITIALIZATION,
+                     "Finite difference Jacobian uses %d constraint evaluations for %d variables.\n",
+                     ncolors, n_full_x_);
+    }
+  }
+
+  Index TNLPAdapter::num_findiff_threads(Index ngroups) const
+  {
+    Index nthreads = 1;
+#ifdef _OPENMP
+    nthreads = findiff_num_threads_ > 0 ? findiff_num_threads_ :
+               omp_get_max_threads();
+#endif
+    return Min(nthreads, Max(ngroups, 1));
+  }
+
+  bool TNLPAdapter::eval_findiff_jac_group(Index c, Number* full_x_pert,
+      Number* full_g_pert, Number* perturbation)
+  {
+    const Index* first = &findiff_jac_group_var_[0] +
+                         findiff_jac_group_start_[c];
+    const Index* last = &findiff_jac_group_var_[0] +
+                        findiff_jac_group_start_[c+1];
+    bool perturbed = false;
+    for (const Index* p=first; p<last; p++) {
+      const Index ivar = *p;
+      if (findiff_x_l_[ivar] < findiff_x_u_[ivar]) {
+        const Number xorig = full_x_[ivar];
+        Number this_perturbation =
+          findiff_perturbation_*Max(1., fabs(xorig));
+        full_x_pert[ivar] = xorig + this_perturbation;
+        if (full_x_pert[ivar] > findiff_x_u_[ivar]) {
+          this_perturbation = -this_perturbation;
+          full_x_pert[ivar] = xorig + this_perturbation;
+        }
+        perturbation[ivar] = this_perturbation;
+        perturbed = true;
+      }
+    }
+    if (!perturbed) {
+      return true;
+    }
+
+    bool ok = tnlp_->eval_g(n_full_x_, full_x_pert, true, n_full_g_,
+                            full_g_pert);
+
+    for (const Index* p=first; p<last; p++) {
+      const Index ivar = *p;
+      if (findiff_x_l_[ivar] < findiff_x_u_[ivar]) {
+        if (ok) {
+          for (Index i=findiff_jac_ia_[ivar]; i<findiff_jac_ia_[ivar+1]; i++) {
+            const Index& icon = findiff_jac_ja_[i];
+            const Index& ipos = findiff_jac_postriplet_[i];
+            jac_g_[ipos] =
+              (full_g_pert[icon]-full_g_[icon])/perturbation[ivar];
+          }
+        }
+        full_x_pert[ivar] = full_x_[ivar];
+      }
+    }
+    return ok;
+  }
+
+  bool TNLPAdapter::internal_eval_findiff_jac()
+  {
+    const Index ngroups = (Index)findiff_jac_group_start_.size()-1;
+    // Perturbation of each variable; every entry is written only by
+    // the thread that handles the group of the variable
+    Number* perturbation = new Number[n_full_x_];
+
+#ifdef _OPENMP
+    const Index nthreads = num_findiff_threads(ngroups);
+    if (nthreads > 1) {
+      // An exception must not leave the parallel region, so it is
+      // treated like an evaluation error
+      Index n_failed = 0;
+      #pragma omp parallel num_threads(nthreads) reduction(+:n_failed)
+      {
+        Number* full_g_pert = new Number[n_full_g_];
+        Number* full_x_pert = new Number[n_full_x_];
+        IpBlasDcopy(n_full_x_, full_x_, 1, full_x_pert, 1);
+
+        #pragma omp for schedule(dynamic)
+        for (Index c=0; c<ngroups; c++) {
+          if (n_failed > 0) {
+            continue;
+          }
+          bool ok;
+          try {
+            ok = eval_findiff_jac_group(c, full_x_pert, full_g_pert,
+                                        perturbation);
+          }
+          catch (...) {
+            ok = false;
+          }
+          if (!ok) {
+            n_failed++;
+          }
+        }
+
+        delete [] full_g_pert;
+        delete [] full_x_pert;
+      }
+      delete [] perturbation;
+      return n_failed == 0;
+    }
+#endif
+
+    Number* full_g_pert = new Number[n_full_g_];
+    Number* full_x_pert = new Number[n_full_x_];
+    IpBlasDcopy(n_full_x_, full_x_, 1, full_x_pert, 1);
+    bool retval = true;
+    try {
+      for (Index c=0; c<ngroups && retval; c++) {
+        retval = eval_findiff_jac_group(c, full_x_pert, full_g_pert,
+                                        perturbation);
+      }
+    }
+    catch (...) {
+      delete [] full_g_pert;
+      delete [] full_x_pert;
+      delete [] perturbation;
+      throw;
+    }
+    delete [] full_g_pert;
+    delete [] full_x_pert;
+    delete [] perturbation;
+    return retval;
+  }
+
+  /** Entry of the Hessian structure in the full space, used to find
+   *  repeated entries */
+  class FindiffHessEntry
+  {
+  public:
+    Index row;
+    Index col;
+    Index pos;
+    bool operator<(const FindiffHessEntry& e) const
+    {
+      return row < e.row || (row == e.row && col < e.col);
+    }
+  };
+
+  void TNLPAdapter::initialize_findiff_hess(const Index* iRow,
+      const Index* jCol)
+  {
+    // Unique entries (row <= col) of the structure, 0-based
+    std::vector<FindiffHessEntry> entries(nz_full_h_);
+    for (Index i=0; i<nz_full_h_; i++) {
+      entries[i].row = Min(iRow[i], jCol[i]) - 1;
+      entries[i].col = Max(iRow[i], jCol[i]) - 1;
+      entries[i].pos = i;
+    }
+    std::stable_sort(entries.begin(), entries.end());
+
+    // Adjacency structure of the symmetric matrix (without diagonal)
+    // and the variables that appear in it
+    std::vector<Index> adj_start(n_full_x_+1, 0);
+    std::vector<bool> appears(n_full_x_, false);
+    for (Index k=0; k<nz_full_h_; k++) {
+      const FindiffHessEntry& e = entries[k];
+      appears[e.row] = true;
+      appears[e.col] = true;
+      if (e.row != e.col && (k == 0 || e.row != entries[k-1].row ||
+                             e.col != entries[k-1].col)) {
+        adj_start[e.row+1]++;
+        adj_start[e.col+1]++;
+      }
+    }
+    for (Index ivar=0; ivar<n_full_x_; ivar++) {
+      adj_start[ivar+1] += adj_start[ivar];
+    }
+    std::vector<Index> adj(adj_start[n_full_x_]);
+    std::vector<Index> next(adj_start.begin(), adj_start.end()-1);
+    for (Index k=0; k<nz_full_h_; k++) {
+      const FindiffHessEntry& e = entries[k];
+      if (e.row != e.col && (k == 0 || e.row != entries[k-1].row ||
+                             e.col != entries[k-1].col)) {
+        adj[next[e.row]++] = e.col;
+        adj[next[e.col]++] = e.row;
+      }
+    }
+
+    std::vector<Index> order;
+    order.reserve(n_full_x_);
+    for (Index ivar=0; ivar<n_full_x_; ivar++) {
+      if (appears[ivar]) {
+        order.push_back(ivar);
+      }
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     FindiffColumnLonger(&adj_start[0]));
+
+    // Greedy star coloring (Gebremedhin, Manne and Pothen, 2005): a
+    // distance-1 coloring in which every path on four vertices uses
+    // at least three colors.  A color is forbidden for v if it is
+    // used by a neighbor w, by a neighbor x of an uncolored neighbor
+    // w, or by a neighbor x of a colored neighbor w if x has another
+    // neighbor with the color of w.
+    std::vector<Index> color(n_full_x_, -1);
+    std::vector<Index> forbidden;
+    Index ncolors = 0;
+    for (size_t k=0; k<order.size(); k++) {
+      const Index v = order[k];
+      for (Index p=adj_start[v]; p<adj_start[v+1]; p++) {
+        const Index w = adj[p];
+        if (color[w] >= 0) {
+          forbidden[color[w]] = v;
+        }
+        for (Index q=adj_start[w]; q<adj_start[w+1]; q++) {
+          const Index x = adj[q];
+          if (x == v || color[x] < 0) {
+            continue;
+          }
+          if (color[w] < 0) {
+            forbidden[color[x]] = v;
+          }
+          else {
+            for (Index r=adj_start[x]; r<adj_start[x+1]; r++) {
+              const Index y = adj[r];
+              if (y != w && color[y] == color[w]) {
+                forbidden[color[x]] = v;
+                break;
+              }
+            }
+          }
+        }
+      }
+      Index c;
+      for (c=0; c<ncolors && forbidden[c] == v; c++) {}
+      if (c == ncolors) {
+        ncolors++;
+        forbidden.push_back(-1);
+      }
+      color[v] = c;
+    }
+
+    findiff_hess_group_start_.assign(ncolors+1, 0);
+    for (Index ivar=0; ivar<n_full_x_; ivar++) {
+      if (color[ivar] >= 0) {
+        findiff_hess_group_start_[color[ivar]+1]++;
+      }
+    }
+    for (Index c=0; c<ncolors; c++) {
+      findiff_hess_group_start_[c+1] += findiff_hess_group_start_[c];
+    }
+    findiff_hess_group_var_.resize(findiff_hess_group_start_[ncolors]);
+    next.assign(findiff_hess_group_start_.begin(),
+                findiff_hess_group_start_.end()-1);
+    for (Index ivar=0; ivar<n_full_x_; ivar++) {
+      if (color[ivar] >= 0) {
+        findiff_hess_group_var_[next[color[ivar]]++] = ivar;
+      }
+    }
+
+    // Each entry (i,j) is read directly from the difference of the
+    // gradients for a single group: from row i of the group of j if
+    // j is the only neighbor of i with that color, otherwise from
+    // row j of the group of i (the star coloring guarantees that i
+    // is then the only neighbor of j with its color).  Repeated
+    // entries of the structure are set to zero.
+    std::vector<Index> entry_group(nz_full_h_, -1);
+    std::vector<Index> entry_row(nz_full_h_);
+    std::vector<Index> entry_var(nz_full_h_);
+    findiff_hess_zero_.clear();
+    for (Index k=0; k<nz_full_h_; k++) {
+      const FindiffHessEntry& e = entries[k];
+      if (k > 0 && e.row == entries[k-1].row && e.col == entries[k-1].col) {
+        findiff_hess_zero_.push_back(e.pos);
+        continue;
+      }
+      Index i = e.row;
+      Index j = e.col;
+      if (i != j) {
+        Index count = 0;
+        for (Index p=adj_start[i]; p<adj_start[i+1]; p++) {
+          if (color[adj[p]] == color[j]) {
+            count++;
+          }
+        }
+        if (count > 1) {
+          std::swap(i, j);
+        }
+      }
+      entry_group[e.pos] = color[j];
+      entry_row[e.pos] = i;
+      entry_var[e.pos] = j;
+    }
+
+    findiff_hess_entry_start_.assign(ncolors+1, 0);
+    for (Index k=0; k<nz_full_h_; k++) {
+      if (entry_group[k] >= 0) {
+        findiff_hess_entry_start_[entry_group[k]+1]++;
+      }
+    }
+    for (Index c=0; c<ncolors; c++) {
+      findiff_hess_entry_start_[c+1] += findiff_hess_entry_start_[c];
+    }
+    const Index nentries = findiff_hess_entry_start_[ncolors];
+    findiff_hess_entry_pos_.resize(nentries);
+    findiff_hess_entry_row_.resize(nentries);
+    findiff_hess_entry_var_.resize(nentries);
+    next.assign(findiff_hess_entry_start_.begin(),
+                findiff_hess_entry_start_.end()-1);
+    for (Index k=0; k<nz_full_h_; k++) {
+      if (entry_group[k] >= 0) {
+        const Index p = next[entry_group[k]]++;
+        findiff_hess_entry_pos_[p] = k;
+        findiff_hess_entry_row_[p] = entry_row[k];
+        findiff_hess_entry_var_[p] = entry_var[k];
+      }
+    }
+
+    if (IsValid(jnlst_)) {
+      jnlst_->Printf(J_DETAILED, J_INITIALIZATION,
+                     "Finite difference Hessian uses %d gradient evaluations for %d variables.\n",
+                     ncolors, n_full_x_);
+    }
+  }
+
+  bool TNLPAdapter::internal_eval_grad_lag(const Number* x, bool new_x,
+      Number obj_factor, Number* grad_lag, Number* jac_values)
+  {
+    bool ok = true;
+    if (obj_factor != 0.) {
+      ok = tnlp_->eval_grad_f(n_full_x_, x, new_x, grad_lag);
+      new_x = false;
+      IpBlasDscal(n_full_x_, obj_factor, grad_lag, 1);
+    }
+    else {
+      const Number zero = 0.;
+      IpBlasDcopy(n_full_x_, &zero, 0, grad_lag, 1);
+    }
+    if (ok && nz_full_jac_g_ > 0) {
+      ok = tnlp_->eval_jac_g(n_full_x_, x, new_x, n_full_g_, nz_full_jac_g_,
+                             NULL, NULL, jac_values);
+      if (ok) {
+        for (Index i=0; i<nz_full_jac_g_; i++) {
+          grad_lag[findiff_jac_jcol_[i]] +=
+            full_lambda_[findiff_jac_irow_[i]]*jac_values[i];
+        }
+      }
+    }
+    return ok;
+  }
+
+  bool TNLPAdapter::eval_findiff_h_group(Index c, Number obj_factor,
+      const Number* grad_lag, Number* full_x_pert, Number* grad_lag_pert,
+      Number* jac_values_pert, Number* perturbation, Number* full_h)
+  {
+    const Index* first = &findiff_hess_group_var_[0] +
+                         findiff_hess_group_start_[c];
+    const Index* last = &findiff_hess_group_var_[0] +
+                        findiff_hess_group_start_[c+1];
+    for (const Index* p=first; p<last; p++) {
+      const Index ivar = *p;
+      if (findiff_x_l_[ivar] < findiff_x_u_[ivar]) {
+        const Number xorig = full_x_[ivar];
+        Number this_perturbation =
+          findiff_perturbation_*Max(1., fabs(xorig));
+        if (xorig + this_perturbation > findiff_x_u_[ivar]) {
+          this_perturbation = -this_perturbation;
+        }
+        full_x_pert[ivar] = xorig + this_perturbation;
+        perturbation[ivar] = this_perturbation;
+      }
+      else {
+        // Fixed variables are not perturbed; the entries that
+        // involve them are not used
+        perturbation[ivar] = 0.;
+      }
+    }
+
+    bool ok = internal_eval_grad_lag(full_x_pert, true, obj_factor,
+                                     grad_lag_pert, jac_values_pert);
+
+    if (ok) {
+      for (Index k=findiff_hess_entry_start_[c];
+           k<findiff_hess_entry_start_[c+1]; k++) {
+        const Index irow = findiff_hess_entry_row_[k];
+        const Number h = perturbation[findiff_hess_entry_var_[k]];
+        full_h[findiff_hess_entry_pos_[k]] = (h == 0.) ? 0. :
+                                             (grad_lag_pert[irow]-grad_lag[irow])/h;
+      }
+    }
+    for (const Index* p=first; p<last; p++) {
+      full_x_pert[*p] = full_x_[*p];
+    }
+    return ok;
+  }
+
+  bool TNLPAdapter::internal_eval_findiff_h(Number obj_factor, Number* full_h)
+  {
+    for (size_t i=0; i<findiff_hess_zero_.size(); i++) {
+      full_h[findiff_hess_zero_[i]] = 0.;
+    }
+
+    const Index ngroups = (Index)findiff_hess_group_start_.size()-1;
+    Number* grad_lag = new Number[n_full_x_];
+    Number* jac_values = new Number[nz_full_jac_g_];
+    // The TNLP may have been evaluated at perturbed points since it
+    // has seen full_x_, so the point is always passed as new
+    bool retval;
+    try {
+      retval = internal_eval_grad_lag(full_x_, true, obj_factor, grad_lag,
+                                      jac_values);
+    }
+    catch (...) {
+      delete [] grad_lag;
+      delete [] jac_values;
+      throw;
+    }
+    delete [] jac_values;
+    if (!retval) {
+      delete [] grad_lag;
+      return false;
+    }
+
+    Number* perturbation = new Number[n_full_x_];
+
+#ifdef _OPENMP
+    const Index nthreads = num_findiff_threads(ngroups);
+    if (nthreads > 1) {
+      // An exception must not leave the parallel region, so it is
+      // treated like an evaluation error
+      Index n_failed = 0;
+      #pragma omp parallel num_threads(nthreads) reduction(+:n_failed)
+      {
+        Number* grad_lag_pert = new Number[n_full_x_];
+        Number* jac_values_pert = new Number[nz_full_jac_g_];
+        Number* full_x_pert = new Number[n_full_x_];
+        IpBlasDcopy(n_full_x_, full_x_, 1, full_x_pert, 1);
+
+        #pragma omp for schedule(dynamic)
+        for (Index c=0; c<ngroups; c++) {
+          if (n_failed > 0) {
+            continue;
+          }
+          bool ok;
+          try {
+            ok = eval_findiff_h_group(c, obj_factor, grad_lag, full_x_pert,
+                                      grad_lag_pert, jac_values_pert,
+                                      perturbation, full_h);
+          }
+          catch (...) {
+            ok = false;
+          }
+          if (!ok) {
+            n_failed++;
+          }
+        }
+
+        delete [] grad_lag_pert;
+        delete [] jac_values_pert;
+        delete [] full_x_pert;
+      }
+      delete [] perturbation;
+      delete [] grad_lag;
+      return n_failed == 0;
+    }
+#endif
+
+    Number* grad_lag_pert = new Number[n_full_x_];
+    Number* jac_values_pert = new Number[nz_full_jac_g_];
+    Number* full_x_pert = new Number[n_full_x_];
+    IpBlasDcopy(n_full_x_, full_x_, 1, full_x_pert, 1);
+    try {
+      for (Index c=0; c<ngroups && retval; c++) {
+        retval = eval_findiff_h_group(c, obj_factor, grad_lag, full_x_pert,
+                                      grad_lag_pert, jac_values_pert,
+                                      perturbation, full_h);
+      }
+    }
+    catch (...) {
+      delete [] grad_lag_pert;
+      delete [] jac_values_pert;
+      delete [] full_x_pert;
+      delete [] perturbation;
+      delete [] grad_lag;
+      throw;
+    }
+    delete [] grad_lag_pert;
+    delete [] jac_values_pert;
+    delete [] full_x_pert;
+    delete [] perturbation;
+    delete [] grad_lag;
+    return retval;
+  }
+
+  /** For the part [0,len) of a map from internal to full positions,
+   *  compute the internal position of the first entry of each block,
+   *  given the block starts in the full array.  Returns false if the
+   *  map is not increasing. */
+  static bool ComputeBlockRanges(const Index* map, Index len,
+                                 const std::vector<Index>& full_start,
+                                 std::vector<Index>& start)
+  {
+    for (Index i=1; i<len; i++) {
+      if (map[i] <= map[i-1]) {
+        return false;
+      }
+    }
+    start.resize(full_start.size());
+    for (size_t b=0; b<full_start.size(); b++) {
+      start[b] = (Index)(std::lower_bound(map, map+len, full_start[b]) - map);
+    }
+    return true;
+  }
+
+  /** Check that start has num_blocks+1 nondecreasing entries from 0 to
+   *  total. */
+  static bool CheckBlockStarts(const std::vector<Index>& start, Index total)
+  {
+    if (start.front() != 0 || start.back() != total) {
+      return false;
+    }
+    for (size_t b=1; b<start.size(); b++) {
+      if (start[b] < start[b-1]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void TNLPAdapter::initialize_blocks()
+  {
+    num_blocks_ = tnlp_->get_number_of_blocks();
+    block_g_start_.clear();
+    block_jac_start_.clear();
+    block_h_start_.clear();
+    block_scatter_ = false;
+    if (num_blocks_ <= 0) {
+      num_blocks_ = 0;
+      return;
+    }
+
+    const bool need_h = IsValid(Hess_lagrangian_space_);
+    block_g_start_.resize(num_blocks_+1);
+    block_jac_start_.resize(num_blocks_+1);
+    if (need_h) {
+      block_h_start_.resize(num_blocks_+1);
+    }
+    bool retval =
+      tnlp_->get_block_structure(num_blocks_, &block_g_start_[0],
+                                 &block_jac_start_[0],
+                                 need_h ? &block_h_start_[0] : NULL);
+    ASSERT_EXCEPTION(retval, INVALID_TNLP,
+                     "get_number_of_blocks is positive, but get_block_structure returned false");
+    ASSERT_EXCEPTION(CheckBlockStarts(block_g_start_, n_full_g_) &&
+                     CheckBlockStarts(block_jac_start_, nz_full_jac_g_) &&
+                     (!need_h || CheckBlockStarts(block_h_start_, nz_full_h_)),
+                     INVALID_TNLP,
+                     "The blocks returned by get_block_structure do not cover the constraints and nonzeros in order.");
+
+    // The internal vectors and matrices contain the entries of the
+    // full ones in the original order (with some left out), so each
+    // block is a contiguous range in them as well.
+    block_scatter_ =
+      ComputeBlockRanges(P_c_g_->ExpandedPosIndices(), P_c_g_->NCols(),
+                         block_g_start_, block_c_start_) &&
+      ComputeBlockRanges(P_d_g_->ExpandedPosIndices(), P_d_g_->NCols(),
+                         block_g_start_, block_d_start_) &&
+      ComputeBlockRanges(jac_idx_map_, nz_jac_c_no_extra_,
+                         block_jac_start_, block_jac_c_start_) &&
+      ComputeBlockRanges(jac_idx_map_ + nz_jac_c_no_extra_, nz_jac_d_,
+                         block_jac_start_, block_jac_d_start_);
+    if (block_scatter_ && need_h) {
+      if (h_idx_map_) {
+        block_scatter_ = ComputeBlockRanges(h_idx_map_, nz_h_, block_h_start_,
+                                            block_h_int_start_);
+      }
+      else {
+        block_h_int_start_ = block_h_start_;
+      }
+    }
+
+    if (IsValid(jnlst_)) {
+      jnlst_->Printf(J_DETAILED, J_INITIALIZATION,
+                     "The NLP has %d independent constraint blocks, evaluated with %d thread(s).\n",
+                     num_blocks_, num_block_threads());
+    }
+  }
+
+  Index TNLPAdapter::num_block_threads() const
+  {
+    Index nthreads = 1;
+#ifdef _OPENMP
+    nthreads = block_eval_num_threads_ > 0 ? block_eval_num_threads_ :
+               omp_get_max_threads();
+#endif
+    return Min(nthreads, Max(num_blocks_, 1));
+  }
+
+  bool TNLPAdapter::internal_eval_g_blocks(bool new_x)
+  {
+    Index n_failed = 0;
+#ifdef _OPENMP
+    const Index nthreads = num_block_threads();
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) if(nthreads > 1) reduction(+:n_failed)
+#endif
+    for (Index b=0; b<num_blocks_; b++) {
+      const Index start = block_g_start_[b];
+      bool ok;
+      try {
+        ok = tnlp_->eval_g_block(b, n_full_x_, full_x_, new_x,
+                                 block_g_start_[b+1]-start, full_g_+start);
+      }
+      catch (...) {
+        ok = false;
+      }
+      if (!ok) {
+        n_failed++;
+      }
+    }
+    return n_failed == 0;
+  }
+
+  bool TNLPAdapter::internal_eval_jac_g_blocks(bool new_x)
+  {
+    Index n_failed = 0;
+#ifdef _OPENMP
+    const Index nthreads = num_block_threads();
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) if(nthreads > 1) reduction(+:n_failed)
+#endif
+    for (Index b=0; b<num_blocks_; b++) {
+      const Index start = block_jac_start_[b];
+      bool ok;
+      try {
+        ok = tnlp_->eval_jac_g_block(b, n_full_x_, full_x_, new_x,
+                                     block_jac_start_[b+1]-start,
+                                     jac_g_+start);
+      }
+      catch (...) {
+        ok = false;
+      }
+      if (!ok) {
+        n_failed++;
+      }
+    }
+    return n_failed == 0;
+  }
+
+  bool TNLPAdapter::internal_eval_h_blocks(bool new_x, Number obj_factor,
+      bool new_y, Number* values)
+  {
+    // Without fixed variables, the blocks are evaluated directly into
+    // the Hessian values.  Otherwise each thread copies the entries of
+    // its block right after evaluating it.
+    Number* full_h = h_idx_map_ ? new Number[nz_full_h_] : values;
+
+    Index n_failed = 0;
+#ifdef _OPENMP
+    const Index nthreads = num_block_threads();
+    #pragma omp parallel for schedule(dynamic) num_threads(nthreads) if(nthreads > 1) reduction(+:n_failed)
+#endif
+    for (Index b=0; b<num_blocks_; b++) {
+      const Index start = block_h_start_[b];
+      bool ok;
+      try {
+        ok = tnlp_->eval_h_block(b, n_full_x_, full_x_, new_x, obj_factor,
+                                 n_full_g_, full_lambda_, new_y,
+                                 block_h_start_[b+1]-start, full_h+start);
+      }
+      catch (...) {
+        ok = false;
+      }
+      if (!ok) {
+        n_failed++;
+      }
+      else if (h_idx_map_ && block_scatter_) {
+        for (Index i=block_h_int_start_[b]; i<block_h_int_start_[b+1]; i++) {
+          values[i] = full_h[h_idx_map_[i]];
+        }
+      }
+    }
+
+    if (h_idx_map_) {
+      if (n_failed == 0 && !block_scatter_) {
+        for (Index i=0; i<nz_h_; i++) {
+          values[i] = full_h[h_idx_map_[i]];
+        }
+      }
+      delete [] full_h;
+    }
+    return n_failed == 0;
   }
 
   bool TNLPAdapter::CheckDerivatives(TNLPAdapter::DerivativeTestEnum deriv_test,
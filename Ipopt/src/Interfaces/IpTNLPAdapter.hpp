@@ -13,6 +13,7 @@
 #include "IpTNLP.hpp"
 #include "IpOrigIpoptNLP.hpp"
 #include <list>
+#include <vector>
 
 namespace Ipopt
 {
@@ -194,6 +195,16 @@ namespace Ipopt
       return tnlp_;
     }
 
+    /** Method for checking whether the TNLP still has the structure
+     *  for which the spaces were created the last time: the same
+     *  dimensions and numbers of nonzeros, the same fixed variables,
+     *  the same finite bounds, and the same equality constraints.  If
+     *  this is the case, the problem can be solved again with
+     *  warm_start_same_structure, even if the values of the bounds
+     *  have changed.  Inconsistent bounds (lower above upper) never
+     *  give the same structure. */
+    bool HasSameStructure();
+
     /** @name Methods for translating data for IpoptNLP into the TNLP
      *  data.  These methods are used to obtain the current (or
      *  final) data for the TNLP formulation from the IpoptNLP
@@ -231,6 +242,14 @@ namespace Ipopt
                                        Index n_c, const Index* c_map,
                                        std::list<Index>& c_deps);
 
+    /** Compute for each variable and constraint a code for the kind of
+     *  its bounds (no, lower, upper or both bounds, fixed variable or
+     *  equality constraint, or inconsistent bounds), which determines
+     *  the structure of the spaces. */
+    void ComputeBoundsPattern(const Number* x_l, const Number* x_u,
+                              const Number* g_l, const Number* g_u,
+                              std::vector<char>& pattern) const;
+
     /** Pointer to the TNLP class (class specific to Number* vectors and
      *  harwell triplet matrices) */
     SmartPtr<TNLP> tnlp_;
@@ -281,6 +300,12 @@ namespace Ipopt
     JacobianApproxEnum jacobian_approximation_;
     /** Size of the perturbation for the derivative approximation */
     Number findiff_perturbation_;
+    /** Flag indicating whether structurally orthogonal columns of the
+     *  finite difference Jacobian are perturbed together */
+    bool findiff_jac_coloring_;
+    /** Number of threads for the finite difference groups (0 for the
+     *  OpenMP default) */
+    Index findiff_num_threads_;
     /** Maximal perturbation of the initial point */
     Number point_perturbation_radius_;
     /** Flag indicating if rhs should be considered during dependency
@@ -289,6 +314,9 @@ namespace Ipopt
 
     /** Overall convergence tolerance */
     Number tol_;
+    /** Number of threads for the evaluation of constraint blocks
+     *  (0 for the OpenMP default) */
+    Index block_eval_num_threads_;
     //@}
 
     /**@name Problem Size Data */
@@ -366,11 +394,60 @@ namespace Ipopt
     bool internal_eval_jac_g(bool new_x);
     //@}
 
+    /** @name Internal methods for block-separable problems */
+    //@{
+    /** Obtain the block structure from the TNLP and compute the
+     *  ranges of the blocks in the internal vectors and matrices. */
+    void initialize_blocks();
+    /** Evaluate all constraint blocks into full_g_ */
+    bool internal_eval_g_blocks(bool new_x);
+    /** Evaluate all Jacobian blocks into jac_g_ */
+    bool internal_eval_jac_g_blocks(bool new_x);
+    /** Evaluate all Hessian blocks and scatter them into values */
+    bool internal_eval_h_blocks(bool new_x, Number obj_factor, bool new_y,
+                                Number* values);
+    /** Number of threads used for the blocks */
+    Index num_block_threads() const;
+    //@}
+
     /** @name Internal methods for dealing with finite difference
     approxation */
     //@{
     /** Initialize sparsity structure for finite difference Jacobian */
     void initialize_findiff_jac(const Index* iRow, const Index* jCol);
+    /** Partition the variables into groups of structurally orthogonal
+     *  columns of the Jacobian */
+    void initialize_findiff_jac_groups();
+    /** Compute the finite difference Jacobian at full_x_, given the
+     *  constraint values in full_g_ */
+    bool internal_eval_findiff_jac();
+    /** Perturb the variables of group c of the finite difference
+     *  Jacobian in full_x_pert (equal to full_x_ on entry and on
+     *  return) and store the difference quotients in jac_g_ */
+    bool eval_findiff_jac_group(Index c, Number* full_x_pert,
+                                Number* full_g_pert, Number* perturbation);
+    /** Number of threads used for ngroups finite difference groups */
+    Index num_findiff_threads(Index ngroups) const;
+    /** Partition the variables into groups for the finite difference
+     *  Hessian (star coloring of the Hessian structure, given in the
+     *  full space with Fortran indices) */
+    void initialize_findiff_hess(const Index* iRow, const Index* jCol);
+    /** Compute the finite difference Hessian of the Lagrangian at
+     *  full_x_ and full_lambda_ into full_h (in the full space) */
+    bool internal_eval_findiff_h(Number obj_factor, Number* full_h);
+    /** Perturb the variables of group c of the finite difference
+     *  Hessian in full_x_pert (equal to full_x_ on entry and on
+     *  return) and store the difference quotients of the gradient of
+     *  the Lagrangian (grad_lag at full_x_) in full_h */
+    bool eval_findiff_h_group(Index c, Number obj_factor,
+                              const Number* grad_lag, Number* full_x_pert,
+                              Number* grad_lag_pert, Number* jac_values_pert,
+                              Number* perturbation, Number* full_h);
+    /** Compute the gradient of the Lagrangian at x, using
+     *  jac_values as work space */
+    bool internal_eval_grad_lag(const Number* x, bool new_x,
+                                Number obj_factor, Number* grad_lag,
+                                Number* jac_values);
     //@}
 
     /**@name Internal Permutation Spaces and matrices
@@ -401,6 +478,11 @@ namespace Ipopt
 
     /** Position of fixed variables. This is required for a warm start */
     Index* x_fixed_map_;
+
+    /** Kind of bounds of each variable and constraint for which the
+     *  spaces were created (see ComputeBoundsPattern).  This is used
+     *  to decide if the structure can be reused. */
+    std::vector<char> bounds_pattern_;
     //@}
 
     /** @name Data for finite difference approximations of derivatives */
@@ -419,6 +501,59 @@ namespace Ipopt
     Number* findiff_x_l_;
     /** Copy of the upper bounds */
     Number* findiff_x_u_;
+    /** Start of each group of simultaneously perturbed variables in
+     *  findiff_jac_group_var_ (one more entry than groups) */
+    std::vector<Index> findiff_jac_group_start_;
+    /** Variables ordered by group; variables that do not appear in
+     *  the constraints are omitted */
+    std::vector<Index> findiff_jac_group_var_;
+    /** Structure of the Jacobian (0-based rows and columns), needed
+     *  for the gradient of the Lagrangian */
+    std::vector<Index> findiff_jac_irow_;
+    std::vector<Index> findiff_jac_jcol_;
+    /** Start of each group of simultaneously perturbed variables for
+     *  the Hessian in findiff_hess_group_var_ */
+    std::vector<Index> findiff_hess_group_start_;
+    /** Variables ordered by Hessian group */
+    std::vector<Index> findiff_hess_group_var_;
+    /** Start of the Hessian entries computed from each group in the
+     *  findiff_hess_entry arrays */
+    std::vector<Index> findiff_hess_entry_start_;
+    /** Position of the entry in the full Hessian triplet arrays */
+    std::vector<Index> findiff_hess_entry_pos_;
+    /** Row of the gradient difference from which the entry is taken */
+    std::vector<Index> findiff_hess_entry_row_;
+    /** Variable whose perturbation determines the entry */
+    std::vector<Index> findiff_hess_entry_var_;
+    /** Positions of repeated Hessian entries, which are set to zero */
+    std::vector<Index> findiff_hess_zero_;
+    //@}
+
+    /** @name Data for block-separable problems.  The start arrays
+     *  have num_blocks_+1 entries; the internal ranges are only
+     *  valid if block_scatter_ is true. */
+    //@{
+    /** Number of constraint blocks (0 if the TNLP has none) */
+    Index num_blocks_;
+    /** Start of each block in full_g_ */
+    std::vector<Index> block_g_start_;
+    /** Start of each block in jac_g_ */
+    std::vector<Index> block_jac_start_;
+    /** Start of each block in the full Hessian */
+    std::vector<Index> block_h_start_;
+    /** Flag indicating whether the internal vectors and matrices
+     *  can be filled block by block */
+    bool block_scatter_;
+    /** Start of each block in c (without the fixed variables) */
+    std::vector<Index> block_c_start_;
+    /** Start of each block in d */
+    std::vector<Index> block_d_start_;
+    /** Start of each block in the values of jac_c */
+    std::vector<Index> block_jac_c_start_;
+    /** Start of each block in the values of jac_d */
+    std::vector<Index> block_jac_d_start_;
+    /** Start of each block in the values of the Hessian */
+    std::vector<Index> block_h_int_start_;
     //@}
   };
 
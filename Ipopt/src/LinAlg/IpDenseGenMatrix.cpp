@@ -116,7 +116,17 @@ namespace Ipopt
     DBG_ASSERT(NCols()==V2.NCols());
     DBG_ASSERT(beta==0. || initialized_);
 
-    if (beta==0.) {
+    if (NRows()>0 && NCols()>0 && V1.CanComputeInnerProducts(V2)) {
+      std::vector<Number> products(NRows()*NCols());
+      V1.ComputeInnerProducts(V2, false, &products[0]);
+      for (Index j=0; j<NCols(); j++) {
+        for (Index i=0; i<NRows(); i++) {
+          values_[i+j*NRows()] = alpha*products[i+j*NRows()] +
+                                 (beta!=0. ? beta*values_[i+j*NRows()] : 0.);
+        }
+      }
+    }
+    else if (beta==0.) {
       for (Index j=0; j<NCols(); j++) {
         for (Index i=0; i<NRows(); i++) {
           values_[i+j*NRows()] = alpha*V1.GetVector(i)->Dot(*V2.GetVector(j));
@@ -118,7 +118,17 @@ namespace Ipopt
     DBG_ASSERT(beta==0. || initialized_);
 
     const Index dim = Dim();
-    if (beta==0.) {
+    if (dim>0 && V1.CanComputeInnerProducts(V2)) {
+      std::vector<Number> products(dim*dim);
+      V1.ComputeInnerProducts(V2, true, &products[0]);
+      for (Index j=0; j<dim; j++) {
+        for (Index i=j; i<dim; i++) {
+          values_[i+j*dim] = alpha*products[i+j*dim] +
+                             (beta!=0. ? beta*values_[i+j*dim] : 0.);
+        }
+      }
+    }
+    else if (beta==0.) {
       for (Index j=0; j<dim; j++) {
         for (Index i=j; i<dim; i++) {
           values_[i+j*dim] = alpha*V1.GetVector(i)->Dot(*V2.GetVector(j));
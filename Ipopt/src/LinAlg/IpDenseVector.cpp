@@ -8,6 +8,7 @@
 
 #include "IpDenseVector.hpp"
 #include "IpBlas.hpp"
+#include "IpVectorKernels.hpp"
 #include "IpUtils.hpp"
 #include "IpDebug.hpp"
 
@@ -257,9 +258,7 @@ namespace Ipopt
         }
       }
       else {
-        for (Index i=0; i<Dim(); i++) {
-          values_[i] /= values_x[i];
-        }
+        IpKernelElementWiseDivide(Dim(), values_, values_x);
       }
     }
   }
@@ -294,9 +293,7 @@ namespace Ipopt
         }
       }
       else {
-        for (Index i=0; i<Dim(); i++) {
-          values_[i] *= values_x[i];
-        }
+        IpKernelElementWiseMultiply(Dim(), values_, values_x);
       }
     }
   }
@@ -578,349 +575,7 @@ namespace Ipopt
       return;
     }
 
-    // I guess I'm going over board here, but it might be best to
-    // capture all cases for a, b, and c separately...
-    if (c==0 ) {
-      if (a==1.) {
-        if (b==0.) {
-          IpBlasDcopy(Dim(), values_v1, 1, values_, 1);
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = values_v1[i] + values_v2[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = values_v1[i] - values_v2[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = values_v1[i] + b*values_v2[i];
-          }
-        }
-      }
-      else if (a==-1.) {
-        if (b==0.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v1[i];
-          }
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v1[i] + values_v2[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v1[i] - values_v2[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v1[i] + b*values_v2[i];
-          }
-        }
-      }
-      else if (a==0.) {
-        if (b==0.) {
-          Number zero = 0.;
-          IpBlasDcopy(Dim(), &zero, 0, values_, 1);
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            IpBlasDcopy(Dim(), values_v2, 1, values_, 1);
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v2[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = b*values_v2[i];
-          }
-        }
-      }
-      else {
-        if (b==0.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = a*values_v1[i];
-          }
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = a*values_v1[i] + values_v2[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = a*values_v1[i] - values_v2[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = a*values_v1[i] + b*values_v2[i];
-          }
-        }
-      }
-    }
-    else if (c==1.) {
-      if (a==1.) {
-        if (b==0.) {
-          IpBlasDaxpy(Dim(), 1., values_v1, 1, values_, 1);
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] += values_v1[i] + values_v2[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] += values_v1[i] - values_v2[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] += values_v1[i] + b*values_v2[i];
-          }
-        }
-      }
-      else if (a==-1.) {
-        if (b==0.) {
-          IpBlasDaxpy(Dim(), -1., values_v1, 1, values_, 1);
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] += -values_v1[i] + values_v2[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] += -values_v1[i] - values_v2[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] += -values_v1[i] + b*values_v2[i];
-          }
-        }
-      }
-      else if (a==0.) {
-        if (b==0.) {
-          /* Nothing */
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            IpBlasDaxpy(Dim(), 1., values_v2, 1, values_, 1);
-          }
-        }
-        else if (b==-1.) {
-          IpBlasDaxpy(Dim(), -1., values_v2, 1, values_, 1);
-        }
-        else {
-          IpBlasDaxpy(Dim(), b, values_v2, 1, values_, 1);
-        }
-      }
-      else {
-        if (b==0.) {
-          IpBlasDaxpy(Dim(), a, values_v1, 1, values_, 1);
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] += a*values_v1[i] + values_v2[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] += a*values_v1[i] - values_v2[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] += a*values_v1[i] + b*values_v2[i];
-          }
-        }
-      }
-    }
-    else if (c==-1.) {
-      if (a==1.) {
-        if (b==0.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = values_v1[i] - values_[i];
-          }
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = values_v1[i] + values_v2[i] - values_[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = values_v1[i] - values_v2[i] - values_[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = values_v1[i] + b*values_v2[i] - values_[i];
-          }
-        }
-      }
-      else if (a==-1.) {
-        if (b==0.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v1[i] - values_[i];
-          }
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v1[i] + values_v2[i] - values_[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v1[i] - values_v2[i] - values_[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v1[i] + b*values_v2[i] - values_[i];
-          }
-        }
-      }
-      else if (a==0.) {
-        if (b==0.) {
-          IpBlasDscal(Dim(), -1., values_, 1);
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = values_v2[i] - values_[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v2[i] - values_[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = b*values_v2[i] - values_[i];
-          }
-        }
-      }
-      else {
-        if (b==0.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = a*values_v1[i] - values_[i];
-          }
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = a*values_v1[i] + values_v2[i] - values_[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = a*values_v1[i] - values_v2[i] - values_[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = a*values_v1[i] + b*values_v2[i] - values_[i];
-          }
-        }
-      }
-    }
-    else {
-      if (a==1.) {
-        if (b==0.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = values_v1[i] + c*values_[i];
-          }
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = values_v1[i] + values_v2[i] + c*values_[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = values_v1[i] - values_v2[i] + c*values_[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = values_v1[i] + b*values_v2[i] + c*values_[i];
-          }
-        }
-      }
-      else if (a==-1.) {
-        if (b==0.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v1[i] + c*values_[i];
-          }
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v1[i] + values_v2[i] + c*values_[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v1[i] - values_v2[i] + c*values_[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v1[i] + b*values_v2[i] + c*values_[i];
-          }
-        }
-      }
-      else if (a==0.) {
-        if (b==0.) {
-          IpBlasDscal(Dim(), c, values_, 1);
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = values_v2[i] + c*values_[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = -values_v2[i] + c*values_[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = b*values_v2[i] + c*values_[i];
-          }
-        }
-      }
-      else {
-        if (b==0.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = a*values_v1[i] + c*values_[i];
-          }
-        }
-        else if (b==1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = a*values_v1[i] + values_v2[i] + c*values_[i];
-          }
-        }
-        else if (b==-1.) {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = a*values_v1[i] - values_v2[i] + c*values_[i];
-          }
-        }
-        else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = a*values_v1[i] + b*values_v2[i] + c*values_[i];
-          }
-        }
-      }
-    }
+    IpKernelAddTwoVectors(Dim(), a, values_v1, b, values_v2, c, values_);
     initialized_=true;
   }
 
@@ -958,11 +613,7 @@ namespace Ipopt
         }
       }
       else {
-        for (Index i=0; i<Dim(); i++) {
-          if (values_delta[i]<0.) {
-            alpha = Ipopt::Min(alpha, -tau/values_delta[i] * values_x[i]);
-          }
-        }
+        alpha = IpKernelFracToBound(Dim(), tau, values_x, values_delta);
       }
     }
 
@@ -1024,9 +675,7 @@ namespace Ipopt
         }
       }
       else {
-        for (Index i=0; i<Dim(); i++) {
-          values_[i] = a * values_z[i] / values_s[i];
-        }
+        IpKernelAddVectorQuotient(Dim(), a, values_z, values_s, 0., values_);
       }
     }
     else if (homogeneous_) {
@@ -1070,9 +719,7 @@ namespace Ipopt
           }
         }
         else {
-          for (Index i=0; i<Dim(); i++) {
-            values_[i] = c*values_[i] + a * values_z[i]/values_s[i];
-          }
+          IpKernelAddVectorQuotient(Dim(), a, values_z, values_s, c, values_);
         }
       }
     }
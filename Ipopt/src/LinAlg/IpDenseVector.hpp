@@ -11,6 +11,7 @@
 
 #include "IpUtils.hpp"
 #include "IpVector.hpp"
+#include "IpNumberArrayPool.hpp"
 #include <map>
 
 namespace Ipopt
@@ -292,7 +293,8 @@ namespace Ipopt
      */
     DenseVectorSpace(Index dim)
         :
-        VectorSpace(dim)
+        VectorSpace(dim),
+        pool_(dim)
     {}
 
     /** Destructor */
@@ -327,6 +329,15 @@ namespace Ipopt
     /** Deallocate internal storage for the DenseVector */
     inline
     void FreeInternalStorage(Number* values) const;
+
+    /** Pool from which the internal storage is taken.  The storage of
+     *  deleted vectors is kept there for the next vectors of this
+     *  space; the statistics of the pool show how often this
+     *  happens. */
+    const NumberArrayPool& StoragePool() const
+    {
+      return pool_;
+    }
     //@}
 
     /**@name Methods for dealing with meta data on the vector
@@ -382,6 +393,9 @@ namespace Ipopt
     //@}
 
   private:
+    /** Free list for the internal storage of the vectors */
+    mutable NumberArrayPool pool_;
+
     // variables to store vector meta data
     StringMetaDataMapType string_meta_data_;
     IntegerMetaDataMapType integer_meta_data_;
@@ -424,18 +438,13 @@ namespace Ipopt
   inline
   Number* DenseVectorSpace::AllocateInternalStorage() const
   {
-    if (Dim()>0) {
-      return new Number[Dim()];
-    }
-    else {
-      return NULL;
-    }
+    return pool_.Allocate();
   }
 
   inline
   void DenseVectorSpace::FreeInternalStorage(Number* values) const
   {
-    delete [] values;
+    pool_.Free(values);
   }
 
   inline
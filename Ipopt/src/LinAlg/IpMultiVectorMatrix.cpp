@@ -9,6 +9,7 @@
 #include "IpMultiVectorMatrix.hpp"
 #include "IpDenseVector.hpp"
 #include "IpDenseGenMatrix.hpp"
+#include "IpBlas.hpp"
 
 #ifdef HAVE_CSTDIO
 # include <cstdio>
@@ -20,6 +21,10 @@
 # endif
 #endif
 
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
 namespace Ipopt
 {
 
@@ -27,6 +32,183 @@ namespace Ipopt
   static const Index dbg_verbosity = 0;
 #endif
 
+  /** Maximal number of row ranges whose partial inner products are
+   *  summed up separately */
+  static const Index max_chunks = 64;
+
+  /** Smallest number of entries (rows times columns) for which the
+   *  blocked operations are used.  Smaller matrices fit into the cache
+   *  anyway, and the operations on the individual vectors can reuse
+   *  cached dot products. */
+  static const Index min_blocked_size = 32768;
+
+  /** Smallest number of entries (rows times columns) for which the
+   *  blocked operations are distributed over threads */
+  static const Index min_parallel_size = 100000;
+
+  /** Number of rows in one block of an operation involving ncols
+   *  columns, chosen so that the block fits into the cache (256 KB) */
+  static Index BlockRows(Index ncols)
+  {
+    return Max(Index(256), Index(32768/Max(ncols, Index(1))));
+  }
+
+#ifdef _OPENMP
+  /** Number of threads for an operation on nrows rows of ncols
+   *  columns, split into nparts independent parts, if num_threads
+   *  threads are requested (0 for the OpenMP default) */
+  static Index NumThreadsFor(Index nrows, Index ncols, Index nparts,
+                             Index num_threads)
+  {
+    Index nthreads = 1;
+    if ((double)nrows*(double)ncols >= (double)min_parallel_size) {
+      nthreads = num_threads > 0 ? num_threads : omp_get_max_threads();
+    }
+    return Max(Index(1), Min(nthreads, nparts));
+  }
+#endif
+
+  /** Compute products[i+j*k1] = cols1[i]^T cols2[j] (only for i>=j if
+   *  lower_only) for vectors of length n.  The rows are split into a
+   *  fixed number of ranges (independent of the number of threads);
+   *  within each range, the products are accumulated block by block,
+   *  and at the end the partial results of the ranges are added in
+   *  order.  This way, the result does not depend on the number of
+   *  threads (num_threads, see MultiVectorMatrixSpace). */
+  static void BlockedInnerProducts(Index n,
+                                   const std::vector<const Number*>& cols1,
+                                   const std::vector<const Number*>& cols2,
+                                   bool lower_only, Number* products,
+                                   Index num_threads)
+  {
+    const Index k1 = (Index)cols1.size();
+    const Index k2 = (Index)cols2.size();
+    const Index nprod = k1*k2;
+    const Index brows = BlockRows(k1+k2);
+    const Index nblocks = Max(Index(1), (n+brows-1)/brows);
+    const Index nchunks = Min(nblocks, max_chunks);
+    std::vector<Number> partial(nchunks*nprod, 0.);
+
+#ifdef _OPENMP
+    const Index nthreads = NumThreadsFor(n, k1+k2, nchunks, num_threads);
+    #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+    for (Index c=0; c<nchunks; c++) {
+      Number* part = &partial[c*nprod];
+      const Index bend = ((c+1)*nblocks)/nchunks;
+      for (Index b=(c*nblocks)/nchunks; b<bend; b++) {
+        const Index start = b*brows;
+        const Index len = Min(brows, n-start);
+        for (Index j=0; j<k2; j++) {
+          for (Index i=(lower_only ? j : 0); i<k1; i++) {
+            part[i+j*k1] += IpBlasDdot(len, cols1[i]+start, 1,
+                                       cols2[j]+start, 1);
+          }
+        }
+      }
+    }
+
+    for (Index p=0; p<nprod; p++) {
+      products[p] = partial[p];
+    }
+    for (Index c=1; c<nchunks; c++) {
+      const Number* part = &partial[c*nprod];
+      for (Index p=0; p<nprod; p++) {
+        products[p] += part[p];
+      }
+    }
+  }
+
+  /** Compute ys[j] = beta*ys[j] + sum_i alpha*coeffs[i+j*k]*cols[i] for
+   *  all output vectors ys[j] of length n, where k is the number of
+   *  columns in cols.  The old values of ys are not accessed if beta
+   *  is zero.  The operations on each element are the same as for a
+   *  sequence of AddOneVector calls, but all vectors are processed
+   *  block by block, and the blocks are distributed over num_threads
+   *  threads. */
+  static void BlockedLinearCombinations(Index n,
+                                        const std::vector<const Number*>& cols,
+                                        Number alpha, const Number* coeffs,
+                                        Number beta,
+                                        const std::vector<Number*>& ys,
+                                        Index num_threads)
+  {
+    const Index k = (Index)cols.size();
+    const Index ny = (Index)ys.size();
+    const Index brows = BlockRows(k+ny);
+    const Index nblocks = (n+brows-1)/brows;
+
+#ifdef _OPENMP
+    const Index nthreads = NumThreadsFor(n, k+ny, nblocks, num_threads);
+    #pragma omp parallel for schedule(static) num_threads(nthreads) if(nthreads > 1)
+#endif
+    for (Index b=0; b<nblocks; b++) {
+      const Index start = b*brows;
+      const Index len = Min(brows, n-start);
+      for (Index j=0; j<ny; j++) {
+        Number* y = ys[j]+start;
+        if (beta==0.) {
+          for (Index r=0; r<len; r++) {
+            y[r] = 0.;
+          }
+        }
+        else if (beta!=1.) {
+          IpBlasDscal(len, beta, y, 1);
+        }
+        for (Index i=0; i<k; i++) {
+          IpBlasDaxpy(len, alpha*coeffs[i+j*k], cols[i]+start, 1, y, 1);
+        }
+      }
+    }
+  }
+
+  bool MultiVectorMatrix::HasDenseColumns() const
+  {
+    if ((double)NRows()*(double)NCols() < (double)min_blocked_size) {
+      return false;
+    }
+    for (Index i=0; i<NCols(); i++) {
+      if (!dynamic_cast<const DenseVector*>(ConstVec(i))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool MultiVectorMatrix::GetDenseColumns(std::vector<const Number*>& cols) const
+  {
+    if (!HasDenseColumns()) {
+      return false;
+    }
+    cols.resize(NCols());
+    for (Index i=0; i<NCols(); i++) {
+      cols[i] = static_cast<const DenseVector*>(ConstVec(i))->ExpandedValues();
+    }
+    return true;
+  }
+
+  bool MultiVectorMatrix::CanComputeInnerProducts(const MultiVectorMatrix& V2) const
+  {
+    return HasDenseColumns() && V2.HasDenseColumns();
+  }
+
+  bool MultiVectorMatrix::ComputeInnerProducts(const MultiVectorMatrix& V2,
+      bool lower_only,
+      Number* products) const
+  {
+    DBG_ASSERT(NRows()==V2.NRows());
+    DBG_ASSERT(!lower_only || NCols()==V2.NCols());
+
+    std::vector<const Number*> cols1;
+    std::vector<const Number*> cols2;
+    if (!GetDenseColumns(cols1) || !V2.GetDenseColumns(cols2)) {
+      return false;
+    }
+    BlockedInnerProducts(NRows(), cols1, cols2, lower_only, products,
+                         owner_space_->NumThreads());
+    return true;
+  }
+
   MultiVectorMatrix::MultiVectorMatrix(const MultiVectorMatrixSpace* owner_space)
       :
       Matrix(owner_space),
@@ -58,6 +240,21 @@ namespace Ipopt
     DBG_ASSERT(NCols()==x.Dim());
     DBG_ASSERT(NRows()==y.Dim());
 
+    // See if we can understand the data
+    const DenseVector* dense_x = static_cast<const DenseVector*>(&x);
+    DBG_ASSERT(dynamic_cast<const DenseVector*>(&x));
+
+    // If all vectors are dense, add the columns block by block
+    std::vector<const Number*> cols;
+    DenseVector* dense_y = dynamic_cast<DenseVector*>(&y);
+    if (dense_y && GetDenseColumns(cols)) {
+      std::vector<Number*> ys(1, dense_y->Values());
+      BlockedLinearCombinations(NRows(), cols, alpha,
+                                dense_x->ExpandedValues(), beta, ys,
+                                owner_space_->NumThreads());
+      return;
+    }
+
     // Take care of the y part of the addition
     if ( beta!=0.0 ) {
       y.Scal(beta);
@@ -66,10 +263,6 @@ namespace Ipopt
       y.Set(0.0);  // In case y hasn't been initialized yet
     }
 
-    // See if we can understand the data
-    const DenseVector* dense_x = static_cast<const DenseVector*>(&x);
-    DBG_ASSERT(dynamic_cast<const DenseVector*>(&x));
-
     // We simply add all the Vectors one after the other
     if (dense_x->IsHomogeneous()) {
       Number val = dense_x->Scalar();
@@ -96,9 +289,24 @@ namespace Ipopt
     DenseVector* dense_y = static_cast<DenseVector*>(&y);
     DBG_ASSERT(dynamic_cast<DenseVector*>(&y));
 
+    Number *yvals=dense_y->Values();
+
+    // If all vectors are dense, compute the dot products in one pass
+    std::vector<const Number*> cols;
+    const DenseVector* dense_x = dynamic_cast<const DenseVector*>(&x);
+    if (dense_x && GetDenseColumns(cols)) {
+      std::vector<const Number*> xs(1, dense_x->ExpandedValues());
+      std::vector<Number> dots(NCols());
+      BlockedInnerProducts(NRows(), cols, xs, false, &dots[0],
+                           owner_space_->NumThreads());
+      for (Index i=0; i<NCols(); i++) {
+        yvals[i] = alpha*dots[i] + (beta!=0.0 ? beta*yvals[i] : 0.);
+      }
+      return;
+    }
+
     // Use the individual dot products to get the matrix (transpose)
     // vector product
-    Number *yvals=dense_y->Values();
     if ( beta!=0.0 ) {
       for (Index i=0; i<NCols(); i++) {
         yvals[i] = alpha*ConstVec(i)->Dot(x) + beta*yvals[i];
@@ -123,6 +331,23 @@ namespace Ipopt
     DBG_PRINT((1, "alpha = %e beta = %e\n", alpha, beta));
     DBG_PRINT_VECTOR(2, "x", x);
 
+    // If all vectors are dense, compute V^T*x in one pass and then add
+    // the columns block by block
+    std::vector<const Number*> cols;
+    const DenseVector* dense_x = dynamic_cast<const DenseVector*>(&x);
+    DenseVector* dense_y = dynamic_cast<DenseVector*>(&y);
+    if (dense_x && dense_y && GetDenseColumns(cols)) {
+      std::vector<const Number*> xs(1, dense_x->ExpandedValues());
+      std::vector<Number> dots(NCols());
+      BlockedInnerProducts(NRows(), cols, xs, false, &dots[0],
+                           owner_space_->NumThreads());
+      std::vector<Number*> ys(1, dense_y->Values());
+      BlockedLinearCombinations(NRows(), cols, alpha, &dots[0], beta, ys,
+                                owner_space_->NumThreads());
+      DBG_PRINT_VECTOR(2, "y", y);
+      return;
+    }
+
     if ( beta!=0.0 ) {
       y.Scal(beta);
     }
@@ -216,14 +441,35 @@ namespace Ipopt
       FillWithNewVectors();
     }
 
-    // ToDo: For now, we simply use MatrixVector multiplications, but
-    // we might be more efficient (at least in the non-parallel case)
-    // if we used Level 3 Blas
+    const DenseGenMatrix* dgm_C = static_cast<const DenseGenMatrix*>(&C);
+    DBG_ASSERT(dynamic_cast<const DenseGenMatrix*>(&C));
+
+    // If all vectors are dense, compute all new columns in one pass
+    // over blocks of rows
+    std::vector<const Number*> ucols;
+    if (U.GetDenseColumns(ucols)) {
+      std::vector<Number*> ys(NCols());
+      bool all_dense = true;
+      for (Index i=0; i<NCols() && all_dense; i++) {
+        DenseVector* dvec = dynamic_cast<DenseVector*>(Vec(i));
+        if (dvec) {
+          ys[i] = dvec->Values();
+        }
+        else {
+          all_dense = false;
+        }
+      }
+      if (all_dense) {
+        BlockedLinearCombinations(NRows(), ucols, a, dgm_C->Values(), b, ys,
+                                  owner_space_->NumThreads());
+        ObjectChanged();
+        return;
+      }
+    }
+
     SmartPtr<const DenseVectorSpace> mydspace = new DenseVectorSpace(C.NRows());
     SmartPtr<DenseVector> mydvec = mydspace->MakeNewDenseVector();
 
-    const DenseGenMatrix* dgm_C = static_cast<const DenseGenMatrix*>(&C);
-    DBG_ASSERT(dynamic_cast<const DenseGenMatrix*>(&C));
     for (Index i=0; i<NCols(); i++) {
       const Number* CValues = dgm_C->Values();
       Number* myvalues = mydvec->Values();
@@ -289,10 +535,12 @@ namespace Ipopt
   }
 
   MultiVectorMatrixSpace::MultiVectorMatrixSpace(Index ncols,
-      const VectorSpace& vec_space)
+      const VectorSpace& vec_space,
+      Index num_threads)
       :
       MatrixSpace(vec_space.Dim(), ncols),
-      vec_space_(&vec_space)
+      vec_space_(&vec_space),
+      num_threads_(Max(Index(0), num_threads))
   {}
 
 } // namespace Ipopt
@@ -97,6 +97,21 @@ namespace Ipopt
     void LRMultVector(Number alpha, const Vector &x,
                       Number beta, Vector &y) const;
 
+    /** Compute the inner products of the columns of this matrix with
+     *  the columns of V2, i.e., products[i+j*NCols()] is the product
+     *  of column i of this matrix and column j of V2.  If lower_only
+     *  is true, only the products with i>=j are computed.  This is
+     *  done in one blocked pass over all columns if all columns are
+     *  DenseVectors and the matrices do not fit into the cache;
+     *  otherwise, false is returned and products is not changed. */
+    bool ComputeInnerProducts(const MultiVectorMatrix& V2, bool lower_only,
+                              Number* products) const;
+
+    /** Return true if ComputeInnerProducts would use the blocked pass
+     *  for V2, so that callers only allocate the products if they are
+     *  computed. */
+    bool CanComputeInnerProducts(const MultiVectorMatrix& V2) const;
+
     /** Vector space for the columns */
     SmartPtr<const VectorSpace> ColVectorSpace() const;
 
@@ -156,6 +171,14 @@ namespace Ipopt
     /** space for storing the non-const Vector's */
     std::vector<SmartPtr<Vector> > non_const_vecs_;
 
+    /** Get the arrays of all columns for the blocked operations.
+     *  Returns false if a column is not a DenseVector, or if the
+     *  matrix is too small for the blocked operations. */
+    bool GetDenseColumns(std::vector<const Number*>& cols) const;
+
+    /** Return true if GetDenseColumns would succeed */
+    bool HasDenseColumns() const;
+
     /** Method for accessing the internal Vectors internally */
     //@{
     inline const Vector* ConstVec(Index i) const
@@ -188,9 +211,16 @@ namespace Ipopt
     //@{
     /** Constructor, given the number of columns (i.e., Vectors to be
      *  stored) and given the VectorSpace for the Vectors.
+     *
+     *  If the columns are DenseVectors, the products of the matrices
+     *  with vectors and other MultiVectorMatrices are computed in one
+     *  pass over blocks of rows, and with OpenMP the blocks are
+     *  distributed over num_threads threads (0 means the OpenMP
+     *  default).  The results do not depend on the number of threads.
      */
     MultiVectorMatrixSpace(Index ncols,
-                           const VectorSpace& vec_space);
+                           const VectorSpace& vec_space,
+                           Index num_threads = 0);
 
     /** Destructor */
     ~MultiVectorMatrixSpace()
@@ -216,9 +246,18 @@ namespace Ipopt
       return vec_space_;
     }
 
+    /** Number of threads for the blocked operations */
+    Index NumThreads() const
+    {
+      return num_threads_;
+    }
+
   private:
     SmartPtr<const VectorSpace> vec_space_;
 
+    /** Number of threads for the blocked operations */
+    Index num_threads_;
+
   };
 
   inline
@@ -0,0 +1,81 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#include "IpNumberArrayPool.hpp"
+
+#ifdef HAVE_CSTDDEF
+# include <cstddef>
+#else
+# ifdef HAVE_STDDEF_H
+#  include <stddef.h>
+# else
+#  error "don't have header file for stddef"
+# endif
+#endif
+
+namespace Ipopt
+{
+  /** Number of Numbers (about 4 MB) up to which the free list may
+   *  grow. */
+  static const Index pool_numbers = 1 << 19;
+  /** Maximal number of arrays in a free list. */
+  static const Index pool_max_free = 32;
+
+  NumberArrayPool::NumberArrayPool(Index size)
+      :
+      size_(size),
+      max_free_(0),
+      n_requests_(0.),
+      n_reused_(0.)
+  {
+    if (size_ > 0) {
+      max_free_ = Max(2, Min(pool_max_free, pool_numbers/size_));
+    }
+  }
+
+  NumberArrayPool::~NumberArrayPool()
+  {
+    Clear();
+  }
+
+  Number* NumberArrayPool::Allocate()
+  {
+    if (size_ == 0) {
+      return NULL;
+    }
+    n_requests_++;
+    if (!free_.empty()) {
+      n_reused_++;
+      Number* values = free_.back();
+      free_.pop_back();
+      return values;
+    }
+    return new Number[size_];
+  }
+
+  void NumberArrayPool::Free(Number* values)
+  {
+    if (values == NULL) {
+      return;
+    }
+    if ((Index)free_.size() < max_free_) {
+      free_.push_back(values);
+    }
+    else {
+      delete [] values;
+    }
+  }
+
+  void NumberArrayPool::Clear()
+  {
+    for (std::vector<Number*>::iterator it = free_.begin();
+         it != free_.end(); it++) {
+      delete [] *it;
+    }
+    free_.clear();
+  }
+
+} // namespace Ipopt
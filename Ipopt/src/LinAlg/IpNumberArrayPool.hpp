@@ -0,0 +1,106 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifndef __IPNUMBERARRAYPOOL_HPP__
+#define __IPNUMBERARRAYPOOL_HPP__
+
+#include "IpUtils.hpp"
+#include <vector>
+
+namespace Ipopt
+{
+
+  /** Free list of Number arrays of one fixed length.  The vector and
+   *  matrix spaces use this to recycle the value arrays of the
+   *  vectors and matrices they create: the storage of an object that
+   *  is destroyed is kept in the pool and handed out to the next
+   *  object of the same space, instead of going back to the system
+   *  allocator.  At most MaxFree() arrays are kept; this number is
+   *  chosen so that the pool does not hold more than a few MB unless
+   *  the arrays themselves are larger.
+   *
+   *  The pool is not thread-safe; like the spaces that own it, it is
+   *  only meant to be used by one thread at a time.
+   */
+  class NumberArrayPool
+  {
+  public:
+    /** @name Constructors/Destructors */
+    //@{
+    /** Constructor for arrays of length size. */
+    NumberArrayPool(Index size);
+
+    /** Destructor.  Deletes all arrays in the free list. */
+    ~NumberArrayPool();
+    //@}
+
+    /** Get an array, from the free list if possible.  Returns NULL if
+     *  the length is zero. */
+    Number* Allocate();
+
+    /** Give an array obtained from Allocate back to the pool. */
+    void Free(Number* values);
+
+    /** Delete all arrays currently in the free list. */
+    void Clear();
+
+    /** @name Statistics */
+    //@{
+    /** Number of calls to Allocate (for non-empty arrays). */
+    double NumberOfRequests() const
+    {
+      return n_requests_;
+    }
+    /** Number of calls to Allocate that were served from the free
+     *  list. */
+    double NumberOfReused() const
+    {
+      return n_reused_;
+    }
+    /** Fraction of the requests served from the free list. */
+    Number HitRate() const
+    {
+      return n_requests_ > 0. ? n_reused_/n_requests_ : 0.;
+    }
+    /** Maximal number of arrays kept in the free list. */
+    Index MaxFree() const
+    {
+      return max_free_;
+    }
+    //@}
+
+  private:
+    /**@name Default Compiler Generated Methods
+     * (Hidden to avoid implicit creation/calling).
+     * These methods are not implemented and
+     * we do not want the compiler to implement
+     * them for us, so we declare them private
+     * and do not define them. This ensures that
+     * they will not be implicitly created/called. */
+    //@{
+    /** Default Constructor */
+    NumberArrayPool();
+    /** Copy Constructor */
+    NumberArrayPool(const NumberArrayPool&);
+    /** Overloaded Equals Operator */
+    void operator=(const NumberArrayPool&);
+    //@}
+
+    /** Length of the arrays */
+    const Index size_;
+    /** Maximal number of arrays in the free list */
+    Index max_free_;
+    /** Arrays that can be reused */
+    std::vector<Number*> free_;
+    /** Number of requests (double to avoid overflow in long runs) */
+    double n_requests_;
+    /** Number of requests served from the free list */
+    double n_reused_;
+  };
+
+} // namespace Ipopt
+
+#endif
@@ -0,0 +1,398 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#include "IpVectorKernels.hpp"
+
+#ifdef IPOPT_HAS_SIMD_KERNELS
+# include <immintrin.h>
+#endif
+
+namespace Ipopt
+{
+  /** Level selected for the kernels, -1 if not yet determined */
+  static int kernel_level = -1;
+
+  VectorKernelLevel IpVectorKernelMaxLevel()
+  {
+#ifdef IPOPT_HAS_SIMD_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return KERNEL_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return KERNEL_AVX2;
+    }
+#endif
+    return KERNEL_SCALAR;
+  }
+
+  VectorKernelLevel IpVectorKernelLevel()
+  {
+    if (kernel_level < 0) {
+      kernel_level = IpVectorKernelMaxLevel();
+    }
+    return (VectorKernelLevel)kernel_level;
+  }
+
+  VectorKernelLevel IpSetVectorKernelLevel(VectorKernelLevel level)
+  {
+    kernel_level = Min((int)level, (int)IpVectorKernelMaxLevel());
+    return (VectorKernelLevel)kernel_level;
+  }
+
+  /////////////////////////////////////////////////////////////////////
+  //                         Plain loops                             //
+  /////////////////////////////////////////////////////////////////////
+
+  template <bool UA, bool UB, bool UC>
+  static void AddTwoVectorsScalar(Index n, Number a, const Number* x,
+                                  Number b, const Number* y,
+                                  Number c, Number* z)
+  {
+    for (Index i=0; i<n; i++) {
+      Number r = 0.;
+      if (UA) {
+        r = a*x[i];
+      }
+      if (UB) {
+        r = UA ? r + b*y[i] : b*y[i];
+      }
+      if (UC) {
+        r = (UA || UB) ? r + c*z[i] : c*z[i];
+      }
+      z[i] = r;
+    }
+  }
+
+  static void ElementWiseMultiplyScalar(Index n, Number* x, const Number* y)
+  {
+    for (Index i=0; i<n; i++) {
+      x[i] *= y[i];
+    }
+  }
+
+  static void ElementWiseDivideScalar(Index n, Number* x, const Number* y)
+  {
+    for (Index i=0; i<n; i++) {
+      x[i] /= y[i];
+    }
+  }
+
+  static Number FracToBoundScalar(Index n, Number tau, const Number* x,
+                                  const Number* delta)
+  {
+    Number alpha = 1.;
+    for (Index i=0; i<n; i++) {
+      if (delta[i]<0.) {
+        alpha = Min(alpha, -tau/delta[i] * x[i]);
+      }
+    }
+    return alpha;
+  }
+
+  template <bool UC>
+  static void AddVectorQuotientScalar(Index n, Number a, const Number* z,
+                                      const Number* s, Number c, Number* y)
+  {
+    for (Index i=0; i<n; i++) {
+      if (UC) {
+        y[i] = c*y[i] + a*z[i]/s[i];
+      }
+      else {
+        y[i] = a*z[i]/s[i];
+      }
+    }
+  }
+
+#ifdef IPOPT_HAS_SIMD_KERNELS
+
+  /////////////////////////////////////////////////////////////////////
+  //                 AVX2 and AVX-512 kernels                        //
+  /////////////////////////////////////////////////////////////////////
+
+  // The kernels for both instruction sets are generated from the same
+  // macros.  VT is the register type, W the number of doubles in it,
+  // and P the prefix of the intrinsics.  The remainder of each loop
+  // is done by the plain loops, which perform the same operations.
+  // Those are compiled without AVX, so the upper halves of the
+  // registers are cleared first; the compiler does not do this for
+  // functions with a target attribute, and the transition penalty
+  // otherwise costs several hundred cycles per call.
+
+#define IPOPT_KERNEL_ADDTWOVECTORS(NAME, TARGET, VT, W, P)               \
+  template <bool UA, bool UB, bool UC>                                    \
+  __attribute__((target(TARGET)))                                         \
+  static void NAME(Index n, Number a, const Number* x,                   \
+                   Number b, const Number* y, Number c, Number* z)       \
+  {                                                                       \
+    const VT va = P##_set1_pd(a);                                         \
+    const VT vb = P##_set1_pd(b);                                         \
+    const VT vc = P##_set1_pd(c);                                         \
+    Index i = 0;                                                          \
+    for (; i+W<=n; i+=W) {                                                \
+      VT r = P##_setzero_pd();                                            \
+      if (UA) {                                                           \
+        r = P##_mul_pd(va, P##_loadu_pd(x+i));                            \
+      }                                                                   \
+      if (UB) {                                                           \
+        const VT t = P##_mul_pd(vb, P##_loadu_pd(y+i));                   \
+        r = UA ? P##_add_pd(r, t) : t;                                    \
+      }                                                                   \
+      if (UC) {                                                           \
+        const VT t = P##_mul_pd(vc, P##_loadu_pd(z+i));                   \
+        r = (UA || UB) ? P##_add_pd(r, t) : t;                            \
+      }                                                                   \
+      P##_storeu_pd(z+i, r);                                              \
+    }                                                                     \
+    _mm256_zeroupper();                                                   \
+    AddTwoVectorsScalar<UA, UB, UC>(n-i, a, UA ? x+i : x, b,              \
+                                    UB ? y+i : y, c, z+i);                \
+  }
+
+#define IPOPT_KERNEL_ELEMENTWISE(NAME, TARGET, VT, W, P, OP, SCALAR)     \
+  __attribute__((target(TARGET)))                                         \
+  static void NAME(Index n, Number* x, const Number* y)                  \
+  {                                                                       \
+    Index i = 0;                                                          \
+    for (; i+W<=n; i+=W) {                                                \
+      P##_storeu_pd(x+i, P##OP(P##_loadu_pd(x+i), P##_loadu_pd(y+i)));    \
+    }                                                                     \
+    _mm256_zeroupper();                                                   \
+    SCALAR(n-i, x+i, y+i);                                                \
+  }
+
+#define IPOPT_KERNEL_ADDVECTORQUOTIENT(NAME, TARGET, VT, W, P)           \
+  template <bool UC>                                                      \
+  __attribute__((target(TARGET)))                                         \
+  static void NAME(Index n, Number a, const Number* z,                   \
+                   const Number* s, Number c, Number* y)                 \
+  {                                                                       \
+    const VT va = P##_set1_pd(a);                                         \
+    const VT vc = P##_set1_pd(c);                                         \
+    Index i = 0;                                                          \
+    for (; i+W<=n; i+=W) {                                                \
+      VT q = P##_div_pd(P##_mul_pd(va, P##_loadu_pd(z+i)),                \
+                        P##_loadu_pd(s+i));                               \
+      if (UC) {                                                           \
+        q = P##_add_pd(P##_mul_pd(vc, P##_loadu_pd(y+i)), q);             \
+      }                                                                   \
+      P##_storeu_pd(y+i, q);                                              \
+    }                                                                     \
+    _mm256_zeroupper();                                                   \
+    AddVectorQuotientScalar<UC>(n-i, a, z+i, s+i, c, y+i);                \
+  }
+
+  IPOPT_KERNEL_ADDTWOVECTORS(AddTwoVectorsAvx2, "avx2", __m256d, 4, _mm256)
+  IPOPT_KERNEL_ELEMENTWISE(ElementWiseMultiplyAvx2, "avx2", __m256d, 4,
+                           _mm256, _mul_pd, ElementWiseMultiplyScalar)
+  IPOPT_KERNEL_ELEMENTWISE(ElementWiseDivideAvx2, "avx2", __m256d, 4,
+                           _mm256, _div_pd, ElementWiseDivideScalar)
+  IPOPT_KERNEL_ADDVECTORQUOTIENT(AddVectorQuotientAvx2, "avx2", __m256d, 4,
+                                 _mm256)
+
+  IPOPT_KERNEL_ADDTWOVECTORS(AddTwoVectorsAvx512, "avx512f", __m512d, 8,
+                             _mm512)
+  IPOPT_KERNEL_ELEMENTWISE(ElementWiseMultiplyAvx512, "avx512f", __m512d, 8,
+                           _mm512, _mul_pd, ElementWiseMultiplyScalar)
+  IPOPT_KERNEL_ELEMENTWISE(ElementWiseDivideAvx512, "avx512f", __m512d, 8,
+                           _mm512, _div_pd, ElementWiseDivideScalar)
+  IPOPT_KERNEL_ADDVECTORQUOTIENT(AddVectorQuotientAvx512, "avx512f",
+                                 __m512d, 8, _mm512)
+
+  // The comparisons differ between the two instruction sets, so the
+  // fraction-to-the-boundary kernels are written out.  Lanes with
+  // delta>=0 are replaced by 1 before taking the minimum.
+
+  __attribute__((target("avx2")))
+  static Number FracToBoundAvx2(Index n, Number tau, const Number* x,
+                                const Number* delta)
+  {
+    const __m256d vmtau = _mm256_set1_pd(-tau);
+    const __m256d vzero = _mm256_setzero_pd();
+    const __m256d vone = _mm256_set1_pd(1.);
+    __m256d valpha = vone;
+    Index i = 0;
+    for (; i+4<=n; i+=4) {
+      const __m256d d = _mm256_loadu_pd(delta+i);
+      const __m256d mask = _mm256_cmp_pd(d, vzero, _CMP_LT_OQ);
+      const __m256d t =
+        _mm256_mul_pd(_mm256_div_pd(vmtau, d), _mm256_loadu_pd(x+i));
+      valpha = _mm256_min_pd(valpha, _mm256_blendv_pd(vone, t, mask));
+    }
+    Number lanes[4];
+    _mm256_storeu_pd(lanes, valpha);
+    _mm256_zeroupper();
+    Number alpha = FracToBoundScalar(n-i, tau, x+i, delta+i);
+    for (Index k=0; k<4; k++) {
+      alpha = Min(alpha, lanes[k]);
+    }
+    return alpha;
+  }
+
+  __attribute__((target("avx512f")))
+  static Number FracToBoundAvx512(Index n, Number tau, const Number* x,
+                                  const Number* delta)
+  {
+    const __m512d vmtau = _mm512_set1_pd(-tau);
+    const __m512d vzero = _mm512_setzero_pd();
+    const __m512d vone = _mm512_set1_pd(1.);
+    __m512d valpha = vone;
+    Index i = 0;
+    for (; i+8<=n; i+=8) {
+      const __m512d d = _mm512_loadu_pd(delta+i);
+      const __mmask8 mask = _mm512_cmp_pd_mask(d, vzero, _CMP_LT_OQ);
+      const __m512d t =
+        _mm512_mul_pd(_mm512_div_pd(vmtau, d), _mm512_loadu_pd(x+i));
+      valpha = _mm512_min_pd(valpha, _mm512_mask_blend_pd(mask, vone, t));
+    }
+    Number lanes[8];
+    _mm512_storeu_pd(lanes, valpha);
+    _mm256_zeroupper();
+    Number alpha = FracToBoundScalar(n-i, tau, x+i, delta+i);
+    for (Index k=0; k<8; k++) {
+      alpha = Min(alpha, lanes[k]);
+    }
+    return alpha;
+  }
+
+#endif
+
+  /////////////////////////////////////////////////////////////////////
+  //                          Dispatch                               //
+  /////////////////////////////////////////////////////////////////////
+
+  template <bool UA, bool UB, bool UC>
+  static void AddTwoVectorsDispatch(Index n, Number a, const Number* x,
+                                    Number b, const Number* y,
+                                    Number c, Number* z)
+  {
+    switch (IpVectorKernelLevel()) {
+#ifdef IPOPT_HAS_SIMD_KERNELS
+    case KERNEL_AVX512:
+      AddTwoVectorsAvx512<UA, UB, UC>(n, a, x, b, y, c, z);
+      break;
+    case KERNEL_AVX2:
+      AddTwoVectorsAvx2<UA, UB, UC>(n, a, x, b, y, c, z);
+      break;
+#endif
+    default:
+      AddTwoVectorsScalar<UA, UB, UC>(n, a, x, b, y, c, z);
+    }
+  }
+
+  void IpKernelAddTwoVectors(Index n, Number a, const Number* x,
+                             Number b, const Number* y,
+                             Number c, Number* z)
+  {
+    const int flags = (a!=0. ? 4 : 0) + (b!=0. ? 2 : 0) + (c!=0. ? 1 : 0);
+    switch (flags) {
+    case 0:
+      AddTwoVectorsDispatch<false, false, false>(n, a, x, b, y, c, z);
+      break;
+    case 1:
+      AddTwoVectorsDispatch<false, false, true>(n, a, x, b, y, c, z);
+      break;
+    case 2:
+      AddTwoVectorsDispatch<false, true, false>(n, a, x, b, y, c, z);
+      break;
+    case 3:
+      AddTwoVectorsDispatch<false, true, true>(n, a, x, b, y, c, z);
+      break;
+    case 4:
+      AddTwoVectorsDispatch<true, false, false>(n, a, x, b, y, c, z);
+      break;
+    case 5:
+      AddTwoVectorsDispatch<true, false, true>(n, a, x, b, y, c, z);
+      break;
+    case 6:
+      AddTwoVectorsDispatch<true, true, false>(n, a, x, b, y, c, z);
+      break;
+    default:
+      AddTwoVectorsDispatch<true, true, true>(n, a, x, b, y, c, z);
+    }
+  }
+
+  void IpKernelElementWiseMultiply(Index n, Number* x, const Number* y)
+  {
+    switch (IpVectorKernelLevel()) {
+#ifdef IPOPT_HAS_SIMD_KERNELS
+    case KERNEL_AVX512:
+      ElementWiseMultiplyAvx512(n, x, y);
+      break;
+    case KERNEL_AVX2:
+      ElementWiseMultiplyAvx2(n, x, y);
+      break;
+#endif
+    default:
+      ElementWiseMultiplyScalar(n, x, y);
+    }
+  }
+
+  void IpKernelElementWiseDivide(Index n, Number* x, const Number* y)
+  {
+    switch (IpVectorKernelLevel()) {
+#ifdef IPOPT_HAS_SIMD_KERNELS
+    case KERNEL_AVX512:
+      ElementWiseDivideAvx512(n, x, y);
+      break;
+    case KERNEL_AVX2:
+      ElementWiseDivideAvx2(n, x, y);
+      break;
+#endif
+    default:
+      ElementWiseDivideScalar(n, x, y);
+    }
+  }
+
+  Number IpKernelFracToBound(Index n, Number tau, const Number* x,
+                             const Number* delta)
+  {
+    switch (IpVectorKernelLevel()) {
+#ifdef IPOPT_HAS_SIMD_KERNELS
+    case KERNEL_AVX512:
+      return FracToBoundAvx512(n, tau, x, delta);
+    case KERNEL_AVX2:
+      return FracToBoundAvx2(n, tau, x, delta);
+#endif
+    default:
+      return FracToBoundScalar(n, tau, x, delta);
+    }
+  }
+
+  void IpKernelAddVectorQuotient(Index n, Number a, const Number* z,
+                                 const Number* s, Number c, Number* y)
+  {
+    if (c!=0.) {
+      switch (IpVectorKernelLevel()) {
+#ifdef IPOPT_HAS_SIMD_KERNELS
+      case KERNEL_AVX512:
+        AddVectorQuotientAvx512<true>(n, a, z, s, c, y);
+        break;
+      case KERNEL_AVX2:
+        AddVectorQuotientAvx2<true>(n, a, z, s, c, y);
+        break;
+#endif
+      default:
+        AddVectorQuotientScalar<true>(n, a, z, s, c, y);
+      }
+    }
+    else {
+      switch (IpVectorKernelLevel()) {
+#ifdef IPOPT_HAS_SIMD_KERNELS
+      case KERNEL_AVX512:
+        AddVectorQuotientAvx512<false>(n, a, z, s, c, y);
+        break;
+      case KERNEL_AVX2:
+        AddVectorQuotientAvx2<false>(n, a, z, s, c, y);
+        break;
+#endif
+      default:
+        AddVectorQuotientScalar<false>(n, a, z, s, c, y);
+      }
+    }
+  }
+
+} // namespace Ipopt
@@ -0,0 +1,74 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifndef __IPVECTORKERNELS_HPP__
+#define __IPVECTORKERNELS_HPP__
+
+#include "IpUtils.hpp"
+
+namespace Ipopt
+{
+  /** @name Element-wise kernels for the dense vector operations.
+   *
+   *  These are the loops behind the fused operations of DenseVector.
+   *  If Ipopt is configured with SIMD kernels (the default with GCC
+   *  compatible compilers on x86), each kernel exists in an AVX2 and
+   *  an AVX-512 version, and the widest one supported by the CPU is
+   *  picked at run time; otherwise, and on other CPUs, the plain
+   *  loops are used.  All versions perform the same floating point
+   *  operations in the same order (no fused multiply-add), so the
+   *  results do not depend on the version that is used.
+   */
+  //@{
+  /** Instruction set used by the kernels */
+  enum VectorKernelLevel {
+    /** Plain loops */
+    KERNEL_SCALAR=0,
+    /** 256 bit AVX2 kernels */
+    KERNEL_AVX2,
+    /** 512 bit AVX-512 kernels */
+    KERNEL_AVX512
+  };
+
+  /** Instruction set currently used by the kernels. */
+  VectorKernelLevel IpVectorKernelLevel();
+
+  /** Widest instruction set supported by this build and this CPU. */
+  VectorKernelLevel IpVectorKernelMaxLevel();
+
+  /** Select the instruction set for the kernels (for testing and
+   *  benchmarking).  Levels that are not supported are reduced to the
+   *  widest supported one.  Returns the level that is used. */
+  VectorKernelLevel IpSetVectorKernelLevel(VectorKernelLevel level);
+
+  /** z = a*x + b*y + c*z.  x is not accessed if a is zero, y is not
+   *  accessed if b is zero, and the old values of z are not accessed
+   *  if c is zero. */
+  void IpKernelAddTwoVectors(Index n, Number a, const Number* x,
+                             Number b, const Number* y,
+                             Number c, Number* z);
+
+  /** x = x .* y */
+  void IpKernelElementWiseMultiply(Index n, Number* x, const Number* y);
+
+  /** x = x ./ y */
+  void IpKernelElementWiseDivide(Index n, Number* x, const Number* y);
+
+  /** Largest alpha in (0,1] with x + alpha*delta >= (1-tau)*x, that
+   *  is, the minimum of 1 and -tau/delta[i]*x[i] over all i with
+   *  delta[i] < 0. */
+  Number IpKernelFracToBound(Index n, Number tau, const Number* x,
+                             const Number* delta);
+
+  /** y = a*z./s + c*y.  The old values of y are not accessed if c is
+   *  zero. */
+  void IpKernelAddVectorQuotient(Index n, Number a, const Number* z,
+                                 const Number* s, Number c, Number* y);
+  //@}
+
+} // namespace Ipopt
+
+#endif
@@ -222,7 +222,8 @@ namespace Ipopt
       MatrixSpace(nRows, nCols),
       nonZeros_(nonZeros),
       jCols_(NULL),
-      iRows_(NULL)
+      iRows_(NULL),
+      pool_(nonZeros)
   {
     iRows_ = new Index[nonZeros];
     jCols_ = new Index[nonZeros];
@@ -234,12 +235,12 @@ namespace Ipopt
 
   Number* GenTMatrixSpace::AllocateInternalStorage() const
   {
-    return new Number[Nonzeros()];
+    return pool_.Allocate();
   }
 
   void GenTMatrixSpace::FreeInternalStorage(Number* values) const
   {
-    delete [] values;
+    pool_.Free(values);
   }
 
 
@@ -11,6 +11,7 @@
 
 #include "IpUtils.hpp"
 #include "IpMatrix.hpp"
+#include "IpNumberArrayPool.hpp"
 
 namespace Ipopt
 {
@@ -217,6 +218,12 @@ namespace Ipopt
     {
       return jCols_;
     }
+
+    /** Pool from which the values of the matrices are taken */
+    const NumberArrayPool& StoragePool() const
+    {
+      return pool_;
+    }
     //@}
 
   private:
@@ -229,6 +236,9 @@ namespace Ipopt
     Index* iRows_;
     //@}
 
+    /** Free list for the values of the matrices */
+    mutable NumberArrayPool pool_;
+
     /** This method is only for the GenTMatrix to call in order
      *   to allocate internal storage */
     Number* AllocateInternalStorage() const;
@@ -207,7 +207,8 @@ namespace Ipopt
       SymMatrixSpace(dim),
       nonZeros_(nonZeros),
       iRows_(NULL),
-      jCols_(NULL)
+      jCols_(NULL),
+      pool_(nonZeros)
   {
     iRows_ = new Index[nonZeros];
     jCols_ = new Index[nonZeros];
@@ -225,12 +226,12 @@ namespace Ipopt
 
   Number* SymTMatrixSpace::AllocateInternalStorage() const
   {
-    return new Number[Nonzeros()];
+    return pool_.Allocate();
   }
 
   void SymTMatrixSpace::FreeInternalStorage(Number* values) const
   {
-    delete [] values;
+    pool_.Free(values);
   }
 
 } // namespace Ipopt
@@ -11,6 +11,7 @@
 
 #include "IpUtils.hpp"
 #include "IpSymMatrix.hpp"
+#include "IpNumberArrayPool.hpp"
 
 namespace Ipopt
 {
@@ -210,6 +211,12 @@ namespace Ipopt
     {
       return jCols_;
     }
+
+    /** Pool from which the values of the matrices are taken */
+    const NumberArrayPool& StoragePool() const
+    {
+      return pool_;
+    }
     //@}
 
   private:
@@ -226,6 +233,9 @@ namespace Ipopt
     Index* iRows_;
     Index* jCols_;
 
+    /** Free list for the values of the matrices */
+    mutable NumberArrayPool pool_;
+
     friend class SymTMatrix;
   };
 
@@ -0,0 +1,180 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+//
+// Compares the evaluations of AmplTNLP on the expression tape
+// (nl_evaluator tape) with those of the AMPL solver library for the
+// .nl file given on the command line.  Requires the AMPL solver
+// library, which is why this is not part of classTests.
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "IpIpoptApplication.hpp"
+#include "AmplTNLP.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+using namespace Ipopt;
+
+namespace
+{
+  /** Number of points at which the functions are evaluated */
+  const Index n_points = 4;
+
+  /** Results of all evaluations of one AmplTNLP */
+  struct Results {
+    Index n;
+    Index m;
+    Index nnz_jac;
+    std::vector<Number> f;
+    std::vector<Number> grad;
+    std::vector<Number> g;
+    std::vector<Index> jac_rows;
+    std::vector<Index> jac_cols;
+    std::vector<Number> jac;
+    /** Dense lower triangles of the Hessians of the Lagrangian */
+    std::vector<Number> hess;
+  };
+
+  /** Point k in the interior of the bounds [0.5,3] of tapetest.nl */
+  Number point(Index k, Index i)
+  {
+    return 0.6 + 0.5*(i % 4) + 0.25*k + 0.01*i;
+  }
+
+  /** Evaluate the model in stub with the given nl_evaluator at all
+   *  points and store the results in res */
+  void evaluate(IpoptApplication& app, const char* stub,
+                const std::string& evaluator, Results& res)
+  {
+    // The fallback to the AMPL solver library is reported as warning
+    SmartPtr<Journalist> jnlst = new Journalist();
+    std::ostringstream warnings;
+    SmartPtr<StreamJournal> journal =
+      new StreamJournal("warnings", J_WARNING);
+    journal->SetOutputStream(&warnings);
+    jnlst->AddJournal(GetRawPtr(journal));
+
+    app.Options()->SetStringValue("nl_evaluator", evaluator);
+    char* args[3] = {const_cast<char*>("amplTapeTest"),
+                     const_cast<char*>(stub), NULL
+                    };
+    char** argv = args;
+    SmartPtr<AmplTNLP> tnlp =
+      new AmplTNLP(ConstPtr(jnlst), app.Options(), argv);
+    assert(warnings.str().find("is used instead") == std::string::npos);
+
+    Index nnz_h;
+    TNLP::IndexStyleEnum index_style;
+    bool ok = tnlp->get_nlp_info(res.n, res.m, res.nnz_jac, nnz_h,
+                                 index_style);
+    assert(ok);
+    assert(index_style == TNLP::FORTRAN_STYLE);
+    const Index n = res.n;
+    const Index m = res.m;
+
+    res.jac_rows.resize(res.nnz_jac);
+    res.jac_cols.resize(res.nnz_jac);
+    ok = tnlp->eval_jac_g(n, NULL, false, m, res.nnz_jac, &res.jac_rows[0],
+                          &res.jac_cols[0], NULL);
+    assert(ok);
+    std::vector<Index> h_rows(nnz_h);
+    std::vector<Index> h_cols(nnz_h);
+    ok = tnlp->eval_h(n, NULL, false, 0., m, NULL, false, nnz_h,
+                      &h_rows[0], &h_cols[0], NULL);
+    assert(ok);
+
+    std::vector<Number> x(n);
+    std::vector<Number> lambda(m);
+    std::vector<Number> vals(Max(n, Max(m, Max(res.nnz_jac, nnz_h))));
+    for (Index k=0; k<n_points; k++) {
+      for (Index i=0; i<n; i++) {
+        x[i] = point(k, i);
+      }
+      for (Index j=0; j<m; j++) {
+        lambda[j] = sin(1. + j + k);
+      }
+
+      Number f;
+      ok = tnlp->eval_f(n, &x[0], true, f);
+      assert(ok);
+      res.f.push_back(f);
+
+      ok = tnlp->eval_grad_f(n, &x[0], false, &vals[0]);
+      assert(ok);
+      res.grad.insert(res.grad.end(), vals.begin(), vals.begin() + n);
+
+      ok = tnlp->eval_g(n, &x[0], false, m, &vals[0]);
+      assert(ok);
+      res.g.insert(res.g.end(), vals.begin(), vals.begin() + m);
+
+      ok = tnlp->eval_jac_g(n, &x[0], false, m, res.nnz_jac, NULL, NULL,
+                            &vals[0]);
+      assert(ok);
+      res.jac.insert(res.jac.end(), vals.begin(),
+                     vals.begin() + res.nnz_jac);
+
+      // The structures of the Hessians differ, so they are compared as
+      // dense matrices, once with and once without the objective
+      for (Index pass=0; pass<2; pass++) {
+        const Number obj_factor = (pass == 0) ? 1.5 : 0.;
+        ok = tnlp->eval_h(n, &x[0], false, obj_factor, m, &lambda[0], true,
+                          nnz_h, NULL, NULL, &vals[0]);
+        assert(ok);
+        std::vector<Number> dense(n*n, 0.);
+        for (Index p=0; p<nnz_h; p++) {
+          const Index row = Max(h_rows[p], h_cols[p]) - 1;
+          const Index col = Min(h_rows[p], h_cols[p]) - 1;
+          dense[row + col*n] += vals[p];
+        }
+        res.hess.insert(res.hess.end(), dense.begin(), dense.end());
+      }
+    }
+  }
+
+  void assertClose(const std::vector<Number>& a, const std::vector<Number>& b)
+  {
+    assert(a.size() == b.size());
+    for (size_t i=0; i<a.size(); i++) {
+      assert(std::abs(a[i] - b[i]) <= 1e-10*(1. + std::abs(b[i])));
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  if (argc != 2) {
+    printf("Usage: %s file.nl\n", argv[0]);
+    return 1;
+  }
+
+  SmartPtr<IpoptApplication> app = new IpoptApplication(false);
+  AmplTNLP::RegisterOptions(app->RegOptions());
+
+  Results asl;
+  evaluate(*app, argv[1], "asl", asl);
+  Results tape;
+  evaluate(*app, argv[1], "tape", tape);
+
+  assert(tape.n == asl.n);
+  assert(tape.m == asl.m);
+  assert(tape.nnz_jac == asl.nnz_jac);
+  assert(tape.jac_rows == asl.jac_rows);
+  assert(tape.jac_cols == asl.jac_cols);
+  assertClose(tape.f, asl.f);
+  assertClose(tape.grad, asl.grad);
+  assertClose(tape.g, asl.g);
+  assertClose(tape.jac, asl.jac);
+  assertClose(tape.hess, asl.hess);
+
+  printf("All tests completed successfully\n");
+  return 0;
+}
@@ -0,0 +1,342 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "IpIpoptApplication.hpp"
+#include "IpSolveStatistics.hpp"
+#include "IpTNLPAdapter.hpp"
+
+#include <cassert>
+#include <sstream>
+
+using namespace Ipopt;
+
+namespace
+{
+  /** min sum_{i<6} (x_i - 0.3*i)^2 with three independent blocks of
+   *  constraints, mixing equalities and inequalities, and a fixed
+   *  variable x6 in the last block:
+   *
+   *  block 0: x0^2 + x1^2 = 1,    x0 - x1 >= -0.5
+   *  block 1: x2*x3 >= 0.25,      x2 + x3 = 1.5
+   *  block 2: x4^2 + x5*x6 = 2
+   *
+   *  The full evaluation methods call the block ones, so that both
+   *  paths compute the same numbers.  The blocks are only declared if
+   *  use_blocks is set. */
+  class BlockTNLP : public TNLP
+  {
+  public:
+    bool use_blocks;
+    /** if set, get_block_structure does not cover all constraints */
+    bool bad_blocks;
+    Index n_block_evals;
+    Number x_sol[7];
+
+    BlockTNLP(bool use_blocks_)
+        :
+        use_blocks(use_blocks_),
+        bad_blocks(false),
+        n_block_evals(0)
+    {}
+
+    virtual bool get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
+                              Index& nnz_h_lag, IndexStyleEnum& index_style)
+    {
+      n = 7;
+      m = 5;
+      nnz_jac_g = 11;
+      nnz_h_lag = 8;
+      index_style = C_STYLE;
+      return true;
+    }
+
+    virtual bool get_bounds_info(Index n, Number* x_l, Number* x_u,
+                                 Index m, Number* g_l, Number* g_u)
+    {
+      for (Index i=0; i<6; i++) {
+        x_l[i] = -10.;
+        x_u[i] = 10.;
+      }
+      x_l[6] = x_u[6] = 1.;
+      g_l[0] = g_u[0] = 1.;
+      g_l[1] = -0.5;
+      g_u[1] = 2e19;
+      g_l[2] = 0.25;
+      g_u[2] = 2e19;
+      g_l[3] = g_u[3] = 1.5;
+      g_l[4] = g_u[4] = 2.;
+      return true;
+    }
+
+    virtual bool get_starting_point(Index n, bool init_x, Number* x,
+                                    bool init_z, Number* z_L, Number* z_U,
+                                    Index m, bool init_lambda, Number* lambda)
+    {
+      for (Index i=0; i<6; i++) {
+        x[i] = 0.5;
+      }
+      x[6] = 1.;
+      return true;
+    }
+
+    virtual bool eval_f(Index n, const Number* x, bool new_x,
+                        Number& obj_value)
+    {
+      obj_value = 0.;
+      for (Index i=0; i<6; i++) {
+        obj_value += (x[i] - 0.3*i)*(x[i] - 0.3*i);
+      }
+      return true;
+    }
+
+    virtual bool eval_grad_f(Index n, const Number* x, bool new_x,
+                             Number* grad_f)
+    {
+      for (Index i=0; i<6; i++) {
+        grad_f[i] = 2.*(x[i] - 0.3*i);
+      }
+      grad_f[6] = 0.;
+      return true;
+    }
+
+    virtual bool eval_g(Index n, const Number* x, bool new_x,
+                        Index m, Number* g)
+    {
+      for (Index b=0; b<3; b++) {
+        g_block(b, x, g + g_start[b]);
+      }
+      return true;
+    }
+
+    virtual bool eval_jac_g(Index n, const Number* x, bool new_x,
+                            Index m, Index nele_jac, Index* iRow,
+                            Index *jCol, Number* values)
+    {
+      if (values) {
+        for (Index b=0; b<3; b++) {
+          jac_block(b, x, values + jac_start[b]);
+        }
+      }
+      else {
+        const Index rows[11] = {0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 4};
+        const Index cols[11] = {0, 1, 0, 1, 2, 3, 2, 3, 4, 5, 6};
+        for (Index k=0; k<11; k++) {
+          iRow[k] = rows[k];
+          jCol[k] = cols[k];
+        }
+      }
+      return true;
+    }
+
+    virtual bool eval_h(Index n, const Number* x, bool new_x,
+                        Number obj_factor, Index m, const Number* lambda,
+                        bool new_lambda, Index nele_hess,
+                        Index* iRow, Index* jCol, Number* values)
+    {
+      if (values) {
+        for (Index b=0; b<3; b++) {
+          h_block(b, obj_factor, lambda, values + h_start[b]);
+        }
+      }
+      else {
+        const Index rows[8] = {0, 1, 2, 3, 3, 4, 5, 6};
+        const Index cols[8] = {0, 1, 2, 3, 2, 4, 5, 5};
+        for (Index k=0; k<8; k++) {
+          iRow[k] = rows[k];
+          jCol[k] = cols[k];
+        }
+      }
+      return true;
+    }
+
+    virtual Index get_number_of_blocks()
+    {
+      return use_blocks ? 3 : 0;
+    }
+
+    virtual bool get_block_structure(Index num_blocks, Index* g_start_,
+                                     Index* jac_start_, Index* h_start_)
+    {
+      assert(num_blocks == 3);
+      for (Index b=0; b<=3; b++) {
+        g_start_[b] = g_start[b];
+        jac_start_[b] = jac_start[b];
+        if (h_start_) {
+          h_start_[b] = h_start[b];
+        }
+      }
+      if (bad_blocks) {
+        g_start_[3]--;
+      }
+      return true;
+    }
+
+    virtual bool eval_g_block(Index block, Index n, const Number* x,
+                              bool new_x, Index m_block, Number* g_block_)
+    {
+      assert(m_block == g_start[block+1] - g_start[block]);
+      n_block_evals++;
+      g_block(block, x, g_block_);
+      return true;
+    }
+
+    virtual bool eval_jac_g_block(Index block, Index n, const Number* x,
+                                  bool new_x, Index nele_block,
+                                  Number* values_block)
+    {
+      assert(nele_block == jac_start[block+1] - jac_start[block]);
+      n_block_evals++;
+      jac_block(block, x, values_block);
+      return true;
+    }
+
+    virtual bool eval_h_block(Index block, Index n, const Number* x,
+                              bool new_x, Number obj_factor, Index m,
+                              const Number* lambda, bool new_lambda,
+                              Index nele_block, Number* values_block)
+    {
+      assert(nele_block == h_start[block+1] - h_start[block]);
+      n_block_evals++;
+      h_block(block, obj_factor, lambda, values_block);
+      return true;
+    }
+
+    virtual void finalize_solution(SolverReturn status,
+                                   Index n, const Number* x,
+                                   const Number* z_L, const Number* z_U,
+                                   Index m, const Number* g,
+                                   const Number* lambda, Number obj_value,
+                                   const IpoptData* ip_data,
+                                   IpoptCalculatedQuantities* ip_cq)
+    {
+      for (Index i=0; i<n; i++) {
+        x_sol[i] = x[i];
+      }
+    }
+
+  private:
+    static const Index g_start[4];
+    static const Index jac_start[4];
+    static const Index h_start[4];
+
+    void g_block(Index b, const Number* x, Number* g)
+    {
+      switch (b) {
+      case 0:
+        g[0] = x[0]*x[0] + x[1]*x[1];
+        g[1] = x[0] - x[1];
+        break;
+      case 1:
+        g[0] = x[2]*x[3];
+        g[1] = x[2] + x[3];
+        break;
+      default:
+        g[0] = x[4]*x[4] + x[5]*x[6];
+      }
+    }
+
+    void jac_block(Index b, const Number* x, Number* values)
+    {
+      switch (b) {
+      case 0:
+        values[0] = 2.*x[0];
+        values[1] = 2.*x[1];
+        values[2] = 1.;
+        values[3] = -1.;
+        break;
+      case 1:
+        values[0] = x[3];
+        values[1] = x[2];
+        values[2] = values[3] = 1.;
+        break;
+      default:
+        values[0] = 2.*x[4];
+        values[1] = x[6];
+        values[2] = x[5];
+      }
+    }
+
+    void h_block(Index b, Number obj_factor, const Number* lambda,
+                 Number* values)
+    {
+      switch (b) {
+      case 0:
+        values[0] = values[1] = 2.*obj_factor + 2.*lambda[0];
+        break;
+      case 1:
+        values[0] = values[1] = 2.*obj_factor;
+        values[2] = lambda[2];
+        break;
+      default:
+        values[0] = 2.*obj_factor + 2.*lambda[4];
+        values[1] = 2.*obj_factor;
+        values[2] = lambda[4];
+      }
+    }
+  };
+
+  const Index BlockTNLP::g_start[4] = {0, 2, 4, 5};
+  const Index BlockTNLP::jac_start[4] = {0, 4, 8, 11};
+  const Index BlockTNLP::h_start[4] = {0, 2, 5, 8};
+
+  /** Solve the problem with a new application, return the number of
+   *  iterations. */
+  Index solve(BlockTNLP* tnlp)
+  {
+    SmartPtr<IpoptApplication> app = new IpoptApplication(false);
+    std::istringstream options("linear_solver ldl\n"
+                               "print_level 0\n"
+                               "block_eval_num_threads 2\n");
+    ApplicationReturnStatus status = app->Initialize(options);
+    assert(status == Solve_Succeeded);
+    status = app->OptimizeTNLP(tnlp);
+    assert(status == Solve_Succeeded);
+    return app->Statistics()->IterationCount();
+  }
+}
+
+void BlockEvalTest(IpoptApplication& app)
+{
+  // Evaluating by blocks takes the same steps as the full evaluation
+  SmartPtr<BlockTNLP> full = new BlockTNLP(false);
+  SmartPtr<BlockTNLP> blocks = new BlockTNLP(true);
+  const Index iter_full = solve(GetRawPtr(full));
+  const Index iter_blocks = solve(GetRawPtr(blocks));
+  assert(full->n_block_evals == 0);
+  assert(blocks->n_block_evals > 0);
+  assert(iter_full == iter_blocks);
+  for (Index i=0; i<7; i++) {
+    assert(full->x_sol[i] == blocks->x_sol[i]);
+  }
+
+  // Blocks that do not cover the constraints are rejected
+  blocks->bad_blocks = true;
+  SmartPtr<TNLPAdapter> adapter = new TNLPAdapter(GetRawPtr(blocks),
+                                  ConstPtr(app.Jnlst()));
+  bool ok = adapter->ProcessOptions(*app.Options(), "");
+  assert(ok);
+  SmartPtr<const VectorSpace> x_space, c_space, d_space, x_l_space,
+  x_u_space, d_l_space, d_u_space;
+  SmartPtr<const MatrixSpace> px_l_space, px_u_space, pd_l_space,
+  pd_u_space, Jac_c_space, Jac_d_space;
+  SmartPtr<const SymMatrixSpace> Hess_lagrangian_space;
+  bool thrown = false;
+  try {
+    adapter->GetSpaces(x_space, c_space, d_space, x_l_space,
+                       px_l_space, x_u_space, px_u_space,
+                       d_l_space, pd_l_space, d_u_space,
+                       pd_u_space, Jac_c_space, Jac_d_space,
+                       Hess_lagrangian_space);
+  }
+  catch (TNLPAdapter::INVALID_TNLP&) {
+    thrown = true;
+  }
+  assert(thrown);
+}
@@ -0,0 +1,634 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+//
+// Benchmark for CachedResults.  The first part replays a lookup
+// pattern similar to the one of IpoptCalculatedQuantities (objects
+// that change in every iteration, caches of sizes 1 to 5 with one to
+// three dependencies, lookups with hits and misses) with
+// CachedResults and with a reference implementation that keeps the
+// results in a std::list of heap-allocated entries, as Ipopt did
+// before.  The hits and misses of both are checked to agree.  The
+// second part solves small NLPs repeatedly and reports the number of
+// cache lookups per solve and per iteration together with the time
+// per solve.  The lookups are only counted in builds with
+// IP_CACHE_STATISTICS (see IpCachedResults.hpp).
+//
+// usage: cachedResultsBench [num_solves [min_seconds]]
+
+#include "IpCachedResults.hpp"
+#include "IpIpoptApplication.hpp"
+#include "IpSolveStatistics.hpp"
+#include "IpTNLP.hpp"
+#include "IpUtils.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <vector>
+
+using namespace Ipopt;
+
+/** Tagged object that can be changed from outside */
+class Quantity : public TaggedObject
+{
+public:
+  void Change()
+  {
+    ObjectChanged();
+  }
+};
+
+/** Reference implementation: one heap-allocated observer per result
+ *  in a std::list, temporary vectors for the dependencies, stale
+ *  results deleted on every access. */
+class ReferenceResult : public Observer
+{
+public:
+  ReferenceResult(Number result,
+                  const std::vector<const TaggedObject*>& dependents)
+      : stale_(false), result_(result), tags_(dependents.size())
+  {
+    for (size_t i=0; i<dependents.size(); i++) {
+      RequestAttach(NT_Changed, dependents[i]);
+      tags_[i] = dependents[i]->GetTag();
+    }
+  }
+  bool IsStale() const
+  {
+    return stale_;
+  }
+  Number Result() const
+  {
+    return result_;
+  }
+  bool Identical(const std::vector<const TaggedObject*>& dependents) const
+  {
+    if (dependents.size() != tags_.size()) {
+      return false;
+    }
+    for (size_t i=0; i<dependents.size(); i++) {
+      if (dependents[i]->GetTag() != tags_[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+protected:
+  virtual void RecieveNotification(NotifyType notify_type,
+                                   const Subject* subject)
+  {
+    if (notify_type == NT_Changed || notify_type == NT_BeingDestroyed) {
+      stale_ = true;
+    }
+  }
+private:
+  bool stale_;
+  Number result_;
+  std::vector<TaggedObject::Tag> tags_;
+};
+
+class ReferenceCache
+{
+public:
+  ReferenceCache(Int max_size)
+      : max_size_(max_size)
+  {}
+  ~ReferenceCache()
+  {
+    for (std::list<ReferenceResult*>::iterator it=results_.begin();
+         it!=results_.end(); it++) {
+      delete *it;
+    }
+  }
+  void Add(Number result, const TaggedObject* d1, const TaggedObject* d2,
+           const TaggedObject* d3, Index ndeps)
+  {
+    Cleanup();
+    std::vector<const TaggedObject*> deps(ndeps);
+    MakeDeps(deps, d1, d2, d3);
+    results_.push_front(new ReferenceResult(result, deps));
+    if ((Int)results_.size() > max_size_) {
+      delete results_.back();
+      results_.pop_back();
+    }
+  }
+  bool Get(Number& result, const TaggedObject* d1, const TaggedObject* d2,
+           const TaggedObject* d3, Index ndeps)
+  {
+    std::vector<const TaggedObject*> deps(ndeps);
+    MakeDeps(deps, d1, d2, d3);
+    Cleanup();
+    for (std::list<ReferenceResult*>::iterator it=results_.begin();
+         it!=results_.end(); it++) {
+      if ((*it)->Identical(deps)) {
+        result = (*it)->Result();
+        return true;
+      }
+    }
+    return false;
+  }
+private:
+  static void MakeDeps(std::vector<const TaggedObject*>& deps,
+                       const TaggedObject* d1, const TaggedObject* d2,
+                       const TaggedObject* d3)
+  {
+    deps[0] = d1;
+    if (deps.size() > 1) {
+      deps[1] = d2;
+    }
+    if (deps.size() > 2) {
+      deps[2] = d3;
+    }
+  }
+  void Cleanup()
+  {
+    std::list<ReferenceResult*>::iterator it = results_.begin();
+    while (it != results_.end()) {
+      if ((*it)->IsStale()) {
+        delete *it;
+        it = results_.erase(it);
+      }
+      else {
+        it++;
+      }
+    }
+  }
+  Int max_size_;
+  std::list<ReferenceResult*> results_;
+};
+
+/** Adapter with the same interface for CachedResults */
+class FlatCache
+{
+public:
+  FlatCache(Int max_size)
+      : cache_(max_size)
+  {}
+  void Add(Number result, const TaggedObject* d1, const TaggedObject* d2,
+           const TaggedObject* d3, Index ndeps)
+  {
+    switch (ndeps) {
+    case 1:
+      cache_.AddCachedResult1Dep(result, d1);
+      break;
+    case 2:
+      cache_.AddCachedResult2Dep(result, d1, d2);
+      break;
+    default:
+      cache_.AddCachedResult3Dep(result, d1, d2, d3);
+    }
+  }
+  bool Get(Number& result, const TaggedObject* d1, const TaggedObject* d2,
+           const TaggedObject* d3, Index ndeps)
+  {
+    switch (ndeps) {
+    case 1:
+      return cache_.GetCachedResult1Dep(result, d1);
+    case 2:
+      return cache_.GetCachedResult2Dep(result, d1, d2);
+    default:
+      return cache_.GetCachedResult3Dep(result, d1, d2, d3);
+    }
+  }
+private:
+  CachedResults<Number> cache_;
+};
+
+/** Lookup pattern: num_quantities objects, of which the "trial" ones
+ *  change in every iteration and the others every fourth iteration.
+ *  For each cache, a few lookups are done per iteration, and the
+ *  result is computed and added whenever a lookup misses. */
+template<class Cache>
+static void ReplayPattern(Index num_iterations, std::vector<Cache*>& caches,
+                          std::vector<Quantity>& quantities,
+                          std::vector<char>& hits, Number& checksum)
+{
+  const Index nq = (Index)quantities.size();
+  const Index nc = (Index)caches.size();
+  hits.clear();
+  checksum = 0.;
+  for (Index it=0; it<num_iterations; it++) {
+    for (Index q=0; q<nq; q++) {
+      if (q < nq/2 || it%4 == 0) {
+        quantities[q].Change();
+      }
+    }
+    for (Index rep=0; rep<4; rep++) {
+      for (Index c=0; c<nc; c++) {
+        const Index ndeps = 1 + c%3;
+        // Dependencies alternate between current and trial objects
+        const TaggedObject* d1 = &quantities[(c + rep%2) % nq];
+        const TaggedObject* d2 = &quantities[(c + 3) % nq];
+        const TaggedObject* d3 = &quantities[(c + 5 + rep%2) % nq];
+        Number result;
+        const bool hit = caches[c]->Get(result, d1, d2, d3, ndeps);
+        if (!hit) {
+          result = (Number)(it + c + rep%2);
+          caches[c]->Add(result, d1, d2, d3, ndeps);
+        }
+        hits.push_back(hit ? 1 : 0);
+        checksum += result;
+      }
+    }
+  }
+}
+
+template<class Cache>
+static Number TimePattern(Index num_iterations, Index num_caches,
+                          std::vector<char>& hits, Number& checksum,
+                          Number min_seconds)
+{
+  Index reps = 0;
+  Number start = WallclockTime();
+  Number elapsed;
+  do {
+    std::vector<Quantity> quantities(12);
+    std::vector<Cache*> caches(num_caches);
+    static const Int sizes[] = {1, 1, 2, 1, 5, 1, 3, 1, 2};
+    for (Index c=0; c<num_caches; c++) {
+      caches[c] = new Cache(sizes[c%9]);
+    }
+    ReplayPattern(num_iterations, caches, quantities, hits, checksum);
+    for (Index c=0; c<num_caches; c++) {
+      delete caches[c];
+    }
+    reps++;
+    elapsed = WallclockTime() - start;
+  }
+  while (elapsed < min_seconds);
+  return elapsed/reps;
+}
+
+/** Problem 71 from the Hock-Schittkowski collection */
+class HS071NLP : public TNLP
+{
+public:
+  virtual bool get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
+                            Index& nnz_h_lag, IndexStyleEnum& index_style)
+  {
+    n = 4;
+    m = 2;
+    nnz_jac_g = 8;
+    nnz_h_lag = 10;
+    index_style = C_STYLE;
+    return true;
+  }
+
+  virtual bool get_bounds_info(Index n, Number* x_l, Number* x_u,
+                               Index m, Number* g_l, Number* g_u)
+  {
+    for (Index i=0; i<4; i++) {
+      x_l[i] = 1.0;
+      x_u[i] = 5.0;
+    }
+    g_l[0] = 25;
+    g_u[0] = 2e19;
+    g_l[1] = g_u[1] = 40.0;
+    return true;
+  }
+
+  virtual bool get_starting_point(Index n, bool init_x, Number* x,
+                                  bool init_z, Number* z_L, Number* z_U,
+                                  Index m, bool init_lambda,
+                                  Number* lambda)
+  {
+    x[0] = 1.0;
+    x[1] = 5.0;
+    x[2] = 5.0;
+    x[3] = 1.0;
+    return true;
+  }
+
+  virtual bool eval_f(Index n, const Number* x, bool new_x,
+                      Number& obj_value)
+  {
+    obj_value = x[0] * x[3] * (x[0] + x[1] + x[2]) + x[2];
+    return true;
+  }
+
+  virtual bool eval_grad_f(Index n, const Number* x, bool new_x,
+                           Number* grad_f)
+  {
+    grad_f[0] = x[0] * x[3] + x[3] * (x[0] + x[1] + x[2]);
+    grad_f[1] = x[0] * x[3];
+    grad_f[2] = x[0] * x[3] + 1;
+    grad_f[3] = x[0] * (x[0] + x[1] + x[2]);
+    return true;
+  }
+
+  virtual bool eval_g(Index n, const Number* x, bool new_x, Index m,
+                      Number* g)
+  {
+    g[0] = x[0] * x[1] * x[2] * x[3];
+    g[1] = x[0]*x[0] + x[1]*x[1] + x[2]*x[2] + x[3]*x[3];
+    return true;
+  }
+
+  virtual bool eval_jac_g(Index n, const Number* x, bool new_x,
+                          Index m, Index nele_jac, Index* iRow,
+                          Index *jCol, Number* values)
+  {
+    if (values == NULL) {
+      for (Index k=0; k<8; k++) {
+        iRow[k] = k/4;
+        jCol[k] = k%4;
+      }
+    }
+    else {
+      values[0] = x[1]*x[2]*x[3];
+      values[1] = x[0]*x[2]*x[3];
+      values[2] = x[0]*x[1]*x[3];
+      values[3] = x[0]*x[1]*x[2];
+      values[4] = 2*x[0];
+      values[5] = 2*x[1];
+      values[6] = 2*x[2];
+      values[7] = 2*x[3];
+    }
+    return true;
+  }
+
+  virtual bool eval_h(Index n, const Number* x, bool new_x,
+                      Number obj_factor, Index m, const Number* lambda,
+                      bool new_lambda, Index nele_hess, Index* iRow,
+                      Index* jCol, Number* values)
+  {
+    if (values == NULL) {
+      Index idx = 0;
+      for (Index row = 0; row < 4; row++) {
+        for (Index col = 0; col <= row; col++) {
+          iRow[idx] = row;
+          jCol[idx] = col;
+          idx++;
+        }
+      }
+    }
+    else {
+      values[0] = obj_factor * (2*x[3]);
+      values[1] = obj_factor * (x[3]);
+      values[2] = 0.;
+      values[3] = obj_factor * (x[3]);
+      values[4] = 0.;
+      values[5] = 0.;
+      values[6] = obj_factor * (2*x[0] + x[1] + x[2]);
+      values[7] = obj_factor * (x[0]);
+      values[8] = obj_factor * (x[0]);
+      values[9] = 0.;
+
+      values[1] += lambda[0] * (x[2] * x[3]);
+      values[3] += lambda[0] * (x[1] * x[3]);
+      values[4] += lambda[0] * (x[0] * x[3]);
+      values[6] += lambda[0] * (x[1] * x[2]);
+      values[7] += lambda[0] * (x[0] * x[2]);
+      values[8] += lambda[0] * (x[0] * x[1]);
+
+      values[0] += lambda[1] * 2;
+      values[2] += lambda[1] * 2;
+      values[5] += lambda[1] * 2;
+      values[9] += lambda[1] * 2;
+    }
+    return true;
+  }
+
+  virtual void finalize_solution(SolverReturn status,
+                                 Index n, const Number* x,
+                                 const Number* z_L, const Number* z_U,
+                                 Index m, const Number* g,
+                                 const Number* lambda,
+                                 Number obj_value,
+                                 const IpoptData* ip_data,
+                                 IpoptCalculatedQuantities* ip_cq)
+  {}
+};
+
+/** Chained Rosenbrock function with n variables and the equality
+ *  constraints of LukVlE1 (n-2 constraints) */
+class ChainedNLP : public TNLP
+{
+public:
+  ChainedNLP(Index n)
+      : n_(n)
+  {}
+
+  virtual bool get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
+                            Index& nnz_h_lag, IndexStyleEnum& index_style)
+  {
+    n = n_;
+    m = n_-2;
+    nnz_jac_g = 3*(n_-2);
+    nnz_h_lag = 2*n_-1;
+    index_style = C_STYLE;
+    return true;
+  }
+
+  virtual bool get_bounds_info(Index n, Number* x_l, Number* x_u,
+                               Index m, Number* g_l, Number* g_u)
+  {
+    for (Index i=0; i<n; i++) {
+      x_l[i] = -1e20;
+      x_u[i] = 1e20;
+    }
+    for (Index j=0; j<m; j++) {
+      g_l[j] = g_u[j] = 0.;
+    }
+    return true;
+  }
+
+  virtual bool get_starting_point(Index n, bool init_x, Number* x,
+                                  bool init_z, Number* z_L, Number* z_U,
+                                  Index m, bool init_lambda,
+                                  Number* lambda)
+  {
+    for (Index i=0; i<n; i++) {
+      x[i] = (i%2 == 0) ? -1.2 : 1.;
+    }
+    return true;
+  }
+
+  virtual bool eval_f(Index n, const Number* x, bool new_x,
+                      Number& obj_value)
+  {
+    obj_value = 0.;
+    for (Index i=0; i<n-1; i++) {
+      const Number a = x[i]*x[i] - x[i+1];
+      const Number b = x[i] - 1.;
+      obj_value += 100.*a*a + b*b;
+    }
+    return true;
+  }
+
+  virtual bool eval_grad_f(Index n, const Number* x, bool new_x,
+                           Number* grad_f)
+  {
+    for (Index i=0; i<n; i++) {
+      grad_f[i] = 0.;
+    }
+    for (Index i=0; i<n-1; i++) {
+      const Number a = x[i]*x[i] - x[i+1];
+      grad_f[i] += 400.*x[i]*a + 2.*(x[i] - 1.);
+      grad_f[i+1] -= 200.*a;
+    }
+    return true;
+  }
+
+  virtual bool eval_g(Index n, const Number* x, bool new_x, Index m,
+                      Number* g)
+  {
+    for (Index j=0; j<m; j++) {
+      g[j] = 3.*x[j+1]*x[j+1]*x[j+1] + 2.*x[j+2] - 5. +
+             sin(x[j+1]-x[j+2])*sin(x[j+1]+x[j+2]) + 4.*x[j+1] -
+             x[j]*exp(x[j]-x[j+1]) - 3.;
+    }
+    return true;
+  }
+
+  virtual bool eval_jac_g(Index n, const Number* x, bool new_x,
+                          Index m, Index nele_jac, Index* iRow,
+                          Index *jCol, Number* values)
+  {
+    if (values == NULL) {
+      for (Index j=0; j<m; j++) {
+        for (Index k=0; k<3; k++) {
+          iRow[3*j+k] = j;
+          jCol[3*j+k] = j+k;
+        }
+      }
+    }
+    else {
+      for (Index j=0; j<m; j++) {
+        const Number e = exp(x[j]-x[j+1]);
+        const Number sm = sin(x[j+1]-x[j+2]);
+        const Number sp = sin(x[j+1]+x[j+2]);
+        const Number cm = cos(x[j+1]-x[j+2]);
+        const Number cp = cos(x[j+1]+x[j+2]);
+        values[3*j] = -e - x[j]*e;
+        values[3*j+1] = 9.*x[j+1]*x[j+1] + cm*sp + sm*cp + 4. + x[j]*e;
+        values[3*j+2] = 2. - cm*sp + sm*cp;
+      }
+    }
+    return true;
+  }
+
+  virtual bool eval_h(Index n, const Number* x, bool new_x,
+                      Number obj_factor, Index m, const Number* lambda,
+                      bool new_lambda, Index nele_hess, Index* iRow,
+                      Index* jCol, Number* values)
+  {
+    // Solved with the quasi-Newton approximation only
+    return false;
+  }
+
+  virtual void finalize_solution(SolverReturn status,
+                                 Index n, const Number* x,
+                                 const Number* z_L, const Number* z_U,
+                                 Index m, const Number* g,
+                                 const Number* lambda,
+                                 Number obj_value,
+                                 const IpoptData* ip_data,
+                                 IpoptCalculatedQuantities* ip_cq)
+  {}
+
+private:
+  Index n_;
+};
+
+/** Solve the NLP num_solves times and report lookups and time */
+static bool SolveRepeatedly(const char* name, SmartPtr<TNLP> nlp,
+                            bool limited_memory, Index num_solves)
+{
+  SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+  app->Options()->SetIntegerValue("print_level", 0);
+  if (limited_memory) {
+    app->Options()->SetStringValue("hessian_approximation",
+                                   "limited-memory");
+  }
+  if (app->Initialize() != Solve_Succeeded) {
+    printf("Error during initialization!\n");
+    return false;
+  }
+
+  Index iterations = 0;
+#ifdef IP_CACHE_STATISTICS
+  CachedResultsStatistics::Reset();
+#endif
+  Number start = WallclockTime();
+  for (Index k=0; k<num_solves; k++) {
+    ApplicationReturnStatus status = app->OptimizeTNLP(nlp);
+    if (status != Solve_Succeeded && status != Solved_To_Acceptable_Level) {
+      printf("Solve of %s failed with status %d!\n", name, status);
+      return false;
+    }
+    iterations += app->Statistics()->IterationCount();
+  }
+  const Number elapsed = WallclockTime() - start;
+#ifdef IP_CACHE_STATISTICS
+  const Number lookups = (Number)CachedResultsStatistics::NumLookups();
+  const Number hits = (Number)CachedResultsStatistics::NumHits();
+  printf("%-16s %8.1f %12.0f %10.1f %8.1f %12.3f\n", name,
+         (Number)iterations/num_solves, lookups/num_solves,
+         lookups/Max(iterations, 1), 100.*hits/Max(lookups, 1.),
+         1e3*elapsed/num_solves);
+#else
+  printf("%-16s %8.1f %12s %10s %8s %12.3f\n", name,
+         (Number)iterations/num_solves, "-", "-", "-",
+         1e3*elapsed/num_solves);
+#endif
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  Index num_solves = 200;
+  Number min_seconds = 0.5;
+  if (argc > 1) {
+    num_solves = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    min_seconds = atof(argv[2]);
+  }
+
+  // Part 1: lookup pattern
+  const Index num_iterations = 1000;
+  const Index num_caches = 60;
+  std::vector<char> hits_ref;
+  std::vector<char> hits_flat;
+  Number sum_ref;
+  Number sum_flat;
+  const Number t_ref =
+    TimePattern<ReferenceCache>(num_iterations, num_caches, hits_ref,
+                                sum_ref, min_seconds);
+  const Number t_flat =
+    TimePattern<FlatCache>(num_iterations, num_caches, hits_flat,
+                           sum_flat, min_seconds);
+  Index num_hits = 0;
+  for (size_t i=0; i<hits_flat.size(); i++) {
+    num_hits += hits_flat[i];
+  }
+  const Number nlookups = (Number)hits_flat.size();
+  printf("Lookup pattern: %d caches, %d iterations, %.0f lookups (%.1f%% hits)\n",
+         num_caches, num_iterations, nlookups, 100.*num_hits/nlookups);
+  printf("  std::list reference: %8.1f ns per lookup\n", 1e9*t_ref/nlookups);
+  printf("  CachedResults:       %8.1f ns per lookup (speedup %.2f)\n\n",
+         1e9*t_flat/nlookups, t_ref/t_flat);
+  const bool identical = (hits_ref == hits_flat && sum_ref == sum_flat);
+  if (!identical) {
+    printf("Hits of CachedResults differ from the reference!\n\n");
+  }
+
+  // Part 2: lookups per solve for small NLPs
+  printf("%-16s %8s %12s %10s %8s %12s\n", "problem", "iter",
+         "lookups", "per iter", "hits %", "ms per solve");
+  bool all_solved = true;
+  all_solved &= SolveRepeatedly("hs071", new HS071NLP(), false, num_solves);
+  all_solved &= SolveRepeatedly("hs071 (L-BFGS)", new HS071NLP(), true,
+                                num_solves);
+  all_solved &= SolveRepeatedly("chained n=10", new ChainedNLP(10), true,
+                                num_solves);
+  all_solved &= SolveRepeatedly("chained n=100", new ChainedNLP(100), true,
+                                num_solves/10 > 0 ? num_solves/10 : 1);
+
+  return (identical && all_solved) ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "IpIpoptApplication.hpp"
+#include "AmplExprTape.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+using namespace Ipopt;
+
+namespace
+{
+  const Index n_vars = 3;
+
+  /** Builds a tape with four functions of three variables:
+   *
+   *  f0 = exp(x0*x1) + log(x2) + 2*x0
+   *  f1 = x0*x1/(1+x2^2) + sin(x1)*cos(x0)
+   *  f2 = x0^x2 + sqrt(x1) + atan2(x0, x1)
+   *  f3 = tanh(x0 + x1 - 0.5*x2) - x1
+   *
+   *  x0*x1 is added twice and must be shared. */
+  SmartPtr<ExprTape> buildTape()
+  {
+    SmartPtr<ExprTape> tape = new ExprTape(n_vars);
+    const Index x0 = tape->AddVariable(0);
+    const Index x1 = tape->AddVariable(1);
+    const Index x2 = tape->AddVariable(2);
+    const Index prod = tape->AddNode(ExprTape::OP_MUL, x0, x1);
+    assert(tape->AddNode(ExprTape::OP_MUL, x0, x1) == prod);
+
+    std::vector<Index> args(2);
+    std::vector<Number> coefs(2, 1.);
+    std::vector<Index> lin_vars;
+    std::vector<Number> lin_coefs;
+
+    args[0] = tape->AddNode(ExprTape::OP_EXP, prod);
+    args[1] = tape->AddNode(ExprTape::OP_LOG, x2);
+    lin_vars.push_back(0);
+    lin_coefs.push_back(2.);
+    tape->AddFunction(tape->AddSum(args, coefs), lin_vars, lin_coefs);
+
+    std::vector<Index> den(1, tape->AddNode(ExprTape::OP_POWC, x2, -1, -1, 2.));
+    std::vector<Number> one(1, 1.);
+    args[0] = tape->AddNode(ExprTape::OP_DIV, tape->AddNode(ExprTape::OP_MUL, x0, x1),
+                            tape->AddSum(den, one, 1.));
+    args[1] = tape->AddNode(ExprTape::OP_MUL, tape->AddNode(ExprTape::OP_SIN, x1),
+                            tape->AddNode(ExprTape::OP_COS, x0));
+    lin_vars.clear();
+    lin_coefs.clear();
+    tape->AddFunction(tape->AddSum(args, coefs), lin_vars, lin_coefs);
+
+    std::vector<Index> args3(3);
+    std::vector<Number> coefs3(3, 1.);
+    args3[0] = tape->AddNode(ExprTape::OP_POW, x0, x2);
+    args3[1] = tape->AddNode(ExprTape::OP_SQRT, x1);
+    args3[2] = tape->AddNode(ExprTape::OP_ATAN2, x0, x1);
+    tape->AddFunction(tape->AddSum(args3, coefs3), lin_vars, lin_coefs);
+
+    args3[0] = x0;
+    args3[1] = x1;
+    args3[2] = x2;
+    coefs3[2] = -0.5;
+    lin_vars.push_back(1);
+    lin_coefs.push_back(-1.);
+    tape->AddFunction(tape->AddNode(ExprTape::OP_TANH, tape->AddSum(args3, coefs3)),
+                      lin_vars, lin_coefs);
+
+    tape->Finalize();
+    return tape;
+  }
+
+  /** The functions of the tape, evaluated directly */
+  Number directValue(Index f, const Number* x)
+  {
+    switch (f) {
+    case 0:
+      return exp(x[0]*x[1]) + log(x[2]) + 2.*x[0];
+    case 1:
+      return x[0]*x[1]/(1. + x[2]*x[2]) + sin(x[1])*cos(x[0]);
+    case 2:
+      return pow(x[0], x[2]) + sqrt(x[1]) + atan2(x[0], x[1]);
+    default:
+      return tanh(x[0] + x[1] - 0.5*x[2]) - x[1];
+    }
+  }
+
+  /** Dense gradient of the sum of weights[f]*f at x from the tape */
+  void denseGradient(const ExprTape& tape, const Number* weights,
+                     const Number* x, ExprTapeWorkspace& ws, Number* grad)
+  {
+    std::vector<Number> fgrad(n_vars);
+    for (Index j=0; j<n_vars; j++) {
+      grad[j] = 0.;
+    }
+    tape.Forward(x, ws);
+    for (Index f=0; f<tape.NumFunctions(); f++) {
+      tape.FunctionGradient(f, ws, &fgrad[0]);
+      const Index* vars = tape.FunctionVariables(f);
+      for (Index k=0; k<tape.FunctionNumVariables(f); k++) {
+        grad[vars[k]] += weights[f]*fgrad[k];
+      }
+    }
+  }
+
+  bool close(Number a, Number b, Number tol)
+  {
+    return fabs(a - b) <= tol*(1. + fabs(b));
+  }
+}
+
+void ExprTapeTest(IpoptApplication& app)
+{
+  SmartPtr<ExprTape> tape = buildTape();
+  assert(tape->NumFunctions() == 4);
+  SmartPtr<ExprTapeWorkspace> ws = tape->MakeWorkspace();
+
+  const Number x[n_vars] = {0.7, 1.3, 1.9};
+  const Number h = 1e-6;
+  const Number tol = 1e-6;
+
+  // Values
+  tape->Forward(x, *ws);
+  for (Index f=0; f<tape->NumFunctions(); f++) {
+    assert(close(tape->FunctionValue(f, x, *ws), directValue(f, x), 1e-14));
+  }
+
+  // Gradients against central differences of the values
+  for (Index f=0; f<tape->NumFunctions(); f++) {
+    std::vector<Number> grad(tape->FunctionNumVariables(f));
+    tape->Forward(x, *ws);
+    tape->FunctionGradient(f, *ws, &grad[0]);
+    const Index* vars = tape->FunctionVariables(f);
+    std::vector<bool> depends(n_vars, false);
+    for (Index k=0; k<tape->FunctionNumVariables(f); k++) {
+      depends[vars[k]] = true;
+      Number xp[n_vars] = {x[0], x[1], x[2]};
+      Number xm[n_vars] = {x[0], x[1], x[2]};
+      xp[vars[k]] += h;
+      xm[vars[k]] -= h;
+      const Number fd = (directValue(f, xp) - directValue(f, xm))/(2.*h);
+      assert(close(grad[k], fd, tol));
+    }
+    for (Index j=0; j<n_vars; j++) {
+      assert(depends[j]);
+    }
+
+    // Evaluating only the subtape of f gives the same results
+    std::vector<Number> grad_f(tape->FunctionNumVariables(f));
+    tape->EvalFunctionGradient(f, x, *ws, &grad_f[0]);
+    for (Index k=0; k<tape->FunctionNumVariables(f); k++) {
+      assert(close(grad_f[k], grad[k], 1e-14));
+    }
+    assert(close(tape->EvalFunction(f, x, *ws), directValue(f, x), 1e-14));
+  }
+
+  // Hessian of the Lagrangian against central differences of the
+  // gradients computed on the tape
+  const Number weights[4] = {1.5, -0.5, 2., 0.75};
+  const Index nnz = tape->NumHessianNonzeros();
+  std::vector<Index> iRow(nnz), jCol(nnz);
+  tape->HessianStructure(&iRow[0], &jCol[0]);
+  std::vector<Number> values(nnz);
+  tape->Forward(x, *ws);
+  tape->HessianValues(weights, *ws, &values[0]);
+
+  std::vector<Number> dense(n_vars*n_vars, 0.);
+  for (Index k=0; k<nnz; k++) {
+    assert(iRow[k] >= jCol[k] && jCol[k] >= 0 && iRow[k] < n_vars);
+    dense[iRow[k]*n_vars + jCol[k]] += values[k];
+  }
+  for (Index j=0; j<n_vars; j++) {
+    Number xp[n_vars] = {x[0], x[1], x[2]};
+    Number xm[n_vars] = {x[0], x[1], x[2]};
+    xp[j] += h;
+    xm[j] -= h;
+    Number gp[n_vars], gm[n_vars];
+    denseGradient(*tape, weights, xp, *ws, gp);
+    denseGradient(*tape, weights, xm, *ws, gm);
+    for (Index i=j; i<n_vars; i++) {
+      const Number fd = (gp[i] - gm[i])/(2.*h);
+      assert(close(dense[i*n_vars + j], fd, tol));
+    }
+  }
+
+  // Workspaces are independent: a second one at another point does
+  // not change the results of the first
+  const Number y[n_vars] = {1.1, 0.4, 2.5};
+  SmartPtr<ExprTapeWorkspace> ws2 = tape->MakeWorkspace();
+  tape->Forward(x, *ws);
+  tape->Forward(y, *ws2);
+  for (Index f=0; f<tape->NumFunctions(); f++) {
+    assert(close(tape->FunctionValue(f, x, *ws), directValue(f, x), 1e-14));
+    assert(close(tape->FunctionValue(f, y, *ws2), directValue(f, y), 1e-14));
+  }
+}
@@ -0,0 +1,365 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "IpIpoptApplication.hpp"
+#include "IpTNLPAdapter.hpp"
+#include "IpDenseVector.hpp"
+#include "IpGenTMatrix.hpp"
+#include "IpSymTMatrix.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+using namespace Ipopt;
+
+namespace
+{
+  const Index n_vars = 7;
+  const Index n_cons = 5;
+
+  /** Thrown by ChainTNLP::eval_g */
+  class EvalError
+  {};
+
+  /** min sum_{i<6} x_i^2 x_{i+1} + x6^2 s.t.
+   *
+   *  g_i = x_i x_{i+1}^2 + sin(x_{i+2}),  i=0,...,4
+   *
+   *  with g0 and g2 equalities, the others inequalities.  Each
+   *  constraint depends on three consecutive variables, so that the
+   *  Jacobian columns need three groups.  x6 is fixed, and x5 has an
+   *  upper bound at the evaluation point. */
+  class ChainTNLP : public TNLP
+  {
+  public:
+    Index n_eval_g;
+    /** eval_g throws an EvalError in the call with this number */
+    Index throw_at_eval_g;
+
+    ChainTNLP()
+        :
+        n_eval_g(0),
+        throw_at_eval_g(-1)
+    {}
+
+    virtual bool get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
+                              Index& nnz_h_lag, IndexStyleEnum& index_style)
+    {
+      n = n_vars;
+      m = n_cons;
+      nnz_jac_g = 3*n_cons;
+      nnz_h_lag = 3*n_vars - 3;
+      index_style = C_STYLE;
+      return true;
+    }
+
+    virtual bool get_bounds_info(Index n, Number* x_l, Number* x_u,
+                                 Index m, Number* g_l, Number* g_u)
+    {
+      for (Index i=0; i<n; i++) {
+        x_l[i] = -10.;
+        x_u[i] = 10.;
+      }
+      x_u[5] = 1.;
+      x_l[6] = x_u[6] = 0.8;
+      for (Index i=0; i<m; i++) {
+        g_l[i] = -2e19;
+        g_u[i] = 5.;
+      }
+      g_l[0] = g_u[0] = 0.;
+      g_l[2] = g_u[2] = 0.;
+      return true;
+    }
+
+    virtual bool get_starting_point(Index n, bool init_x, Number* x,
+                                    bool init_z, Number* z_L, Number* z_U,
+                                    Index m, bool init_lambda, Number* lambda)
+    {
+      for (Index i=0; i<n; i++) {
+        x[i] = 0.5;
+      }
+      return true;
+    }
+
+    virtual bool eval_f(Index n, const Number* x, bool new_x,
+                        Number& obj_value)
+    {
+      obj_value = x[6]*x[6];
+      for (Index i=0; i<n-1; i++) {
+        obj_value += x[i]*x[i]*x[i+1];
+      }
+      return true;
+    }
+
+    virtual bool eval_grad_f(Index n, const Number* x, bool new_x,
+                             Number* grad_f)
+    {
+      for (Index i=0; i<n; i++) {
+        grad_f[i] = 0.;
+      }
+      grad_f[6] = 2.*x[6];
+      for (Index i=0; i<n-1; i++) {
+        grad_f[i] += 2.*x[i]*x[i+1];
+        grad_f[i+1] += x[i]*x[i];
+      }
+      return true;
+    }
+
+    virtual bool eval_g(Index n, const Number* x, bool new_x,
+                        Index m, Number* g)
+    {
+      n_eval_g++;
+      if (n_eval_g == throw_at_eval_g) {
+        throw EvalError();
+      }
+      for (Index i=0; i<m; i++) {
+        g[i] = x[i]*x[i+1]*x[i+1] + sin(x[i+2]);
+      }
+      return true;
+    }
+
+    virtual bool eval_jac_g(Index n, const Number* x, bool new_x,
+                            Index m, Index nele_jac, Index* iRow,
+                            Index *jCol, Number* values)
+    {
+      for (Index i=0; i<m; i++) {
+        if (values) {
+          values[3*i] = x[i+1]*x[i+1];
+          values[3*i+1] = 2.*x[i]*x[i+1];
+          values[3*i+2] = cos(x[i+2]);
+        }
+        else {
+          for (Index k=0; k<3; k++) {
+            iRow[3*i+k] = i;
+            jCol[3*i+k] = i+k;
+          }
+        }
+      }
+      return true;
+    }
+
+    /** Entries (i,i), (i+1,i) and (i+2,i) of the lower triangle */
+    virtual bool eval_h(Index n, const Number* x, bool new_x,
+                        Number obj_factor, Index m, const Number* lambda,
+                        bool new_lambda, Index nele_hess,
+                        Index* iRow, Index* jCol, Number* values)
+    {
+      if (!values) {
+        Index k = 0;
+        for (Index j=0; j<n; j++) {
+          for (Index i=j; i<n && i<=j+2; i++) {
+            iRow[k] = i;
+            jCol[k] = j;
+            k++;
+          }
+        }
+        return true;
+      }
+
+      std::vector<Number> dense(n*n, 0.);
+      dense[6*n+6] = 2.*obj_factor;
+      for (Index i=0; i<n-1; i++) {
+        dense[i*n+i] += 2.*obj_factor*x[i+1];
+        dense[(i+1)*n+i] += 2.*obj_factor*x[i];
+      }
+      for (Index i=0; i<m; i++) {
+        dense[(i+1)*n+i] += 2.*lambda[i]*x[i+1];
+        dense[(i+1)*n+i+1] += 2.*lambda[i]*x[i];
+        dense[(i+2)*n+i+2] -= lambda[i]*sin(x[i+2]);
+      }
+      Index k = 0;
+      for (Index j=0; j<n; j++) {
+        for (Index i=j; i<n && i<=j+2; i++) {
+          values[k++] = dense[i*n+j];
+        }
+      }
+      return true;
+    }
+
+    virtual void finalize_solution(SolverReturn status,
+                                   Index n, const Number* x,
+                                   const Number* z_L, const Number* z_U,
+                                   Index m, const Number* g,
+                                   const Number* lambda, Number obj_value,
+                                   const IpoptData* ip_data,
+                                   IpoptCalculatedQuantities* ip_cq)
+    {}
+  };
+
+  /** Adapter for tnlp with the given options and its spaces */
+  class Setup
+  {
+  public:
+    SmartPtr<TNLPAdapter> adapter;
+    SmartPtr<const VectorSpace> x_space, c_space, d_space, x_l_space,
+    x_u_space, d_l_space, d_u_space;
+    SmartPtr<const MatrixSpace> px_l_space, px_u_space, pd_l_space,
+    pd_u_space, Jac_c_space, Jac_d_space;
+    SmartPtr<const SymMatrixSpace> Hess_lagrangian_space;
+
+    Setup(IpoptApplication& app, ChainTNLP* tnlp, OptionsList& options)
+    {
+      adapter = new TNLPAdapter(tnlp, ConstPtr(app.Jnlst()));
+      bool ok = adapter->ProcessOptions(options, "");
+      assert(ok);
+      ok = adapter->GetSpaces(x_space, c_space, d_space, x_l_space,
+                              px_l_space, x_u_space, px_u_space,
+                              d_l_space, pd_l_space, d_u_space,
+                              pd_u_space, Jac_c_space, Jac_d_space,
+                              Hess_lagrangian_space);
+      assert(ok);
+      // The finite differences need the bounds of the variables
+      SmartPtr<Vector> x_l = x_l_space->MakeNew();
+      SmartPtr<Vector> x_u = x_u_space->MakeNew();
+      SmartPtr<Vector> d_l = d_l_space->MakeNew();
+      SmartPtr<Vector> d_u = d_u_space->MakeNew();
+      SmartPtr<Matrix> px_l = px_l_space->MakeNew();
+      SmartPtr<Matrix> px_u = px_u_space->MakeNew();
+      SmartPtr<Matrix> pd_l = pd_l_space->MakeNew();
+      SmartPtr<Matrix> pd_u = pd_u_space->MakeNew();
+      ok = adapter->GetBoundsInformation(*px_l, *x_l, *px_u, *x_u,
+                                         *pd_l, *d_l, *pd_u, *d_u);
+      assert(ok);
+    }
+
+    /** The evaluation point; x5 is at its upper bound */
+    SmartPtr<Vector> point()
+    {
+      SmartPtr<DenseVector> x = static_cast<DenseVector*>(x_space->MakeNew());
+      assert(x->Dim() == n_vars-1);
+      Number* values = x->Values();
+      for (Index i=0; i<n_vars-1; i++) {
+        values[i] = 0.3 + 0.1*i;
+      }
+      values[5] = 1.;
+      return GetRawPtr(x);
+    }
+
+    /** Values of the Jacobians of c and d, in this order */
+    std::vector<Number> jacobian()
+    {
+      SmartPtr<Vector> x = point();
+      SmartPtr<Matrix> jac_c = Jac_c_space->MakeNew();
+      SmartPtr<Matrix> jac_d = Jac_d_space->MakeNew();
+      bool ok = adapter->Eval_jac_c(*x, *jac_c);
+      assert(ok);
+      ok = adapter->Eval_jac_d(*x, *jac_d);
+      assert(ok);
+      const GenTMatrix* c = static_cast<const GenTMatrix*>(GetRawPtr(jac_c));
+      const GenTMatrix* d = static_cast<const GenTMatrix*>(GetRawPtr(jac_d));
+      std::vector<Number> values(c->Values(), c->Values()+c->Nonzeros());
+      values.insert(values.end(), d->Values(), d->Values()+d->Nonzeros());
+      return values;
+    }
+
+    /** Values of the Hessian of the Lagrangian */
+    std::vector<Number> hessian(Number obj_factor)
+    {
+      SmartPtr<Vector> x = point();
+      SmartPtr<DenseVector> yc = static_cast<DenseVector*>(c_space->MakeNew());
+      SmartPtr<DenseVector> yd = static_cast<DenseVector*>(d_space->MakeNew());
+      assert(yc->Dim() == 2 && yd->Dim() == 3);
+      Number* values = yc->Values();
+      values[0] = 0.7;
+      values[1] = -1.3;
+      values = yd->Values();
+      values[0] = 2.1;
+      values[1] = -0.4;
+      values[2] = 0.9;
+      SmartPtr<SymMatrix> h = Hess_lagrangian_space->MakeNewSymMatrix();
+      bool ok = adapter->Eval_h(*x, obj_factor, *yc, *yd, *h);
+      assert(ok);
+      const SymTMatrix* t = static_cast<const SymTMatrix*>(GetRawPtr(h));
+      return std::vector<Number>(t->Values(), t->Values()+t->Nonzeros());
+    }
+  };
+
+  bool close(Number a, Number b, Number tol)
+  {
+    return fabs(a - b) <= tol*(1. + fabs(b));
+  }
+}
+
+void FinDiffTest(IpoptApplication& app)
+{
+  // Finite difference Jacobian with and without grouping of the
+  // columns against the exact one
+  {
+    SmartPtr<OptionsList> options = new OptionsList(app.RegOptions(),
+        app.Jnlst());
+    SmartPtr<ChainTNLP> tnlp = new ChainTNLP();
+    Setup exact(app, GetRawPtr(tnlp), *options);
+    std::vector<Number> jac_exact = exact.jacobian();
+
+    options->SetStringValue("jacobian_approximation",
+                            "finite-difference-values");
+    Setup plain(app, GetRawPtr(tnlp), *options);
+    tnlp->n_eval_g = 0;
+    std::vector<Number> jac_plain = plain.jacobian();
+    const Index n_eval_plain = tnlp->n_eval_g;
+
+    options->SetStringValue("findiff_jac_coloring", "yes");
+    Setup colored(app, GetRawPtr(tnlp), *options);
+    tnlp->n_eval_g = 0;
+    std::vector<Number> jac_colored = colored.jacobian();
+    const Index n_eval_colored = tnlp->n_eval_g;
+
+    // One evaluation at the point, and one per perturbed variable or
+    // per group
+    assert(n_eval_plain == 1 + (n_vars-1));
+    assert(n_eval_colored == 1 + 3);
+
+    // Every constraint depends only on the variables of its entries,
+    // so grouping does not change the differences
+    assert(jac_exact.size() == jac_plain.size());
+    assert(jac_exact.size() == jac_colored.size());
+    for (size_t k=0; k<jac_exact.size(); k++) {
+      assert(jac_colored[k] == jac_plain[k]);
+      assert(close(jac_plain[k], jac_exact[k], 1e-5));
+    }
+
+    // Without threads, an exception in eval_g is passed on
+    Setup failing(app, GetRawPtr(tnlp), *options);
+    tnlp->n_eval_g = 0;
+    tnlp->throw_at_eval_g = 3;
+    bool thrown = false;
+    try {
+      failing.jacobian();
+    }
+    catch (EvalError&) {
+      thrown = true;
+    }
+    assert(thrown);
+  }
+
+  // Finite difference Hessian (star coloring) against the exact one;
+  // the entries of the fixed variable x6 are left out by both
+  {
+    SmartPtr<OptionsList> options = new OptionsList(app.RegOptions(),
+        app.Jnlst());
+    SmartPtr<ChainTNLP> tnlp = new ChainTNLP();
+    Setup exact(app, GetRawPtr(tnlp), *options);
+    options->SetStringValue("hessian_approximation",
+                            "finite-difference-values");
+    Setup findiff(app, GetRawPtr(tnlp), *options);
+
+    const Number obj_factors[2] = {1.5, 0.};
+    for (Index i=0; i<2; i++) {
+      std::vector<Number> h_exact = exact.hessian(obj_factors[i]);
+      std::vector<Number> h_findiff = findiff.hessian(obj_factors[i]);
+      assert(h_exact.size() == (size_t)(3*(n_vars-1) - 3));
+      assert(h_findiff.size() == h_exact.size());
+      for (size_t k=0; k<h_exact.size(); k++) {
+        assert(close(h_findiff[k], h_exact[k], 1e-5));
+      }
+    }
+  }
+}
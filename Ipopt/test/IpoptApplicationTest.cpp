@@ -0,0 +1,165 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "IpIpoptApplication.hpp"
+#include "IpSolveStatistics.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <sstream>
+
+using namespace Ipopt;
+
+namespace
+{
+  /** min sum_i (x_i - 1)^4 s.t. sum_i x_i^2 <= 2, which takes more
+   *  than one iteration */
+  class QuarticTNLP : public TNLP
+  {
+  public:
+    virtual bool get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
+                              Index& nnz_h_lag, IndexStyleEnum& index_style)
+    {
+      n = 3;
+      m = 1;
+      nnz_jac_g = 3;
+      nnz_h_lag = 3;
+      index_style = C_STYLE;
+      return true;
+    }
+
+    virtual bool get_bounds_info(Index n, Number* x_l, Number* x_u,
+                                 Index m, Number* g_l, Number* g_u)
+    {
+      for (Index i=0; i<n; i++) {
+        x_l[i] = -10.;
+        x_u[i] = 10.;
+      }
+      g_l[0] = -2e19;
+      g_u[0] = 2.;
+      return true;
+    }
+
+    virtual bool get_starting_point(Index n, bool init_x, Number* x,
+                                    bool init_z, Number* z_L, Number* z_U,
+                                    Index m, bool init_lambda, Number* lambda)
+    {
+      for (Index i=0; i<n; i++) {
+        x[i] = -1.;
+      }
+      return true;
+    }
+
+    virtual bool eval_f(Index n, const Number* x, bool new_x,
+                        Number& obj_value)
+    {
+      obj_value = 0.;
+      for (Index i=0; i<n; i++) {
+        obj_value += pow(x[i] - 1., 4);
+      }
+      return true;
+    }
+
+    virtual bool eval_grad_f(Index n, const Number* x, bool new_x,
+                             Number* grad_f)
+    {
+      for (Index i=0; i<n; i++) {
+        grad_f[i] = 4.*pow(x[i] - 1., 3);
+      }
+      return true;
+    }
+
+    virtual bool eval_g(Index n, const Number* x, bool new_x,
+                        Index m, Number* g)
+    {
+      g[0] = 0.;
+      for (Index i=0; i<n; i++) {
+        g[0] += x[i]*x[i];
+      }
+      return true;
+    }
+
+    virtual bool eval_jac_g(Index n, const Number* x, bool new_x,
+                            Index m, Index nele_jac, Index* iRow,
+                            Index *jCol, Number* values)
+    {
+      for (Index i=0; i<n; i++) {
+        if (values) {
+          values[i] = 2.*x[i];
+        }
+        else {
+          iRow[i] = 0;
+          jCol[i] = i;
+        }
+      }
+      return true;
+    }
+
+    virtual bool eval_h(Index n, const Number* x, bool new_x,
+                        Number obj_factor, Index m, const Number* lambda,
+                        bool new_lambda, Index nele_hess,
+                        Index* iRow, Index* jCol, Number* values)
+    {
+      for (Index i=0; i<n; i++) {
+        if (values) {
+          values[i] = obj_factor*12.*pow(x[i] - 1., 2) + 2.*lambda[0];
+        }
+        else {
+          iRow[i] = jCol[i] = i;
+        }
+      }
+      return true;
+    }
+
+    virtual void finalize_solution(SolverReturn status,
+                                   Index n, const Number* x,
+                                   const Number* z_L, const Number* z_U,
+                                   Index m, const Number* g,
+                                   const Number* lambda, Number obj_value,
+                                   const IpoptData* ip_data,
+                                   IpoptCalculatedQuantities* ip_cq)
+    {}
+  };
+}
+
+void IpoptApplicationTest(IpoptApplication& app)
+{
+  SmartPtr<IpoptApplication> solver = new IpoptApplication(false);
+  std::istringstream options("linear_solver ldl\n"
+                             "print_level 0\n");
+  ApplicationReturnStatus status = solver->Initialize(options);
+  assert(status == Solve_Succeeded);
+  SmartPtr<TNLP> tnlp = new QuarticTNLP();
+
+  // Values for single solves apply to all kinds of solves, but do not
+  // change the options
+  Index max_iter;
+  solver->SetSolveIntegerValue("max_iter", 1);
+  status = solver->OptimizeTNLP(tnlp);
+  assert(status == Maximum_Iterations_Exceeded);
+  assert(solver->Statistics()->IterationCount() == 1);
+  assert(!solver->Options()->GetIntegerValue("max_iter", max_iter, ""));
+
+  solver->Options()->SetStringValue("warm_start_reuse_structure", "yes");
+  status = solver->ReOptimizeTNLP(tnlp);
+  assert(status == Maximum_Iterations_Exceeded);
+  assert(!solver->Options()->GetIntegerValue("max_iter", max_iter, ""));
+
+  solver->Options()->SetStringValue("warm_start_reuse_structure", "no");
+  status = solver->ReOptimizeTNLP(tnlp);
+  assert(status == Maximum_Iterations_Exceeded);
+  assert(!solver->Options()->GetIntegerValue("max_iter", max_iter, ""));
+
+  // and are gone once cleared
+  solver->ClearSolveIntegerValues();
+  status = solver->OptimizeTNLP(tnlp);
+  assert(status == Solve_Succeeded);
+  assert(solver->Statistics()->IterationCount() > 1);
+}
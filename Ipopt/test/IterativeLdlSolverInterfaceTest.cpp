@@ -0,0 +1,232 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "IpIpoptApplication.hpp"
+#include "IpIterativeLdlSolverInterface.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+using namespace Ipopt;
+
+namespace
+{
+  /** Termination tester that never stops the iterations, so that
+   *  the solver runs until the relative residual tolerance is
+   *  reached, and that counts the solves */
+  class CountingTester : public IterativeSolverTerminationTester
+  {
+  public:
+    Index n_solves;
+    Index iterations;
+
+    CountingTester()
+        :
+        n_solves(0),
+        iterations(0)
+    {}
+
+    virtual bool InitializeImpl(const OptionsList& options,
+                                const std::string& prefix)
+    {
+      return true;
+    }
+
+    virtual bool InitializeSolve()
+    {
+      n_solves++;
+      iterations = 0;
+      return true;
+    }
+
+    virtual ETerminationTest TestTermination(Index ndim, const Number* sol,
+        const Number* resid, Index iter,
+        Number norm2_rhs)
+    {
+      iterations = iter;
+      return CONTINUE;
+    }
+
+    virtual void Clear()
+    {}
+
+    virtual Index GetSolverIterations() const
+    {
+      return iterations;
+    }
+  };
+
+  /** KKT system [H A^T; A 0] with a positive definite tridiagonal H
+   *  of dimension n and m sparse constraint rows, in the upper
+   *  triangular CSR format of the solver (1-based, with all diagonal
+   *  entries) */
+  class KktSystem
+  {
+  public:
+    static const Index n = 40;
+    static const Index m = 12;
+    std::vector<Index> ia;
+    std::vector<Index> ja;
+    std::vector<Number> a;
+
+    KktSystem()
+    {
+      for (Index i=0; i<n+m; i++) {
+        ia.push_back((Index)ja.size() + 1);
+        add(i, i, i<n ? 4. + 0.1*i : 0.);
+        if (i<n-1) {
+          add(i, i+1, -1.);
+        }
+        // Column i of A^T, i.e., the entries of the constraint rows
+        // with variable i
+        for (Index k=0; k<m && i<n; k++) {
+          if (i == k || i == k+m || i == (7*k+3)%n) {
+            add(i, n+k, 1. + 0.05*k - 0.02*i);
+          }
+        }
+      }
+      ia.push_back((Index)ja.size() + 1);
+    }
+
+    /** y = K x */
+    void mult(const std::vector<Number>& x, std::vector<Number>& y) const
+    {
+      y.assign(n+m, 0.);
+      for (Index i=0; i<n+m; i++) {
+        for (Index p=ia[i]-1; p<ia[i+1]-1; p++) {
+          const Index j = ja[p]-1;
+          y[i] += a[p]*x[j];
+          if (j != i) {
+            y[j] += a[p]*x[i];
+          }
+        }
+      }
+    }
+
+  private:
+    void add(Index i, Index j, Number val)
+    {
+      ja.push_back(j+1);
+      a.push_back(val);
+    }
+  };
+
+  /** Solve K x = K x_true with the given options and the
+   *  primal-dual tester (which the solver keeps a SmartPtr to),
+   *  return the status and the maximal error of the solution */
+  ESymSolverStatus solve(IpoptApplication& app, const std::string& opts,
+                         CountingTester& tester, bool check_negevals,
+                         Index numberOfNegEVals, Number& error,
+                         Index& negevals)
+  {
+    SmartPtr<OptionsList> options =
+      new OptionsList(app.RegOptions(), app.Jnlst());
+    std::istringstream is(opts);
+    bool ok = options->ReadFromStream(*app.Jnlst(), is);
+    assert(ok);
+
+    SmartPtr<CountingTester> normal_tester = new CountingTester();
+    SmartPtr<IterativeLdlSolverInterface> solver =
+      new IterativeLdlSolverInterface(*normal_tester, tester);
+    ok = solver->ReducedInitialize(*app.Jnlst(), *options, "");
+    assert(ok);
+
+    KktSystem K;
+    const Index dim = K.n + K.m;
+    ESymSolverStatus status =
+      solver->InitializeStructure(dim, (Index)K.a.size(), &K.ia[0], &K.ja[0]);
+    assert(status == SYMSOLVER_SUCCESS);
+    double* vals = solver->GetValuesArrayPtr();
+    for (Index k=0; k<(Index)K.a.size(); k++) {
+      vals[k] = K.a[k];
+    }
+
+    std::vector<Number> x_true(dim);
+    for (Index i=0; i<dim; i++) {
+      x_true[i] = sin(1. + i);
+    }
+    std::vector<Number> rhs;
+    K.mult(x_true, rhs);
+    status = solver->MultiSolve(true, &K.ia[0], &K.ja[0], 1, &rhs[0],
+                                check_negevals, numberOfNegEVals);
+    error = 0.;
+    for (Index i=0; i<dim; i++) {
+      error = Max(error, fabs(rhs[i] - x_true[i]));
+    }
+    negevals = solver->NumberOfNegEVals();
+    assert(normal_tester->n_solves == 0);
+    return status;
+  }
+}
+
+void IterativeLdlSolverInterfaceTest(IpoptApplication& app)
+{
+  Number error;
+  Index negevals;
+  Index complete_iterations;
+
+  // Without dropping the preconditioner is the complete factorization,
+  // with the inertia of the KKT system, and SQMR converges at once
+  {
+    SmartPtr<CountingTester> tester = new CountingTester();
+    ESymSolverStatus status =
+      solve(app, "ldl_iter_dropping_factor 1e-14\n"
+            "ldl_iter_max_fill 100\n"
+            "ldl_iter_relative_tol 1e-12\n",
+            *tester, true, KktSystem::m, error, negevals);
+    assert(status == SYMSOLVER_SUCCESS);
+    assert(negevals == KktSystem::m);
+    assert(tester->n_solves == 1);
+    assert(tester->iterations <= 2);
+    assert(error <= 1e-8);
+    complete_iterations = tester->iterations;
+  }
+
+  // With the default incomplete factorization more iterations are
+  // needed for the same accuracy
+  {
+    SmartPtr<CountingTester> tester = new CountingTester();
+    ESymSolverStatus status =
+      solve(app, "ldl_iter_relative_tol 1e-12\n",
+            *tester, false, 0, error, negevals);
+    assert(status == SYMSOLVER_SUCCESS);
+    assert(tester->n_solves == 1);
+    assert(tester->iterations > complete_iterations);
+    assert(error <= 1e-6);
+  }
+
+  // Too few negative eigenvalues requested
+  {
+    SmartPtr<CountingTester> tester = new CountingTester();
+    ESymSolverStatus status =
+      solve(app, "ldl_iter_dropping_factor 1e-14\n"
+            "ldl_iter_max_fill 100\n",
+            *tester, true, KktSystem::m - 1, error, negevals);
+    assert(status == SYMSOLVER_WRONG_INERTIA);
+    assert(tester->n_solves == 0);
+  }
+
+  // If SQMR does not converge, the dropping tolerance is decreased
+  // and the system is solved again, as often as allowed
+  {
+    SmartPtr<CountingTester> tester = new CountingTester();
+    ESymSolverStatus status =
+      solve(app, "ldl_iter_dropping_factor 0.5\n"
+            "ldl_iter_max_fill 0.5\n"
+            "ldl_iter_max_iter 1\n"
+            "ldl_iter_relative_tol 1e-14\n"
+            "ldl_iter_max_droptol_corrections 2\n",
+            *tester, false, 0, error, negevals);
+    assert(status == SYMSOLVER_SUCCESS);
+    assert(tester->n_solves == 3);
+  }
+}
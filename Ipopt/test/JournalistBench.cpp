@@ -0,0 +1,141 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+//
+// Benchmark for the cost of suppressed output.  A Journalist with a
+// console journal and a file journal (both at J_NONE, as in a
+// Bonmin run with print_level 0, except for one category) receives
+// Printf, PrintfIndented and ProduceOutput calls at levels that are
+// not printed.  The same calls are timed on a reference journalist
+// that asks every journal, through the virtual IsAccepted, as
+// Ipopt's Journalist did before it kept the largest print level of
+// each category.  Finally one accepted message per call is written
+// to the file journal, to compare with the suppressed calls.
+//
+// usage: journalistBench [num_calls]
+
+#include "IpJournalist.hpp"
+#include "IpUtils.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Ipopt;
+
+/** Reference: dispatches every message to all journals. */
+class ReferenceJournalist
+{
+public:
+  void AddJournal(const SmartPtr<Journal>& jrnl)
+  {
+    journals_.push_back(jrnl);
+  }
+  void Printf(EJournalLevel level, EJournalCategory category,
+              const char* pformat, ...) const
+  {
+    va_list ap;
+    va_start(ap, pformat);
+    for (Index i=0; i<(Index)journals_.size(); i++) {
+      if (journals_[i]->IsAccepted(category, level)) {
+        journals_[i]->Printf(category, level, pformat, ap);
+      }
+    }
+    va_end(ap);
+  }
+  bool ProduceOutput(EJournalLevel level, EJournalCategory category) const
+  {
+    for (Index i=0; i<(Index)journals_.size(); i++) {
+      if (journals_[i]->IsAccepted(category, level)) {
+        return true;
+      }
+    }
+    return false;
+  }
+private:
+  std::vector< SmartPtr<Journal> > journals_;
+};
+
+int main(int argc, char** argv)
+{
+  Index num_calls = 10000000;
+  if (argc > 1) {
+    num_calls = atoi(argv[1]);
+  }
+
+  SmartPtr<FileJournal> console = new FileJournal("console", J_NONE);
+  console->Open("stdout");
+  SmartPtr<FileJournal> file = new FileJournal("file", J_NONE);
+  file->Open("journalistBench.out");
+  file->SetPrintLevel(J_STATISTICS, J_SUMMARY);
+
+  SmartPtr<Journalist> jnlst = new Journalist();
+  jnlst->AddJournal(GetRawPtr(console));
+  jnlst->AddJournal(GetRawPtr(file));
+  ReferenceJournalist reference;
+  reference.AddJournal(GetRawPtr(console));
+  reference.AddJournal(GetRawPtr(file));
+
+  const EJournalCategory categories[4] = {
+                                           J_MAIN, J_LINEAR_ALGEBRA, J_LINE_SEARCH, J_STATISTICS
+                                         };
+  Number x = 1.5;
+  Index produced = 0;
+
+  printf("%-34s %12s\n", "suppressed calls", "ns per call");
+
+  Number start = WallclockTime();
+  for (Index i=0; i<num_calls; i++) {
+    reference.Printf(J_DETAILED, categories[i&3], "%5d %23.16e\n", i, x);
+  }
+  Number ref_printf = WallclockTime() - start;
+
+  start = WallclockTime();
+  for (Index i=0; i<num_calls; i++) {
+    jnlst->Printf(J_DETAILED, categories[i&3], "%5d %23.16e\n", i, x);
+  }
+  Number new_printf = WallclockTime() - start;
+
+  start = WallclockTime();
+  for (Index i=0; i<num_calls; i++) {
+    jnlst->PrintfIndented(J_DETAILED, categories[i&3], 2,
+                          "%5d %23.16e\n", i, x);
+  }
+  Number new_indented = WallclockTime() - start;
+
+  start = WallclockTime();
+  for (Index i=0; i<num_calls; i++) {
+    produced += reference.ProduceOutput(J_MOREDETAILED, categories[i&3]);
+  }
+  Number ref_produce = WallclockTime() - start;
+
+  start = WallclockTime();
+  for (Index i=0; i<num_calls; i++) {
+    produced += jnlst->ProduceOutput(J_MOREDETAILED, categories[i&3]);
+  }
+  Number new_produce = WallclockTime() - start;
+
+  Index num_printed = num_calls/100 + 1;
+  start = WallclockTime();
+  for (Index i=0; i<num_printed; i++) {
+    jnlst->Printf(J_SUMMARY, J_STATISTICS, "%5d %23.16e\n", i, x);
+  }
+  Number printed = WallclockTime() - start;
+
+  printf("%-34s %12.2f\n", "Printf, all journals asked", 1e9*ref_printf/num_calls);
+  printf("%-34s %12.2f\n", "Printf", 1e9*new_printf/num_calls);
+  printf("%-34s %12.2f\n", "PrintfIndented", 1e9*new_indented/num_calls);
+  printf("%-34s %12.2f\n", "ProduceOutput, all journals asked", 1e9*ref_produce/num_calls);
+  printf("%-34s %12.2f\n", "ProduceOutput", 1e9*new_produce/num_calls);
+  printf("%-34s %12.2f\n", "Printf written to file", 1e9*printed/num_printed);
+  if (produced != 0) {
+    printf("error: suppressed output was produced\n");
+    return 1;
+  }
+
+  jnlst->DeleteAllJournals();
+  remove("journalistBench.out");
+  return 0;
+}
@@ -0,0 +1,331 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "IpIpoptApplication.hpp"
+#include "IpLdlSolverInterface.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+using namespace Ipopt;
+
+namespace
+{
+  /** Solver initialized with the options in opts */
+  SmartPtr<LdlSolverInterface> makeSolver(IpoptApplication& app,
+                                          const std::string& opts)
+  {
+    SmartPtr<OptionsList> options =
+      new OptionsList(app.RegOptions(), app.Jnlst());
+    std::istringstream is(opts);
+    bool ok = options->ReadFromStream(*app.Jnlst(), is);
+    assert(ok);
+    SmartPtr<LdlSolverInterface> ldl = new LdlSolverInterface();
+    ok = ldl->ReducedInitialize(*app.Jnlst(), *options, "");
+    assert(ok);
+    return ldl;
+  }
+
+  /** Factorize the matrix given by the triplets (1-based) and solve
+   *  for the right hand side rhs, which is overwritten by the
+   *  solution. */
+  ESymSolverStatus solve(IpoptApplication& app, Index dim,
+                         const std::vector<Index>& irn,
+                         const std::vector<Index>& jcn,
+                         const std::vector<Number>& val,
+                         std::vector<Number>& rhs, Index& negevals)
+  {
+    SmartPtr<LdlSolverInterface> ldl = makeSolver(app, "");
+    const Index nnz = (Index)val.size();
+    ESymSolverStatus status =
+      ldl->InitializeStructure(dim, nnz, &irn[0], &jcn[0]);
+    assert(status == SYMSOLVER_SUCCESS);
+    double* a = ldl->GetValuesArrayPtr();
+    for (Index k=0; k<nnz; k++) {
+      a[k] = val[k];
+    }
+    status = ldl->MultiSolve(true, &irn[0], &jcn[0], 1, &rhs[0], false, 0);
+    negevals = ldl->NumberOfNegEVals();
+    return status;
+  }
+
+  /** Symmetric matrix with the lower triangle in triplet format
+   *  (1-based) */
+  class Triplets
+  {
+  public:
+    Index dim;
+    std::vector<Index> irn;
+    std::vector<Index> jcn;
+    std::vector<Number> val;
+
+    explicit Triplets(Index n)
+        :
+        dim(n)
+    {}
+
+    /** Add the entry (i,j) with i >= j (0-based) */
+    void add(Index i, Index j, Number v)
+    {
+      irn.push_back(i+1);
+      jcn.push_back(j+1);
+      val.push_back(v);
+    }
+
+    /** y = A x */
+    void mult(const std::vector<Number>& x, std::vector<Number>& y) const
+    {
+      y.assign(dim, 0.);
+      for (Index k=0; k<(Index)val.size(); k++) {
+        const Index i = irn[k]-1;
+        const Index j = jcn[k]-1;
+        y[i] += val[k]*x[j];
+        if (i != j) {
+          y[j] += val[k]*x[i];
+        }
+      }
+    }
+  };
+
+  /** Set up ldl for the structure of A */
+  void initStructure(LdlSolverInterface& ldl, const Triplets& A)
+  {
+    ESymSolverStatus status =
+      ldl.InitializeStructure(A.dim, (Index)A.val.size(), &A.irn[0],
+                              &A.jcn[0]);
+    assert(status == SYMSOLVER_SUCCESS);
+  }
+
+  /** Pass the values of A to ldl (if new_matrix), solve A x = A x_true
+   *  and return the status, the solution and its maximal error */
+  ESymSolverStatus factorSolve(LdlSolverInterface& ldl, const Triplets& A,
+                               bool new_matrix, bool check_negevals,
+                               Index numberOfNegEVals,
+                               std::vector<Number>& x, Number& error)
+  {
+    if (new_matrix) {
+      double* a = ldl.GetValuesArrayPtr();
+      for (Index k=0; k<(Index)A.val.size(); k++) {
+        a[k] = A.val[k];
+      }
+    }
+    std::vector<Number> x_true(A.dim);
+    for (Index i=0; i<A.dim; i++) {
+      x_true[i] = sin(1. + i);
+    }
+    A.mult(x_true, x);
+    ESymSolverStatus status =
+      ldl.MultiSolve(new_matrix, &A.irn[0], &A.jcn[0], 1, &x[0],
+                     check_negevals, numberOfNegEVals);
+    error = 0.;
+    for (Index i=0; i<A.dim; i++) {
+      error = Max(error, fabs(x[i] - x_true[i]));
+    }
+    return status;
+  }
+
+  /** KKT system [H A^T; A 0] with n variables and m constraints.  H
+   *  is tridiagonal, and its diagonal entries with zero_mod > 0 and
+   *  i%zero_mod == 0 are zero. */
+  Triplets kktSystem(Index n, Index m, Index zero_mod)
+  {
+    Triplets K(n+m);
+    for (Index i=0; i<n; i++) {
+      const bool zero = (zero_mod > 0 && i%zero_mod == 0);
+      K.add(i, i, zero ? 0. : 4. + 0.1*i);
+      if (i < n-1) {
+        K.add(i+1, i, -1.);
+      }
+      for (Index k=0; k<m; k++) {
+        if (i == k || i == k+m || i == (7*k+3)%n) {
+          K.add(n+k, i, 1. + 0.05*k - 0.02*i);
+        }
+      }
+    }
+    return K;
+  }
+}
+
+void LdlSolverInterfaceTest(IpoptApplication& app)
+{
+  // A barrier KKT system [W+Sigma A^T; A 0] in which the barrier term of
+  // a nearly active bound (1e25) dominates the other entries by far.
+  // The zero pivot threshold has to be absolute: relative to the largest
+  // entry it would exceed the other pivots and report the (perfectly
+  // well conditioned) remaining system as singular.
+  {
+    const Index dim = 4;
+    std::vector<Index> irn, jcn;
+    std::vector<Number> val;
+    const Number diag[3] = {1e25, 1., 1.};
+    for (Index i=0; i<3; i++) {
+      irn.push_back(i+1);
+      jcn.push_back(i+1);
+      val.push_back(diag[i]);
+      irn.push_back(4);
+      jcn.push_back(i+1);
+      val.push_back(1.);
+    }
+    const Number x[4] = {1., 2., 3., 4.};
+    std::vector<Number> rhs(dim);
+    rhs[0] = diag[0]*x[0] + x[3];
+    rhs[1] = diag[1]*x[1] + x[3];
+    rhs[2] = diag[2]*x[2] + x[3];
+    rhs[3] = x[0] + x[1] + x[2];
+    Index negevals;
+    ESymSolverStatus status = solve(app, dim, irn, jcn, val, rhs, negevals);
+    assert(status == SYMSOLVER_SUCCESS);
+    assert(negevals == 1);
+    for (Index i=0; i<dim; i++) {
+      assert(fabs(rhs[i] - x[i]) <= 1e-8*(1. + fabs(x[i])));
+    }
+  }
+
+  // Singular matrices are still detected, whatever their scale
+  {
+    const Number scale[2] = {1., 1e30};
+    for (Index s=0; s<2; s++) {
+      std::vector<Index> irn, jcn;
+      std::vector<Number> val;
+      irn.push_back(1);
+      jcn.push_back(1);
+      val.push_back(scale[s]);
+      irn.push_back(2);
+      jcn.push_back(1);
+      val.push_back(scale[s]);
+      irn.push_back(2);
+      jcn.push_back(2);
+      val.push_back(scale[s]);
+      std::vector<Number> rhs(2, 1.);
+      Index negevals;
+      ESymSolverStatus status = solve(app, 2, irn, jcn, val, rhs, negevals);
+      assert(status == SYMSOLVER_SINGULAR);
+    }
+  }
+
+  std::vector<Number> x;
+  Number error;
+
+  // Without any nonzero diagonal entry, [0 B; B^T 0] can only be
+  // factorized with 2x2 pivots.  Its inertia is that of the KKT system.
+  {
+    const Index n = 6;
+    Triplets A(2*n);
+    for (Index i=0; i<n; i++) {
+      A.add(n+i, i, 2. + 0.1*i);
+      if (i > 0) {
+        A.add(n+i, i-1, -1.);
+      }
+    }
+    SmartPtr<LdlSolverInterface> ldl = makeSolver(app, "");
+    initStructure(*ldl, A);
+    ESymSolverStatus status = factorSolve(*ldl, A, true, true, n, x, error);
+    assert(status == SYMSOLVER_SUCCESS);
+    assert(ldl->NumberOfNegEVals() == n);
+    assert(error <= 1e-12);
+
+    status = factorSolve(*ldl, A, true, true, n-1, x, error);
+    assert(status == SYMSOLVER_WRONG_INERTIA);
+  }
+
+  // A column with a tiny diagonal entry and the smallest degree is
+  // eliminated first, in a front of its own.  It fails the threshold
+  // test there and is delayed to the front of the clique {1,2,3}.
+  {
+    Triplets A(4);
+    A.add(0, 0, 1e-8);
+    for (Index j=1; j<4; j++) {
+      A.add(j, j, 4.);
+      for (Index i=j+1; i<4; i++) {
+        A.add(i, j, 1.);
+      }
+    }
+    A.add(3, 0, 1.);
+    SmartPtr<LdlSolverInterface> ldl = makeSolver(app, "ldl_nemin 1\n");
+    initStructure(*ldl, A);
+    ESymSolverStatus status = factorSolve(*ldl, A, true, true, 1, x, error);
+    assert(status == SYMSOLVER_SUCCESS);
+    assert(ldl->NumberOfDelayedPivots() == 1);
+    assert(error <= 1e-8);
+  }
+
+  // With the largest pivot tolerance, columns of a KKT system are delayed
+  // across several fronts; the solution and inertia stay the same
+  {
+    Triplets K = kktSystem(40, 12, 0);
+    SmartPtr<LdlSolverInterface> ldl =
+      makeSolver(app, "ldl_nemin 1\nldl_pivtol 0.5\nldl_pivtolmax 0.5\n");
+    initStructure(*ldl, K);
+    ESymSolverStatus status = factorSolve(*ldl, K, true, true, 12, x, error);
+    assert(status == SYMSOLVER_SUCCESS);
+    assert(ldl->NumberOfDelayedPivots() > 1);
+    assert(error <= 1e-10);
+  }
+
+  // The ordering is computed with the first matrix.  Later matrices with
+  // the same structure reuse it, also if their zero diagonal entries
+  // differ, and the factorization is repeated when the pivot tolerance
+  // is increased.
+  {
+    Triplets K1 = kktSystem(40, 12, 0);
+    Triplets K2 = kktSystem(40, 12, 3);
+    SmartPtr<LdlSolverInterface> ldl = makeSolver(app, "ldl_nemin 1\n");
+    initStructure(*ldl, K1);
+    ESymSolverStatus status = factorSolve(*ldl, K1, true, true, 12, x, error);
+    assert(status == SYMSOLVER_SUCCESS);
+    assert(error <= 1e-10);
+    const std::vector<Number> x1 = x;
+
+    // The inertia of K2 from a solver that has only seen K2
+    SmartPtr<LdlSolverInterface> ldl2 = makeSolver(app, "ldl_nemin 1\n");
+    initStructure(*ldl2, K2);
+    status = factorSolve(*ldl2, K2, true, false, 0, x, error);
+    assert(status == SYMSOLVER_SUCCESS);
+    assert(error <= 1e-8);
+    const Index negevals2 = ldl2->NumberOfNegEVals();
+
+    status = factorSolve(*ldl, K2, true, true, negevals2, x, error);
+    assert(status == SYMSOLVER_SUCCESS);
+    assert(ldl->NumberOfDelayedPivots() > 0);
+    assert(error <= 1e-8);
+
+    status = factorSolve(*ldl, K1, true, true, 12, x, error);
+    assert(status == SYMSOLVER_SUCCESS);
+    assert(x == x1);
+
+    bool increased = ldl->IncreaseQuality();
+    assert(increased);
+    status = factorSolve(*ldl, K1, false, true, 12, x, error);
+    assert(status == SYMSOLVER_CALL_AGAIN);
+    status = factorSolve(*ldl, K1, true, true, 12, x, error);
+    assert(status == SYMSOLVER_SUCCESS);
+    assert(error <= 1e-10);
+  }
+
+  // The result does not depend on the number of threads
+  {
+    Triplets K = kktSystem(40, 12, 3);
+    SmartPtr<LdlSolverInterface> ldl1 =
+      makeSolver(app, "ldl_nemin 1\nldl_num_threads 1\n");
+    initStructure(*ldl1, K);
+    ESymSolverStatus status = factorSolve(*ldl1, K, true, false, 0, x, error);
+    assert(status == SYMSOLVER_SUCCESS);
+    const std::vector<Number> x1 = x;
+    SmartPtr<LdlSolverInterface> ldl3 =
+      makeSolver(app, "ldl_nemin 1\nldl_num_threads 3\n");
+    initStructure(*ldl3, K);
+    status = factorSolve(*ldl3, K, true, false, 0, x, error);
+    assert(status == SYMSOLVER_SUCCESS);
+    assert(x == x1);
+    assert(ldl3->NumberOfNegEVals() == ldl1->NumberOfNegEVals());
+  }
+}
@@ -0,0 +1,204 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "IpIpoptApplication.hpp"
+#include "IpMultiVectorMatrix.hpp"
+#include "IpDenseGenMatrix.hpp"
+#include "IpDenseSymMatrix.hpp"
+#include "IpDenseVector.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+using namespace Ipopt;
+
+namespace
+{
+  /** Number of rows, large enough for the blocked operations, and
+   *  with a last block of rows that is only partly filled */
+  const Index nrows = 40007;
+  /** Number of columns */
+  const Index ncols = 5;
+
+  /** Deterministic values in [-1,1] */
+  Number entry(Index i, Index j)
+  {
+    return std::sin(0.37*i + 1.3*j + 0.1);
+  }
+
+  /** Matrix with DenseVector columns, shifted by shift, in a space
+   *  with num_threads threads */
+  SmartPtr<MultiVectorMatrix> makeMatrix(Index rows, Index num_threads,
+                                         Number shift)
+  {
+    SmartPtr<DenseVectorSpace> vec_space = new DenseVectorSpace(rows);
+    SmartPtr<MultiVectorMatrixSpace> space =
+      new MultiVectorMatrixSpace(ncols, *vec_space, num_threads);
+    SmartPtr<MultiVectorMatrix> V = space->MakeNewMultiVectorMatrix();
+    for (Index j=0; j<ncols; j++) {
+      SmartPtr<DenseVector> col = vec_space->MakeNewDenseVector();
+      Number* vals = col->Values();
+      for (Index i=0; i<rows; i++) {
+        vals[i] = entry(i, j) + shift;
+      }
+      V->SetVector(j, *col);
+    }
+    return V;
+  }
+
+  /** x with dim entries */
+  SmartPtr<DenseVector> makeVector(Index dim)
+  {
+    SmartPtr<DenseVectorSpace> space = new DenseVectorSpace(dim);
+    SmartPtr<DenseVector> x = space->MakeNewDenseVector();
+    Number* vals = x->Values();
+    for (Index i=0; i<dim; i++) {
+      vals[i] = entry(i, 7) - 0.2;
+    }
+    return x;
+  }
+
+  bool close(Number a, Number b)
+  {
+    return std::abs(a - b) <= 1e-12*(1. + std::abs(b))*nrows;
+  }
+
+  /** Results of the operations in checkProducts */
+  struct Results {
+    std::vector<Number> gen;
+    std::vector<Number> sym;
+    std::vector<Number> transmult;
+    std::vector<Number> mult;
+    std::vector<Number> rightmult;
+  };
+
+  /** Compare the operations of V1 and V2 with the products computed
+   *  column by column, and store their results in res */
+  void checkProducts(const MultiVectorMatrix& V1,
+                     const MultiVectorMatrix& V2, Results& res)
+  {
+    const Index rows = V1.NRows();
+    const Number* col1[ncols];
+    const Number* col2[ncols];
+    for (Index j=0; j<ncols; j++) {
+      col1[j] = static_cast<const DenseVector*>(GetRawPtr(V1.GetVector(j)))
+                ->Values();
+      col2[j] = static_cast<const DenseVector*>(GetRawPtr(V2.GetVector(j)))
+                ->Values();
+    }
+
+    // DenseGenMatrix::HighRankUpdateTranspose, once without and once
+    // with the old values
+    SmartPtr<DenseGenMatrixSpace> gen_space =
+      new DenseGenMatrixSpace(ncols, ncols);
+    SmartPtr<DenseGenMatrix> G = gen_space->MakeNewDenseGenMatrix();
+    G->HighRankUpdateTranspose(2., V1, V2, 0.);
+    G->HighRankUpdateTranspose(3., V1, V2, 0.5);
+    res.gen.assign(G->Values(), G->Values() + ncols*ncols);
+    for (Index j=0; j<ncols; j++) {
+      for (Index i=0; i<ncols; i++) {
+        const Number dot = V1.GetVector(i)->Dot(*V2.GetVector(j));
+        assert(close(res.gen[i+j*ncols], 4.*dot));
+      }
+    }
+
+    // DenseSymMatrix::HighRankUpdateTranspose
+    SmartPtr<DenseSymMatrixSpace> sym_space = new DenseSymMatrixSpace(ncols);
+    SmartPtr<DenseSymMatrix> S = sym_space->MakeNewDenseSymMatrix();
+    S->HighRankUpdateTranspose(1., V1, V2, 0.);
+    S->HighRankUpdateTranspose(2., V1, V2, 0.5);
+    res.sym.clear();
+    for (Index j=0; j<ncols; j++) {
+      for (Index i=j; i<ncols; i++) {
+        const Number dot = V1.GetVector(i)->Dot(*V2.GetVector(j));
+        res.sym.push_back(S->Values()[i+j*ncols]);
+        assert(close(S->Values()[i+j*ncols], 2.5*dot));
+      }
+    }
+
+    // TransMultVector and MultVector
+    SmartPtr<DenseVector> x = makeVector(rows);
+    SmartPtr<DenseVector> y = makeVector(ncols);
+    SmartPtr<DenseVector> y0 = makeVector(ncols);
+    V1.TransMultVector(2., *x, 0.5, *y);
+    res.transmult.assign(y->Values(), y->Values() + ncols);
+    for (Index j=0; j<ncols; j++) {
+      Number dot = 0.;
+      for (Index i=0; i<rows; i++) {
+        dot += col1[j][i]*x->Values()[i];
+      }
+      assert(close(res.transmult[j], 2.*dot + 0.5*y0->Values()[j]));
+    }
+
+    SmartPtr<DenseVector> z = makeVector(rows);
+    V2.MultVector(-1., *y, 3., *z);
+    res.mult.assign(z->Values(), z->Values() + rows);
+    const Number* xvals = x->Values();
+    for (Index i=0; i<rows; i++) {
+      Number sum = 3.*xvals[i];
+      for (Index j=0; j<ncols; j++) {
+        sum -= col2[j][i]*y->Values()[j];
+      }
+      assert(close(res.mult[i], sum));
+    }
+
+    // AddRightMultMatrix
+    SmartPtr<DenseGenMatrix> C = gen_space->MakeNewDenseGenMatrix();
+    for (Index k=0; k<ncols*ncols; k++) {
+      C->Values()[k] = entry(k, 11);
+    }
+    SmartPtr<MultiVectorMatrix> W = V2.MakeNewMultiVectorMatrix();
+    W->FillWithNewVectors();
+    W->AddRightMultMatrix(1.5, V1, *C, 0.);
+    res.rightmult.clear();
+    for (Index j=0; j<ncols; j++) {
+      const Number* wvals =
+        static_cast<const DenseVector*>(GetRawPtr(W->GetVector(j)))->Values();
+      for (Index i=0; i<rows; i++) {
+        Number sum = 0.;
+        for (Index k=0; k<ncols; k++) {
+          sum += col1[k][i]*C->Values()[k+j*ncols];
+        }
+        assert(close(wvals[i], 1.5*sum));
+        res.rightmult.push_back(wvals[i]);
+      }
+    }
+  }
+}
+
+void MultiVectorMatrixTest(IpoptApplication& app)
+{
+  // The blocked operations agree with the column-wise ones
+  SmartPtr<MultiVectorMatrix> V1 = makeMatrix(nrows, 1, 0.);
+  SmartPtr<MultiVectorMatrix> V2 = makeMatrix(nrows, 1, 0.3);
+  assert(V1->CanComputeInnerProducts(*V2));
+  Results res1;
+  checkProducts(*V1, *V2, res1);
+
+  // and their results do not depend on the number of threads
+  SmartPtr<MultiVectorMatrix> V1t = makeMatrix(nrows, 3, 0.);
+  SmartPtr<MultiVectorMatrix> V2t = makeMatrix(nrows, 3, 0.3);
+  assert(V1t->MultiVectorMatrixOwnerSpace()->NumThreads() == 3);
+  Results res3;
+  checkProducts(*V1t, *V2t, res3);
+  assert(res1.gen == res3.gen);
+  assert(res1.sym == res3.sym);
+  assert(res1.transmult == res3.transmult);
+  assert(res1.mult == res3.mult);
+  assert(res1.rightmult == res3.rightmult);
+
+  // Small matrices use the column-wise operations
+  SmartPtr<MultiVectorMatrix> V1s = makeMatrix(100, 1, 0.);
+  SmartPtr<MultiVectorMatrix> V2s = makeMatrix(100, 1, 0.3);
+  assert(!V1s->CanComputeInnerProducts(*V2s));
+  Results ress;
+  checkProducts(*V1s, *V2s, ress);
+}
@@ -0,0 +1,307 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+//
+// Benchmark for repeated solves of NLPs with the same structure.  A
+// sequence of rolling-horizon control problems, which differ only in
+// the reference trajectory, the initial state and the control bounds,
+// is solved (1) with a new OptimizeTNLP call for each problem, (2)
+// with ReOptimizeTNLP, and (3) with ReOptimizeTNLP and the option
+// warm_start_reuse_structure.  In a few stretches of the sequence the
+// upper bounds of the controls are removed, which changes the
+// structure of the problem.  The optimal objective values of all
+// versions are checked to agree.
+//
+// usage: resolveBench [num_solves [horizon]]
+
+#include "IpIpoptApplication.hpp"
+#include "IpSolveStatistics.hpp"
+#include "IpTNLP.hpp"
+#include "IpUtils.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Ipopt;
+
+/** Discretized control problem with horizon N:
+ *
+ *  min   sum_{i=0}^N (x_i - r_i)^2 + alpha sum_{i=0}^{N-1} u_i^2
+ *  s.t.  x_{i+1} = x_i + h (u_i - x_i^3),   i = 0,...,N-1
+ *        x_0 = x0 (fixed variable)
+ *        -umax <= u_i <= umax (upper bound optional)
+ *
+ *  with the reference r_i = sin(0.05 (i + shift)).
+ */
+class RollingHorizonNLP : public TNLP
+{
+public:
+  RollingHorizonNLP(Index N)
+      :
+      N_(N),
+      h_(0.1),
+      alpha_(0.01),
+      shift_(0.),
+      x0_(0.),
+      umax_(1.),
+      bounded_above_(true),
+      final_obj_(0.)
+  {}
+
+  /** Set the parameters of the next problem in the sequence */
+  void SetParameters(Number shift, Number x0, Number umax,
+                     bool bounded_above)
+  {
+    shift_ = shift;
+    x0_ = x0;
+    umax_ = umax;
+    bounded_above_ = bounded_above;
+  }
+
+  Number FinalObjective() const
+  {
+    return final_obj_;
+  }
+
+  virtual bool get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
+                            Index& nnz_h_lag, IndexStyleEnum& index_style)
+  {
+    n = 2*N_+1;
+    m = N_;
+    nnz_jac_g = 3*N_;
+    nnz_h_lag = 2*N_+1;
+    index_style = C_STYLE;
+    return true;
+  }
+
+  virtual bool get_bounds_info(Index n, Number* x_l, Number* x_u,
+                               Index m, Number* g_l, Number* g_u)
+  {
+    x_l[0] = x_u[0] = x0_;
+    for (Index i=1; i<=N_; i++) {
+      x_l[i] = -1e20;
+      x_u[i] = 1e20;
+    }
+    for (Index i=0; i<N_; i++) {
+      x_l[N_+1+i] = -umax_;
+      x_u[N_+1+i] = bounded_above_ ? umax_ : 1e20;
+      g_l[i] = g_u[i] = 0.;
+    }
+    return true;
+  }
+
+  virtual bool get_starting_point(Index n, bool init_x, Number* x,
+                                  bool init_z, Number* z_L, Number* z_U,
+                                  Index m, bool init_lambda,
+                                  Number* lambda)
+  {
+    for (Index i=0; i<n; i++) {
+      x[i] = 0.;
+    }
+    x[0] = x0_;
+    return true;
+  }
+
+  virtual bool eval_f(Index n, const Number* x, bool new_x,
+                      Number& obj_value)
+  {
+    obj_value = 0.;
+    for (Index i=0; i<=N_; i++) {
+      const Number d = x[i] - Reference(i);
+      obj_value += d*d;
+    }
+    for (Index i=0; i<N_; i++) {
+      obj_value += alpha_*x[N_+1+i]*x[N_+1+i];
+    }
+    return true;
+  }
+
+  virtual bool eval_grad_f(Index n, const Number* x, bool new_x,
+                           Number* grad_f)
+  {
+    for (Index i=0; i<=N_; i++) {
+      grad_f[i] = 2.*(x[i] - Reference(i));
+    }
+    for (Index i=0; i<N_; i++) {
+      grad_f[N_+1+i] = 2.*alpha_*x[N_+1+i];
+    }
+    return true;
+  }
+
+  virtual bool eval_g(Index n, const Number* x, bool new_x,
+                      Index m, Number* g)
+  {
+    for (Index i=0; i<N_; i++) {
+      g[i] = x[i+1] - x[i] - h_*(x[N_+1+i] - x[i]*x[i]*x[i]);
+    }
+    return true;
+  }
+
+  virtual bool eval_jac_g(Index n, const Number* x, bool new_x,
+                          Index m, Index nele_jac, Index* iRow,
+                          Index *jCol, Number* values)
+  {
+    if (values == NULL) {
+      for (Index i=0; i<N_; i++) {
+        iRow[3*i] = i;
+        jCol[3*i] = i;
+        iRow[3*i+1] = i;
+        jCol[3*i+1] = i+1;
+        iRow[3*i+2] = i;
+        jCol[3*i+2] = N_+1+i;
+      }
+    }
+    else {
+      for (Index i=0; i<N_; i++) {
+        values[3*i] = -1. + 3.*h_*x[i]*x[i];
+        values[3*i+1] = 1.;
+        values[3*i+2] = -h_;
+      }
+    }
+    return true;
+  }
+
+  virtual bool eval_h(Index n, const Number* x, bool new_x,
+                      Number obj_factor, Index m, const Number* lambda,
+                      bool new_lambda, Index nele_hess, Index* iRow,
+                      Index* jCol, Number* values)
+  {
+    if (values == NULL) {
+      for (Index i=0; i<n; i++) {
+        iRow[i] = i;
+        jCol[i] = i;
+      }
+    }
+    else {
+      for (Index i=0; i<=N_; i++) {
+        values[i] = 2.*obj_factor;
+        if (i<N_) {
+          values[i] += lambda[i]*6.*h_*x[i];
+        }
+      }
+      for (Index i=0; i<N_; i++) {
+        values[N_+1+i] = 2.*alpha_*obj_factor;
+      }
+    }
+    return true;
+  }
+
+  virtual void finalize_solution(SolverReturn status,
+                                 Index n, const Number* x,
+                                 const Number* z_L, const Number* z_U,
+                                 Index m, const Number* g,
+                                 const Number* lambda,
+                                 Number obj_value,
+                                 const IpoptData* ip_data,
+                                 IpoptCalculatedQuantities* ip_cq)
+  {
+    final_obj_ = obj_value;
+  }
+
+private:
+  Number Reference(Index i) const
+  {
+    return sin(0.05*(i + shift_));
+  }
+
+  Index N_;
+  Number h_;
+  Number alpha_;
+  Number shift_;
+  Number x0_;
+  Number umax_;
+  bool bounded_above_;
+  Number final_obj_;
+};
+
+/** Parameters of the k-th problem of the sequence.  In every fifth
+ *  stretch of 100 problems, the controls have no upper bounds. */
+static void SetProblem(RollingHorizonNLP& nlp, Index k)
+{
+  nlp.SetParameters((Number)k, 0.5*cos(0.1*k), 0.8 + 0.2*sin(0.03*k),
+                    (k/100)%5 != 4);
+}
+
+int main(int argc, char** argv)
+{
+  Index num_solves = 1000;
+  Index horizon = 500;
+  if (argc > 1) {
+    num_solves = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    horizon = atoi(argv[2]);
+  }
+
+  static const char* mode_names[] = {
+    "OptimizeTNLP", "ReOptimizeTNLP", "reuse structure"
+  };
+  SmartPtr<RollingHorizonNLP> nlp = new RollingHorizonNLP(horizon);
+  std::vector<Number> reference_obj(num_solves);
+  Number reference_time = 0.;
+  bool all_solved = true;
+  bool all_agree = true;
+
+  printf("%d solves with horizon %d (%d variables)\n\n",
+         num_solves, horizon, 2*horizon+1);
+  printf("%-16s %10s %12s %10s %8s\n", "mode", "time [s]",
+         "per solve[ms]", "iterations", "speedup");
+
+  for (int mode=0; mode<3; mode++) {
+    SmartPtr<IpoptApplication> app = IpoptApplicationFactory();
+    app->Options()->SetIntegerValue("print_level", 0);
+    if (mode == 2) {
+      app->Options()->SetStringValue("warm_start_reuse_structure", "yes");
+    }
+    if (app->Initialize() != Solve_Succeeded) {
+      printf("Error during initialization!\n");
+      return 1;
+    }
+
+    Index iterations = 0;
+    Number start = WallclockTime();
+    for (Index k=0; k<num_solves; k++) {
+      SetProblem(*nlp, k);
+      ApplicationReturnStatus status;
+      if (mode == 0 || k == 0) {
+        status = app->OptimizeTNLP(GetRawPtr(nlp));
+      }
+      else {
+        status = app->ReOptimizeTNLP(GetRawPtr(nlp));
+      }
+      if (status != Solve_Succeeded) {
+        printf("Solve %d failed with status %d for mode %s!\n", k, status,
+               mode_names[mode]);
+        all_solved = false;
+        continue;
+      }
+      iterations += app->Statistics()->IterationCount();
+
+      const Number obj = nlp->FinalObjective();
+      if (mode == 0) {
+        reference_obj[k] = obj;
+      }
+      else if (fabs(obj - reference_obj[k]) >
+               1e-6*(1. + fabs(reference_obj[k]))) {
+        printf("Objective of solve %d differs for mode %s: %e vs %e\n",
+               k, mode_names[mode], obj, reference_obj[k]);
+        all_agree = false;
+      }
+    }
+    Number elapsed = WallclockTime() - start;
+    if (mode == 0) {
+      reference_time = elapsed;
+    }
+    printf("%-16s %10.3f %12.3f %10d %8.2f\n", mode_names[mode], elapsed,
+           1e3*elapsed/num_solves, iterations, reference_time/elapsed);
+  }
+
+  if (!all_solved || !all_agree) {
+    return 1;
+  }
+  return 0;
+}
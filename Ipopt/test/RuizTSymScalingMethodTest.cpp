@@ -0,0 +1,67 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "IpIpoptApplication.hpp"
+#include "IpRuizTSymScalingMethod.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+using namespace Ipopt;
+
+void RuizTSymScalingMethodTest(IpoptApplication& app)
+{
+  // Lower triangle (1-based triplets) of a symmetric matrix whose
+  // entries range from 1e-8 to 1e8, including an empty row
+  const Index n = 7;
+  std::vector<Index> irn, jcn;
+  std::vector<Number> val;
+  for (Index i=0; i<n-1; i++) {
+    irn.push_back(i+1);
+    jcn.push_back(i+1);
+    val.push_back(pow(10., 8-3*i));
+    if (i+1 < n-1) {
+      irn.push_back(i+2);
+      jcn.push_back(i+1);
+      val.push_back(-pow(10., i-4));
+    }
+  }
+  irn.push_back(n-1);
+  jcn.push_back(1);
+  val.push_back(3e5);
+  const Index nnz = (Index)val.size();
+
+  Number tol;
+  app.Options()->GetNumericValue("ruiz_scaling_tol", tol, "");
+  app.Options()->SetIntegerValue("ruiz_scaling_max_iter", 100);
+  SmartPtr<RuizTSymScalingMethod> ruiz = new RuizTSymScalingMethod();
+  bool ok = ruiz->ReducedInitialize(*app.Jnlst(), *app.Options(), "");
+  assert(ok);
+  std::vector<Number> d(n);
+  ok = ruiz->ComputeSymTScalingFactors(n, nnz, &irn[0], &jcn[0], &val[0],
+                                       &d[0]);
+  assert(ok);
+
+  // The rows of D|A|D have max norm one up to the tolerance, the empty
+  // row keeps the factor one
+  std::vector<Number> row_max(n, 0.);
+  for (Index k=0; k<nnz; k++) {
+    const Index i = irn[k]-1;
+    const Index j = jcn[k]-1;
+    const Number scaled = d[i]*fabs(val[k])*d[j];
+    row_max[i] = Max(row_max[i], scaled);
+    row_max[j] = Max(row_max[j], scaled);
+  }
+  for (Index i=0; i<n-1; i++) {
+    assert(fabs(row_max[i] - 1.) <= tol);
+  }
+  assert(d[n-1] == 1.);
+}
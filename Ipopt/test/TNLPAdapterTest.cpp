@@ -0,0 +1,185 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "IpIpoptApplication.hpp"
+#include "IpTNLPAdapter.hpp"
+
+#include <cassert>
+
+using namespace Ipopt;
+
+namespace
+{
+  /** min x0^2 + x1^2 s.t. g_l <= x0 + x1 <= g_u, x_l <= x <= x_u,
+   *  with bounds that can be changed between the calls. */
+  class BoundsTNLP : public TNLP
+  {
+  public:
+    Number x_l[2], x_u[2], g_l, g_u;
+
+    BoundsTNLP()
+        :
+        g_l(1.),
+        g_u(2e19)
+    {
+      x_l[0] = x_l[1] = -1.;
+      x_u[0] = x_u[1] = 1.;
+    }
+
+    virtual bool get_nlp_info(Index& n, Index& m, Index& nnz_jac_g,
+                              Index& nnz_h_lag, IndexStyleEnum& index_style)
+    {
+      n = 2;
+      m = 1;
+      nnz_jac_g = 2;
+      nnz_h_lag = 2;
+      index_style = C_STYLE;
+      return true;
+    }
+
+    virtual bool get_bounds_info(Index n, Number* xl, Number* xu,
+                                 Index m, Number* gl, Number* gu)
+    {
+      for (Index i=0; i<n; i++) {
+        xl[i] = x_l[i];
+        xu[i] = x_u[i];
+      }
+      gl[0] = g_l;
+      gu[0] = g_u;
+      return true;
+    }
+
+    virtual bool get_starting_point(Index n, bool init_x, Number* x,
+                                    bool init_z, Number* z_L, Number* z_U,
+                                    Index m, bool init_lambda, Number* lambda)
+    {
+      x[0] = x[1] = 0.5;
+      return true;
+    }
+
+    virtual bool eval_f(Index n, const Number* x, bool new_x,
+                        Number& obj_value)
+    {
+      obj_value = x[0]*x[0] + x[1]*x[1];
+      return true;
+    }
+
+    virtual bool eval_grad_f(Index n, const Number* x, bool new_x,
+                             Number* grad_f)
+    {
+      grad_f[0] = 2.*x[0];
+      grad_f[1] = 2.*x[1];
+      return true;
+    }
+
+    virtual bool eval_g(Index n, const Number* x, bool new_x,
+                        Index m, Number* g)
+    {
+      g[0] = x[0] + x[1];
+      return true;
+    }
+
+    virtual bool eval_jac_g(Index n, const Number* x, bool new_x,
+                            Index m, Index nele_jac, Index* iRow,
+                            Index *jCol, Number* values)
+    {
+      if (values) {
+        values[0] = values[1] = 1.;
+      }
+      else {
+        iRow[0] = iRow[1] = 0;
+        jCol[0] = 0;
+        jCol[1] = 1;
+      }
+      return true;
+    }
+
+    virtual bool eval_h(Index n, const Number* x, bool new_x,
+                        Number obj_factor, Index m, const Number* lambda,
+                        bool new_lambda, Index nele_hess,
+                        Index* iRow, Index* jCol, Number* values)
+    {
+      if (values) {
+        values[0] = values[1] = 2.*obj_factor;
+      }
+      else {
+        iRow[0] = jCol[0] = 0;
+        iRow[1] = jCol[1] = 1;
+      }
+      return true;
+    }
+
+    virtual void finalize_solution(SolverReturn status,
+                                   Index n, const Number* x,
+                                   const Number* z_L, const Number* z_U,
+                                   Index m, const Number* g,
+                                   const Number* lambda, Number obj_value,
+                                   const IpoptData* ip_data,
+                                   IpoptCalculatedQuantities* ip_cq)
+    {}
+  };
+
+  void createSpaces(TNLPAdapter& adapter)
+  {
+    SmartPtr<const VectorSpace> x_space, c_space, d_space, x_l_space,
+    x_u_space, d_l_space, d_u_space;
+    SmartPtr<const MatrixSpace> px_l_space, px_u_space, pd_l_space,
+    pd_u_space, Jac_c_space, Jac_d_space;
+    SmartPtr<const SymMatrixSpace> Hess_lagrangian_space;
+    bool ok = adapter.GetSpaces(x_space, c_space, d_space, x_l_space,
+                                px_l_space, x_u_space, px_u_space,
+                                d_l_space, pd_l_space, d_u_space,
+                                pd_u_space, Jac_c_space, Jac_d_space,
+                                Hess_lagrangian_space);
+    assert(ok);
+  }
+}
+
+void TNLPAdapterTest(IpoptApplication& app)
+{
+  SmartPtr<BoundsTNLP> tnlp = new BoundsTNLP();
+  SmartPtr<TNLPAdapter> adapter = new TNLPAdapter(GetRawPtr(tnlp),
+                                  ConstPtr(app.Jnlst()));
+  bool ok = adapter->ProcessOptions(*app.Options(), "");
+  assert(ok);
+  assert(!adapter->HasSameStructure());
+  createSpaces(*adapter);
+  assert(adapter->HasSameStructure());
+
+  // Other values of finite bounds keep the structure
+  tnlp->x_u[0] = 3.;
+  tnlp->g_l = 0.5;
+  assert(adapter->HasSameStructure());
+
+  // Inconsistent bounds never do, and are rejected by GetSpaces
+  tnlp->x_l[1] = 2.;
+  assert(!adapter->HasSameStructure());
+  bool thrown = false;
+  try {
+    createSpaces(*adapter);
+  }
+  catch (TNLPAdapter::INVALID_TNLP&) {
+    thrown = true;
+  }
+  assert(thrown);
+  tnlp->x_l[1] = -1.;
+
+  tnlp->g_l = 3e19;
+  assert(!adapter->HasSameStructure());
+  tnlp->g_l = 0.5;
+
+  // Fixing a variable or removing a bound changes the structure
+  createSpaces(*adapter);
+  assert(adapter->HasSameStructure());
+  tnlp->x_l[0] = tnlp->x_u[0];
+  assert(!adapter->HasSameStructure());
+  tnlp->x_l[0] = -2e19;
+  assert(!adapter->HasSameStructure());
+}
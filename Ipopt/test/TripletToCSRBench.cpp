@@ -0,0 +1,353 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+//
+// Benchmark for TripletToCSRConverter.  KKT matrices of generated
+// problems with n variables and n/2 constraints are converted from
+// the triplet format (in the order in which Ipopt creates it,
+// including repeated diagonal entries) to the compressed format.  The
+// structure conversion and the conversion of the values are timed
+// for a reference implementation that sorts the entries with
+// std::stable_sort and copies the values with plain loops, and for
+// TripletToCSRConverter with one thread and with the OpenMP default
+// number of threads.  The results are checked to be identical.
+//
+// usage: tripletToCSRBench [max_n [min_seconds]]
+
+#include "IpTripletToCSRConverter.hpp"
+#include "IpUtils.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace Ipopt;
+
+/** Generate the triplet structure of the KKT matrix of a problem with
+ *  n variables and m constraints: a banded Hessian with a few random
+ *  entries, the diagonal of the primal-dual Hessian, the Jacobian
+ *  with three entries per row, and the diagonal for the
+ *  constraints. */
+static void GenerateKKT(Index n, Index m, std::vector<Index>& airn,
+                        std::vector<Index>& ajcn)
+{
+  airn.clear();
+  ajcn.clear();
+  for (Index i=1; i<=n; i++) {
+    airn.push_back(i);
+    ajcn.push_back(i);
+    if (i>1) {
+      airn.push_back(i);
+      ajcn.push_back(i-1);
+    }
+    if (i>50) {
+      airn.push_back(i);
+      ajcn.push_back(i - 1 - (Index)(49*IpRandom01()));
+    }
+  }
+  for (Index i=1; i<=n; i++) {
+    airn.push_back(i);
+    ajcn.push_back(i);
+  }
+  for (Index r=0; r<m; r++) {
+    const Index j = 2*r + 1;
+    airn.push_back(n+r+1);
+    ajcn.push_back(j);
+    airn.push_back(n+r+1);
+    ajcn.push_back(j+1);
+    airn.push_back(n+r+1);
+    ajcn.push_back(1 + (Index)(n*IpRandom01()));
+  }
+  for (Index r=0; r<m; r++) {
+    airn.push_back(n+r+1);
+    ajcn.push_back(n+r+1);
+  }
+}
+
+/** Reference conversion into the upper triangular format with offset 1 */
+class ReferenceConverter
+{
+public:
+  class Entry
+  {
+  public:
+    Index row;
+    Index col;
+    Index pos;
+    bool operator<(const Entry& e) const
+    {
+      return row < e.row || (row == e.row && col < e.col);
+    }
+  };
+
+  void Initialize(Index dim, Index nonzeros, const Index* airn,
+                  const Index* ajcn)
+  {
+    std::vector<Entry> entries(nonzeros);
+    for (Index k=0; k<nonzeros; k++) {
+      entries[k].row = Min(airn[k], ajcn[k]);
+      entries[k].col = Max(airn[k], ajcn[k]);
+      entries[k].pos = k;
+    }
+    std::stable_sort(entries.begin(), entries.end());
+
+    ia.assign(dim+1, 0);
+    ja.clear();
+    ipos_first.clear();
+    double_triplet.clear();
+    double_compressed.clear();
+    for (Index k=0; k<nonzeros; k++) {
+      const Entry& e = entries[k];
+      if (k>0 && e.row == entries[k-1].row && e.col == entries[k-1].col) {
+        double_triplet.push_back(e.pos);
+        double_compressed.push_back((Index)ja.size()-1);
+      }
+      else {
+        ja.push_back(e.col);
+        ipos_first.push_back(e.pos);
+        ia[e.row]++;
+      }
+    }
+    ia[0] = 1;
+    for (Index i=1; i<=dim; i++) {
+      ia[i] += ia[i-1];
+    }
+  }
+
+  void ConvertValues(const Number* a_triplet, Number* a_compressed) const
+  {
+    for (size_t i=0; i<ipos_first.size(); i++) {
+      a_compressed[i] = a_triplet[ipos_first[i]];
+    }
+    for (size_t i=0; i<double_triplet.size(); i++) {
+      a_compressed[double_compressed[i]] += a_triplet[double_triplet[i]];
+    }
+  }
+
+  std::vector<Index> ia;
+  std::vector<Index> ja;
+  std::vector<Index> ipos_first;
+  std::vector<Index> double_triplet;
+  std::vector<Index> double_compressed;
+};
+
+/** Check the full format against the triangular one: each entry of
+ *  the upper triangle must appear at both positions with the same
+ *  value. */
+static bool CheckFullFormat(Index dim, const ReferenceConverter& ref,
+                            const Number* a_ref,
+                            const TripletToCSRConverter& full,
+                            const Number* a_full)
+{
+  const Index* ia = full.IA();
+  const Index* ja = full.JA();
+  for (Index i=0; i<dim; i++) {
+    for (Index p=ref.ia[i]-1; p<ref.ia[i+1]-1; p++) {
+      const Index j = ref.ja[p]-1;
+      for (int twice=0; twice<2; twice++) {
+        const Index r = twice ? j : i;
+        const Index c = twice ? i : j;
+        const Index* first = ja + ia[r] - 1;
+        const Index* last = ja + ia[r+1] - 1;
+        const Index* q = std::lower_bound(first, last, c+1);
+        if (q == last || *q != c+1 || a_full[q-ja] != a_ref[p]) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/** Time the function object f; returns the seconds per call. */
+template<class F>
+static Number Time(F& f, Number min_seconds)
+{
+  Index reps = 0;
+  Number start = WallclockTime();
+  Number elapsed;
+  do {
+    f();
+    reps++;
+    elapsed = WallclockTime() - start;
+  }
+  while (elapsed < min_seconds);
+  return elapsed/reps;
+}
+
+class InitReference
+{
+public:
+  InitReference(ReferenceConverter& c, Index dim, const std::vector<Index>& airn,
+                const std::vector<Index>& ajcn)
+      : c_(c), dim_(dim), airn_(airn), ajcn_(ajcn)
+  {}
+  void operator()()
+  {
+    c_.Initialize(dim_, (Index)airn_.size(), &airn_[0], &ajcn_[0]);
+  }
+private:
+  ReferenceConverter& c_;
+  Index dim_;
+  const std::vector<Index>& airn_;
+  const std::vector<Index>& ajcn_;
+};
+
+class InitConverter
+{
+public:
+  InitConverter(TripletToCSRConverter& c, Index dim,
+                const std::vector<Index>& airn, const std::vector<Index>& ajcn)
+      : c_(c), dim_(dim), airn_(airn), ajcn_(ajcn)
+  {}
+  void operator()()
+  {
+    c_.InitializeConverter(dim_, (Index)airn_.size(), &airn_[0], &ajcn_[0]);
+  }
+private:
+  TripletToCSRConverter& c_;
+  Index dim_;
+  const std::vector<Index>& airn_;
+  const std::vector<Index>& ajcn_;
+};
+
+class ValuesReference
+{
+public:
+  ValuesReference(const ReferenceConverter& c, const Number* a, Number* b)
+      : c_(c), a_(a), b_(b)
+  {}
+  void operator()()
+  {
+    c_.ConvertValues(a_, b_);
+  }
+private:
+  const ReferenceConverter& c_;
+  const Number* a_;
+  Number* b_;
+};
+
+class ValuesConverter
+{
+public:
+  ValuesConverter(TripletToCSRConverter& c, Index nt, const Number* a,
+                  Index nc, Number* b)
+      : c_(c), nt_(nt), a_(a), nc_(nc), b_(b)
+  {}
+  void operator()()
+  {
+    c_.ConvertValues(nt_, a_, nc_, b_);
+  }
+private:
+  TripletToCSRConverter& c_;
+  Index nt_;
+  const Number* a_;
+  Index nc_;
+  Number* b_;
+};
+
+int main(int argc, char** argv)
+{
+  Index max_n = 4000000;
+  Number min_seconds = 0.2;
+  if (argc > 1) {
+    max_n = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    min_seconds = atof(argv[2]);
+  }
+
+  TripletToCSRConverter probe(1);
+  printf("Threads for large matrices: %d\n\n", probe.NumThreads(1<<30));
+  printf("%9s %10s | %28s | %28s\n", "n", "nonzeros",
+         "structure (ms)", "values (ms)");
+  printf("%9s %10s | %8s %8s %8s %8s | %8s %8s %8s %8s\n", "", "",
+         "ref", "1 thr", "threads", "speedup", "ref", "1 thr", "threads",
+         "speedup");
+
+  bool all_identical = true;
+  for (Index n=10000; n<=max_n; n*=4) {
+    const Index m = n/2;
+    const Index dim = n + m;
+    std::vector<Index> airn;
+    std::vector<Index> ajcn;
+    IpResetRandom01();
+    GenerateKKT(n, m, airn, ajcn);
+    const Index nonzeros = (Index)airn.size();
+    std::vector<Number> a_triplet(nonzeros);
+    for (Index k=0; k<nonzeros; k++) {
+      a_triplet[k] = IpRandom01() - 0.5;
+    }
+
+    ReferenceConverter ref;
+    TripletToCSRConverter serial(1, TripletToCSRConverter::Triangular_Format, 1);
+    TripletToCSRConverter parallel(1);
+    TripletToCSRConverter full(1, TripletToCSRConverter::Full_Format);
+
+    Number t_init[3];
+    InitReference init_ref(ref, dim, airn, ajcn);
+    InitConverter init_serial(serial, dim, airn, ajcn);
+    InitConverter init_parallel(parallel, dim, airn, ajcn);
+    t_init[0] = Time(init_ref, min_seconds);
+    t_init[1] = Time(init_serial, min_seconds);
+    t_init[2] = Time(init_parallel, min_seconds);
+    const Index nc = (Index)ref.ja.size();
+    const Index nc_full =
+      full.InitializeConverter(dim, nonzeros, &airn[0], &ajcn[0]);
+
+    std::vector<Number> a_ref(nc);
+    std::vector<Number> a_serial(nc);
+    std::vector<Number> a_parallel(nc);
+    std::vector<Number> a_full(nc_full);
+    Number t_values[3];
+    ValuesReference values_ref(ref, &a_triplet[0], &a_ref[0]);
+    ValuesConverter values_serial(serial, nonzeros, &a_triplet[0], nc,
+                                  &a_serial[0]);
+    ValuesConverter values_parallel(parallel, nonzeros, &a_triplet[0], nc,
+                                    &a_parallel[0]);
+    t_values[0] = Time(values_ref, min_seconds);
+    t_values[1] = Time(values_serial, min_seconds);
+    t_values[2] = Time(values_parallel, min_seconds);
+    full.ConvertValues(nonzeros, &a_triplet[0], nc_full, &a_full[0]);
+
+    // Check the results against the reference implementation
+    const TripletToCSRConverter* convs[2] = {&serial, &parallel};
+    const Number* vals[2] = {&a_serial[0], &a_parallel[0]};
+    for (int c=0; c<2; c++) {
+      const TripletToCSRConverter& conv = *convs[c];
+      const Index nd = (Index)ref.double_triplet.size();
+      if (conv.NumDoubles() != nd ||
+          memcmp(conv.IA(), &ref.ia[0], (dim+1)*sizeof(Index)) ||
+          memcmp(conv.JA(), &ref.ja[0], nc*sizeof(Index)) ||
+          memcmp(conv.iPosFirst(), &ref.ipos_first[0], nc*sizeof(Index)) ||
+          (nd > 0 &&
+           (memcmp(conv.iPosDoubleTriplet(), &ref.double_triplet[0],
+                   nd*sizeof(Index)) ||
+            memcmp(conv.iPosDoubleCompressed(), &ref.double_compressed[0],
+                   nd*sizeof(Index)))) ||
+          memcmp(vals[c], &a_ref[0], nc*sizeof(Number))) {
+        printf("Results of the converter differ from the reference for n=%d!\n", n);
+        all_identical = false;
+      }
+    }
+    if (!CheckFullFormat(dim, ref, &a_ref[0], full, &a_full[0])) {
+      printf("Full format is inconsistent for n=%d!\n", n);
+      all_identical = false;
+    }
+
+    printf("%9d %10d | %8.2f %8.2f %8.2f %8.2f | %8.2f %8.2f %8.2f %8.2f\n",
+           n, nonzeros, 1e3*t_init[0], 1e3*t_init[1], 1e3*t_init[2],
+           t_init[0]/t_init[2], 1e3*t_values[0], 1e3*t_values[1],
+           1e3*t_values[2], t_values[0]/t_values[2]);
+  }
+
+  if (!all_identical) {
+    printf("\nThe converter does not reproduce the reference!\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,168 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+//
+// Micro-benchmark for the element-wise kernels of DenseVector.  For
+// vector lengths from 10 to 10^7, the fused DenseVector operations are
+// timed with the plain loops and with each vectorized version
+// supported by the CPU, and the results of all versions are checked
+// to be identical.
+//
+// usage: vectorKernelsBench [max_length [min_seconds]]
+
+#include "IpDenseVector.hpp"
+#include "IpVectorKernels.hpp"
+#include "IpUtils.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace Ipopt;
+
+static const char* level_names[] = {"scalar", "avx2", "avx512"};
+static const int n_ops = 5;
+static const char* op_names[] = {
+  "AddTwoVectors", "ElementWiseMultiply", "ElementWiseDivide",
+  "FracToBound", "AddVectorQuotient"
+};
+
+/** Fill v with random numbers in [lo, lo+width). */
+static void RandomFill(DenseVector& v, Number lo, Number width)
+{
+  Number* vals = v.Values();
+  for (Index i=0; i<v.Dim(); i++) {
+    vals[i] = lo + width*IpRandom01();
+  }
+}
+
+/** Perform operation op once on the vectors; returns the result of
+ *  FracToBound (or 0).  sinv contains the reciprocals of s. */
+static Number RunOp(int op, bool inverse, DenseVector& y,
+                    const DenseVector& x, const DenseVector& z,
+                    const DenseVector& s, const DenseVector& sinv)
+{
+  switch (op) {
+  case 0:
+    y.AddTwoVectors(0.5, x, -2., z, 0.25);
+    break;
+  case 1:
+    y.ElementWiseMultiply(inverse ? sinv : s);
+    break;
+  case 2:
+    y.ElementWiseDivide(inverse ? sinv : s);
+    break;
+  case 3:
+    return s.FracToBound(x, 0.99);
+  default:
+    y.AddVectorQuotient(0.5, z, s, 0.25);
+  }
+  return 0.;
+}
+
+int main(int argc, char** argv)
+{
+  Index max_len = 10000000;
+  Number min_seconds = 0.2;
+  if (argc > 1) {
+    max_len = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    min_seconds = atof(argv[2]);
+  }
+
+  const VectorKernelLevel max_level = IpVectorKernelMaxLevel();
+  printf("Widest kernels supported: %s\n\n", level_names[max_level]);
+  printf("%9s %-20s", "n", "operation");
+  for (int l=0; l<=max_level; l++) {
+    printf(" %10s", level_names[l]);
+  }
+  printf("   (ns per element)");
+  for (int l=1; l<=max_level; l++) {
+    printf(" %8s", level_names[l]);
+  }
+  printf(" (speedup)\n");
+
+  bool all_identical = true;
+  for (Index n=10; n<=max_len; n*=10) {
+    SmartPtr<DenseVectorSpace> space = new DenseVectorSpace(n);
+    SmartPtr<DenseVector> x = space->MakeNewDenseVector();
+    SmartPtr<DenseVector> z = space->MakeNewDenseVector();
+    SmartPtr<DenseVector> s = space->MakeNewDenseVector();
+    SmartPtr<DenseVector> sinv = space->MakeNewDenseVector();
+    SmartPtr<DenseVector> y0 = space->MakeNewDenseVector();
+    SmartPtr<DenseVector> y = space->MakeNewDenseVector();
+    IpResetRandom01();
+    RandomFill(*x, -1., 2.);
+    RandomFill(*z, -1., 2.);
+    RandomFill(*s, 0.5, 1.);
+    RandomFill(*y0, -1., 2.);
+    sinv->Copy(*s);
+    sinv->ElementWiseReciprocal();
+
+    for (int op=0; op<n_ops; op++) {
+      Number ns[3];
+      std::vector<Number> reference;
+      Number reference_alpha = 0.;
+      for (int l=0; l<=max_level; l++) {
+        IpSetVectorKernelLevel((VectorKernelLevel)l);
+
+        // Check the result of one call against the plain loops
+        y->Copy(*y0);
+        Number alpha = RunOp(op, false, *y, *x, *z, *s, *sinv);
+        const Number* vals = y->Values();
+        if (l == 0) {
+          reference.assign(vals, vals+n);
+          reference_alpha = alpha;
+        }
+        else if (alpha != reference_alpha ||
+                 memcmp(&reference[0], vals, n*sizeof(Number))) {
+          printf("Results of %s differ for %s kernels and n=%d!\n",
+                 op_names[op], level_names[l], n);
+          all_identical = false;
+        }
+
+        // Repeat until at least min_seconds have passed.  Products
+        // and quotients alternate between s and its reciprocal, so that
+        // the values of y stay bounded.
+        Index reps = 0;
+        Number start = WallclockTime();
+        Number elapsed = 0.;
+        Number sink = 0.;
+        do {
+          Index batch = Max(1, 1000000/n);
+          for (Index k=0; k<batch; k++) {
+            sink += RunOp(op, k%2 == 1, *y, *x, *z, *s, *sinv);
+          }
+          reps += batch;
+          elapsed = WallclockTime() - start;
+        }
+        while (elapsed < min_seconds);
+        ns[l] = 1e9*elapsed/((Number)reps*(Number)n);
+        if (sink == -1.) {
+          printf(" ");
+        }
+      }
+
+      printf("%9d %-20s", n, op_names[op]);
+      for (int l=0; l<=max_level; l++) {
+        printf(" %10.3f", ns[l]);
+      }
+      printf("                  ");
+      for (int l=1; l<=max_level; l++) {
+        printf(" %8.2f", ns[0]/ns[l]);
+      }
+      printf("\n");
+    }
+  }
+
+  IpSetVectorKernelLevel(max_level);
+  if (!all_identical) {
+    printf("\nThe vectorized kernels do not reproduce the plain loops!\n");
+    return 1;
+  }
+  return 0;
+}
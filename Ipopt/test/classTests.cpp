@@ -0,0 +1,78 @@
+// Copyright (C) 2012 International Business Machines and others.
+// All Rights Reserved.
+// This code is published under the Eclipse Public License.
+//
+// $Id$
+//
+// Tests of individual Ipopt classes.  Each test function checks its
+// results with assert and aborts on the first failure.
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "IpIpoptApplication.hpp"
+
+// The tests of the optional parts depend on the configuration
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdio>
+
+using namespace Ipopt;
+
+void BlockEvalTest(IpoptApplication& app);
+void ExprTapeTest(IpoptApplication& app);
+void FinDiffTest(IpoptApplication& app);
+void IpoptApplicationTest(IpoptApplication& app);
+#ifdef BUILD_INEXACT
+void IterativeLdlSolverInterfaceTest(IpoptApplication& app);
+#endif
+void LdlSolverInterfaceTest(IpoptApplication& app);
+void MultiVectorMatrixTest(IpoptApplication& app);
+void RuizTSymScalingMethodTest(IpoptApplication& app);
+void TNLPAdapterTest(IpoptApplication& app);
+
+static void testingMessage(const char* msg)
+{
+  printf("%s", msg);
+  fflush(stdout);
+}
+
+int main()
+{
+  SmartPtr<IpoptApplication> app = new IpoptApplication(false);
+
+  testingMessage("Testing LdlSolverInterface\n");
+  LdlSolverInterfaceTest(*app);
+
+#ifdef BUILD_INEXACT
+  testingMessage("Testing IterativeLdlSolverInterface\n");
+  IterativeLdlSolverInterfaceTest(*app);
+#endif
+
+  testingMessage("Testing MultiVectorMatrix\n");
+  MultiVectorMatrixTest(*app);
+
+  testingMessage("Testing RuizTSymScalingMethod\n");
+  RuizTSymScalingMethodTest(*app);
+
+  testingMessage("Testing ExprTape\n");
+  ExprTapeTest(*app);
+
+  testingMessage("Testing finite difference derivatives\n");
+  FinDiffTest(*app);
+
+  testingMessage("Testing TNLPAdapter\n");
+  TNLPAdapterTest(*app);
+
+  testingMessage("Testing IpoptApplication\n");
+  IpoptApplicationTest(*app);
+
+  testingMessage("Testing block evaluation\n");
+  BlockEvalTest(*app);
+
+  testingMessage("All tests completed successfully\n");
+  return 0;
+}
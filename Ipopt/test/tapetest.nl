@@ -0,0 +1,100 @@
+g0 0 0 0	# tape test problem - the 'g' indicates the file here is in ascii
+4 3 1 1 0	# num vars, num constraints, num objectives, num ranges, num equations
+3 1	        # number nonlinear constraints, num nonlinear objectives
+0 0	        # num nonlinear network constraints, num linear network constraints
+4 4 4	        # num nonlinear vars in constraints, objectives, both
+0 0 0 1	        # num linear network variables; functions; arith, flags
+0 0 0 0 0	# discrete variables: binary, integer, nonlinear (b,c,o)
+12 4	        # number nonzeros in Jacobian, number nonzeros in gradients
+0 0	        # max name lengths: constraints, variables
+1 0 0 0 0	# common expressions: both, constraints, objectives, c1, o1
+V4 1 0	#           defined variable v4 = x0*x1 + 0.5*x2, used in constraints and objective
+2 0.5   #             var-2, linear coefficient 0.5
+o2	#             = multiply
+v0	#             = x0
+v1	#             = x1
+C0	#           constraint-0: sin(x0)*exp(v4) + x3^2
+o0	#             = add
+o2	#             = multiply
+o41	#             = sin
+v0
+o44	#             = exp
+v4
+o5	#             = raise-to-power
+v3
+n2
+C1	#           constraint-1: log(x0+x2)/x1 - (x0 + x1*x3 + tanh(x2))
+o1	#             = subtract
+o3	#             = divide
+o43	#             = log
+o0	#             = add
+v0
+v2
+v1
+o54	#             = sum of a list
+3       #             with 3 terms
+v0
+o2	#             = multiply
+v1
+v3
+o37	#             = tanh
+v2
+C2	#           constraint-2: sqrt(x1) + atan(x3)*v4 - cos(x0) + linear part
+o54	#             = sum of a list
+3       #             with 3 terms
+o39	#             = sqrt
+v1
+o2	#             = multiply
+o49	#             = atan
+v3
+v4
+o16	#             = unary minus
+o46	#             = cos
+v0
+O0 0	#           objective(-0), minimize: x0^x1 + v4^2/(1 + x2*x3) + linear part
+o0	#             = add
+o5	#             = raise-to-power
+v0
+v1
+o3	#             = divide
+o5	#             = raise-to-power
+v4
+n2
+o0	#             = add
+n1
+o2	#             = multiply
+v2
+v3
+r	#           right-hand side section
+1 10    #             constraint-0 body <= 10
+2 -10   #             constraint-1 body >= -10
+0 -5 20 #             -5 <= constraint-2 body <= 20
+b	#           bounds on variables section
+0 0.5 3 #             0.5 <= var-0 <= 3
+0 0.5 3 #             0.5 <= var-1 <= 3
+0 0.5 3 #             0.5 <= var-2 <= 3
+0 0.5 3 #             0.5 <= var-3 <= 3
+k3	#           cumulative Jacobian column counts
+3       #             columns 0..0
+6       #             columns 0..1
+9       #             columns 0..2
+J0 4    #           row-0 of the Jacobian (all variables appear nonlinearly)
+0 0
+1 0
+2 0
+3 0
+J1 4    #           row-1 of the Jacobian
+0 0
+1 0
+2 0
+3 0
+J2 4    #           row-2 of the Jacobian, with the linear part -x0 + 2*x3
+0 -1
+1 0
+2 0
+3 2
+G0 4    #           gradient of objective(-0), with the linear part 0.3*x3
+0 0
+1 0
+2 0
+3 0.3